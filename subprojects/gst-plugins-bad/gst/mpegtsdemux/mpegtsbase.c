@@ -1507,6 +1507,7 @@ mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   MpegTSPacketizer2 *packetizer;
   MpegTSPacketizerPacket packet;
   MpegTSBaseClass *klass;
+  gboolean skip_unknown;
 
   base = GST_MPEGTS_BASE (parent);
   klass = GST_MPEGTS_BASE_GET_CLASS (base);
@@ -1537,7 +1538,18 @@ mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 
   mpegts_packetizer_push (base->packetizer, buf);
 
+  /* Without unknown packets to push or inspect, packets on PIDs we don't
+   * handle can be skipped without parsing them. With a subclass that only
+   * handles the PES PIDs of the selected program, this also skips the
+   * packets of all other programs in a multiplex */
+  skip_unknown = !base->push_unknown && !klass->inspect_packet;
+
   while (res == GST_FLOW_OK) {
+    if (skip_unknown)
+      mpegts_packetizer_skip_packets (packetizer,
+          base->selected_pes ? base->selected_pes : base->is_pes,
+          base->known_psi);
+
     pret = mpegts_packetizer_next_packet (base->packetizer, &packet);
 
     /* If we don't have enough data, return */
@@ -135,6 +135,9 @@ struct _MpegTSBase {
   /* Use MPEGTS_BIT_* to set/unset/check the values */
   guint8 *known_psi;
   guint8 *is_pes;
+  /* set by subclasses that only handle some of the pes pids, the packets of
+   * the other pes pids are then skipped without parsing them */
+  guint8 *selected_pes;
 
   gboolean disposed;
 
@@ -915,6 +915,66 @@ mpegts_packetizer_process_next_packet (MpegTSPacketizer2 * packetizer)
   return ret;
 }
 
+/* Skips the run of packets at the current position whose PID is set in
+ * neither @pids nor @other_pids, only looking at their headers. Packets
+ * carrying a PCR are never skipped, since PCRs are observed on all PIDs.
+ * Stops at the first packet that needs parsing, when sync is lost or at the
+ * end of the available data, and leaves those to next_packet().
+ *
+ * Returns the number of skipped packets */
+guint
+mpegts_packetizer_skip_packets (MpegTSPacketizer2 * packetizer,
+    const guint8 * pids, const guint8 * other_pids)
+{
+  const guint8 *data;
+  guint packet_size, skipped = 0;
+  gsize sync_offset, offset;
+
+  packet_size = packetizer->packet_size;
+  if (G_UNLIKELY (!packet_size || packetizer->need_sync))
+    return 0;
+
+  if (!mpegts_packetizer_map (packetizer, packet_size))
+    return 0;
+
+  if (packet_size == MPEGTS_M2TS_PACKETSIZE)
+    sync_offset = 4;
+  else
+    sync_offset = 0;
+
+  for (offset = packetizer->map_offset;
+      offset + packet_size <= packetizer->map_size; offset += packet_size) {
+    guint16 pid;
+
+    data = &packetizer->map_data[offset + sync_offset];
+
+    if (G_UNLIKELY (data[0] != PACKET_SYNC_BYTE))
+      break;
+
+    pid = GST_READ_UINT16_BE (data + 1) & 0x1FFF;
+    if (MPEGTS_BIT_IS_SET (pids, pid) || MPEGTS_BIT_IS_SET (other_pids, pid))
+      break;
+
+    /* adaptation field with a PCR */
+    if (FLAGS_HAS_AFC (data[3]) && data[4] > 0
+        && (data[5] & MPEGTS_AFC_PCR_FLAG))
+      break;
+
+    skipped++;
+  }
+
+  if (skipped) {
+    GST_LOG ("skipped %u packets", skipped);
+    packetizer->skipped_packets += skipped;
+    packetizer->offset += (guint64) skipped *packet_size;
+    packetizer->map_offset = offset;
+    if (packetizer->map_size - packetizer->map_offset < packet_size)
+      mpegts_packetizer_flush_bytes (packetizer, packetizer->map_offset);
+  }
+
+  return skipped;
+}
+
 void
 mpegts_packetizer_clear_packet (MpegTSPacketizer2 * packetizer,
     MpegTSPacketizerPacket * packet)
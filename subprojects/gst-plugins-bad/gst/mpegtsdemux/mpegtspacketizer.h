@@ -269,6 +269,9 @@ struct _MpegTSPacketizer2 {
   gsize map_size;
   gboolean need_sync;
 
+  /* Number of packets skipped without parsing them */
+  guint64 skipped_packets;
+
   /* Reference offset */
   guint64 refoffset;
 
@@ -355,6 +358,8 @@ G_GNUC_INTERNAL MpegTSPacketizerPacketReturn mpegts_packetizer_next_packet (Mpeg
   MpegTSPacketizerPacket *packet);
 G_GNUC_INTERNAL MpegTSPacketizerPacketReturn
 mpegts_packetizer_process_next_packet(MpegTSPacketizer2 * packetizer);
+G_GNUC_INTERNAL guint mpegts_packetizer_skip_packets (MpegTSPacketizer2 *packetizer,
+  const guint8 *pids, const guint8 *other_pids);
 G_GNUC_INTERNAL void mpegts_packetizer_clear_packet (MpegTSPacketizer2 *packetizer,
 				     MpegTSPacketizerPacket *packet);
 G_GNUC_INTERNAL void mpegts_packetizer_remove_stream(MpegTSPacketizer2 *packetizer,
@@ -370,6 +370,7 @@ gst_ts_demux_finalize (GObject * object)
 
   gst_event_replace (&demux->segment_event, NULL);
   g_mutex_clear (&demux->lock);
+  g_free (GST_MPEGTS_BASE (demux)->selected_pes);
 
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
@@ -491,6 +492,8 @@ gst_ts_demux_init (GstTSDemux * demux)
   base->parse_private_sections = TRUE;
   /* We are not interested in sections (all handled by mpegtsbase) */
   base->push_section = FALSE;
+  /* nor in the packets of the programs we don't output */
+  base->selected_pes = g_new0 (guint8, 1024);
 
   demux->flowcombiner = gst_flow_combiner_new ();
   demux->requested_program_number = -1;
@@ -2346,6 +2349,25 @@ gst_ts_demux_can_remove_program (MpegTSBase * base, MpegTSBaseProgram * program)
   return TRUE;
 }
 
+/* Only the packets of the streams of the current program are pushed, let
+ * mpegtsbase skip the others */
+static void
+gst_ts_demux_update_selected_pes (GstTSDemux * demux)
+{
+  MpegTSBase *base = (MpegTSBase *) demux;
+  GList *tmp;
+
+  memset (base->selected_pes, 0, 1024);
+  if (!demux->program)
+    return;
+
+  for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
+    MpegTSBaseStream *stream = (MpegTSBaseStream *) tmp->data;
+
+    MPEGTS_BIT_SET (base->selected_pes, stream->pid);
+  }
+}
+
 static void
 gst_ts_demux_update_program (MpegTSBase * base, MpegTSBaseProgram * program)
 {
@@ -2353,6 +2375,8 @@ gst_ts_demux_update_program (MpegTSBase * base, MpegTSBaseProgram * program)
   GList *tmp;
 
   GST_DEBUG ("Updating program %d", program->program_number);
+  if (demux->program == program)
+    gst_ts_demux_update_selected_pes (demux);
   /* Emit collection message */
   gst_element_post_message ((GstElement *) base,
       gst_message_new_stream_collection ((GstObject *) base,
@@ -2395,6 +2419,7 @@ gst_ts_demux_program_started (MpegTSBase * base, MpegTSBaseProgram * program)
     GST_LOG ("program %d started", program->program_number);
     demux->program_number = program->program_number;
     demux->program = program;
+    gst_ts_demux_update_selected_pes (demux);
 
     /* Increment the program_generation counter */
     demux->program_generation = (demux->program_generation + 1) & 0xf;
@@ -2478,6 +2503,7 @@ gst_ts_demux_program_stopped (MpegTSBase * base, MpegTSBaseProgram * program)
   if (demux->program == program) {
     demux->program = NULL;
     demux->program_number = -1;
+    gst_ts_demux_update_selected_pes (demux);
   }
 }
 
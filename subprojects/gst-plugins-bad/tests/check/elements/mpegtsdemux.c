@@ -18,10 +18,14 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <string.h>
+
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
 
+#include "../../../gst/mpegtsdemux/mpegtsbase.h"
+
 #define PACKETSIZE 188
 
 /* Output of the following pipeline, split into standard 188-bytes packets:
@@ -377,6 +381,196 @@ GST_START_TEST (test_tsdemux_simple)
 
 GST_END_TEST;
 
+/* Total number of packets the packetizer of @tsdemux skipped without parsing
+ * them */
+static guint64
+get_skipped_packets (GstElement * tsdemux)
+{
+  MpegTSBase *base = (MpegTSBase *) tsdemux;
+
+  return base->packetizer->skipped_packets;
+}
+
+GST_START_TEST (test_tsdemux_skip_unknown_pids)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("tsdemux", "sink", NULL);
+  GstBuffer *buf;
+  GstCaps *caps;
+  GstSegment segment;
+  guint8 *data, *unknown_ts;
+  gsize size, offset;
+  guint64 skipped;
+  guint i, j;
+
+  caps = gst_caps_from_string ("video/mpegts,systemstream=true");
+  gst_harness_push_event (h, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_harness_push_event (h, gst_event_new_segment (&segment));
+
+  gst_harness_set_sink_caps_str (h,
+      "audio/mpeg,mpegversion=4,stream-format=adts");
+
+  g_signal_connect (h->element, "pad-added",
+      G_CALLBACK (tsdemux_simple_pad_added), h);
+
+  /* Packet on a PID that isn't in the PMT */
+  unknown_ts = g_memdup2 (padding_ts, PACKETSIZE);
+  unknown_ts[1] = 0x01;
+  unknown_ts[2] = 0x00;
+
+  /* Follow each packet of the stream with a run of packets tsdemux doesn't
+   * handle */
+  size = aac_ts_packets * 5 * PACKETSIZE;
+  data = g_malloc (size);
+  for (i = 0, offset = 0; i < aac_ts_packets; i++) {
+    memcpy (data + offset, aac_ts + i * PACKETSIZE, PACKETSIZE);
+    offset += PACKETSIZE;
+    for (j = 0; j < 4; j++) {
+      memcpy (data + offset, j % 2 ? padding_ts : unknown_ts, PACKETSIZE);
+      offset += PACKETSIZE;
+    }
+  }
+  g_free (unknown_ts);
+
+  /* Push in chunks that don't match the packet boundaries */
+  for (offset = 0; offset < size; offset += 500) {
+    buf = gst_buffer_new_memdup (data + offset, MIN (500, size - offset));
+    fail_unless (gst_harness_push (h, buf) == GST_FLOW_OK);
+  }
+  gst_harness_push_event (h, gst_event_new_eos ());
+  g_free (data);
+
+  buf = gst_harness_take_all_data_as_buffer (h);
+  gst_check_buffer_data (buf, aac_data, sizeof aac_data);
+  gst_buffer_unref (buf);
+
+  /* Only the packets following the first one can be skipped, since the
+   * packet size isn't known yet before that */
+  skipped = get_skipped_packets (h->element);
+  fail_unless (skipped >= (aac_ts_packets - 1) * 4);
+  fail_unless (skipped <= aac_ts_packets * 4);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* CRC32 of PSI sections (MPEG-2 CRC, no reflection) */
+static guint32
+psi_crc32 (const guint8 * data, gsize size)
+{
+  guint32 crc = 0xffffffff;
+  gsize i;
+  guint j;
+
+  for (i = 0; i < size; i++) {
+    crc ^= (guint32) data[i] << 24;
+    for (j = 0; j < 8; j++)
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+  }
+
+  return crc;
+}
+
+/* Writes a packet with @section on @pid, the section is followed by the CRC */
+static void
+write_psi_packet (guint8 * packet, guint16 pid, const guint8 * section,
+    gsize size)
+{
+  guint32 crc = psi_crc32 (section, size);
+
+  memset (packet, 0xff, PACKETSIZE);
+  packet[0] = 0x47;
+  packet[1] = 0x40 | (pid >> 8);
+  packet[2] = pid & 0xff;
+  packet[3] = 0x10;
+  /* pointer field */
+  packet[4] = 0x00;
+  memcpy (packet + 5, section, size);
+  GST_WRITE_UINT32_BE (packet + 5 + size, crc);
+}
+
+
+/* The PAT has a second program whose PMT is on PID 0x30, with one stream on
+ * PID 0x51. tsdemux only outputs the first program, so the packets of the
+ * second one are skipped without parsing them */
+GST_START_TEST (test_tsdemux_skip_unselected_program)
+{
+  static const guint8 pat[] = {
+    0x00, 0xb0, 0x11, 0x00, 0x01, 0xc1, 0x00, 0x00,
+    0x00, 0x01, 0xe0, 0x20, 0x00, 0x02, 0xe0, 0x30
+  };
+  static const guint8 pmt[] = {
+    0x02, 0xb0, 0x12, 0x00, 0x02, 0xc1, 0x00, 0x00, 0xe0, 0x51, 0xf0, 0x00,
+    0x0f, 0xe0, 0x51, 0xf0, 0x00
+  };
+  const guint n_other = 3;
+  GstHarness *h = gst_harness_new_with_padnames ("tsdemux", "sink", NULL);
+  GstBuffer *buf;
+  GstCaps *caps;
+  GstSegment segment;
+  guint8 *data, *packet;
+  gsize size;
+  guint i, j, cc = 0;
+
+  caps = gst_caps_from_string ("video/mpegts,systemstream=true");
+  gst_harness_push_event (h, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_harness_push_event (h, gst_event_new_segment (&segment));
+
+  gst_harness_set_sink_caps_str (h,
+      "audio/mpeg,mpegversion=4,stream-format=adts");
+
+  g_signal_connect (h->element, "pad-added",
+      G_CALLBACK (tsdemux_simple_pad_added), h);
+
+  /* PAT, PMT of both programs, then each packet of the first program
+   * followed by packets of the second one */
+  size = (aac_ts_packets + 1 + (aac_ts_packets - 2) * n_other) * PACKETSIZE;
+  data = g_malloc (size);
+  packet = data;
+
+  write_psi_packet (packet, 0x00, pat, sizeof pat);
+  packet += PACKETSIZE;
+  memcpy (packet, aac_ts + PACKETSIZE, PACKETSIZE);
+  packet += PACKETSIZE;
+  write_psi_packet (packet, 0x30, pmt, sizeof pmt);
+  packet += PACKETSIZE;
+
+  for (i = 2; i < aac_ts_packets; i++) {
+    memcpy (packet, aac_ts + i * PACKETSIZE, PACKETSIZE);
+    packet += PACKETSIZE;
+    for (j = 0; j < n_other; j++) {
+      memset (packet, 0xff, PACKETSIZE);
+      packet[0] = 0x47;
+      packet[1] = 0x00;
+      packet[2] = 0x51;
+      packet[3] = 0x10 | (cc++ & 0xf);
+      packet += PACKETSIZE;
+    }
+  }
+  fail_unless_equals_int (packet - data, size);
+
+  buf = gst_buffer_new_wrapped (data, size);
+  fail_unless (gst_harness_push (h, buf) == GST_FLOW_OK);
+  gst_harness_push_event (h, gst_event_new_eos ());
+
+  buf = gst_harness_take_all_data_as_buffer (h);
+  gst_check_buffer_data (buf, aac_data, sizeof aac_data);
+  gst_buffer_unref (buf);
+
+  fail_unless_equals_uint64 (get_skipped_packets (h->element),
+      (aac_ts_packets - 2) * n_other);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 mpegtsdemux_suite (void)
 {
@@ -394,6 +588,8 @@ mpegtsdemux_suite (void)
   tc = tcase_create ("tsdemux");
   suite_add_tcase (s, tc);
   tcase_add_test (tc, test_tsdemux_simple);
+  tcase_add_test (tc, test_tsdemux_skip_unknown_pids);
+  tcase_add_test (tc, test_tsdemux_skip_unselected_program);
 
   return s;
 }
@@ -27,6 +27,10 @@
 #include <math.h>
 #include <string.h>
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "audio-channel-mixer.h"
 
 #ifndef GST_DISABLE_GST_DEBUG
@@ -54,13 +58,64 @@ ensure_debug_category (void)
 
 #define PRECISION_INT 10
 
+/* number of frames the sparse mixers process at a time */
+#define MIX_BLOCK 256
+
 typedef void (*MixerFunc) (GstAudioChannelMixer * mix, const gpointer src[],
     gpointer dst[], gint samples);
 
+/* The inputs contributing to one output channel. Only the input channels with
+ * a non-zero coefficient are listed, in increasing order so that the result
+ * is the same as summing over the complete matrix column. */
+typedef struct
+{
+  gint n_taps;
+  gint *in;
+  gfloat *coeff;
+
+  /* the same for matrix_int, padded to an even number of taps. The 16 bit
+   * coefficients of tap 2 * i and 2 * i + 1 are packed in int_coeff[i] */
+  gint n_int_taps;
+  gint *int_in;
+  guint32 *int_coeff;
+} MixRow;
+
+/* The channel conversion matrix and everything derived from it. This is
+ * never modified after setup and can be shared between mixers. */
+typedef struct
+{
+  gint ref_count;
+  /* key in the matrix cache or NULL */
+  gchar *key;
+
+  gint in_channels;
+  gint out_channels;
+
+  gfloat **matrix;
+  gint **matrix_int;
+
+  /* one row per output channel */
+  MixRow *rows;
+  /* if an input channel is used by any of the rows */
+  gboolean *in_used;
+  /* if all of matrix_int fits in 16 bits */
+  gboolean int16_coeffs;
+
+  /* for stereo output, the input channels used by either output with the
+   * coefficients as { left, right, left, right } */
+  gint n_stereo_taps;
+  gint *stereo_in;
+  gfloat *stereo_coeff;
+} MixMatrix;
+
 struct _GstAudioChannelMixer
 {
   gint in_channels;
   gint out_channels;
+  GstAudioChannelMixerFlags flags;
+  GstAudioFormat format;
+
+  MixMatrix *shared;
 
   /* channel conversion matrix, m[in_channels][out_channels].
    * If identity matrix, passthrough applies. */
@@ -71,8 +126,65 @@ struct _GstAudioChannelMixer
   gint **matrix_int;
 
   MixerFunc func;
+
+  /* scratch memory of the sparse mixers */
+  gpointer tmp;
+  gconstpointer *src;
 };
 
+/* precompiled matrices of the mixers created from channel positions,
+ * shared by all mixers that convert between the same layouts */
+static GMutex matrix_lock;
+static GHashTable *matrix_cache;
+
+static MixMatrix *
+mix_matrix_ref (MixMatrix * m)
+{
+  g_mutex_lock (&matrix_lock);
+  m->ref_count++;
+  g_mutex_unlock (&matrix_lock);
+
+  return m;
+}
+
+static void
+mix_matrix_unref (MixMatrix * m)
+{
+  gint i;
+
+  g_mutex_lock (&matrix_lock);
+  if (--m->ref_count > 0) {
+    g_mutex_unlock (&matrix_lock);
+    return;
+  }
+  if (m->key) {
+    g_hash_table_remove (matrix_cache, m->key);
+    if (g_hash_table_size (matrix_cache) == 0)
+      g_clear_pointer (&matrix_cache, g_hash_table_unref);
+  }
+  g_mutex_unlock (&matrix_lock);
+
+  for (i = 0; i < m->in_channels; i++) {
+    g_free (m->matrix[i]);
+    g_free (m->matrix_int[i]);
+  }
+  g_free (m->matrix);
+  g_free (m->matrix_int);
+
+  for (i = 0; i < m->out_channels; i++) {
+    g_free (m->rows[i].in);
+    g_free (m->rows[i].coeff);
+    g_free (m->rows[i].int_in);
+    g_free (m->rows[i].int_coeff);
+  }
+  g_free (m->rows);
+  g_free (m->in_used);
+  g_free (m->stereo_in);
+  g_free (m->stereo_coeff);
+  g_free (m->key);
+  g_free (m);
+}
+
 /**
  * gst_audio_channel_mixer_free:
  * @mix: a #GstAudioChannelMixer
@@ -82,19 +194,14 @@ struct _GstAudioChannelMixer
 void
 gst_audio_channel_mixer_free (GstAudioChannelMixer * mix)
 {
-  gint i;
-
   /* free */
-  for (i = 0; i < mix->in_channels; i++)
-    g_free (mix->matrix[i]);
-  g_free (mix->matrix);
+  mix_matrix_unref (mix->shared);
+  mix->shared = NULL;
   mix->matrix = NULL;
-
-  for (i = 0; i < mix->in_channels; i++)
-    g_free (mix->matrix_int[i]);
-  g_free (mix->matrix_int);
   mix->matrix_int = NULL;
 
+  g_free (mix->tmp);
+  g_free (mix->src);
   g_free (mix);
 }
 
@@ -778,26 +885,150 @@ gst_audio_channel_mixer_fill_matrix (gfloat ** matrix,
   }
 }
 
-/* only call mix after mix->matrix is fully set up and normalized */
+/* only call mix after m->matrix is fully set up and normalized */
 static void
-gst_audio_channel_mixer_setup_matrix_int (GstAudioChannelMixer * mix)
+gst_audio_channel_mixer_setup_matrix_int (MixMatrix * m)
 {
   gint i, j;
   gfloat tmp;
   gfloat factor = (1 << PRECISION_INT);
 
-  mix->matrix_int = g_new0 (gint *, mix->in_channels);
+  m->matrix_int = g_new0 (gint *, m->in_channels);
 
-  for (i = 0; i < mix->in_channels; i++) {
-    mix->matrix_int[i] = g_new (gint, mix->out_channels);
+  for (i = 0; i < m->in_channels; i++) {
+    m->matrix_int[i] = g_new (gint, m->out_channels);
 
-    for (j = 0; j < mix->out_channels; j++) {
-      tmp = mix->matrix[i][j] * factor;
-      mix->matrix_int[i][j] = (gint) tmp;
+    for (j = 0; j < m->out_channels; j++) {
+      tmp = m->matrix[i][j] * factor;
+      m->matrix_int[i][j] = (gint) tmp;
+    }
+  }
+}
+
+/* collect the non-zero coefficients of each output channel */
+static void
+gst_audio_channel_mixer_setup_rows (MixMatrix * m)
+{
+  gint i, j;
+
+  m->rows = g_new0 (MixRow, m->out_channels);
+  m->in_used = g_new0 (gboolean, m->in_channels);
+  m->int16_coeffs = TRUE;
+
+  for (j = 0; j < m->out_channels; j++) {
+    MixRow *row = &m->rows[j];
+
+    row->in = g_new (gint, m->in_channels);
+    row->coeff = g_new (gfloat, m->in_channels);
+    row->int_in = g_new (gint, m->in_channels + 1);
+    row->int_coeff = g_new0 (guint32, (m->in_channels + 1) / 2);
+
+    for (i = 0; i < m->in_channels; i++) {
+      gint icoeff = m->matrix_int[i][j];
+
+      if (m->matrix[i][j] != 0.0f) {
+        row->in[row->n_taps] = i;
+        row->coeff[row->n_taps] = m->matrix[i][j];
+        row->n_taps++;
+        m->in_used[i] = TRUE;
+      }
+      if (icoeff != 0) {
+        /* keep clear of -32768 so that a pair of products can't overflow */
+        if (icoeff < -G_MAXINT16 || icoeff > G_MAXINT16)
+          m->int16_coeffs = FALSE;
+
+        row->int_coeff[row->n_int_taps / 2] |=
+            ((guint32) icoeff & 0xffff) << (16 * (row->n_int_taps & 1));
+        row->int_in[row->n_int_taps] = i;
+        row->n_int_taps++;
+        m->in_used[i] = TRUE;
+      }
+    }
+    /* pad with a zero coefficient */
+    if (row->n_int_taps & 1) {
+      row->int_in[row->n_int_taps] = row->int_in[row->n_int_taps - 1];
+      row->n_int_taps++;
+    }
+  }
+
+  if (m->out_channels == 2) {
+    m->stereo_in = g_new (gint, m->in_channels);
+    m->stereo_coeff = g_new (gfloat, 4 * m->in_channels);
+
+    for (i = 0; i < m->in_channels; i++) {
+      gfloat *coeff = &m->stereo_coeff[4 * m->n_stereo_taps];
+
+      if (m->matrix[i][0] == 0.0f && m->matrix[i][1] == 0.0f)
+        continue;
+
+      coeff[0] = coeff[2] = m->matrix[i][0];
+      coeff[1] = coeff[3] = m->matrix[i][1];
+      m->stereo_in[m->n_stereo_taps++] = i;
     }
   }
 }
 
+/* takes ownership of @matrix */
+static MixMatrix *
+gst_audio_channel_mixer_matrix_new (gint in_channels, gint out_channels,
+    gfloat ** matrix)
+{
+  MixMatrix *m;
+
+  m = g_new0 (MixMatrix, 1);
+  m->ref_count = 1;
+  m->in_channels = in_channels;
+  m->out_channels = out_channels;
+
+  if (!matrix) {
+    /* Generate (potentially truncated) identity matrix */
+    gint i, j;
+
+    m->matrix = g_new0 (gfloat *, in_channels);
+
+    for (i = 0; i < in_channels; i++) {
+      m->matrix[i] = g_new (gfloat, out_channels);
+      for (j = 0; j < out_channels; j++) {
+        m->matrix[i][j] = i == j ? 1.0 : 0.0;
+      }
+    }
+  } else {
+    m->matrix = matrix;
+  }
+
+  gst_audio_channel_mixer_setup_matrix_int (m);
+  gst_audio_channel_mixer_setup_rows (m);
+
+#ifndef GST_DISABLE_GST_DEBUG
+  /* debug */
+  {
+    GString *s;
+    gint i, j;
+
+    s = g_string_new ("Matrix for");
+    g_string_append_printf (s, " %d -> %d: ",
+        m->in_channels, m->out_channels);
+    g_string_append (s, "{");
+    for (i = 0; i < m->in_channels; i++) {
+      if (i != 0)
+        g_string_append (s, ",");
+      g_string_append (s, " {");
+      for (j = 0; j < m->out_channels; j++) {
+        if (j != 0)
+          g_string_append (s, ",");
+        g_string_append_printf (s, " %f", m->matrix[i][j]);
+      }
+      g_string_append (s, " }");
+    }
+    g_string_append (s, " }");
+    GST_DEBUG ("%s", s->str);
+    g_string_free (s, TRUE);
+  }
+#endif
+
+  return m;
+}
+
 static gfloat **
 gst_audio_channel_mixer_setup_matrix (GstAudioChannelMixerFlags flags,
     gint in_channels, GstAudioChannelPosition * in_position,
@@ -931,83 +1162,239 @@ DEFINE_FLOAT_MIX_FUNC (double, interleaved, planar);
 DEFINE_FLOAT_MIX_FUNC (double, planar, interleaved);
 DEFINE_FLOAT_MIX_FUNC (double, planar, planar);
 
-/**
- * gst_audio_channel_mixer_new_with_matrix: (skip):
- * @flags: #GstAudioChannelMixerFlags
- * @in_channels: number of input channels
- * @out_channels: number of output channels
- * @matrix: (transfer full) (nullable): channel conversion matrix, m[@in_channels][@out_channels].
- *   If identity matrix, passthrough applies. If %NULL, a (potentially truncated)
- *   identity matrix is generated.
- *
- * Create a new channel mixer object for the given parameters.
- *
- * Returns: a new #GstAudioChannelMixer object.
- *   Free with gst_audio_channel_mixer_free() after usage.
- *
- * Since: 1.14
- */
-GstAudioChannelMixer *
-gst_audio_channel_mixer_new_with_matrix (GstAudioChannelMixerFlags flags,
-    GstAudioFormat format,
-    gint in_channels, gint out_channels, gfloat ** matrix)
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+/* Sparse mixers. The input is processed in blocks of MIX_BLOCK frames that
+ * are first deinterleaved (if needed), then each output channel is computed
+ * from only the inputs it actually uses, many frames at a time, and finally
+ * interleaved again (if needed). Downmixing interleaved float samples to
+ * stereo works directly on the interleaved frames instead. */
+static inline void
+mix_row_gfloat (gfloat * dst, const gfloat * src[], const MixRow * row,
+    gint n)
 {
-  GstAudioChannelMixer *mix;
+  gint i = 0, t;
 
-  g_return_val_if_fail (format == GST_AUDIO_FORMAT_S16
-      || format == GST_AUDIO_FORMAT_S32
-      || format == GST_AUDIO_FORMAT_F32
-      || format == GST_AUDIO_FORMAT_F64, NULL);
+  for (; i + 8 <= n; i += 8) {
+    __m128 a0 = _mm_setzero_ps (), a1 = _mm_setzero_ps ();
 
-  mix = g_new0 (GstAudioChannelMixer, 1);
-  mix->in_channels = in_channels;
-  mix->out_channels = out_channels;
+    for (t = 0; t < row->n_taps; t++) {
+      const gfloat *s = src[row->in[t]] + i;
+      __m128 c = _mm_set1_ps (row->coeff[t]);
 
-  if (!matrix) {
-    /* Generate (potentially truncated) identity matrix */
-    gint i, j;
+      a0 = _mm_add_ps (a0, _mm_mul_ps (_mm_loadu_ps (s), c));
+      a1 = _mm_add_ps (a1, _mm_mul_ps (_mm_loadu_ps (s + 4), c));
+    }
+    _mm_storeu_ps (dst + i, a0);
+    _mm_storeu_ps (dst + i + 4, a1);
+  }
+  for (; i < n; i++) {
+    gfloat res = 0.0;
 
-    mix->matrix = g_new0 (gfloat *, in_channels);
+    for (t = 0; t < row->n_taps; t++)
+      res += src[row->in[t]][i] * row->coeff[t];
+    dst[i] = res;
+  }
+}
 
-    for (i = 0; i < in_channels; i++) {
-      mix->matrix[i] = g_new (gfloat, out_channels);
-      for (j = 0; j < out_channels; j++) {
-        mix->matrix[i][j] = i == j ? 1.0 : 0.0;
-      }
+static inline void
+mix_row_gdouble (gdouble * dst, const gdouble * src[], const MixRow * row,
+    gint n)
+{
+  gint i = 0, t;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128d a0 = _mm_setzero_pd (), a1 = _mm_setzero_pd ();
+
+    for (t = 0; t < row->n_taps; t++) {
+      const gdouble *s = src[row->in[t]] + i;
+      __m128d c = _mm_set1_pd (row->coeff[t]);
+
+      a0 = _mm_add_pd (a0, _mm_mul_pd (_mm_loadu_pd (s), c));
+      a1 = _mm_add_pd (a1, _mm_mul_pd (_mm_loadu_pd (s + 2), c));
     }
-  } else {
-    mix->matrix = matrix;
+    _mm_storeu_pd (dst + i, a0);
+    _mm_storeu_pd (dst + i + 2, a1);
   }
+  for (; i < n; i++) {
+    gdouble res = 0.0;
 
-  gst_audio_channel_mixer_setup_matrix_int (mix);
+    for (t = 0; t < row->n_taps; t++)
+      res += src[row->in[t]][i] * row->coeff[t];
+    dst[i] = res;
+  }
+}
 
-#ifndef GST_DISABLE_GST_DEBUG
-  /* debug */
-  {
-    GString *s;
-    gint i, j;
+/* only used when all coefficients fit in 16 bits, the products of two taps
+ * are then summed with one pmaddwd */
+static inline void
+mix_row_gint16 (gint16 * dst, const gint16 * src[], const MixRow * row,
+    gint n)
+{
+  gint i = 0, t;
 
-    s = g_string_new ("Matrix for");
-    g_string_append_printf (s, " %d -> %d: ",
-        mix->in_channels, mix->out_channels);
-    g_string_append (s, "{");
-    for (i = 0; i < mix->in_channels; i++) {
-      if (i != 0)
-        g_string_append (s, ",");
-      g_string_append (s, " {");
-      for (j = 0; j < mix->out_channels; j++) {
-        if (j != 0)
-          g_string_append (s, ",");
-        g_string_append_printf (s, " %f", mix->matrix[i][j]);
-      }
-      g_string_append (s, " }");
+  for (; i + 8 <= n; i += 8) {
+    __m128i lo = _mm_setzero_si128 (), hi = _mm_setzero_si128 ();
+    const __m128i round = _mm_set1_epi32 (1 << (PRECISION_INT - 1));
+
+    for (t = 0; t < row->n_int_taps; t += 2) {
+      __m128i a = _mm_loadu_si128 ((const __m128i *) (src[row->int_in[t]] + i));
+      __m128i b =
+          _mm_loadu_si128 ((const __m128i *) (src[row->int_in[t + 1]] + i));
+      __m128i c = _mm_set1_epi32 ((gint32) row->int_coeff[t / 2]);
+
+      lo = _mm_add_epi32 (lo, _mm_madd_epi16 (_mm_unpacklo_epi16 (a, b), c));
+      hi = _mm_add_epi32 (hi, _mm_madd_epi16 (_mm_unpackhi_epi16 (a, b), c));
     }
-    g_string_append (s, " }");
-    GST_DEBUG ("%s", s->str);
-    g_string_free (s, TRUE);
+    lo = _mm_srai_epi32 (_mm_add_epi32 (lo, round), PRECISION_INT);
+    hi = _mm_srai_epi32 (_mm_add_epi32 (hi, round), PRECISION_INT);
+    _mm_storeu_si128 ((__m128i *) (dst + i), _mm_packs_epi32 (lo, hi));
+  }
+  for (; i < n; i++) {
+    gint32 res = 0;
+
+    for (t = 0; t < row->n_int_taps; t++) {
+      gint16 coeff = row->int_coeff[t / 2] >> (16 * (t & 1));
+
+      res += src[row->int_in[t]][i] * (gint32) coeff;
+    }
+    res = (res + (1 << (PRECISION_INT - 1))) >> PRECISION_INT;
+    dst[i] = CLAMP (res, G_MININT16, G_MAXINT16);
+  }
+}
+
+/* with a constant number of channels the compiler can unroll these */
+#define DEINTERLEAVE(tmp, ip, channels, n) \
+G_STMT_START { \
+  gint i, c; \
+  for (i = 0; i < n; i++) \
+    for (c = 0; c < channels; c++) \
+      tmp[c * MIX_BLOCK + i] = ip[i * channels + c]; \
+} G_STMT_END
+
+#define INTERLEAVE(op, tmp, channels, n) \
+G_STMT_START { \
+  gint i, c; \
+  for (i = 0; i < n; i++) \
+    for (c = 0; c < channels; c++) \
+      op[i * channels + c] = tmp[c * MIX_BLOCK + i]; \
+} G_STMT_END
+
+#define DEFINE_SPARSE_MIX_FUNC(type) \
+static void \
+gst_audio_channel_mixer_mix_sparse_##type (GstAudioChannelMixer * mix, \
+    const type * in_data[], type * out_data[], gint samples) \
+{ \
+  MixMatrix *m = mix->shared; \
+  gint inchannels = mix->in_channels; \
+  gint outchannels = mix->out_channels; \
+  gboolean planar_in = \
+      (mix->flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN) != 0; \
+  gboolean planar_out = \
+      (mix->flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT) != 0; \
+  const type **src = (const type **) mix->src; \
+  type *tmp_in = mix->tmp; \
+  type *tmp_out = tmp_in + inchannels * MIX_BLOCK; \
+  gint pos, n, c; \
+  \
+  for (pos = 0; pos < samples; pos += n) { \
+    n = MIN (samples - pos, MIX_BLOCK); \
+    \
+    if (planar_in) { \
+      for (c = 0; c < inchannels; c++) \
+        src[c] = in_data[c] + pos; \
+    } else { \
+      const type *ip = in_data[0] + pos * inchannels; \
+      \
+      switch (inchannels) { \
+        case 2: DEINTERLEAVE (tmp_in, ip, 2, n); break; \
+        case 6: DEINTERLEAVE (tmp_in, ip, 6, n); break; \
+        case 8: DEINTERLEAVE (tmp_in, ip, 8, n); break; \
+        default: DEINTERLEAVE (tmp_in, ip, inchannels, n); break; \
+      } \
+      for (c = 0; c < inchannels; c++) \
+        src[c] = tmp_in + c * MIX_BLOCK; \
+    } \
+    for (c = 0; c < outchannels; c++) { \
+      type *dst = planar_out ? out_data[c] + pos : tmp_out + c * MIX_BLOCK; \
+      \
+      mix_row_##type (dst, src, &m->rows[c], n); \
+    } \
+    if (!planar_out) { \
+      type *op = out_data[0] + pos * outchannels; \
+      \
+      switch (outchannels) { \
+        case 1: memcpy (op, tmp_out, n * sizeof (type)); break; \
+        case 2: INTERLEAVE (op, tmp_out, 2, n); break; \
+        case 6: INTERLEAVE (op, tmp_out, 6, n); break; \
+        default: INTERLEAVE (op, tmp_out, outchannels, n); break; \
+      } \
+    } \
+  } \
+}
+
+/* downmix to interleaved stereo without deinterleaving the input, two
+ * frames at a time */
+static void
+gst_audio_channel_mixer_mix_sparse_gfloat_stereo (GstAudioChannelMixer * mix,
+    const gfloat * in_data[], gfloat * out_data[], gint samples)
+{
+  MixMatrix *m = mix->shared;
+  gint inchannels = mix->in_channels;
+  const gfloat *ip = in_data[0];
+  gfloat *op = out_data[0];
+  gint i = 0, t;
+
+  for (; i + 2 <= samples; i += 2) {
+    __m128 acc = _mm_setzero_ps ();
+
+    for (t = 0; t < m->n_stereo_taps; t++) {
+      gint c = m->stereo_in[t];
+      __m128 x = _mm_setr_ps (ip[c], ip[c], ip[inchannels + c],
+          ip[inchannels + c]);
+
+      acc = _mm_add_ps (acc, _mm_mul_ps (x,
+              _mm_loadu_ps (&m->stereo_coeff[4 * t])));
+    }
+    _mm_storeu_ps (op, acc);
+    ip += 2 * inchannels;
+    op += 4;
   }
+  for (; i < samples; i++) {
+    gfloat l = 0.0, r = 0.0;
+
+    for (t = 0; t < m->n_stereo_taps; t++) {
+      gfloat x = ip[m->stereo_in[t]];
+
+      l += x * m->stereo_coeff[4 * t];
+      r += x * m->stereo_coeff[4 * t + 1];
+    }
+    op[0] = l;
+    op[1] = r;
+    ip += inchannels;
+    op += 2;
+  }
+}
+
+DEFINE_SPARSE_MIX_FUNC (gint16);
+DEFINE_SPARSE_MIX_FUNC (gfloat);
+DEFINE_SPARSE_MIX_FUNC (gdouble);
 #endif
 
+static GstAudioChannelMixer *
+gst_audio_channel_mixer_new_with_shared (GstAudioChannelMixerFlags flags,
+    GstAudioFormat format, MixMatrix * m)
+{
+  GstAudioChannelMixer *mix;
+
+  mix = g_new0 (GstAudioChannelMixer, 1);
+  mix->in_channels = m->in_channels;
+  mix->out_channels = m->out_channels;
+  mix->flags = flags;
+  mix->format = format;
+  mix->shared = m;
+  mix->matrix = m->matrix;
+  mix->matrix_int = m->matrix_int;
+
   switch (format) {
     case GST_AUDIO_FORMAT_S16:
       if (flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN) {
@@ -1089,9 +1476,75 @@ gst_audio_channel_mixer_new_with_matrix (GstAudioChannelMixerFlags flags,
       g_assert_not_reached ();
       break;
   }
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  /* skip the zero coefficients and vectorize over the frames */
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:
+      if (m->int16_coeffs)
+        mix->func = (MixerFunc) gst_audio_channel_mixer_mix_sparse_gint16;
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      if (mix->out_channels == 2 && !(flags &
+              (GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN |
+                  GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT)))
+        mix->func =
+            (MixerFunc) gst_audio_channel_mixer_mix_sparse_gfloat_stereo;
+      else
+        mix->func = (MixerFunc) gst_audio_channel_mixer_mix_sparse_gfloat;
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      mix->func = (MixerFunc) gst_audio_channel_mixer_mix_sparse_gdouble;
+      break;
+    default:
+      break;
+  }
+
+  if (mix->func == (MixerFunc) gst_audio_channel_mixer_mix_sparse_gint16 ||
+      mix->func == (MixerFunc) gst_audio_channel_mixer_mix_sparse_gfloat ||
+      mix->func == (MixerFunc) gst_audio_channel_mixer_mix_sparse_gdouble) {
+    mix->tmp = g_malloc ((mix->in_channels + mix->out_channels) * MIX_BLOCK *
+        GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info (format)) / 8);
+    mix->src = g_new0 (gconstpointer, mix->in_channels);
+  }
+#endif
+  GST_DEBUG ("%d -> %d, sparse %d", mix->in_channels, mix->out_channels,
+      mix->func == (MixerFunc) gst_audio_channel_mixer_mix_sparse_gfloat_stereo
+      || mix->tmp != NULL);
+
   return mix;
 }
 
+/**
+ * gst_audio_channel_mixer_new_with_matrix: (skip):
+ * @flags: #GstAudioChannelMixerFlags
+ * @in_channels: number of input channels
+ * @out_channels: number of output channels
+ * @matrix: (transfer full) (nullable): channel conversion matrix, m[@in_channels][@out_channels].
+ *   If identity matrix, passthrough applies. If %NULL, a (potentially truncated)
+ *   identity matrix is generated.
+ *
+ * Create a new channel mixer object for the given parameters.
+ *
+ * Returns: a new #GstAudioChannelMixer object.
+ *   Free with gst_audio_channel_mixer_free() after usage.
+ *
+ * Since: 1.14
+ */
+GstAudioChannelMixer *
+gst_audio_channel_mixer_new_with_matrix (GstAudioChannelMixerFlags flags,
+    GstAudioFormat format,
+    gint in_channels, gint out_channels, gfloat ** matrix)
+{
+  g_return_val_if_fail (format == GST_AUDIO_FORMAT_S16
+      || format == GST_AUDIO_FORMAT_S32
+      || format == GST_AUDIO_FORMAT_F32
+      || format == GST_AUDIO_FORMAT_F64, NULL);
+
+  return gst_audio_channel_mixer_new_with_shared (flags, format,
+      gst_audio_channel_mixer_matrix_new (in_channels, out_channels, matrix));
+}
+
 /**
  * gst_audio_channel_mixer_new: (skip):
  * @flags: #GstAudioChannelMixerFlags
@@ -1113,17 +1566,93 @@ gst_audio_channel_mixer_new (GstAudioChannelMixerFlags flags,
     gint out_channels, GstAudioChannelPosition * out_position)
 {
   gfloat **matrix;
+  MixMatrix *m = NULL;
+  gchar *key = NULL;
 
   g_return_val_if_fail (format == GST_AUDIO_FORMAT_S16
       || format == GST_AUDIO_FORMAT_S32
       || format == GST_AUDIO_FORMAT_F32
       || format == GST_AUDIO_FORMAT_F64, NULL);
 
-  matrix =
-      gst_audio_channel_mixer_setup_matrix (flags, in_channels, in_position,
-      out_channels, out_position);
-  return gst_audio_channel_mixer_new_with_matrix (flags, format, in_channels,
-      out_channels, matrix);
+  /* the matrix only depends on the channel positions, reuse the one of
+   * another mixer for the same conversion if there is one */
+  if (in_position && out_position) {
+    GString *s;
+    gint i;
+
+    s = g_string_new (NULL);
+    g_string_append_printf (s, "%x:%d", flags &
+        (GST_AUDIO_CHANNEL_MIXER_FLAGS_UNPOSITIONED_IN |
+            GST_AUDIO_CHANNEL_MIXER_FLAGS_UNPOSITIONED_OUT), in_channels);
+    for (i = 0; i < in_channels; i++)
+      g_string_append_printf (s, ",%d", in_position[i]);
+    g_string_append_printf (s, ":%d", out_channels);
+    for (i = 0; i < out_channels; i++)
+      g_string_append_printf (s, ",%d", out_position[i]);
+    key = g_string_free (s, FALSE);
+
+    g_mutex_lock (&matrix_lock);
+    if (matrix_cache && (m = g_hash_table_lookup (matrix_cache, key)))
+      m->ref_count++;
+    g_mutex_unlock (&matrix_lock);
+  }
+
+  if (m) {
+    GST_DEBUG ("reusing matrix for %s", key);
+    g_free (key);
+  } else {
+    matrix =
+        gst_audio_channel_mixer_setup_matrix (flags, in_channels, in_position,
+        out_channels, out_position);
+    m = gst_audio_channel_mixer_matrix_new (in_channels, out_channels, matrix);
+
+    if (key) {
+      g_mutex_lock (&matrix_lock);
+      if (!matrix_cache)
+        matrix_cache = g_hash_table_new (g_str_hash, g_str_equal);
+      /* another thread might have added the same matrix in the meantime */
+      if (!g_hash_table_contains (matrix_cache, key)) {
+        m->key = key;
+        g_hash_table_insert (matrix_cache, m->key, m);
+      } else {
+        g_free (key);
+      }
+      g_mutex_unlock (&matrix_lock);
+    }
+  }
+
+  return gst_audio_channel_mixer_new_with_shared (flags, format, m);
+}
+
+/**
+ * gst_audio_channel_mixer_new_from_mixer: (skip):
+ * @mix: a #GstAudioChannelMixer
+ * @flags: #GstAudioChannelMixerFlags
+ * @format: the sample format
+ *
+ * Create a new channel mixer that shares the precompiled channel conversion
+ * matrix of @mix but possibly uses a different sample @format and layout.
+ *
+ * This avoids setting up the matrix again when the same conversion is done
+ * by multiple mixers. @mix can be freed independently of the new mixer.
+ *
+ * Returns: a new #GstAudioChannelMixer object.
+ *   Free with gst_audio_channel_mixer_free() after usage.
+ *
+ * Since: 1.26
+ */
+GstAudioChannelMixer *
+gst_audio_channel_mixer_new_from_mixer (GstAudioChannelMixer * mix,
+    GstAudioChannelMixerFlags flags, GstAudioFormat format)
+{
+  g_return_val_if_fail (mix != NULL, NULL);
+  g_return_val_if_fail (format == GST_AUDIO_FORMAT_S16
+      || format == GST_AUDIO_FORMAT_S32
+      || format == GST_AUDIO_FORMAT_F32
+      || format == GST_AUDIO_FORMAT_F64, NULL);
+
+  return gst_audio_channel_mixer_new_with_shared (flags, format,
+      mix_matrix_ref (mix->shared));
 }
 
 /**
@@ -61,6 +61,11 @@ GstAudioChannelMixer * gst_audio_channel_mixer_new_with_matrix (GstAudioChannelM
                                                                 gint out_channels,
                                                                 gfloat **matrix);
 
+GST_AUDIO_API
+GstAudioChannelMixer * gst_audio_channel_mixer_new_from_mixer (GstAudioChannelMixer *mix,
+                                                                GstAudioChannelMixerFlags flags,
+                                                                GstAudioFormat format);
+
 GST_AUDIO_API
 void                   gst_audio_channel_mixer_free  (GstAudioChannelMixer *mix);
 
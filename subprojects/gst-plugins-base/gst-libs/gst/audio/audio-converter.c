@@ -30,6 +30,10 @@
 #include "audio-converter.h"
 #include "gstaudiopack.h"
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * SECTION:gstaudioconverter
  * @title: GstAudioConverter
@@ -76,6 +80,8 @@ typedef gboolean (*AudioConvertSamplesFunc) (GstAudioConverter * convert,
     gpointer out[], gsize out_frames);
 typedef void (*AudioConvertEndianFunc) (gpointer dst, const gpointer src,
     gint count);
+typedef void (*AudioConvertFusedFunc) (GstAudioConverter * convert,
+    gpointer dst, const gpointer src, gsize count);
 
 /*                           int/int    int/float  float/int float/float
  *
@@ -145,6 +151,11 @@ struct _GstAudioConverter
   /* endian swap */
   AudioConvertEndianFunc swap_endian;
 
+  /* single pass conversion for common format combinations */
+  AudioConvertFusedFunc fused;
+  gfloat fused_gain;
+  guint32 fused_random[4];
+
   AudioConvertSamplesFunc convert;
 };
 
@@ -1319,6 +1330,240 @@ converter_resample (GstAudioConverter * convert,
   return TRUE;
 }
 
+/* S16 -> F32, optionally scaled by a gain */
+static void
+converter_fused_s16_to_f32 (GstAudioConverter * convert, gpointer dst,
+    const gpointer src, gsize count)
+{
+  const gint16 *s = src;
+  gfloat *d = dst;
+  gfloat gain = convert->fused_gain / 32768.0f;
+  gsize i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  {
+    __m128 g = _mm_set1_ps (gain);
+    __m128i v, lo, hi;
+
+    for (; i + 8 <= count; i += 8) {
+      v = _mm_loadu_si128 ((const __m128i *) (s + i));
+      lo = _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+      hi = _mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16);
+      _mm_storeu_ps (d + i, _mm_mul_ps (_mm_cvtepi32_ps (lo), g));
+      _mm_storeu_ps (d + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (hi), g));
+    }
+  }
+#endif
+  for (; i < count; i++)
+    d[i] = s[i] * gain;
+}
+
+/* F32 -> S16, round to nearest and clip */
+static void
+converter_fused_f32_to_s16 (GstAudioConverter * convert, gpointer dst,
+    const gpointer src, gsize count)
+{
+  const gfloat *s = src;
+  gint16 *d = dst;
+  gsize i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  {
+    __m128 scale = _mm_set1_ps (32768.0f);
+    __m128 vmin = _mm_set1_ps (-32768.0f), vmax = _mm_set1_ps (32767.0f);
+    __m128 a, b;
+
+    for (; i + 8 <= count; i += 8) {
+      a = _mm_mul_ps (_mm_loadu_ps (s + i), scale);
+      b = _mm_mul_ps (_mm_loadu_ps (s + i + 4), scale);
+      a = _mm_min_ps (_mm_max_ps (a, vmin), vmax);
+      b = _mm_min_ps (_mm_max_ps (b, vmin), vmax);
+      _mm_storeu_si128 ((__m128i *) (d + i),
+          _mm_packs_epi32 (_mm_cvtps_epi32 (a), _mm_cvtps_epi32 (b)));
+    }
+  }
+#endif
+  for (; i < count; i++)
+    d[i] = lrintf (CLAMP (s[i] * 32768.0f, -32768.0f, 32767.0f));
+}
+
+/* 32 bit xorshift PRNG, see https://en.wikipedia.org/wiki/Xorshift */
+static inline guint32
+fused_random_uint32 (guint32 * state)
+{
+  guint32 x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return (*state = x);
+}
+
+/* F32 -> S16 with TPDF dither of +/- 1 LSB. There are 4 generator states,
+ * sample i always uses state i % 4 so that the SIMD and the scalar code
+ * produce the same output. */
+static void
+converter_fused_f32_to_s16_tpdf (GstAudioConverter * convert, gpointer dst,
+    const gpointer src, gsize count)
+{
+  const gfloat *s = src;
+  gint16 *d = dst;
+  guint32 *state = convert->fused_random;
+  gsize i = 0;
+  gfloat v, r;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  {
+    __m128 scale = _mm_set1_ps (32768.0f);
+    __m128 rscale = _mm_set1_ps (1.0f / 4294967296.0f);
+    __m128 vmin = _mm_set1_ps (-32768.0f), vmax = _mm_set1_ps (32767.0f);
+    __m128i x = _mm_loadu_si128 ((const __m128i *) state);
+    __m128 a[2], r1, r2;
+    gint j;
+
+#define XORSHIFT_SSE2(x) G_STMT_START {                 \
+    x = _mm_xor_si128 (x, _mm_slli_epi32 (x, 13));      \
+    x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 17));      \
+    x = _mm_xor_si128 (x, _mm_slli_epi32 (x, 5));       \
+} G_STMT_END
+
+    for (; i + 8 <= count; i += 8) {
+      for (j = 0; j < 2; j++) {
+        XORSHIFT_SSE2 (x);
+        r1 = _mm_cvtepi32_ps (x);
+        XORSHIFT_SSE2 (x);
+        r2 = _mm_cvtepi32_ps (x);
+
+        a[j] = _mm_mul_ps (_mm_loadu_ps (s + i + j * 4), scale);
+        a[j] = _mm_add_ps (a[j], _mm_mul_ps (_mm_add_ps (r1, r2), rscale));
+        a[j] = _mm_min_ps (_mm_max_ps (a[j], vmin), vmax);
+      }
+      _mm_storeu_si128 ((__m128i *) (d + i),
+          _mm_packs_epi32 (_mm_cvtps_epi32 (a[0]), _mm_cvtps_epi32 (a[1])));
+    }
+#undef XORSHIFT_SSE2
+    _mm_storeu_si128 ((__m128i *) state, x);
+  }
+#endif
+  for (; i < count; i++) {
+    r = (gfloat) (gint32) fused_random_uint32 (&state[i & 3]);
+    r += (gfloat) (gint32) fused_random_uint32 (&state[i & 3]);
+    v = s[i] * 32768.0f + r * (1.0f / 4294967296.0f);
+    d[i] = lrintf (CLAMP (v, -32768.0f, 32767.0f));
+  }
+}
+
+static gboolean
+converter_fused (GstAudioConverter * convert,
+    GstAudioConverterFlags flags, gpointer in[], gsize in_frames,
+    gpointer out[], gsize out_frames)
+{
+  gint i;
+  AudioChain *chain;
+  gsize samples;
+
+  chain = convert->chain_end;
+  samples = in_frames * chain->inc;
+
+  GST_LOG ("convert fused: %" G_GSIZE_FORMAT " / %" G_GSIZE_FORMAT " samples",
+      in_frames, samples);
+
+  if (in) {
+    for (i = 0; i < chain->blocks; i++)
+      convert->fused (convert, out[i], in[i], samples);
+  } else {
+    for (i = 0; i < chain->blocks; i++)
+      gst_audio_format_info_fill_silence (convert->out.finfo, out[i], samples);
+  }
+  return TRUE;
+}
+
+/* check if the mix matrix only applies the same gain to every channel */
+static gboolean
+mix_matrix_get_gain (GstAudioConverter * convert, gfloat * gain)
+{
+  const GValue *opt_matrix = GET_OPT_MIX_MATRIX (convert);
+  guint i, j, channels = convert->in.channels;
+  gboolean res = TRUE;
+  gfloat **matrix;
+
+  if (convert->mix_passthrough) {
+    *gain = 1.0f;
+    return TRUE;
+  }
+  if (opt_matrix == NULL || gst_value_array_get_size (opt_matrix) == 0 ||
+      channels != convert->out.channels)
+    return FALSE;
+
+  matrix = mix_matrix_from_g_value (channels, channels, opt_matrix);
+  *gain = matrix[0][0];
+  for (i = 0; i < channels; i++) {
+    for (j = 0; j < channels; j++) {
+      if (matrix[i][j] != (i == j ? *gain : 0.0f))
+        res = FALSE;
+    }
+    g_free (matrix[i]);
+  }
+  g_free (matrix);
+
+  return res;
+}
+
+static void
+setup_fused (GstAudioConverter * convert)
+{
+  GstAudioInfo *in = &convert->in;
+  GstAudioInfo *out = &convert->out;
+  GstAudioFormat in_format = in->finfo->format;
+  GstAudioFormat out_format = out->finfo->format;
+  GstAudioDitherMethod dither;
+  gfloat gain;
+
+  if (convert->resampler != NULL || in->layout != out->layout)
+    return;
+
+  if (in_format == GST_AUDIO_FORMAT_S16 && out_format == GST_AUDIO_FORMAT_F32) {
+    if (!mix_matrix_get_gain (convert, &gain))
+      return;
+
+    GST_INFO ("S16 to F32 with gain %f -> fused conversion", gain);
+    convert->fused = converter_fused_s16_to_f32;
+    convert->fused_gain = gain;
+  } else if (in_format == GST_AUDIO_FORMAT_F32 &&
+      out_format == GST_AUDIO_FORMAT_S16) {
+    if (!convert->mix_passthrough)
+      return;
+
+    /* same decision as chain_quantize(), noise shaping is applied with and
+     * without dither and isn't implemented here */
+    dither = GET_OPT_DITHER_METHOD (convert);
+    if (16 > GET_OPT_DITHER_THRESHOLD (convert))
+      dither = GST_AUDIO_DITHER_NONE;
+    else if (GET_OPT_NOISE_SHAPING_METHOD (convert) !=
+        GST_AUDIO_NOISE_SHAPING_NONE)
+      return;
+
+    switch (dither) {
+      case GST_AUDIO_DITHER_NONE:
+        GST_INFO ("F32 to S16 -> fused conversion");
+        convert->fused = converter_fused_f32_to_s16;
+        break;
+      case GST_AUDIO_DITHER_TPDF:
+        GST_INFO ("F32 to S16 with TPDF dither -> fused conversion");
+        convert->fused = converter_fused_f32_to_s16_tpdf;
+        convert->fused_random[0] = 0xc2d6038f;
+        convert->fused_random[1] = 0x6b8b4567;
+        convert->fused_random[2] = 0x327b23c6;
+        convert->fused_random[3] = 0x643c9869;
+        break;
+      default:
+        return;
+    }
+  } else {
+    return;
+  }
+  convert->convert = converter_fused;
+}
+
 #define GST_AUDIO_FORMAT_IS_ENDIAN_CONVERSION(info1, info2) \
 		( \
 			!(((info1)->flags ^ (info2)->flags) & (~GST_AUDIO_FORMAT_FLAG_UNPACK)) && \
@@ -1450,6 +1695,9 @@ gst_audio_converter_new (GstAudioConverterFlags flags, GstAudioInfo * in_info,
     }
   }
 
+  if (convert->convert == converter_generic)
+    setup_fused (convert);
+
   setup_allocators (convert);
 
   return convert;
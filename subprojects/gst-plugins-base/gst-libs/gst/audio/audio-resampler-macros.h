@@ -99,6 +99,67 @@ DECL_RESAMPLE_FUNC (type, inter, channels, arch)                \
   resampler->samp_phase = samp_phase;                           \
 }
 
+/* Same as MAKE_RESAMPLE_FUNC but iterates over the output samples first and
+ * over the channels second. The taps of a phase are looked up once per
+ * output sample and channels are handled in pairs so that the inner product
+ * can share each load of the filter coefficients between two channels. */
+#define DECL_RESAMPLE_N_FUNC(type,inter,arch)                           \
+void                                                                    \
+resample_ ##type## _ ##inter## _n_ ##arch (GstAudioResampler * resampler, \
+    gpointer in[], gsize in_len,  gpointer out[], gsize out_len,        \
+    gsize * consumed)
+
+#define MAKE_RESAMPLE_N_FUNC(type,inter,arch)                           \
+DECL_RESAMPLE_N_FUNC (type, inter, arch)                                \
+{                                                                       \
+  gint c, di = 0;                                                       \
+  gint n_taps = resampler->n_taps;                                      \
+  gint blocks = resampler->blocks;                                      \
+  gint ostride = resampler->ostride;                                    \
+  gint taps_stride = resampler->taps_stride;                            \
+  gint samp_index = resampler->samp_index;                              \
+  gint samp_phase = resampler->samp_phase;                              \
+                                                                        \
+  for (di = 0; di < out_len; di++) {                                    \
+    type icoeff[4], *taps, *op0, *op1;                                  \
+    gint idx = samp_index;                                              \
+                                                                        \
+    taps = get_taps_ ##type##_##inter                                   \
+            (resampler, &samp_index, &samp_phase, icoeff);              \
+                                                                        \
+    for (c = 0; c + 1 < blocks; c += 2) {                               \
+      if (ostride == 1) {                                               \
+        op0 = (type *) out[c] + di;                                     \
+        op1 = (type *) out[c + 1] + di;                                 \
+      } else {                                                          \
+        op0 = (type *) out[0] + di * ostride + c;                       \
+        op1 = op0 + 1;                                                  \
+      }                                                                 \
+      inner_product_ ##type##_##inter##_x2_##arch (op0, op1,            \
+          (type *) in[c] + idx, (type *) in[c + 1] + idx,               \
+          taps, n_taps, icoeff, taps_stride);                           \
+    }                                                                   \
+    if (c < blocks) {                                                   \
+      op0 = ostride == 1 ? (type *) out[c] + di :                       \
+          (type *) out[0] + di * ostride + c;                           \
+      inner_product_ ##type##_##inter##_1_##arch                        \
+              (op0, (type *) in[c] + idx, taps, n_taps, icoeff,         \
+              taps_stride);                                             \
+    }                                                                   \
+  }                                                                     \
+  for (c = 0; c < blocks; c++) {                                        \
+    type *ip = in[c];                                                   \
+                                                                        \
+    if (in_len > samp_index)                                            \
+      memmove (ip, &ip[samp_index],                                     \
+          (in_len - samp_index) * sizeof(type));                        \
+  }                                                                     \
+  *consumed = samp_index - resampler->samp_index;                       \
+                                                                        \
+  resampler->samp_index = 0;                                            \
+  resampler->samp_phase = samp_phase;                                   \
+}
+
 #define DECL_RESAMPLE_FUNC_STATIC(type,inter,channels,arch)     \
 static DECL_RESAMPLE_FUNC (type, inter, channels, arch)
 
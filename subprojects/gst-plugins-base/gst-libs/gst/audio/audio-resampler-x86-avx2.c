@@ -0,0 +1,635 @@
+/* GStreamer
+ * Copyright (C) <2016> Wim Taymans <wim.taymans@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "audio-resampler-x86-avx2.h"
+
+#if defined (__x86_64__) && defined (HAVE_IMMINTRIN_H) && \
+    defined (__AVX2__) && defined (__FMA__)
+
+#include <immintrin.h>
+
+/* The taps are only guaranteed to be 16 byte aligned, so all 256 bit
+ * accesses below use unaligned loads and stores. n_taps is always a
+ * multiple of 8 and the tap rows are zero padded by TAPS_OVERREAD. */
+
+static inline __m128
+hsum_ps_avx2 (__m256 v)
+{
+  __m128 s = _mm_add_ps (_mm256_castps256_ps128 (v),
+      _mm256_extractf128_ps (v, 1));
+
+  s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+  return _mm_add_ss (s, _mm_shuffle_ps (s, s, 0x55));
+}
+
+static inline __m256
+full_gfloat_avx2 (const gfloat * a, const gfloat * b, gint len)
+{
+  gint i = 0;
+  __m256 sum[2];
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (; i + 16 <= len; i += 16) {
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 0),
+        _mm256_loadu_ps (b + i + 0), sum[0]);
+    sum[1] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 8),
+        _mm256_loadu_ps (b + i + 8), sum[1]);
+  }
+  if (i < len)
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a + i),
+        _mm256_loadu_ps (b + i), sum[0]);
+
+  return _mm256_add_ps (sum[0], sum[1]);
+}
+
+static inline void
+inner_product_gfloat_full_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  _mm_store_ss (o, hsum_ps_avx2 (full_gfloat_avx2 (a, b, len)));
+}
+
+static inline void
+inner_product_gfloat_full_x2_avx2 (gfloat * o0, gfloat * o1,
+    const gfloat * a0, const gfloat * a1, const gfloat * b, gint len,
+    const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2], t;
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t = _mm256_loadu_ps (b + i);
+    sum[0] = _mm256_fmadd_ps (_mm256_loadu_ps (a0 + i), t, sum[0]);
+    sum[1] = _mm256_fmadd_ps (_mm256_loadu_ps (a1 + i), t, sum[1]);
+  }
+  _mm_store_ss (o0, hsum_ps_avx2 (sum[0]));
+  _mm_store_ss (o1, hsum_ps_avx2 (sum[1]));
+}
+
+static inline __m256
+linear_gfloat_finish_avx2 (__m256 s0, __m256 s1, const gfloat * icoeff)
+{
+  return _mm256_fmadd_ps (_mm256_sub_ps (s0, s1),
+      _mm256_broadcast_ss (icoeff), s1);
+}
+
+static inline void
+inner_product_gfloat_linear_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[2], t;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+  }
+  _mm_store_ss (o, hsum_ps_avx2 (linear_gfloat_finish_avx2 (sum[0], sum[1],
+              icoeff)));
+}
+
+static inline void
+inner_product_gfloat_linear_x2_avx2 (gfloat * o0, gfloat * o1,
+    const gfloat * a0, const gfloat * a1, const gfloat * b, gint len,
+    const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[4], t0, t1, tb;
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t0 = _mm256_loadu_ps (a0 + i);
+    t1 = _mm256_loadu_ps (a1 + i);
+    tb = _mm256_loadu_ps (c[0] + i);
+    sum[0] = _mm256_fmadd_ps (t0, tb, sum[0]);
+    sum[2] = _mm256_fmadd_ps (t1, tb, sum[2]);
+    tb = _mm256_loadu_ps (c[1] + i);
+    sum[1] = _mm256_fmadd_ps (t0, tb, sum[1]);
+    sum[3] = _mm256_fmadd_ps (t1, tb, sum[3]);
+  }
+  _mm_store_ss (o0, hsum_ps_avx2 (linear_gfloat_finish_avx2 (sum[0], sum[1],
+              icoeff)));
+  _mm_store_ss (o1, hsum_ps_avx2 (linear_gfloat_finish_avx2 (sum[2], sum[3],
+              icoeff)));
+}
+
+static inline __m256
+cubic_gfloat_finish_avx2 (const __m256 sum[4], const gfloat * icoeff)
+{
+  __m256 res;
+
+  res = _mm256_mul_ps (sum[0], _mm256_broadcast_ss (icoeff + 0));
+  res = _mm256_fmadd_ps (sum[1], _mm256_broadcast_ss (icoeff + 1), res);
+  res = _mm256_fmadd_ps (sum[2], _mm256_broadcast_ss (icoeff + 2), res);
+  return _mm256_fmadd_ps (sum[3], _mm256_broadcast_ss (icoeff + 3), res);
+}
+
+static inline void
+inner_product_gfloat_cubic_1_avx2 (gfloat * o, const gfloat * a,
+    const gfloat * b, gint len, const gfloat * icoeff, gint bstride)
+{
+  gint i = 0;
+  __m256 sum[4], t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t = _mm256_loadu_ps (a + i);
+    sum[0] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[0] + i), sum[0]);
+    sum[1] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[1] + i), sum[1]);
+    sum[2] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[2] + i), sum[2]);
+    sum[3] = _mm256_fmadd_ps (t, _mm256_loadu_ps (c[3] + i), sum[3]);
+  }
+  _mm_store_ss (o, hsum_ps_avx2 (cubic_gfloat_finish_avx2 (sum, icoeff)));
+}
+
+static inline void
+inner_product_gfloat_cubic_x2_avx2 (gfloat * o0, gfloat * o1,
+    const gfloat * a0, const gfloat * a1, const gfloat * b, gint len,
+    const gfloat * icoeff, gint bstride)
+{
+  gint i = 0, j;
+  __m256 sum0[4], sum1[4], t0, t1, tb;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) b + 0 * bstride),
+    (gfloat *) ((gint8 *) b + 1 * bstride),
+    (gfloat *) ((gint8 *) b + 2 * bstride),
+    (gfloat *) ((gint8 *) b + 3 * bstride)
+  };
+
+  for (j = 0; j < 4; j++)
+    sum0[j] = sum1[j] = _mm256_setzero_ps ();
+
+  for (; i < len; i += 8) {
+    t0 = _mm256_loadu_ps (a0 + i);
+    t1 = _mm256_loadu_ps (a1 + i);
+    for (j = 0; j < 4; j++) {
+      tb = _mm256_loadu_ps (c[j] + i);
+      sum0[j] = _mm256_fmadd_ps (t0, tb, sum0[j]);
+      sum1[j] = _mm256_fmadd_ps (t1, tb, sum1[j]);
+    }
+  }
+  _mm_store_ss (o0, hsum_ps_avx2 (cubic_gfloat_finish_avx2 (sum0, icoeff)));
+  _mm_store_ss (o1, hsum_ps_avx2 (cubic_gfloat_finish_avx2 (sum1, icoeff)));
+}
+
+/* the gint16 reductions fold the 256 bit accumulators into 128 bits first
+ * and then round exactly like the SSE2 versions */
+static inline __m128i
+fold_epi32_avx2 (__m256i v)
+{
+  return _mm_add_epi32 (_mm256_castsi256_si128 (v),
+      _mm256_extracti128_si256 (v, 1));
+}
+
+static inline gint16
+round_gint16_avx2 (__m128i sum)
+{
+  sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, _MM_SHUFFLE (2, 3, 2, 3)));
+  sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  sum = _mm_add_epi32 (sum, _mm_set1_epi32 (1 << (PRECISION_S16 - 1)));
+  sum = _mm_srai_epi32 (sum, PRECISION_S16);
+  sum = _mm_packs_epi32 (sum, sum);
+  return _mm_extract_epi16 (sum, 0);
+}
+
+static inline void
+inner_product_gint16_full_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    sum = _mm256_add_epi32 (sum,
+        _mm256_madd_epi16 (_mm256_loadu_si256 ((__m256i *) (a + i)),
+            _mm256_loadu_si256 ((__m256i *) (b + i))));
+  }
+  *o = round_gint16_avx2 (fold_epi32_avx2 (sum));
+}
+
+static inline void
+inner_product_gint16_full_x2_avx2 (gint16 * o0, gint16 * o1,
+    const gint16 * a0, const gint16 * a1, const gint16 * b, gint len,
+    const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum[2], t;
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t = _mm256_loadu_si256 ((__m256i *) (b + i));
+    sum[0] = _mm256_add_epi32 (sum[0],
+        _mm256_madd_epi16 (_mm256_loadu_si256 ((__m256i *) (a0 + i)), t));
+    sum[1] = _mm256_add_epi32 (sum[1],
+        _mm256_madd_epi16 (_mm256_loadu_si256 ((__m256i *) (a1 + i)), t));
+  }
+  *o0 = round_gint16_avx2 (fold_epi32_avx2 (sum[0]));
+  *o1 = round_gint16_avx2 (fold_epi32_avx2 (sum[1]));
+}
+
+static inline gint16
+linear_gint16_finish_avx2 (__m256i s0, __m256i s1, const gint16 * icoeff)
+{
+  __m128i sum[2];
+  __m128i f = _mm_set_epi64x (0, *((gint64 *) icoeff));
+
+  f = _mm_unpacklo_epi16 (f, _mm_setzero_si128 ());
+
+  sum[0] = _mm_srai_epi32 (fold_epi32_avx2 (s0), PRECISION_S16);
+  sum[1] = _mm_srai_epi32 (fold_epi32_avx2 (s1), PRECISION_S16);
+
+  sum[0] =
+      _mm_madd_epi16 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_madd_epi16 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  return round_gint16_avx2 (_mm_add_epi32 (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gint16_linear_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum[2], t;
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t = _mm256_loadu_si256 ((__m256i *) (a + i));
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[0] + i))));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t,
+            _mm256_loadu_si256 ((__m256i *) (c[1] + i))));
+  }
+  *o = linear_gint16_finish_avx2 (sum[0], sum[1], icoeff);
+}
+
+static inline void
+inner_product_gint16_linear_x2_avx2 (gint16 * o0, gint16 * o1,
+    const gint16 * a0, const gint16 * a1, const gint16 * b, gint len,
+    const gint16 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i sum[4], t0, t1, tb;
+  const gint16 *c[2] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  sum[0] = sum[1] = sum[2] = sum[3] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t0 = _mm256_loadu_si256 ((__m256i *) (a0 + i));
+    t1 = _mm256_loadu_si256 ((__m256i *) (a1 + i));
+    tb = _mm256_loadu_si256 ((__m256i *) (c[0] + i));
+    sum[0] = _mm256_add_epi32 (sum[0], _mm256_madd_epi16 (t0, tb));
+    sum[2] = _mm256_add_epi32 (sum[2], _mm256_madd_epi16 (t1, tb));
+    tb = _mm256_loadu_si256 ((__m256i *) (c[1] + i));
+    sum[1] = _mm256_add_epi32 (sum[1], _mm256_madd_epi16 (t0, tb));
+    sum[3] = _mm256_add_epi32 (sum[3], _mm256_madd_epi16 (t1, tb));
+  }
+  *o0 = linear_gint16_finish_avx2 (sum[0], sum[1], icoeff);
+  *o1 = linear_gint16_finish_avx2 (sum[2], sum[3], icoeff);
+}
+
+static inline gint16
+cubic_gint16_finish_avx2 (const __m256i s[4], const gint16 * icoeff)
+{
+  __m128i sum[4], t[4];
+  __m128i f = _mm_set_epi64x (0, *((long long *) icoeff));
+
+  f = _mm_unpacklo_epi16 (f, _mm_setzero_si128 ());
+
+  sum[0] = fold_epi32_avx2 (s[0]);
+  sum[1] = fold_epi32_avx2 (s[1]);
+  sum[2] = fold_epi32_avx2 (s[2]);
+  sum[3] = fold_epi32_avx2 (s[3]);
+
+  t[0] = _mm_unpacklo_epi32 (sum[0], sum[1]);
+  t[1] = _mm_unpacklo_epi32 (sum[2], sum[3]);
+  t[2] = _mm_unpackhi_epi32 (sum[0], sum[1]);
+  t[3] = _mm_unpackhi_epi32 (sum[2], sum[3]);
+
+  sum[0] =
+      _mm_add_epi32 (_mm_unpacklo_epi64 (t[0], t[1]), _mm_unpackhi_epi64 (t[0],
+          t[1]));
+  sum[2] =
+      _mm_add_epi32 (_mm_unpacklo_epi64 (t[2], t[3]), _mm_unpackhi_epi64 (t[2],
+          t[3]));
+  sum[0] = _mm_add_epi32 (sum[0], sum[2]);
+
+  sum[0] = _mm_srai_epi32 (sum[0], PRECISION_S16);
+  sum[0] = _mm_madd_epi16 (sum[0], f);
+
+  return round_gint16_avx2 (sum[0]);
+}
+
+static inline void
+inner_product_gint16_cubic_1_avx2 (gint16 * o, const gint16 * a,
+    const gint16 * b, gint len, const gint16 * icoeff, gint bstride)
+{
+  gint i, j;
+  __m256i sum[4], t;
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  for (j = 0; j < 4; j++)
+    sum[j] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t = _mm256_loadu_si256 ((__m256i *) (a + i));
+    for (j = 0; j < 4; j++)
+      sum[j] = _mm256_add_epi32 (sum[j], _mm256_madd_epi16 (t,
+              _mm256_loadu_si256 ((__m256i *) (c[j] + i))));
+  }
+  *o = cubic_gint16_finish_avx2 (sum, icoeff);
+}
+
+static inline void
+inner_product_gint16_cubic_x2_avx2 (gint16 * o0, gint16 * o1,
+    const gint16 * a0, const gint16 * a1, const gint16 * b, gint len,
+    const gint16 * icoeff, gint bstride)
+{
+  gint i, j;
+  __m256i sum0[4], sum1[4], t0, t1, tb;
+  const gint16 *c[4] = { (gint16 *) ((gint8 *) b + 0 * bstride),
+    (gint16 *) ((gint8 *) b + 1 * bstride),
+    (gint16 *) ((gint8 *) b + 2 * bstride),
+    (gint16 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  for (j = 0; j < 4; j++)
+    sum0[j] = sum1[j] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 16) {
+    t0 = _mm256_loadu_si256 ((__m256i *) (a0 + i));
+    t1 = _mm256_loadu_si256 ((__m256i *) (a1 + i));
+    for (j = 0; j < 4; j++) {
+      tb = _mm256_loadu_si256 ((__m256i *) (c[j] + i));
+      sum0[j] = _mm256_add_epi32 (sum0[j], _mm256_madd_epi16 (t0, tb));
+      sum1[j] = _mm256_add_epi32 (sum1[j], _mm256_madd_epi16 (t1, tb));
+    }
+  }
+  *o0 = cubic_gint16_finish_avx2 (sum0, icoeff);
+  *o1 = cubic_gint16_finish_avx2 (sum1, icoeff);
+}
+
+/* The gint32 products are accumulated separately for the even and odd
+ * samples so that the 64 bit lanes end up holding the same partial sums as
+ * the SSE4.1 versions, which keeps the results bit exact between the two. */
+static inline __m256i
+mul_even_epi32_avx2 (__m256i a, __m256i b)
+{
+  return _mm256_mul_epi32 (a, b);
+}
+
+static inline __m256i
+mul_odd_epi32_avx2 (__m256i a, __m256i b)
+{
+  return _mm256_mul_epi32 (_mm256_srli_epi64 (a, 32),
+      _mm256_srli_epi64 (b, 32));
+}
+
+static inline __m128i
+fold_even_odd_epi64_avx2 (__m256i even, __m256i odd)
+{
+  __m128i e, o;
+
+  e = _mm_add_epi64 (_mm256_castsi256_si128 (even),
+      _mm256_extracti128_si256 (even, 1));
+  o = _mm_add_epi64 (_mm256_castsi256_si128 (odd),
+      _mm256_extracti128_si256 (odd, 1));
+  e = _mm_add_epi64 (e, _mm_unpackhi_epi64 (e, e));
+  o = _mm_add_epi64 (o, _mm_unpackhi_epi64 (o, o));
+
+  return _mm_unpacklo_epi64 (e, o);
+}
+
+static inline gint32
+round_gint32_avx2 (__m128i sum)
+{
+  gint64 res;
+
+  sum = _mm_add_epi64 (sum, _mm_unpackhi_epi64 (sum, sum));
+  res = _mm_cvtsi128_si64 (sum);
+
+  res = (res + (1 << (PRECISION_S32 - 1))) >> PRECISION_S32;
+  return CLAMP (res, G_MININT32, G_MAXINT32);
+}
+
+static inline void
+inner_product_gint32_full_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i even, odd, ta, tb;
+
+  even = odd = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+    tb = _mm256_loadu_si256 ((__m256i *) (b + i));
+
+    even = _mm256_add_epi64 (even, mul_even_epi32_avx2 (ta, tb));
+    odd = _mm256_add_epi64 (odd, mul_odd_epi32_avx2 (ta, tb));
+  }
+  *o = round_gint32_avx2 (fold_even_odd_epi64_avx2 (even, odd));
+}
+
+static inline void
+inner_product_gint32_linear_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i;
+  __m256i even[2], odd[2], ta, tb;
+  __m128i sum[2];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[2] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride)
+  };
+
+  even[0] = even[1] = odd[0] = odd[1] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+
+    tb = _mm256_loadu_si256 ((__m256i *) (c[0] + i));
+    even[0] = _mm256_add_epi64 (even[0], mul_even_epi32_avx2 (ta, tb));
+    odd[0] = _mm256_add_epi64 (odd[0], mul_odd_epi32_avx2 (ta, tb));
+
+    tb = _mm256_loadu_si256 ((__m256i *) (c[1] + i));
+    even[1] = _mm256_add_epi64 (even[1], mul_even_epi32_avx2 (ta, tb));
+    odd[1] = _mm256_add_epi64 (odd[1], mul_odd_epi32_avx2 (ta, tb));
+  }
+  sum[0] = fold_even_odd_epi64_avx2 (even[0], odd[0]);
+  sum[1] = fold_even_odd_epi64_avx2 (even[1], odd[1]);
+
+  sum[0] = _mm_srli_epi64 (sum[0], PRECISION_S32);
+  sum[1] = _mm_srli_epi64 (sum[1], PRECISION_S32);
+  sum[0] =
+      _mm_mul_epi32 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_mul_epi32 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+
+  *o = round_gint32_avx2 (_mm_add_epi64 (sum[0], sum[1]));
+}
+
+static inline void
+inner_product_gint32_cubic_1_avx2 (gint32 * o, const gint32 * a,
+    const gint32 * b, gint len, const gint32 * icoeff, gint bstride)
+{
+  gint i, j;
+  __m256i even[4], odd[4], ta, tb;
+  __m128i sum[4];
+  __m128i f = _mm_loadu_si128 ((__m128i *) icoeff);
+  const gint32 *c[4] = { (gint32 *) ((gint8 *) b + 0 * bstride),
+    (gint32 *) ((gint8 *) b + 1 * bstride),
+    (gint32 *) ((gint8 *) b + 2 * bstride),
+    (gint32 *) ((gint8 *) b + 3 * bstride)
+  };
+
+  for (j = 0; j < 4; j++)
+    even[j] = odd[j] = _mm256_setzero_si256 ();
+
+  for (i = 0; i < len; i += 8) {
+    ta = _mm256_loadu_si256 ((__m256i *) (a + i));
+
+    for (j = 0; j < 4; j++) {
+      tb = _mm256_loadu_si256 ((__m256i *) (c[j] + i));
+      even[j] = _mm256_add_epi64 (even[j], mul_even_epi32_avx2 (ta, tb));
+      odd[j] = _mm256_add_epi64 (odd[j], mul_odd_epi32_avx2 (ta, tb));
+    }
+  }
+  for (j = 0; j < 4; j++) {
+    sum[j] = fold_even_odd_epi64_avx2 (even[j], odd[j]);
+    sum[j] = _mm_srli_epi64 (sum[j], PRECISION_S32);
+  }
+  sum[0] =
+      _mm_mul_epi32 (sum[0], _mm_shuffle_epi32 (f, _MM_SHUFFLE (0, 0, 0, 0)));
+  sum[1] =
+      _mm_mul_epi32 (sum[1], _mm_shuffle_epi32 (f, _MM_SHUFFLE (1, 1, 1, 1)));
+  sum[2] =
+      _mm_mul_epi32 (sum[2], _mm_shuffle_epi32 (f, _MM_SHUFFLE (2, 2, 2, 2)));
+  sum[3] =
+      _mm_mul_epi32 (sum[3], _mm_shuffle_epi32 (f, _MM_SHUFFLE (3, 3, 3, 3)));
+  sum[0] = _mm_add_epi64 (sum[0], sum[1]);
+  sum[2] = _mm_add_epi64 (sum[2], sum[3]);
+
+  *o = round_gint32_avx2 (_mm_add_epi64 (sum[0], sum[2]));
+}
+
+MAKE_RESAMPLE_FUNC (gint16, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint16, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gint32, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gint32, cubic, 1, avx2);
+
+MAKE_RESAMPLE_FUNC (gfloat, full, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, linear, 1, avx2);
+MAKE_RESAMPLE_FUNC (gfloat, cubic, 1, avx2);
+
+MAKE_RESAMPLE_N_FUNC (gint16, full, avx2);
+MAKE_RESAMPLE_N_FUNC (gint16, linear, avx2);
+MAKE_RESAMPLE_N_FUNC (gint16, cubic, avx2);
+
+MAKE_RESAMPLE_N_FUNC (gfloat, full, avx2);
+MAKE_RESAMPLE_N_FUNC (gfloat, linear, avx2);
+MAKE_RESAMPLE_N_FUNC (gfloat, cubic, avx2);
+
+void
+interpolate_gfloat_linear_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[2];
+  const gfloat *c[2] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride)
+  };
+
+  f[0] = _mm256_broadcast_ss (ic + 0);
+  f[1] = _mm256_broadcast_ss (ic + 1);
+
+  for (i = 0; i < len; i += 8) {
+    _mm256_storeu_ps (o + i,
+        _mm256_fmadd_ps (_mm256_loadu_ps (c[1] + i), f[1],
+            _mm256_mul_ps (_mm256_loadu_ps (c[0] + i), f[0])));
+  }
+}
+
+void
+interpolate_gfloat_cubic_avx2 (gpointer op, const gpointer ap,
+    gint len, const gpointer icp, gint astride)
+{
+  gint i;
+  gfloat *o = op, *a = ap, *ic = icp;
+  __m256 f[4], t;
+  const gfloat *c[4] = { (gfloat *) ((gint8 *) a + 0 * astride),
+    (gfloat *) ((gint8 *) a + 1 * astride),
+    (gfloat *) ((gint8 *) a + 2 * astride),
+    (gfloat *) ((gint8 *) a + 3 * astride)
+  };
+
+  f[0] = _mm256_broadcast_ss (ic + 0);
+  f[1] = _mm256_broadcast_ss (ic + 1);
+  f[2] = _mm256_broadcast_ss (ic + 2);
+  f[3] = _mm256_broadcast_ss (ic + 3);
+
+  for (i = 0; i < len; i += 8) {
+    t = _mm256_mul_ps (_mm256_loadu_ps (c[0] + i), f[0]);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[1] + i), f[1], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[2] + i), f[2], t);
+    t = _mm256_fmadd_ps (_mm256_loadu_ps (c[3] + i), f[3], t);
+    _mm256_storeu_ps (o + i, t);
+  }
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "audio-resampler-x86-sse.h"
 #include "audio-resampler-x86-sse2.h"
 #include "audio-resampler-x86-sse41.h"
+#include "audio-resampler-x86-avx2.h"
 
 static void
 audio_resampler_check_x86 (const gchar *option)
@@ -66,6 +67,38 @@ audio_resampler_check_x86 (const gchar *option)
     resample_gint32_cubic_1 = resample_gint32_cubic_1_sse41;
 #else
     GST_DEBUG ("SSE41 optimisations not enabled");
+#endif
+  } else if (!strcmp (option, "avx2")) {
+#if defined (__x86_64__) && defined (HAVE_IMMINTRIN_H) && HAVE_AVX2
+    if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) {
+      GST_DEBUG ("enable AVX2 optimisations");
+      resample_gint16_full_1 = resample_gint16_full_1_avx2;
+      resample_gint16_linear_1 = resample_gint16_linear_1_avx2;
+      resample_gint16_cubic_1 = resample_gint16_cubic_1_avx2;
+
+      resample_gint32_full_1 = resample_gint32_full_1_avx2;
+      resample_gint32_linear_1 = resample_gint32_linear_1_avx2;
+      resample_gint32_cubic_1 = resample_gint32_cubic_1_avx2;
+
+      resample_gfloat_full_1 = resample_gfloat_full_1_avx2;
+      resample_gfloat_linear_1 = resample_gfloat_linear_1_avx2;
+      resample_gfloat_cubic_1 = resample_gfloat_cubic_1_avx2;
+
+      resample_gint16_full_n = resample_gint16_full_n_avx2;
+      resample_gint16_linear_n = resample_gint16_linear_n_avx2;
+      resample_gint16_cubic_n = resample_gint16_cubic_n_avx2;
+
+      resample_gfloat_full_n = resample_gfloat_full_n_avx2;
+      resample_gfloat_linear_n = resample_gfloat_linear_n_avx2;
+      resample_gfloat_cubic_n = resample_gfloat_cubic_n_avx2;
+
+      interpolate_gfloat_linear = interpolate_gfloat_linear_avx2;
+      interpolate_gfloat_cubic = interpolate_gfloat_cubic_avx2;
+    } else {
+      GST_DEBUG ("AVX2 not supported by the CPU");
+    }
+#else
+    GST_DEBUG ("AVX2 optimisations not enabled");
 #endif
   }
 }
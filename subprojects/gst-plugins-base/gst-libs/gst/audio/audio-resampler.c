@@ -822,6 +822,25 @@ static ResampleFunc resample_funcs[] = {
 #define resample_gfloat_cubic_1 resample_funcs[14]
 #define resample_gdouble_cubic_1 resample_funcs[15]
 
+/* optional variants that process all channels for each output sample, set by
+ * the arch specific checks below */
+static ResampleFunc resample_n_funcs[16];
+
+#define resample_gint16_full_n resample_n_funcs[4]
+#define resample_gint32_full_n resample_n_funcs[5]
+#define resample_gfloat_full_n resample_n_funcs[6]
+#define resample_gdouble_full_n resample_n_funcs[7]
+
+#define resample_gint16_linear_n resample_n_funcs[8]
+#define resample_gint32_linear_n resample_n_funcs[9]
+#define resample_gfloat_linear_n resample_n_funcs[10]
+#define resample_gdouble_linear_n resample_n_funcs[11]
+
+#define resample_gint16_cubic_n resample_n_funcs[12]
+#define resample_gint32_cubic_n resample_n_funcs[13]
+#define resample_gfloat_cubic_n resample_n_funcs[14]
+#define resample_gdouble_cubic_n resample_n_funcs[15]
+
 #if defined HAVE_ORC && !defined DISABLE_ORC
 # if defined (HAVE_ARM_NEON)
 #  define CHECK_NEON
@@ -872,6 +891,10 @@ audio_resampler_init (void)
 #endif
           }
         }
+#ifdef CHECK_X86
+        /* orc has no flags for AVX2/FMA, this one probes the CPU itself */
+        audio_resampler_check_x86 ("avx2");
+#endif
       }
     }
 #endif
@@ -1059,6 +1082,11 @@ setup_functions (GstAudioResampler * resampler)
     }
     GST_DEBUG ("using resample function %d", index);
     resampler->resample = resample_funcs[index];
+
+    if (resampler->blocks > 1 && resample_n_funcs[index]) {
+      GST_DEBUG ("using multichannel resample function %d", index);
+      resampler->resample = resample_n_funcs[index];
+    }
   }
 }
 
@@ -124,6 +124,11 @@ struct _GstAudioAggregatorPadPrivate
   guint64 dropped;              /* Number of sampels dropped since the element came out of READY */
 
   gboolean qos_messages;        /* Property to decide to send QoS messages or not */
+
+  /* Converted version of prepared_input, filled by the parallel conversion
+   * and picked up by the mixing loop in the same aggregate() call */
+  GstBuffer *prepared_input;
+  GstBuffer *prepared_buffer;
 };
 
 
@@ -143,6 +148,8 @@ gst_audio_aggregator_pad_finalize (GObject * object)
   GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) object;
 
   gst_buffer_replace (&pad->priv->buffer, NULL);
+  gst_buffer_replace (&pad->priv->prepared_input, NULL);
+  gst_buffer_replace (&pad->priv->prepared_buffer, NULL);
 
   G_OBJECT_CLASS (gst_audio_aggregator_pad_parent_class)->finalize (object);
 }
@@ -242,6 +249,8 @@ gst_audio_aggregator_pad_flush_pad (GstAggregatorPad * aggpad,
   pad->priv->output_offset = pad->priv->next_offset = -1;
   pad->priv->discont_time = GST_CLOCK_TIME_NONE;
   gst_buffer_replace (&pad->priv->buffer, NULL);
+  gst_buffer_replace (&pad->priv->prepared_input, NULL);
+  gst_buffer_replace (&pad->priv->prepared_buffer, NULL);
   gst_audio_aggregator_pad_reset_qos (pad);
   GST_OBJECT_UNLOCK (aggpad);
 
@@ -491,6 +500,12 @@ struct _GstAudioAggregatorPrivate
   /* Only access from src thread */
   /* Messages to post after releasing locks */
   GQueue messages;
+
+  /* Protected by the object lock */
+  guint max_threads;
+
+  /* Used for converting the input buffers of multiple pads in parallel */
+  GstTaskPool *task_pool;
 };
 
 #define GST_AUDIO_AGGREGATOR_LOCK(self)   g_mutex_lock (&(self)->priv->mutex);
@@ -537,6 +552,7 @@ static GstSample *gst_audio_aggregator_peek_next_sample (GstAggregator * agg,
 #define DEFAULT_OUTPUT_BUFFER_DURATION_N (1)
 #define DEFAULT_OUTPUT_BUFFER_DURATION_D (100)
 #define DEFAULT_FORCE_LIVE FALSE
+#define DEFAULT_MAX_THREADS 1
 
 enum
 {
@@ -547,6 +563,7 @@ enum
   PROP_OUTPUT_BUFFER_DURATION_FRACTION,
   PROP_IGNORE_INACTIVE_PADS,
   PROP_FORCE_LIVE,
+  PROP_MAX_THREADS,
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GstAudioAggregator, gst_audio_aggregator,
@@ -758,6 +775,23 @@ gst_audio_aggregator_class_init (GstAudioAggregatorClass * klass)
           "whether any live sources are linked upstream",
           DEFAULT_FORCE_LIVE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_CONSTRUCT_ONLY));
+
+  /**
+   * GstAudioAggregator:max-threads:
+   *
+   * Maximum number of threads used for converting the input buffers of the
+   * sink pads to the output format. When more than one pad needs a new
+   * buffer converted for the same output buffer, the conversions are spread
+   * over this many threads instead of running one after another in the
+   * aggregate thread. 0 means one thread per processor.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_THREADS,
+      g_param_spec_uint ("max-threads", "Maximum threads",
+          "Maximum number of threads to convert input buffers with "
+          "(0 = number of processors)", 0, G_MAXUINT, DEFAULT_MAX_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -777,6 +811,8 @@ gst_audio_aggregator_init (GstAudioAggregator * aagg)
       ("GstAudioAggregatorSelectedSamplesInfo");
 
   g_queue_init (&aagg->priv->messages);
+
+  aagg->priv->max_threads = DEFAULT_MAX_THREADS;
 }
 
 static void
@@ -788,6 +824,10 @@ gst_audio_aggregator_dispose (GObject * object)
 
   gst_clear_structure (&aagg->priv->selected_samples_info);
 
+  if (aagg->priv->task_pool)
+    gst_task_pool_cleanup (aagg->priv->task_pool);
+  gst_clear_object (&aagg->priv->task_pool);
+
   g_mutex_clear (&aagg->priv->mutex);
 
   G_OBJECT_CLASS (gst_audio_aggregator_parent_class)->dispose (object);
@@ -828,6 +868,11 @@ gst_audio_aggregator_set_property (GObject * object, guint prop_id,
       gst_aggregator_set_force_live (GST_AGGREGATOR (object),
           g_value_get_boolean (value));
       break;
+    case PROP_MAX_THREADS:
+      GST_OBJECT_LOCK (aagg);
+      aagg->priv->max_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -864,6 +909,11 @@ gst_audio_aggregator_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value,
           gst_aggregator_get_force_live (GST_AGGREGATOR (object)));
       break;
+    case PROP_MAX_THREADS:
+      GST_OBJECT_LOCK (aagg);
+      g_value_set_uint (value, aagg->priv->max_threads);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2180,6 +2230,148 @@ gst_audio_aggregator_peek_next_sample (GstAggregator * agg,
   return sample;
 }
 
+typedef struct
+{
+  GstAudioAggregatorPad *pad;
+  GstBuffer *input;
+  GstBuffer *output;
+} ConvertJob;
+
+typedef struct
+{
+  GstAudioAggregator *aagg;
+  ConvertJob *jobs;
+  guint n_jobs;
+  guint first;
+  guint stride;
+} ConvertSlice;
+
+static void
+gst_audio_aggregator_convert_slice (gpointer data)
+{
+  ConvertSlice *slice = data;
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR (slice->aagg)->srcpad);
+  guint i;
+
+  for (i = slice->first; i < slice->n_jobs; i += slice->stride) {
+    ConvertJob *job = &slice->jobs[i];
+
+    GST_OBJECT_LOCK (job->pad);
+    job->output = gst_audio_aggregator_convert_buffer (slice->aagg,
+        GST_PAD (job->pad), &job->pad->info, &srcpad->info, job->input);
+    GST_OBJECT_UNLOCK (job->pad);
+  }
+}
+
+/* Called with the object lock held.
+ *
+ * Converts the next input buffer of every pad that needs a new one on the
+ * task pool. The mixing loop in aggregate() then only has to pick up the
+ * prepared buffers instead of converting them one after another. */
+static void
+gst_audio_aggregator_convert_parallel (GstAudioAggregator * aagg)
+{
+  GstElement *element = GST_ELEMENT (aagg);
+  ConvertJob *jobs;
+  ConvertSlice *slices;
+  gpointer *tasks;
+  guint n_threads, n_jobs = 0, i;
+  GList *iter;
+
+  n_threads = aagg->priv->max_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+  if (n_threads < 2 || element->numsinkpads < 2)
+    return;
+
+  jobs = g_newa (ConvertJob, element->numsinkpads);
+  for (iter = element->sinkpads; iter; iter = iter->next) {
+    GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) iter->data;
+    GstAggregatorPad *aggpad = (GstAggregatorPad *) iter->data;
+    GstBuffer *input_buffer;
+
+    if (!GST_AUDIO_AGGREGATOR_PAD_GET_CLASS (pad)->convert_buffer
+        || gst_aggregator_pad_is_inactive (aggpad))
+      continue;
+
+    input_buffer = gst_aggregator_pad_peek_buffer (aggpad);
+    if (!input_buffer)
+      continue;
+
+    GST_OBJECT_LOCK (pad);
+    if (!pad->priv->buffer && GST_AUDIO_INFO_IS_VALID (&pad->info)
+        && pad->priv->prepared_input != input_buffer) {
+      jobs[n_jobs].pad = pad;
+      jobs[n_jobs].input = input_buffer;
+      jobs[n_jobs].output = NULL;
+      n_jobs++;
+    } else {
+      gst_buffer_unref (input_buffer);
+    }
+    GST_OBJECT_UNLOCK (pad);
+  }
+
+  if (n_jobs < 2) {
+    /* Nothing to gain, let the mixing loop convert as usual */
+    for (i = 0; i < n_jobs; i++)
+      gst_buffer_unref (jobs[i].input);
+    return;
+  }
+
+  n_threads = MIN (n_threads, n_jobs);
+
+  /* The pool is only needed once there is something to run in parallel,
+   * the aggregate thread takes one slice itself */
+  if (!aagg->priv->task_pool) {
+    aagg->priv->task_pool = gst_shared_task_pool_new ();
+    gst_task_pool_prepare (aagg->priv->task_pool, NULL);
+  }
+  if (gst_shared_task_pool_get_max_threads (GST_SHARED_TASK_POOL (aagg->
+              priv->task_pool)) < n_threads - 1)
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL (aagg->
+            priv->task_pool), n_threads - 1);
+
+  slices = g_newa (ConvertSlice, n_threads);
+  tasks = g_newa (gpointer, n_threads);
+
+  GST_LOG_OBJECT (aagg, "Converting %u buffers with %u threads", n_jobs,
+      n_threads);
+
+  for (i = 0; i < n_threads; i++) {
+    slices[i].aagg = aagg;
+    slices[i].jobs = jobs;
+    slices[i].n_jobs = n_jobs;
+    slices[i].first = i;
+    slices[i].stride = n_threads;
+  }
+
+  /* The first slice is handled by the aggregate thread itself */
+  for (i = 1; i < n_threads; i++) {
+    tasks[i] = gst_task_pool_push (aagg->priv->task_pool,
+        gst_audio_aggregator_convert_slice, &slices[i], NULL);
+  }
+  gst_audio_aggregator_convert_slice (&slices[0]);
+  for (i = 1; i < n_threads; i++) {
+    if (tasks[i])
+      gst_task_pool_join (aagg->priv->task_pool, tasks[i]);
+    else
+      gst_audio_aggregator_convert_slice (&slices[i]);
+  }
+
+  for (i = 0; i < n_jobs; i++) {
+    GstAudioAggregatorPad *pad = jobs[i].pad;
+
+    GST_OBJECT_LOCK (pad);
+    gst_buffer_replace (&pad->priv->prepared_input, jobs[i].input);
+    gst_buffer_replace (&pad->priv->prepared_buffer, NULL);
+    pad->priv->prepared_buffer = jobs[i].output;
+    GST_OBJECT_UNLOCK (pad);
+
+    gst_buffer_unref (jobs[i].input);
+  }
+}
+
 static gboolean
 sync_pad_values (GstElement * aagg, GstPad * pad, gpointer user_data)
 {
@@ -2348,6 +2540,8 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
       " with timestamp %" GST_TIME_FORMAT, blocksize,
       aagg->priv->offset, GST_TIME_ARGS (agg_segment->position));
 
+  gst_audio_aggregator_convert_parallel (aagg);
+
   for (iter = element->sinkpads; iter; iter = iter->next) {
     GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) iter->data;
     GstAggregatorPad *aggpad = (GstAggregatorPad *) iter->data;
@@ -2386,9 +2580,15 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
     /* New buffer? */
     if (!pad->priv->buffer) {
       if (GST_AUDIO_AGGREGATOR_PAD_GET_CLASS (pad)->convert_buffer) {
-        pad->priv->buffer =
-            gst_audio_aggregator_convert_buffer
-            (aagg, GST_PAD (pad), &pad->info, &srcpad->info, input_buffer);
+        if (pad->priv->prepared_input == input_buffer) {
+          pad->priv->buffer = pad->priv->prepared_buffer;
+          pad->priv->prepared_buffer = NULL;
+          gst_buffer_replace (&pad->priv->prepared_input, NULL);
+        } else {
+          pad->priv->buffer =
+              gst_audio_aggregator_convert_buffer
+              (aagg, GST_PAD (pad), &pad->info, &srcpad->info, input_buffer);
+        }
         if (!pad->priv->buffer) {
           GST_OBJECT_UNLOCK (pad);
           GST_OBJECT_UNLOCK (agg);
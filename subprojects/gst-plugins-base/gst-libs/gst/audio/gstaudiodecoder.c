@@ -96,7 +96,16 @@
  * small(er) buffers being pushed and processed downstream. Note that this
  * feature is only available if the buffer layout is interleaved. For planar
  * buffers, the decoder implementation is fully responsible for the output
- * buffer size.
+ * buffer size.  Alternatively, #GstAudioDecoder:output-buffer-list makes the
+ * base class collect the output buffers into a #GstBufferList pushed
+ * downstream in one go, which avoids copying the samples and also works for
+ * planar buffers.
+ *
+ * Subclasses decoding small frames can reduce per-frame overhead on the input
+ * side as well by implementing @handle_frame_list and configuring a batch
+ * size with gst_audio_decoder_set_max_batch_frames().  Base class then hands
+ * over up to that many parsed frames at once, and subclass may finish them
+ * with a single (merged) output buffer.
  *
  * On the other hand, it should be noted that baseclass only provides limited
  * seeking support (upon explicit subclass request), as full-fledged support
@@ -143,7 +152,8 @@ enum
   PROP_LATENCY,
   PROP_TOLERANCE,
   PROP_PLC,
-  PROP_MAX_ERRORS
+  PROP_MAX_ERRORS,
+  PROP_OUTPUT_BUFFER_LIST
 };
 
 #define DEFAULT_LATENCY    0
@@ -152,6 +162,8 @@ enum
 #define DEFAULT_DRAINABLE  TRUE
 #define DEFAULT_NEEDS_FORMAT  FALSE
 #define DEFAULT_MAX_ERRORS GST_AUDIO_DECODER_MAX_ERRORS
+#define DEFAULT_OUTPUT_BUFFER_LIST FALSE
+#define DEFAULT_MAX_BATCH_FRAMES 1
 
 typedef struct _GstAudioDecoderContext
 {
@@ -206,6 +218,8 @@ struct _GstAudioDecoderPrivate
   GQueue frames;
   /* collected output data */
   GstAdapter *adapter_out;
+  /* or collected output buffers, if so configured */
+  GstBufferList *out_list;
   /* ts and duration for output data collected above */
   GstClockTime out_ts, out_dur;
   /* mark outgoing discont */
@@ -268,6 +282,12 @@ struct _GstAudioDecoderPrivate
   gboolean plc;
   gboolean drainable;
   gboolean needs_format;
+  gboolean output_buffer_list;
+  guint max_batch_frames;
+  /* frames collected for handle_frame_list() and their total duration,
+   * GST_CLOCK_TIME_NONE if unknown */
+  GstBufferList *batch;
+  GstClockTime batch_dur;
 
   /* pending serialized sink events, will be sent from finish_frame() */
   GList *pending_events;
@@ -431,6 +451,21 @@ gst_audio_decoder_class_init (GstAudioDecoderClass * klass)
           -1, G_MAXINT, DEFAULT_MAX_ERRORS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioDecoder:output-buffer-list:
+   *
+   * Aggregate output as a #GstBufferList rather than merging it into a
+   * single buffer. Only has an effect if #GstAudioDecoder:min-latency is
+   * non-zero. See gst_audio_decoder_set_output_buffer_list() for more details.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_OUTPUT_BUFFER_LIST,
+      g_param_spec_boolean ("output-buffer-list", "Output Buffer List",
+          "Aggregate output into buffer lists instead of merged buffers",
+          DEFAULT_OUTPUT_BUFFER_LIST,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   audiodecoder_class->sink_event =
       GST_DEBUG_FUNCPTR (gst_audio_decoder_sink_eventfunc);
   audiodecoder_class->src_event =
@@ -501,6 +536,8 @@ gst_audio_decoder_init (GstAudioDecoder * dec, GstAudioDecoderClass * klass)
   dec->priv->drainable = DEFAULT_DRAINABLE;
   dec->priv->needs_format = DEFAULT_NEEDS_FORMAT;
   dec->priv->max_errors = GST_AUDIO_DECODER_MAX_ERRORS;
+  dec->priv->output_buffer_list = DEFAULT_OUTPUT_BUFFER_LIST;
+  dec->priv->max_batch_frames = DEFAULT_MAX_BATCH_FRAMES;
 
   /* init state */
   dec->priv->ctx.min_latency = 0;
@@ -567,6 +604,8 @@ gst_audio_decoder_reset (GstAudioDecoder * dec, gboolean full)
   g_queue_clear (&dec->priv->frames);
   gst_adapter_clear (dec->priv->adapter);
   gst_adapter_clear (dec->priv->adapter_out);
+  gst_clear_buffer_list (&dec->priv->out_list);
+  gst_clear_buffer_list (&dec->priv->batch);
   dec->priv->out_ts = GST_CLOCK_TIME_NONE;
   dec->priv->out_dur = 0;
   dec->priv->prev_ts = GST_CLOCK_TIME_NONE;
@@ -594,6 +633,8 @@ gst_audio_decoder_finalize (GObject * object)
   if (dec->priv->adapter_out) {
     g_object_unref (dec->priv->adapter_out);
   }
+  gst_clear_buffer_list (&dec->priv->out_list);
+  gst_clear_buffer_list (&dec->priv->batch);
 
   g_rec_mutex_clear (&dec->stream_lock);
 
@@ -960,18 +1001,22 @@ gst_audio_decoder_setup (GstAudioDecoder * dec)
   dec->priv->agg = !!res;
 }
 
+/* clips and decorates @buf for pushing, which is set to NULL if nothing is
+ * left to push */
 static GstFlowReturn
-gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
+gst_audio_decoder_prepare_push (GstAudioDecoder * dec, GstBuffer ** buffer)
 {
   GstAudioDecoderClass *klass;
   GstAudioDecoderPrivate *priv;
   GstAudioDecoderContext *ctx;
   GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *buf = *buffer;
   GstClockTime ts;
 
   klass = GST_AUDIO_DECODER_GET_CLASS (dec);
   priv = dec->priv;
   ctx = &dec->priv->ctx;
+  *buffer = NULL;
 
   g_return_val_if_fail (ctx->info.bpf != 0, GST_FLOW_ERROR);
 
@@ -1030,6 +1075,7 @@ gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
           gst_flow_get_name (ret), buf);
       if (buf)
         gst_buffer_unref (buf);
+      buf = NULL;
       goto exit;
     }
   }
@@ -1040,13 +1086,60 @@ gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
       GST_TIME_ARGS (GST_BUFFER_PTS (buf)),
       GST_TIME_ARGS (GST_BUFFER_DURATION (buf)));
 
-  ret = gst_pad_push (dec->srcpad, buf);
-
 exit:
+  *buffer = buf;
+  return ret;
+}
+
+static GstFlowReturn
+gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
+{
+  GstFlowReturn ret;
+
+  ret = gst_audio_decoder_prepare_push (dec, &buf);
+  if (buf)
+    ret = gst_pad_push (dec->srcpad, buf);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_audio_decoder_push_forward_list (GstAudioDecoder * dec,
+    GstBufferList * list)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBufferList *out;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  out = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++) {
+    GstBuffer *buf = gst_buffer_ref (gst_buffer_list_get (list, i));
+
+    ret = gst_audio_decoder_prepare_push (dec, &buf);
+    if (buf)
+      gst_buffer_list_add (out, buf);
+  }
+  gst_buffer_list_unref (list);
+
+  if (gst_buffer_list_length (out) > 0) {
+    GstFlowReturn push_ret;
+
+    GST_LOG_OBJECT (dec, "pushing list of %u buffers",
+        gst_buffer_list_length (out));
+    push_ret = gst_pad_push_list (dec->srcpad, out);
+    /* a clipping EOS only applies after what was still in segment */
+    if (push_ret != GST_FLOW_OK)
+      ret = push_ret;
+  } else {
+    gst_buffer_list_unref (out);
+  }
+
   return ret;
 }
 
-/* mini aggregator combining output buffers into fewer larger ones,
+/* mini aggregator combining output buffers into fewer larger ones (or lists),
  * if so allowed/configured */
 static GstFlowReturn
 gst_audio_decoder_output (GstAudioDecoder * dec, GstBuffer * buf)
@@ -1054,6 +1147,7 @@ gst_audio_decoder_output (GstAudioDecoder * dec, GstBuffer * buf)
   GstAudioDecoderPrivate *priv;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *inbuf = NULL;
+  GstBufferList *list;
 
   priv = dec->priv;
 
@@ -1070,14 +1164,22 @@ gst_audio_decoder_output (GstAudioDecoder * dec, GstBuffer * buf)
 
 again:
   inbuf = NULL;
-  if (priv->agg && dec->priv->latency > 0 &&
-      priv->ctx.info.layout == GST_AUDIO_LAYOUT_INTERLEAVED) {
+  list = NULL;
+  if (priv->agg && dec->priv->latency > 0 && (priv->out_list ||
+          priv->output_buffer_list ||
+          priv->ctx.info.layout == GST_AUDIO_LAYOUT_INTERLEAVED)) {
     gint av;
-    gboolean assemble = FALSE;
+    gboolean use_list, assemble = FALSE;
     const GstClockTimeDiff tol = 10 * GST_MSECOND;
     GstClockTimeDiff diff = -100 * GST_MSECOND;
 
     av = gst_adapter_available (priv->adapter_out);
+    /* stick to the mode a pending fragment was started in, av then only
+     * needs to tell whether anything is pending */
+    if (priv->out_list)
+      av += gst_buffer_list_length (priv->out_list);
+    use_list = priv->out_list || (!av && priv->output_buffer_list);
+
     if (G_UNLIKELY (!buf)) {
       /* forcibly send current */
       assemble = TRUE;
@@ -1097,9 +1199,15 @@ again:
       } else {
         GST_LOG_OBJECT (dec, "adding to fragment");
       }
-      gst_adapter_push (priv->adapter_out, buf);
       priv->out_dur += GST_BUFFER_DURATION (buf);
       av += gst_buffer_get_size (buf);
+      if (use_list) {
+        if (!priv->out_list)
+          priv->out_list = gst_buffer_list_new ();
+        gst_buffer_list_add (priv->out_list, buf);
+      } else {
+        gst_adapter_push (priv->adapter_out, buf);
+      }
       buf = NULL;
     }
     if (priv->out_dur > dec->priv->latency)
@@ -1107,15 +1215,41 @@ again:
     if (av && assemble) {
       GST_LOG_OBJECT (dec, "assembling fragment");
       inbuf = buf;
-      buf = gst_adapter_take_buffer (priv->adapter_out, av);
-      GST_BUFFER_PTS (buf) = priv->out_ts;
-      GST_BUFFER_DURATION (buf) = priv->out_dur;
+      if (use_list) {
+        list = priv->out_list;
+        priv->out_list = NULL;
+        buf = NULL;
+      } else {
+        buf = gst_adapter_take_buffer (priv->adapter_out, av);
+        GST_BUFFER_PTS (buf) = priv->out_ts;
+        GST_BUFFER_DURATION (buf) = priv->out_dur;
+      }
       priv->out_ts = GST_CLOCK_TIME_NONE;
       priv->out_dur = 0;
     }
   }
 
-  if (G_LIKELY (buf)) {
+  if (G_UNLIKELY (list)) {
+    if (dec->output_segment.rate > 0.0) {
+      ret = gst_audio_decoder_push_forward_list (dec, list);
+      GST_LOG_OBJECT (dec, "buffer list pushed: %s", gst_flow_get_name (ret));
+    } else {
+      guint i, len = gst_buffer_list_length (list);
+
+      ret = GST_FLOW_OK;
+      for (i = 0; i < len; i++) {
+        priv->queued = g_list_prepend (priv->queued,
+            gst_buffer_ref (gst_buffer_list_get (list, i)));
+      }
+      gst_buffer_list_unref (list);
+      GST_LOG_OBJECT (dec, "buffer list queued");
+    }
+
+    if (inbuf) {
+      buf = inbuf;
+      goto again;
+    }
+  } else if (G_LIKELY (buf)) {
     if (dec->output_segment.rate > 0.0) {
       ret = gst_audio_decoder_push_forward (dec, buf);
       GST_LOG_OBJECT (dec, "buffer pushed: %s", gst_flow_get_name (ret));
@@ -1655,6 +1789,66 @@ gst_audio_decoder_handle_frame (GstAudioDecoder * dec,
   return klass->handle_frame (dec, buffer);
 }
 
+/* takes ownership of *frames and clears it */
+static GstFlowReturn
+gst_audio_decoder_handle_frame_list (GstAudioDecoder * dec,
+    GstAudioDecoderClass * klass, GstBufferList ** frames)
+{
+  GstBufferList *list = *frames;
+  GstFlowReturn ret;
+  gsize size = 0;
+  guint i, len;
+
+  *frames = NULL;
+  len = gst_buffer_list_length (list);
+
+  /* keep around for admin */
+  for (i = 0; i < len; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+
+    size += gst_buffer_get_size (buffer);
+    g_queue_push_tail (&dec->priv->frames, gst_buffer_ref (buffer));
+  }
+  dec->priv->ctx.delay = dec->priv->frames.length;
+  GST_OBJECT_LOCK (dec);
+  dec->priv->bytes_in += size;
+  GST_OBJECT_UNLOCK (dec);
+
+  GST_LOG_OBJECT (dec, "providing subclass with %u frames, total size %"
+      G_GSIZE_FORMAT, len, size);
+  ret = klass->handle_frame_list (dec, list);
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
+/* hands the frames still collected for handle_frame_list() to subclass */
+static GstFlowReturn
+gst_audio_decoder_push_batch (GstAudioDecoder * dec)
+{
+  if (!dec->priv->batch)
+    return GST_FLOW_OK;
+
+  return gst_audio_decoder_handle_frame_list (dec,
+      GST_AUDIO_DECODER_GET_CLASS (dec), &dec->priv->batch);
+}
+
+/* whether collected frames may wait for the next input buffer, which is only
+ * done for forward playback in non-live pipelines and as long as they cover
+ * less than #GstAudioDecoder:min-latency, as for output aggregation */
+static gboolean
+gst_audio_decoder_hold_batch (GstAudioDecoder * dec)
+{
+  GstAudioDecoderPrivate *priv = dec->priv;
+
+  if (G_UNLIKELY (priv->agg < 0))
+    gst_audio_decoder_setup (dec);
+
+  return priv->agg && priv->latency > 0 && dec->input_segment.rate > 0.0 &&
+      GST_CLOCK_TIME_IS_VALID (priv->batch_dur) &&
+      priv->batch_dur < priv->latency;
+}
+
 /* maybe subclass configurable instead, but this allows for a whole lot of
  * raw samples, so at least quite some encoded ... */
 #define GST_AUDIO_DECODER_MAX_SYNC     10 * 8 * 2 * 1024
@@ -1667,6 +1861,7 @@ gst_audio_decoder_push_buffers (GstAudioDecoder * dec, gboolean force)
   GstAudioDecoderContext *ctx;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *buffer;
+  guint max_batch = 1;
   gint av, flush;
 
   klass = GST_AUDIO_DECODER_GET_CLASS (dec);
@@ -1678,6 +1873,13 @@ gst_audio_decoder_push_buffers (GstAudioDecoder * dec, gboolean force)
   av = gst_adapter_available (priv->adapter);
   GST_DEBUG_OBJECT (dec, "available: %d", av);
 
+  /* collect frames for subclass if it can take several at once,
+   * trickmode gaps are handled per frame though */
+  if (klass->handle_frame_list && priv->max_batch_frames > 1 &&
+      !(dec->input_segment.rate > 0.0
+          && dec->input_segment.flags & GST_SEGMENT_FLAG_TRICKMODE_NO_AUDIO))
+    max_batch = priv->max_batch_frames;
+
   while (ret == GST_FLOW_OK) {
 
     flush = 0;
@@ -1706,8 +1908,10 @@ gst_audio_decoder_push_buffers (GstAudioDecoder * dec, gboolean force)
           flush = offset;
           /* avoid parsing indefinitely */
           priv->sync_flush += offset;
-          if (priv->sync_flush > GST_AUDIO_DECODER_MAX_SYNC)
+          if (priv->sync_flush > GST_AUDIO_DECODER_MAX_SYNC) {
+            gst_clear_buffer_list (&priv->batch);
             goto parse_failed;
+          }
         }
 
         if (ret == GST_FLOW_EOS) {
@@ -1750,7 +1954,27 @@ gst_audio_decoder_push_buffers (GstAudioDecoder * dec, gboolean force)
       priv->force = TRUE;
     }
 
-    ret = gst_audio_decoder_handle_frame (dec, klass, buffer);
+    if (buffer && max_batch > 1) {
+      if (!priv->batch) {
+        priv->batch = gst_buffer_list_new_sized (max_batch);
+        priv->batch_dur = 0;
+      }
+      if (GST_CLOCK_TIME_IS_VALID (priv->batch_dur) &&
+          GST_BUFFER_DURATION_IS_VALID (buffer))
+        priv->batch_dur += GST_BUFFER_DURATION (buffer);
+      else
+        priv->batch_dur = GST_CLOCK_TIME_NONE;
+      gst_buffer_list_add (priv->batch, buffer);
+      if (gst_buffer_list_length (priv->batch) >= max_batch)
+        ret = gst_audio_decoder_push_batch (dec);
+    } else {
+      /* preserve order with respect to draining */
+      ret = gst_audio_decoder_push_batch (dec);
+      if (ret == GST_FLOW_OK)
+        ret = gst_audio_decoder_handle_frame (dec, klass, buffer);
+      else if (buffer)
+        gst_buffer_unref (buffer);
+    }
 
     /* do not keep pushing it ... */
     if (G_UNLIKELY (!av)) {
@@ -1762,6 +1986,15 @@ gst_audio_decoder_push_buffers (GstAudioDecoder * dec, gboolean force)
     g_assert (av >= 0);
   }
 
+  /* hand over what was collected so far, unless something failed or it can
+   * wait for the frames of the next input buffers */
+  if (priv->batch) {
+    if (ret != GST_FLOW_OK)
+      gst_clear_buffer_list (&priv->batch);
+    else if (force || !gst_audio_decoder_hold_batch (dec))
+      ret = gst_audio_decoder_push_batch (dec);
+  }
+
   GST_LOG_OBJECT (dec, "done pushing to subclass");
   return ret;
 
@@ -2292,6 +2525,8 @@ gst_audio_decoder_handle_gap (GstAudioDecoder * dec, GstEvent * event)
       gst_pad_mark_reconfigure (dec->srcpad);
     }
   }
+  /* frames before the gap come first */
+  gst_audio_decoder_push_batch (dec);
   GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
 
   gst_event_parse_gap (event, &timestamp, &duration);
@@ -2382,6 +2617,8 @@ gst_audio_decoder_sink_eventfunc (GstAudioDecoder * dec, GstEvent * event)
       GstFormat format;
 
       GST_AUDIO_DECODER_STREAM_LOCK (dec);
+      /* frames held back belong to the previous segment */
+      gst_audio_decoder_push_batch (dec);
       gst_event_copy_segment (event, &seg);
 
       format = seg.format;
@@ -3155,6 +3392,10 @@ gst_audio_decoder_get_property (GObject * object, guint prop_id,
     case PROP_MAX_ERRORS:
       g_value_set_int (value, gst_audio_decoder_get_max_errors (dec));
       break;
+    case PROP_OUTPUT_BUFFER_LIST:
+      g_value_set_boolean (value,
+          gst_audio_decoder_get_output_buffer_list (dec));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3182,6 +3423,10 @@ gst_audio_decoder_set_property (GObject * object, guint prop_id,
     case PROP_MAX_ERRORS:
       gst_audio_decoder_set_max_errors (dec, g_value_get_int (value));
       break;
+    case PROP_OUTPUT_BUFFER_LIST:
+      gst_audio_decoder_set_output_buffer_list (dec,
+          g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3738,6 +3983,116 @@ gst_audio_decoder_get_needs_format (GstAudioDecoder * dec)
   return result;
 }
 
+/**
+ * gst_audio_decoder_set_max_batch_frames:
+ * @dec: a #GstAudioDecoder
+ * @frames: maximum number of frames per batch
+ *
+ * Configures the maximum number of parsed input frames base class collects
+ * before handing them to #GstAudioDecoderClass.handle_frame_list() in one
+ * call.  A value of 1 (the default) disables batching, in which case every
+ * frame is provided to #GstAudioDecoderClass.handle_frame().  Has no effect
+ * if subclass does not implement #GstAudioDecoderClass.handle_frame_list().
+ *
+ * Frames are collected across input buffers, so packetized input with one
+ * frame per buffer is batched as well.  In non-live pipelines, a batch waits
+ * for further input as long as it covers less than
+ * #GstAudioDecoder:min-latency; otherwise, and whenever base class drains
+ * (e.g. on EOS, DISCONT or a new segment), it is handed over right away, so
+ * subclass may be given fewer frames than configured.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+void
+gst_audio_decoder_set_max_batch_frames (GstAudioDecoder * dec, guint frames)
+{
+  g_return_if_fail (GST_IS_AUDIO_DECODER (dec));
+  g_return_if_fail (frames > 0);
+
+  GST_OBJECT_LOCK (dec);
+  dec->priv->max_batch_frames = frames;
+  GST_OBJECT_UNLOCK (dec);
+}
+
+/**
+ * gst_audio_decoder_get_max_batch_frames:
+ * @dec: a #GstAudioDecoder
+ *
+ * Queries the maximum number of frames handed to subclass at once.
+ *
+ * Returns: the configured batch size.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+guint
+gst_audio_decoder_get_max_batch_frames (GstAudioDecoder * dec)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_AUDIO_DECODER (dec), 1);
+
+  GST_OBJECT_LOCK (dec);
+  result = dec->priv->max_batch_frames;
+  GST_OBJECT_UNLOCK (dec);
+
+  return result;
+}
+
+/**
+ * gst_audio_decoder_set_output_buffer_list:
+ * @dec: a #GstAudioDecoder
+ * @enabled: new state
+ *
+ * Configures how output is aggregated up to #GstAudioDecoder:min-latency.
+ * If enabled, decoded buffers are collected into a #GstBufferList that is
+ * pushed downstream at once, instead of being copied into a single merged
+ * buffer.  This also allows aggregation of non-interleaved output.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+void
+gst_audio_decoder_set_output_buffer_list (GstAudioDecoder * dec,
+    gboolean enabled)
+{
+  g_return_if_fail (GST_IS_AUDIO_DECODER (dec));
+
+  GST_OBJECT_LOCK (dec);
+  dec->priv->output_buffer_list = enabled;
+  GST_OBJECT_UNLOCK (dec);
+}
+
+/**
+ * gst_audio_decoder_get_output_buffer_list:
+ * @dec: a #GstAudioDecoder
+ *
+ * Queries whether output is aggregated into buffer lists.
+ *
+ * Returns: TRUE if output is aggregated into buffer lists.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+gboolean
+gst_audio_decoder_get_output_buffer_list (GstAudioDecoder * dec)
+{
+  gboolean result;
+
+  g_return_val_if_fail (GST_IS_AUDIO_DECODER (dec), FALSE);
+
+  GST_OBJECT_LOCK (dec);
+  result = dec->priv->output_buffer_list;
+  GST_OBJECT_UNLOCK (dec);
+
+  return result;
+}
+
 /**
  * gst_audio_decoder_merge_tags:
  * @dec: a #GstAudioDecoder
@@ -253,6 +253,17 @@ struct _GstAudioDecoder
  *                  tags and meta with only the "audio" tag. subclasses can
  *                  implement this method and return %TRUE if the metadata is to be
  *                  copied. Since: 1.6
+ * @handle_frame_list: Optional.
+ *                  Provides a batch of up to
+ *                  gst_audio_decoder_get_max_batch_frames() parsed input
+ *                  frames to subclass in one call, in stream order.
+ *                  As with @handle_frame, input data ref management is
+ *                  performed by base class.  Subclass decodes the frames and
+ *                  passes the output to gst_audio_decoder_finish_frame(),
+ *                  possibly merged into a single buffer covering several
+ *                  frames.  Only used if the batch size has been configured
+ *                  larger than 1; draining (NULL data) and concealment still
+ *                  go through @handle_frame. Since: 1.26
  *
  * Subclasses can override any of the available virtual methods or not, as
  * needed. At minimum @handle_frame (and likely @set_format) needs to be
@@ -315,8 +326,11 @@ struct _GstAudioDecoderClass
   gboolean      (*transform_meta)     (GstAudioDecoder *enc, GstBuffer *outbuf,
                                        GstMeta *meta, GstBuffer *inbuf);
 
+  GstFlowReturn (*handle_frame_list)  (GstAudioDecoder *dec,
+                                       GstBufferList *frames);
+
   /*< private >*/
-  gpointer       _gst_reserved[GST_PADDING_LARGE - 4];
+  gpointer       _gst_reserved[GST_PADDING_LARGE - 5];
 };
 
 GST_AUDIO_API
@@ -434,6 +448,20 @@ void              gst_audio_decoder_set_needs_format (GstAudioDecoder * dec,
 GST_AUDIO_API
 gboolean          gst_audio_decoder_get_needs_format (GstAudioDecoder * dec);
 
+GST_AUDIO_API
+void              gst_audio_decoder_set_max_batch_frames (GstAudioDecoder * dec,
+                                                          guint frames);
+
+GST_AUDIO_API
+guint             gst_audio_decoder_get_max_batch_frames (GstAudioDecoder * dec);
+
+GST_AUDIO_API
+void              gst_audio_decoder_set_output_buffer_list (GstAudioDecoder * dec,
+                                                            gboolean enabled);
+
+GST_AUDIO_API
+gboolean          gst_audio_decoder_get_output_buffer_list (GstAudioDecoder * dec);
+
 GST_AUDIO_API
 void              gst_audio_decoder_get_allocator (GstAudioDecoder * dec,
                                                    GstAllocator ** allocator,
@@ -39,9 +39,16 @@
 
 #include <string.h>
 
+#ifdef HAVE_MEMFD_CREATE
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <gst/audio/audio.h>
 #include <gst/audio/gstdsd.h>
 #include "gstaudioringbuffer.h"
+#include "gstaudioutilsprivate.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_audio_ring_buffer_debug);
 #define GST_CAT_DEFAULT gst_audio_ring_buffer_debug
@@ -162,6 +169,15 @@ struct _GstAudioRingBufferPrivate
   /* ATOMIC */
   guint64 segdone;
   guint64 segbase;
+
+  /* single producer/single consumer mode, writepos is the ATOMIC absolute
+   * byte position up to which the writer has produced data */
+  gboolean spsc;
+  guint64 writepos;
+
+  /* memory shared through a file descriptor */
+  gboolean shared;
+  gint memory_fd;
 };
 
 static void gst_audio_ring_buffer_dispose (GObject * object);
@@ -210,6 +226,10 @@ gst_audio_ring_buffer_init (GstAudioRingBuffer * ringbuffer)
   ringbuffer->segdone = 0;
   ringbuffer->priv->segbase = 0;
   ringbuffer->priv->segdone = 0;
+  ringbuffer->priv->spsc = FALSE;
+  ringbuffer->priv->writepos = 0;
+  ringbuffer->priv->shared = FALSE;
+  ringbuffer->priv->memory_fd = -1;
 }
 
 static void
@@ -938,6 +958,7 @@ gst_audio_ring_buffer_release (GstAudioRingBuffer * buf)
   g_atomic_int_set (&buf->segdone, 0);
   buf->priv->segbase = 0;
   buf->segbase = 0;
+  gst_atomic_uint64_set (&buf->priv->writepos, 0);
   g_free (buf->empty_seg);
   buf->empty_seg = NULL;
   gst_caps_replace (&buf->spec.caps, NULL);
@@ -1519,6 +1540,10 @@ gst_audio_ring_buffer_set_sample (GstAudioRingBuffer * buf, guint64 sample)
   buf->priv->segbase = segdone - sample / buf->samples_per_seg;
   buf->segbase = buf->priv->segbase;
 
+  /* everything that was queued is discarded */
+  if (buf->priv->spsc)
+    gst_atomic_uint64_set (&buf->priv->writepos, segdone * buf->spec.segsize);
+
   gst_audio_ring_buffer_clear_all (buf);
 
   GST_DEBUG_OBJECT (buf,
@@ -1580,6 +1605,187 @@ gst_audio_ring_buffer_get_segbase (GstAudioRingBuffer * buf)
   return gst_atomic_uint64_get (&buf->priv->segbase);
 }
 
+/**
+ * gst_audio_ring_buffer_set_spsc:
+ * @buf: the #GstAudioRingBuffer
+ * @spsc: the new value
+ *
+ * Put @buf in single producer/single consumer mode. Next to the segments
+ * processed by the device, the writer then keeps an atomic write pointer
+ * so that the reader knows which data is valid without any locking.
+ *
+ * Segments that were not written are played straight from a segment of
+ * silence, which avoids clearing every segment after it was processed,
+ * and samples can be produced in place with
+ * gst_audio_ring_buffer_prepare_write().
+ *
+ * This is only useful for playback with a single thread writing to @buf and
+ * can only be changed when the ringbuffer is not acquired.
+ *
+ * Since: 1.26
+ */
+void
+gst_audio_ring_buffer_set_spsc (GstAudioRingBuffer * buf, gboolean spsc)
+{
+  g_return_if_fail (GST_IS_AUDIO_RING_BUFFER (buf));
+
+  GST_OBJECT_LOCK (buf);
+  if (G_UNLIKELY (buf->acquired))
+    goto was_acquired;
+
+  GST_DEBUG_OBJECT (buf, "single producer/single consumer mode: %d", spsc);
+  buf->priv->spsc = spsc;
+  gst_atomic_uint64_set (&buf->priv->writepos, 0);
+  GST_OBJECT_UNLOCK (buf);
+
+  return;
+
+  /* ERRORS */
+was_acquired:
+  {
+    GST_OBJECT_UNLOCK (buf);
+    GST_WARNING_OBJECT (buf, "can't change mode of an acquired ringbuffer");
+    return;
+  }
+}
+
+/**
+ * gst_audio_ring_buffer_is_spsc:
+ * @buf: the #GstAudioRingBuffer
+ *
+ * Check if @buf is in single producer/single consumer mode.
+ *
+ * Returns: TRUE if @buf is in single producer/single consumer mode.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+gboolean
+gst_audio_ring_buffer_is_spsc (GstAudioRingBuffer * buf)
+{
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), FALSE);
+
+  return buf->priv->spsc;
+}
+
+/**
+ * gst_audio_ring_buffer_set_shared:
+ * @buf: the #GstAudioRingBuffer
+ * @shared: the new value
+ *
+ * Allocate the memory of @buf so that it can be mapped by other processes
+ * through the file descriptor returned by
+ * gst_audio_ring_buffer_get_memory_fd(), e.g. for monitoring. Only the
+ * ringbuffers of #GstAudioSink and #GstAudioSrc allocate their memory this
+ * way.
+ *
+ * This can only be changed when the ringbuffer is not acquired.
+ *
+ * Returns: FALSE if shared memory is not supported on this platform or
+ * @buf is acquired.
+ *
+ * Since: 1.26
+ */
+gboolean
+gst_audio_ring_buffer_set_shared (GstAudioRingBuffer * buf, gboolean shared)
+{
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), FALSE);
+
+#ifdef HAVE_MEMFD_CREATE
+  GST_OBJECT_LOCK (buf);
+  if (G_UNLIKELY (buf->acquired)) {
+    GST_OBJECT_UNLOCK (buf);
+    GST_WARNING_OBJECT (buf, "can't change memory of an acquired ringbuffer");
+    return FALSE;
+  }
+  buf->priv->shared = shared;
+  GST_OBJECT_UNLOCK (buf);
+
+  return TRUE;
+#else
+  return !shared;
+#endif
+}
+
+/**
+ * gst_audio_ring_buffer_get_memory_fd:
+ * @buf: the #GstAudioRingBuffer
+ *
+ * Get the file descriptor of the shared memory of @buf, see
+ * gst_audio_ring_buffer_set_shared(). The file descriptor is owned by @buf
+ * and is only valid while the ringbuffer is acquired. The mapping length is
+ * the size field of @buf.
+ *
+ * Returns: the file descriptor or -1 if the memory is not shared.
+ *
+ * Since: 1.26
+ */
+gint
+gst_audio_ring_buffer_get_memory_fd (GstAudioRingBuffer * buf)
+{
+  gint fd;
+
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), -1);
+
+  GST_OBJECT_LOCK (buf);
+  fd = buf->priv->memory_fd;
+  GST_OBJECT_UNLOCK (buf);
+
+  return fd;
+}
+
+/* called by subclasses from their acquire vfunc, with the LOCK */
+void
+__gst_audio_ring_buffer_alloc_memory (GstAudioRingBuffer * buf, gsize size)
+{
+#ifdef HAVE_MEMFD_CREATE
+  if (buf->priv->shared) {
+    gpointer mem = MAP_FAILED;
+    gint fd;
+
+    fd = memfd_create ("gst-audio-ringbuffer", MFD_CLOEXEC);
+    if (fd >= 0 && ftruncate (fd, size) == 0)
+      mem = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (mem != MAP_FAILED) {
+      GST_DEBUG_OBJECT (buf, "allocated %" G_GSIZE_FORMAT
+          " bytes of shared memory, fd %d", size, fd);
+      buf->priv->memory_fd = fd;
+      buf->memory = mem;
+      buf->size = size;
+      return;
+    }
+
+    GST_WARNING_OBJECT (buf, "could not allocate shared memory: %s",
+        g_strerror (errno));
+    if (fd >= 0)
+      close (fd);
+  }
+#endif
+
+  buf->memory = g_malloc (size);
+  buf->size = size;
+}
+
+/* called by subclasses from their release vfunc, with the LOCK */
+void
+__gst_audio_ring_buffer_free_memory (GstAudioRingBuffer * buf)
+{
+#ifdef HAVE_MEMFD_CREATE
+  if (buf->priv->memory_fd >= 0) {
+    munmap (buf->memory, buf->size);
+    close (buf->priv->memory_fd);
+    buf->priv->memory_fd = -1;
+    buf->memory = NULL;
+    return;
+  }
+#endif
+
+  g_free (buf->memory);
+  buf->memory = NULL;
+}
+
 /**
  * default_clear_all:
  * @buf: the #GstAudioRingBuffer to clear
@@ -1697,6 +1903,54 @@ no_start:
 
 
 
+/* the absolute byte position of the segment the reader is processing */
+static inline guint64
+spsc_read_position (GstAudioRingBuffer * buf)
+{
+  return gst_atomic_uint64_get (&buf->priv->segdone) * buf->spec.segsize;
+}
+
+/* In single producer/single consumer mode segments are not cleared after
+ * they are played. When the writer skips ahead, fill everything between the
+ * last written byte and @pos with silence so that the reader never plays
+ * data left from a previous pass. Only called from the writer. */
+static void
+spsc_fill_gap (GstAudioRingBuffer * buf, guint64 pos)
+{
+  guint64 start, readpos, size;
+  gint segsize;
+
+  segsize = buf->spec.segsize;
+  size = (guint64) segsize * buf->spec.segtotal;
+
+  start = gst_atomic_uint64_get (&buf->priv->writepos);
+  readpos = spsc_read_position (buf);
+  if (start < readpos)
+    start = readpos;
+  if (G_LIKELY (pos <= start))
+    return;
+  if (pos - start > size)
+    start = pos - size;
+
+  GST_LOG_OBJECT (buf, "silence from %" G_GUINT64_FORMAT " to %"
+      G_GUINT64_FORMAT, start, pos);
+
+  while (start < pos) {
+    guint off = start % segsize;
+    guint len = MIN (segsize - off, pos - start);
+
+    memcpy (buf->memory + (start % size), buf->empty_seg + off, len);
+    start += len;
+  }
+}
+
+static inline void
+spsc_publish (GstAudioRingBuffer * buf, guint64 pos)
+{
+  if (pos > gst_atomic_uint64_get (&buf->priv->writepos))
+    gst_atomic_uint64_set (&buf->priv->writepos, pos);
+}
+
 #define REORDER_SAMPLE(d, s, l)                 \
 G_STMT_START {                                  \
   gint i;                                       \
@@ -1815,11 +2069,13 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
   gint inr, outr;
   gboolean reverse;
   gboolean need_reorder;
+  gboolean spsc;
 
   g_return_val_if_fail (buf->memory != NULL, -1);
   g_return_val_if_fail (data != NULL, -1);
 
   need_reorder = buf->need_reorder;
+  spsc = buf->priv->spsc;
 
   channels = buf->spec.info.channels;
   dest = buf->memory;
@@ -1855,8 +2111,9 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
   while (*toprocess > 0) {
     gint avail;
     guint8 *d, *d_end;
-    gint ws;
+    gint ws, prev_out;
     gboolean skip;
+    guint64 writepos = 0;
 
     while (TRUE) {
       gint64 diff;
@@ -1905,6 +2162,12 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
         "write @%p seg %d, sps %d, off %" G_GUINT64_FORMAT ", avail %d",
         dest + ws * segsize, ws, sps, sampleoff, avail);
 
+    if (spsc && !skip) {
+      writepos = (writeseg + buf->priv->segbase) * segsize + sampleoff;
+      spsc_fill_gap (buf, writepos);
+    }
+    prev_out = out_samples;
+
     if (need_reorder) {
       gint *reorder_map = buf->channel_reorder_map;
 
@@ -1947,6 +2210,10 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
       }
     }
 
+    /* make the written samples visible to the reader */
+    if (spsc && !skip)
+      spsc_publish (buf, writepos + (guint64) (prev_out - out_samples) * bpf);
+
     /* for the next iteration we write to the next segment at the beginning. */
     writeseg++;
     sampleoff = 0;
@@ -2170,6 +2437,10 @@ not_started:
  * Returns a pointer to memory where the data from segment @segment
  * can be found. This function is mostly used by subclasses.
  *
+ * In single producer/single consumer mode @readptr can point to a shared
+ * segment of silence when nothing was written to @segment and must not be
+ * written to, see gst_audio_ring_buffer_set_spsc().
+ *
  * Returns: FALSE if the buffer is not started.
  *
  * MT safe.
@@ -2209,12 +2480,118 @@ gst_audio_ring_buffer_prepare_read (GstAudioRingBuffer * buf, gint * segment,
 
   /* callback to fill the memory with data, for pull based
    * scheduling. */
-  if (buf->callback)
+  if (buf->callback) {
     buf->callback (buf, *readptr, *len, buf->cb_data);
+  } else if (buf->priv->spsc) {
+    guint64 start = segdone * *len;
+    guint64 writepos = gst_atomic_uint64_get (&buf->priv->writepos);
+
+    if (writepos <= start) {
+      /* nothing written, play silence without touching the ringbuffer */
+      GST_LOG_OBJECT (buf, "segment %d not written", *segment);
+      *readptr = buf->empty_seg;
+    } else if (writepos < start + *len) {
+      guint off = writepos - start;
+
+      /* partially written, complete it with silence */
+      GST_LOG_OBJECT (buf, "segment %d written up to %u", *segment, off);
+      memcpy (*readptr + off, buf->empty_seg + off, *len - off);
+    }
+  }
 
   return TRUE;
 }
 
+/**
+ * gst_audio_ring_buffer_prepare_write:
+ * @buf: the #GstAudioRingBuffer to write to
+ * @segment: (out): the segment to write
+ * @writeptr: (out) (array length=len):
+ *     the pointer to the memory where samples can be written
+ * @len: (out): the number of bytes that can be written
+ *
+ * Returns a pointer to the memory in segment @segment where the next samples
+ * should be written, so that they can be produced in place instead of being
+ * copied with gst_audio_ring_buffer_commit(). After writing,
+ * gst_audio_ring_buffer_advance_write() makes them available to the reader.
+ *
+ * This function never blocks and is only available in single
+ * producer/single consumer mode, see gst_audio_ring_buffer_set_spsc().
+ *
+ * Returns: FALSE if @buf is not in single producer/single consumer mode or
+ * when the ringbuffer is full.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+gboolean
+gst_audio_ring_buffer_prepare_write (GstAudioRingBuffer * buf, gint * segment,
+    guint8 ** writeptr, gint * len)
+{
+  guint64 writepos, readpos;
+  gint segsize, segtotal;
+  guint off;
+
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), FALSE);
+  g_return_val_if_fail (segment != NULL, FALSE);
+  g_return_val_if_fail (writeptr != NULL, FALSE);
+  g_return_val_if_fail (len != NULL, FALSE);
+
+  if (G_UNLIKELY (!buf->priv->spsc || buf->memory == NULL))
+    return FALSE;
+
+  segsize = buf->spec.segsize;
+  segtotal = buf->spec.segtotal;
+
+  readpos = spsc_read_position (buf);
+  writepos = gst_atomic_uint64_get (&buf->priv->writepos);
+
+  /* the reader overtook us, continue at the segment it is processing */
+  if (G_UNLIKELY (writepos < readpos)) {
+    GST_DEBUG_OBJECT (buf, "writer too slow, skipping %" G_GUINT64_FORMAT
+        " bytes", readpos - writepos);
+    writepos = readpos;
+    gst_atomic_uint64_set (&buf->priv->writepos, writepos);
+  }
+
+  if (writepos - readpos >= (guint64) segsize * segtotal)
+    return FALSE;
+
+  *segment = (writepos / segsize) % segtotal;
+  off = writepos % segsize;
+  *writeptr = buf->memory + *segment * segsize + off;
+  *len = segsize - off;
+
+  GST_LOG_OBJECT (buf, "prepare write to segment %d, offset %u @%p",
+      *segment, off, *writeptr);
+
+  return TRUE;
+}
+
+/**
+ * gst_audio_ring_buffer_advance_write:
+ * @buf: the #GstAudioRingBuffer to advance
+ * @len: the number of bytes written
+ *
+ * Notify the reader of @buf that @len bytes were written to the memory
+ * returned by gst_audio_ring_buffer_prepare_write(). @len must not be
+ * larger than the length returned there.
+ *
+ * MT safe.
+ *
+ * Since: 1.26
+ */
+void
+gst_audio_ring_buffer_advance_write (GstAudioRingBuffer * buf, guint len)
+{
+  g_return_if_fail (GST_IS_AUDIO_RING_BUFFER (buf));
+  g_return_if_fail (buf->priv->spsc);
+
+  /* there is only one writer, the reader only ever loads the position */
+  gst_atomic_uint64_add (&buf->priv->writepos, len);
+}
+
 /**
  * gst_audio_ring_buffer_advance:
  * @buf: the #GstAudioRingBuffer to advance
@@ -420,9 +420,13 @@ void            gst_audio_ring_buffer_set_timestamp   (GstAudioRingBuffer * buf,
                                                        timestamp);
 
 /* mostly protected */
-/* not yet implemented
-gboolean        gst_audio_ring_buffer_prepare_write   (GstAudioRingBuffer *buf, gint *segment, guint8 **writeptr, gint *len);
-*/
+
+GST_AUDIO_API
+gboolean        gst_audio_ring_buffer_prepare_write   (GstAudioRingBuffer *buf, gint *segment,
+                                                       guint8 **writeptr, gint *len);
+
+GST_AUDIO_API
+void            gst_audio_ring_buffer_advance_write   (GstAudioRingBuffer *buf, guint len);
 
 GST_AUDIO_API
 gboolean        gst_audio_ring_buffer_prepare_read    (GstAudioRingBuffer *buf, gint *segment,
@@ -446,6 +450,22 @@ guint64         gst_audio_ring_buffer_get_segdone     (GstAudioRingBuffer *buf);
 GST_AUDIO_API
 guint64         gst_audio_ring_buffer_get_segbase     (GstAudioRingBuffer *buf);
 
+/* single producer/single consumer mode */
+
+GST_AUDIO_API
+void            gst_audio_ring_buffer_set_spsc        (GstAudioRingBuffer *buf, gboolean spsc);
+
+GST_AUDIO_API
+gboolean        gst_audio_ring_buffer_is_spsc         (GstAudioRingBuffer *buf);
+
+/* shared memory */
+
+GST_AUDIO_API
+gboolean        gst_audio_ring_buffer_set_shared      (GstAudioRingBuffer *buf, gboolean shared);
+
+GST_AUDIO_API
+gint            gst_audio_ring_buffer_get_memory_fd   (GstAudioRingBuffer *buf);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstAudioRingBuffer, gst_object_unref)
 
 G_END_DECLS
@@ -263,8 +263,11 @@ audioringbuffer_thread_func (GstAudioRingBuffer * buf)
         readptr += written;
       } while (left > 0);
 
-      /* clear written samples */
-      gst_audio_ring_buffer_clear (buf, readseg);
+      /* clear written samples, not needed in single producer/single
+       * consumer mode where segments that are not written again are
+       * played as silence */
+      if (!gst_audio_ring_buffer_is_spsc (buf))
+        gst_audio_ring_buffer_clear (buf, readseg);
 
       /* we wrote one segment */
       gst_audio_ring_buffer_advance (buf, 1);
@@ -413,9 +416,7 @@ gst_audio_sink_ring_buffer_acquire (GstAudioRingBuffer * buf,
   /* set latency to one more segment as we need some headroom */
   spec->seglatency = spec->segtotal + 1;
 
-  buf->size = spec->segtotal * spec->segsize;
-
-  buf->memory = g_malloc (buf->size);
+  __gst_audio_ring_buffer_alloc_memory (buf, spec->segtotal * spec->segsize);
 
   switch (buf->spec.type) {
     case GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW:
@@ -505,8 +506,7 @@ gst_audio_sink_ring_buffer_release (GstAudioRingBuffer * buf)
   csink = GST_AUDIO_SINK_GET_CLASS (sink);
 
   /* free the buffer */
-  g_free (buf->memory);
-  buf->memory = NULL;
+  __gst_audio_ring_buffer_free_memory (buf);
 
   if (csink->unprepare)
     result = csink->unprepare (sink);
@@ -381,8 +381,7 @@ gst_audio_src_ring_buffer_acquire (GstAudioRingBuffer * buf,
   if (!result)
     goto could_not_open;
 
-  buf->size = spec->segtotal * spec->segsize;
-  buf->memory = g_malloc (buf->size);
+  __gst_audio_ring_buffer_alloc_memory (buf, spec->segtotal * spec->segsize);
   if (buf->spec.type == GST_AUDIO_RING_BUFFER_FORMAT_TYPE_RAW) {
     gst_audio_format_info_fill_silence (buf->spec.info.finfo, buf->memory,
         buf->size);
@@ -431,8 +430,7 @@ gst_audio_src_ring_buffer_release (GstAudioRingBuffer * buf)
   GST_OBJECT_LOCK (buf);
 
   /* free the buffer */
-  g_free (buf->memory);
-  buf->memory = NULL;
+  __gst_audio_ring_buffer_free_memory (buf);
 
   if (csrc->unprepare)
     result = csrc->unprepare (src);
@@ -48,6 +48,13 @@ gboolean __gst_audio_set_thread_priority   (gpointer * handle);
 G_GNUC_INTERNAL
 gboolean __gst_audio_restore_thread_priority (gpointer handle);
 
+/* Ringbuffer memory allocation */
+G_GNUC_INTERNAL
+void     __gst_audio_ring_buffer_alloc_memory (GstAudioRingBuffer * buf, gsize size);
+
+G_GNUC_INTERNAL
+void     __gst_audio_ring_buffer_free_memory  (GstAudioRingBuffer * buf);
+
 G_END_DECLS
 
 #endif
@@ -1309,21 +1309,102 @@ gst_rtp_base_depayload_get_extensions (GstRTPBaseDepayload * depayload,
   GST_OBJECT_UNLOCK (depayload);
 }
 
+/* one-byte headers can't carry more than 14 extensions, anything past this
+ * with two-byte headers is most likely garbage */
+#define MAX_HEADER_EXT_SLICES 64
+
+typedef struct
+{
+  guint8 id;
+  guint8 len;
+  guint offset;
+} HeaderExtSlice;
+
+/* Walks the extension block of a packet once and records where the data of
+ * each extension is. Returns the number of slices found */
+static guint
+index_rtp_header_extensions (GstRTPBaseDepayload * depayload,
+    const guint8 * pdata, gsize bytelen, guint hdr_unit_bytes,
+    HeaderExtSlice * slices)
+{
+  gsize offset = 0;
+  guint n_slices = 0;
+
+  while (n_slices < MAX_HEADER_EXT_SLICES) {
+    guint8 read_id, read_len;
+
+    if (offset + hdr_unit_bytes >= bytelen)
+      /* not enough remaning data */
+      break;
+
+    if (hdr_unit_bytes == 1) {
+      read_id = GST_READ_UINT8 (pdata + offset) >> 4;
+      read_len = (GST_READ_UINT8 (pdata + offset) & 0x0F) + 1;
+      offset += 1;
+
+      if (read_id == 0)
+        /* padding */
+        continue;
+
+      if (read_id == 15)
+        /* special id for possible future expansion */
+        break;
+    } else {
+      read_id = GST_READ_UINT8 (pdata + offset);
+      offset += 1;
+
+      if (read_id == 0)
+        /* padding */
+        continue;
+
+      read_len = GST_READ_UINT8 (pdata + offset);
+      offset += 1;
+    }
+    GST_TRACE_OBJECT (depayload, "found rtp header extension with id %u and "
+        "length %u", read_id, read_len);
+
+    /* Ignore extension headers where the size does not fit */
+    if (offset + read_len > bytelen) {
+      GST_WARNING_OBJECT (depayload, "Extension length extends past the "
+          "size of the extension data");
+      break;
+    }
+
+    slices[n_slices].id = read_id;
+    slices[n_slices].len = read_len;
+    slices[n_slices].offset = offset;
+    n_slices++;
+
+    offset += read_len;
+  }
+
+  return n_slices;
+}
+
 static gboolean
 read_rtp_header_extensions (GstRTPBaseDepayload * depayload,
     GstBuffer * input, GstBuffer * output)
 {
+  GstRTPBaseDepayloadPrivate *priv = depayload->priv;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
   guint16 bit_pattern;
   guint8 *pdata;
   guint wordlen;
   gboolean needs_src_caps_update = FALSE;
+  gboolean have_exts;
 
   if (!input) {
     GST_DEBUG_OBJECT (depayload, "no input buffer");
     return needs_src_caps_update;
   }
 
+  /* nothing to hand the extension data to */
+  GST_OBJECT_LOCK (depayload);
+  have_exts = priv->header_exts->len > 0;
+  GST_OBJECT_UNLOCK (depayload);
+  if (!have_exts)
+    return needs_src_caps_update;
+
   if (!gst_rtp_buffer_map (input, GST_MAP_READ, &rtp)) {
     GST_WARNING_OBJECT (depayload, "Failed to map buffer");
     return needs_src_caps_update;
@@ -1332,9 +1413,9 @@ read_rtp_header_extensions (GstRTPBaseDepayload * depayload,
   if (gst_rtp_buffer_get_extension_data (&rtp, &bit_pattern, (gpointer) & pdata,
           &wordlen)) {
     GstRTPHeaderExtensionFlags ext_flags = 0;
-    gsize bytelen = wordlen * 4;
+    HeaderExtSlice slices[MAX_HEADER_EXT_SLICES];
     guint hdr_unit_bytes;
-    gsize offset = 0;
+    guint i, j, n_slices;
 
     if (bit_pattern == 0xBEDE) {
       /* one byte extensions */
@@ -1350,77 +1431,37 @@ read_rtp_header_extensions (GstRTPBaseDepayload * depayload,
       goto out;
     }
 
-    while (TRUE) {
-      guint8 read_id, read_len;
-      GstRTPHeaderExtension *ext = NULL;
-      guint i;
-
-      if (offset + hdr_unit_bytes >= bytelen)
-        /* not enough remaning data */
-        break;
-
-      if (ext_flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
-        read_id = GST_READ_UINT8 (pdata + offset) >> 4;
-        read_len = (GST_READ_UINT8 (pdata + offset) & 0x0F) + 1;
-        offset += 1;
-
-        if (read_id == 0)
-          /* padding */
-          continue;
-
-        if (read_id == 15)
-          /* special id for possible future expansion */
-          break;
-      } else {
-        read_id = GST_READ_UINT8 (pdata + offset);
-        offset += 1;
-
-        if (read_id == 0)
-          /* padding */
-          continue;
+    n_slices = index_rtp_header_extensions (depayload, pdata, wordlen * 4,
+        hdr_unit_bytes, slices);
 
-        read_len = GST_READ_UINT8 (pdata + offset);
-        offset += 1;
-      }
-      GST_TRACE_OBJECT (depayload, "found rtp header extension with id %u and "
-          "length %u", read_id, read_len);
-
-      /* Ignore extension headers where the size does not fit */
-      if (offset + read_len > bytelen) {
-        GST_WARNING_OBJECT (depayload, "Extension length extends past the "
-            "size of the extension data");
-        break;
-      }
+    /* hand every extension its data, the extensions are kept alive by
+     * header_exts while we hold the lock */
+    GST_OBJECT_LOCK (depayload);
+    for (i = 0; i < n_slices; i++) {
+      GstRTPHeaderExtension *ext = NULL;
 
-      GST_OBJECT_LOCK (depayload);
-      for (i = 0; i < depayload->priv->header_exts->len; i++) {
-        ext = g_ptr_array_index (depayload->priv->header_exts, i);
-        if (read_id == gst_rtp_header_extension_get_id (ext)) {
-          gst_object_ref (ext);
+      for (j = 0; j < priv->header_exts->len; j++) {
+        ext = g_ptr_array_index (priv->header_exts, j);
+        if (slices[i].id == gst_rtp_header_extension_get_id (ext))
           break;
-        }
         ext = NULL;
       }
 
-      if (ext) {
-        if (!gst_rtp_header_extension_read (ext, ext_flags, &pdata[offset],
-                read_len, output)) {
-          GST_WARNING_OBJECT (depayload, "RTP header extension (%s) could "
-              "not read payloaded data", GST_OBJECT_NAME (ext));
-          gst_object_unref (ext);
-          goto out;
-        }
-
-        if (gst_rtp_header_extension_wants_update_non_rtp_src_caps (ext)) {
-          needs_src_caps_update = TRUE;
-        }
+      if (!ext)
+        continue;
 
-        gst_object_unref (ext);
+      if (!gst_rtp_header_extension_read (ext, ext_flags,
+              &pdata[slices[i].offset], slices[i].len, output)) {
+        GST_WARNING_OBJECT (depayload, "RTP header extension (%s) could "
+            "not read payloaded data", GST_OBJECT_NAME (ext));
+        break;
       }
-      GST_OBJECT_UNLOCK (depayload);
 
-      offset += read_len;
+      if (gst_rtp_header_extension_wants_update_non_rtp_src_caps (ext)) {
+        needs_src_caps_update = TRUE;
+      }
     }
+    GST_OBJECT_UNLOCK (depayload);
   }
 
 out:
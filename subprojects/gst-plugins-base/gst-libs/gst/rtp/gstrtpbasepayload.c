@@ -78,6 +78,10 @@ struct _GstRTPBasePayloadPrivate
 
   /* array of GstRTPHeaderExtension's * */
   GPtrArray *header_exts;
+
+  /* extensions are written here before being copied into the packet */
+  guint8 *hdrext_scratch;
+  gsize hdrext_scratch_size;
 };
 
 /* RTPBasePayload signals and args */
@@ -616,6 +620,8 @@ gst_rtp_base_payload_finalize (GObject * object)
 
   g_ptr_array_unref (rtpbasepayload->priv->header_exts);
   rtpbasepayload->priv->header_exts = NULL;
+  g_free (rtpbasepayload->priv->hdrext_scratch);
+  rtpbasepayload->priv->hdrext_scratch = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -1587,6 +1593,18 @@ gst_rtp_base_payload_is_filled (GstRTPBasePayload * payload,
   return FALSE;
 }
 
+typedef struct
+{
+  GstRTPBasePayload *payload;
+  GstRTPHeaderExtensionFlags flags;
+  GstBuffer *output;
+  guint8 *data;
+  gsize allocated_size;
+  gsize written_size;
+  gsize hdr_unit_size;
+  gboolean abort;
+} HeaderExt;
+
 typedef struct
 {
   GstRTPBasePayload *payload;
@@ -1597,6 +1615,12 @@ typedef struct
   GstClockTime pts;
   guint64 offset;
   guint32 rtptime;
+
+  /* layout of the header extension block, the same for all packets made
+   * from one input buffer */
+  gboolean write_hdrext;
+  guint16 hdrext_bit_pattern;
+  HeaderExt hdrext;
 } HeaderData;
 
 static gboolean
@@ -1665,18 +1689,6 @@ gst_rtp_base_payload_get_extensions (GstRTPBasePayload * payload,
   GST_OBJECT_UNLOCK (payload);
 }
 
-typedef struct
-{
-  GstRTPBasePayload *payload;
-  GstRTPHeaderExtensionFlags flags;
-  GstBuffer *output;
-  guint8 *data;
-  gsize allocated_size;
-  gsize written_size;
-  gsize hdr_unit_size;
-  gboolean abort;
-} HeaderExt;
-
 static void
 determine_header_extension_flags_size (GstRTPHeaderExtension * ext,
     gpointer user_data)
@@ -1777,11 +1789,62 @@ error:
   return;
 }
 
+/* Works out the header extension block layout once for all the packets made
+ * from the current input buffer, must be called with the object lock */
+static void
+prepare_header_extensions (GstRTPBasePayload * payload, HeaderData * data)
+{
+  GstRTPBasePayloadPrivate *priv = payload->priv;
+  HeaderExt *hdrext = &data->hdrext;
+  gsize extlen;
+
+  memset (hdrext, 0, sizeof (HeaderExt));
+  data->write_hdrext = FALSE;
+
+  if (priv->header_exts->len == 0 || !priv->input_meta_buffer)
+    return;
+
+  hdrext->payload = payload;
+  hdrext->flags =
+      GST_RTP_HEADER_EXTENSION_ONE_BYTE | GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+  g_ptr_array_foreach (priv->header_exts,
+      (GFunc) determine_header_extension_flags_size, hdrext);
+  if (hdrext->flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
+    /* prefer the one byte header */
+    hdrext->hdr_unit_size = 1;
+    /* TODO: support mixed size writing modes, i.e. RFC8285 */
+    hdrext->flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+    data->hdrext_bit_pattern = 0xBEDE;
+  } else if (hdrext->flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
+    hdrext->hdr_unit_size = 2;
+    data->hdrext_bit_pattern = 0x1000;
+  } else {
+    GST_ERROR_OBJECT (payload,
+        "Cannot add rtp header extensions with mixed header types");
+    return;
+  }
+
+  /* room for every extension at its maximum size, in whole 32-bit words */
+  extlen = hdrext->hdr_unit_size * priv->header_exts->len +
+      hdrext->allocated_size;
+  extlen = GST_ROUND_UP_4 (extlen);
+
+  if (priv->hdrext_scratch_size < extlen) {
+    g_free (priv->hdrext_scratch);
+    priv->hdrext_scratch = g_malloc (extlen);
+    priv->hdrext_scratch_size = extlen;
+  }
+  hdrext->data = priv->hdrext_scratch;
+  hdrext->allocated_size = extlen;
+
+  data->write_hdrext = TRUE;
+}
+
+/* must be called with the object lock when writing header extensions */
 static gboolean
 set_headers (GstBuffer ** buffer, guint idx, gpointer user_data)
 {
   HeaderData *data = user_data;
-  HeaderExt hdrext = { NULL, };
   GstRTPBuffer rtp = { NULL, };
 
   if (!gst_rtp_buffer_map (*buffer, GST_MAP_READWRITE, &rtp))
@@ -1792,49 +1855,14 @@ set_headers (GstBuffer ** buffer, guint idx, gpointer user_data)
   gst_rtp_buffer_set_seq (&rtp, data->seqnum);
   gst_rtp_buffer_set_timestamp (&rtp, data->rtptime);
 
-  GST_OBJECT_LOCK (data->payload);
-  if (data->payload->priv->header_exts->len > 0
-      && data->payload->priv->input_meta_buffer) {
+  if (data->write_hdrext) {
+    HeaderExt hdrext = data->hdrext;
+    guint8 *extdata;
     guint wordlen;
-    gsize extlen;
-    guint16 bit_pattern;
 
-    /* write header extensions */
-    hdrext.payload = data->payload;
+    /* write header extensions into the scratch block, the packet only gets
+     * an extension block of the final size */
     hdrext.output = *buffer;
-    /* XXX: pre-calculate these flags and sizes? */
-    hdrext.flags =
-        GST_RTP_HEADER_EXTENSION_ONE_BYTE | GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-    g_ptr_array_foreach (data->payload->priv->header_exts,
-        (GFunc) determine_header_extension_flags_size, &hdrext);
-    hdrext.hdr_unit_size = 0;
-    if (hdrext.flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
-      /* prefer the one byte header */
-      hdrext.hdr_unit_size = 1;
-      /* TODO: support mixed size writing modes, i.e. RFC8285 */
-      hdrext.flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-      bit_pattern = 0xBEDE;
-    } else if (hdrext.flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
-      hdrext.hdr_unit_size = 2;
-      bit_pattern = 0x1000;
-    } else {
-      goto unsupported_flags;
-    }
-
-    extlen =
-        hdrext.hdr_unit_size * data->payload->priv->header_exts->len +
-        hdrext.allocated_size;
-    wordlen = extlen / 4 + ((extlen % 4) ? 1 : 0);
-
-    /* XXX: do we need to add to any existing extension data instead of
-     * overwriting everything? */
-    gst_rtp_buffer_set_extension_data (&rtp, bit_pattern, wordlen);
-    gst_rtp_buffer_get_extension_data (&rtp, NULL, (gpointer) & hdrext.data,
-        &wordlen);
-
-    /* from 32-bit words to bytes */
-    hdrext.allocated_size = wordlen * 4;
-
     g_ptr_array_foreach (data->payload->priv->header_exts,
         (GFunc) write_header_extension, &hdrext);
 
@@ -1845,12 +1873,17 @@ set_headers (GstBuffer ** buffer, guint idx, gpointer user_data)
       memset (&hdrext.data[hdrext.written_size], 0,
           wordlen * 4 - hdrext.written_size);
 
-      gst_rtp_buffer_set_extension_data (&rtp, bit_pattern, wordlen);
+      /* XXX: do we need to add to any existing extension data instead of
+       * overwriting everything? */
+      gst_rtp_buffer_set_extension_data (&rtp, data->hdrext_bit_pattern,
+          wordlen);
+      gst_rtp_buffer_get_extension_data (&rtp, NULL, (gpointer) & extdata,
+          &wordlen);
+      memcpy (extdata, hdrext.data, wordlen * 4);
     } else {
       gst_rtp_buffer_remove_extension_data (&rtp);
     }
   }
-  GST_OBJECT_UNLOCK (data->payload);
   gst_rtp_buffer_unmap (&rtp);
 
   /* increment the seqnum for each buffer */
@@ -1863,14 +1896,6 @@ map_failed:
     GST_ERROR ("failed to map buffer %p", *buffer);
     return FALSE;
   }
-
-unsupported_flags:
-  {
-    GST_OBJECT_UNLOCK (data->payload);
-    gst_rtp_buffer_unmap (&rtp);
-    GST_ERROR ("Cannot add rtp header extensions with mixed header types");
-    return FALSE;
-  }
 }
 
 static gboolean
@@ -1992,16 +2017,25 @@ gst_rtp_base_payload_prepare_push (GstRTPBasePayload * payload,
     data.rtptime = payload->timestamp;
   }
 
-  /* set ssrc, payload type, seq number, caps and rtptime */
-  /* remove unwanted meta */
+  /* set ssrc, payload type, seq number, caps, rtptime and header
+   * extensions */
+  GST_OBJECT_LOCK (payload);
+  prepare_header_extensions (payload, &data);
   if (is_list) {
     gst_buffer_list_foreach (GST_BUFFER_LIST_CAST (obj), set_headers, &data);
+  } else {
+    GstBuffer *buf = GST_BUFFER_CAST (obj);
+    set_headers (&buf, 0, &data);
+  }
+  GST_OBJECT_UNLOCK (payload);
+
+  /* remove unwanted meta */
+  if (is_list) {
     gst_buffer_list_foreach (GST_BUFFER_LIST_CAST (obj), filter_meta, NULL);
     /* sequence number has increased more if this was a buffer list */
     payload->seqnum = data.seqnum - 1;
   } else {
     GstBuffer *buf = GST_BUFFER_CAST (obj);
-    set_headers (&buf, 0, &data);
     filter_meta (&buf, 0, NULL);
   }
 
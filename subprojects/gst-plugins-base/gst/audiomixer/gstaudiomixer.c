@@ -49,6 +49,10 @@
  * * "mute": Whether to mute the pad or not (#gboolean)
  * * "volume": The volume of the pad, between 0.0 and 10.0 (#gdouble)
  *
+ * For mixing many streams, e.g. in a conference bridge, see the
+ * #GstAudioMixer:batch-threshold property and the
+ * #GstAudioAggregator:max-threads property of the base class.
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 audiotestsrc freq=100 ! audiomixer name=mix ! audioconvert ! alsasink audiotestsrc freq=500 ! mix.
@@ -60,9 +64,15 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "gstaudiomixerelements.h"
 #include "gstaudiomixerorc.h"
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 #define DEFAULT_PAD_VOLUME (1.0)
 #define DEFAULT_PAD_MUTE (FALSE)
@@ -162,11 +172,32 @@ gst_audiomixer_pad_init (GstAudioMixerPad * pad)
   pad->mute = DEFAULT_PAD_MUTE;
 }
 
+#define DEFAULT_BATCH_THRESHOLD 0
+
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_BATCH_THRESHOLD
 };
 
+/* One input buffer region collected for mixing in batch mode. Offsets and
+ * sizes are in samples, not frames */
+typedef struct
+{
+  GstBuffer *inbuf;
+  guint in_offset;
+  guint out_offset;
+  guint n_samples;
+  gboolean unity;
+  gdouble volume;
+  gint volume_i16;
+  gint volume_i32;
+} GstAudioMixerBatchInput;
+
+/* Number of samples summed at once in batch mode, the accumulators of one
+ * block stay in the L1 cache while all inputs are added to them */
+#define BATCH_BLOCK 1024
+
 /* These are the formats we can mix natively */
 
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
@@ -212,14 +243,99 @@ static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
     GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
     GstBuffer * outbuf, guint out_offset, guint num_samples);
+static GstFlowReturn gst_audiomixer_finish_buffer (GstAggregator * agg,
+    GstBuffer * buffer);
+static GstFlowReturn gst_audiomixer_flush (GstAggregator * agg);
+static gboolean gst_audiomixer_negotiated_src_caps (GstAggregator * agg,
+    GstCaps * caps);
+static gboolean gst_audiomixer_stop (GstAggregator * agg);
+static GstFlowReturn gst_audiomixer_aggregate (GstAggregator * agg,
+    gboolean timeout);
+
+static void
+gst_audiomixer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_BATCH_THRESHOLD:
+      GST_OBJECT_LOCK (audiomixer);
+      audiomixer->batch_threshold = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_audiomixer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  switch (prop_id) {
+    case PROP_BATCH_THRESHOLD:
+      GST_OBJECT_LOCK (audiomixer);
+      g_value_set_uint (value, audiomixer->batch_threshold);
+      GST_OBJECT_UNLOCK (audiomixer);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_audiomixer_batch_input_clear (GstAudioMixerBatchInput * input)
+{
+  gst_buffer_unref (input->inbuf);
+}
+
+static void
+gst_audiomixer_finalize (GObject * object)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  g_array_unref (audiomixer->batch);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
 
 
 static void
 gst_audiomixer_class_init (GstAudioMixerClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *agg_class = (GstAggregatorClass *) klass;
   GstAudioAggregatorClass *aagg_class = (GstAudioAggregatorClass *) klass;
 
+  gobject_class->set_property = gst_audiomixer_set_property;
+  gobject_class->get_property = gst_audiomixer_get_property;
+  gobject_class->finalize = gst_audiomixer_finalize;
+
+  /**
+   * GstAudioMixer:batch-threshold:
+   *
+   * Number of sink pads from which on the inputs are not added to the
+   * output one after another anymore. Instead all inputs of an output
+   * buffer are collected and summed in one pass over the output, block by
+   * block. The output is the same as when mixing pad by pad.
+   *
+   * This is used for S16, S32, F32 and F64 output, other formats are always
+   * mixed pad by pad. 0 disables batch mixing.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_THRESHOLD,
+      g_param_spec_uint ("batch-threshold", "Batch threshold",
+          "Minimum number of sink pads to sum all inputs in one pass "
+          "(0 = disabled)", 0, G_MAXUINT, DEFAULT_BATCH_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_src_template, GST_TYPE_AUDIO_AGGREGATOR_CONVERT_PAD);
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
@@ -233,6 +349,13 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (gst_audiomixer_release_pad);
 
+  agg_class->finish_buffer = GST_DEBUG_FUNCPTR (gst_audiomixer_finish_buffer);
+  agg_class->flush = GST_DEBUG_FUNCPTR (gst_audiomixer_flush);
+  agg_class->stop = GST_DEBUG_FUNCPTR (gst_audiomixer_stop);
+  agg_class->aggregate = GST_DEBUG_FUNCPTR (gst_audiomixer_aggregate);
+  agg_class->negotiated_src_caps =
+      GST_DEBUG_FUNCPTR (gst_audiomixer_negotiated_src_caps);
+
   aagg_class->aggregate_one_buffer = gst_audiomixer_aggregate_one_buffer;
 
   gst_type_mark_as_plugin_api (GST_TYPE_AUDIO_MIXER_PAD, 0);
@@ -241,6 +364,11 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
 static void
 gst_audiomixer_init (GstAudioMixer * audiomixer)
 {
+  audiomixer->batch_threshold = DEFAULT_BATCH_THRESHOLD;
+  audiomixer->batch = g_array_new (FALSE, FALSE,
+      sizeof (GstAudioMixerBatchInput));
+  g_array_set_clear_func (audiomixer->batch,
+      (GDestroyNotify) gst_audiomixer_batch_input_clear);
 }
 
 static GstPad *
@@ -283,12 +411,351 @@ gst_audiomixer_release_pad (GstElement * element, GstPad * pad)
   GST_ELEMENT_CLASS (parent_class)->release_pad (element, pad);
 }
 
+/* Batch mixing
+ *
+ * All inputs of an output buffer are collected in aggregate_one_buffer()
+ * and summed when the output buffer is finished. The output is processed in
+ * blocks of BATCH_BLOCK samples: the block is loaded into accumulators,
+ * every input overlapping the block is added and the result is stored once.
+ * This touches every output sample only twice, independent of the number of
+ * inputs, instead of once per input. The inputs are added in pad order with
+ * the same saturation as the ORC functions, so that the output is the same
+ * as when mixing pad by pad. */
+
+static inline void
+batch_add_s16 (gint16 * acc, const gint16 * src, guint n,
+    const GstAudioMixerBatchInput * input)
+{
+  guint i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  if (input->unity) {
+    for (; i + 8 <= n; i += 8) {
+      __m128i s = _mm_loadu_si128 ((const __m128i *) (src + i));
+
+      _mm_storeu_si128 ((__m128i *) (acc + i),
+          _mm_adds_epi16 (_mm_loadu_si128 ((__m128i *) (acc + i)), s));
+    }
+  } else {
+    __m128i v = _mm_set1_epi16 (input->volume_i16);
+
+    for (; i + 8 <= n; i += 8) {
+      __m128i s = _mm_loadu_si128 ((const __m128i *) (src + i));
+      __m128i pl = _mm_mullo_epi16 (s, v);
+      __m128i ph = _mm_mulhi_epi16 (s, v);
+      __m128i lo = _mm_srai_epi32 (_mm_unpacklo_epi16 (pl, ph),
+          VOLUME_UNITY_INT16_BIT_SHIFT);
+      __m128i hi = _mm_srai_epi32 (_mm_unpackhi_epi16 (pl, ph),
+          VOLUME_UNITY_INT16_BIT_SHIFT);
+
+      /* Clamp each scaled input like the ORC functions do */
+      s = _mm_packs_epi32 (lo, hi);
+
+      _mm_storeu_si128 ((__m128i *) (acc + i),
+          _mm_adds_epi16 (_mm_loadu_si128 ((__m128i *) (acc + i)), s));
+    }
+  }
+#endif
+
+  if (input->unity) {
+    for (; i < n; i++)
+      acc[i] = CLAMP (acc[i] + src[i], G_MININT16, G_MAXINT16);
+  } else {
+    for (; i < n; i++) {
+      gint32 v = (src[i] * input->volume_i16) >> VOLUME_UNITY_INT16_BIT_SHIFT;
+
+      v = CLAMP (v, G_MININT16, G_MAXINT16);
+      acc[i] = CLAMP (acc[i] + v, G_MININT16, G_MAXINT16);
+    }
+  }
+}
+
+static inline void
+batch_store_s16 (gint16 * dst, const gint16 * acc, guint n)
+{
+  memcpy (dst, acc, n * sizeof (gint16));
+}
+
+static inline void
+batch_add_s32 (gint32 * acc, const gint32 * src, guint n,
+    const GstAudioMixerBatchInput * input)
+{
+  guint i;
+
+  if (input->unity) {
+    for (i = 0; i < n; i++)
+      acc[i] = CLAMP ((gint64) acc[i] + src[i], G_MININT32, G_MAXINT32);
+  } else {
+    for (i = 0; i < n; i++) {
+      gint64 v = (((gint64) src[i]) * input->volume_i32) >>
+          VOLUME_UNITY_INT32_BIT_SHIFT;
+
+      v = CLAMP (v, G_MININT32, G_MAXINT32);
+      acc[i] = CLAMP (acc[i] + v, G_MININT32, G_MAXINT32);
+    }
+  }
+}
+
+static inline void
+batch_store_s32 (gint32 * dst, const gint32 * acc, guint n)
+{
+  memcpy (dst, acc, n * sizeof (gint32));
+}
+
+static inline void
+batch_add_f32 (gfloat * acc, const gfloat * src, guint n,
+    const GstAudioMixerBatchInput * input)
+{
+  gfloat volume = input->volume;
+  guint i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  if (input->unity) {
+    for (; i + 4 <= n; i += 4) {
+      _mm_storeu_ps (acc + i, _mm_add_ps (_mm_loadu_ps (acc + i),
+              _mm_loadu_ps (src + i)));
+    }
+  } else {
+    __m128 v = _mm_set1_ps (volume);
+
+    for (; i + 4 <= n; i += 4) {
+      _mm_storeu_ps (acc + i, _mm_add_ps (_mm_loadu_ps (acc + i),
+              _mm_mul_ps (_mm_loadu_ps (src + i), v)));
+    }
+  }
+#endif
+
+  if (input->unity) {
+    for (; i < n; i++)
+      acc[i] += src[i];
+  } else {
+    for (; i < n; i++)
+      acc[i] += src[i] * volume;
+  }
+}
+
+static inline void
+batch_store_f32 (gfloat * dst, const gfloat * acc, guint n)
+{
+  memcpy (dst, acc, n * sizeof (gfloat));
+}
+
+static inline void
+batch_add_f64 (gdouble * acc, const gdouble * src, guint n,
+    const GstAudioMixerBatchInput * input)
+{
+  guint i;
+
+  if (input->unity) {
+    for (i = 0; i < n; i++)
+      acc[i] += src[i];
+  } else {
+    for (i = 0; i < n; i++)
+      acc[i] += src[i] * input->volume;
+  }
+}
+
+static inline void
+batch_store_f64 (gdouble * dst, const gdouble * acc, guint n)
+{
+  memcpy (dst, acc, n * sizeof (gdouble));
+}
+
+#define DEFINE_BATCH_MIX_FUNC(fmt,type,acctype) \
+static void \
+gst_audiomixer_mix_batch_##fmt (const GstAudioMixerBatchInput * inputs, \
+    const guint8 ** in_data, guint n_inputs, type * out, guint n_samples) \
+{ \
+  acctype acc[BATCH_BLOCK]; \
+  guint b, i, k; \
+  \
+  for (b = 0; b < n_samples; b += BATCH_BLOCK) { \
+    guint len = MIN (BATCH_BLOCK, n_samples - b); \
+    \
+    for (i = 0; i < len; i++) \
+      acc[i] = out[b + i]; \
+    \
+    for (k = 0; k < n_inputs; k++) { \
+      const GstAudioMixerBatchInput *input = &inputs[k]; \
+      guint start = MAX (b, input->out_offset); \
+      guint end = MIN (b + len, input->out_offset + input->n_samples); \
+      \
+      if (start >= end) \
+        continue; \
+      \
+      batch_add_##fmt (acc + start - b, (const type *) in_data[k] + \
+          input->in_offset + start - input->out_offset, end - start, input); \
+    } \
+    \
+    batch_store_##fmt (out + b, acc, len); \
+  } \
+}
+
+DEFINE_BATCH_MIX_FUNC (s16, gint16, gint16);
+DEFINE_BATCH_MIX_FUNC (s32, gint32, gint32);
+DEFINE_BATCH_MIX_FUNC (f32, gfloat, gfloat);
+DEFINE_BATCH_MIX_FUNC (f64, gdouble, gdouble);
+
+#undef DEFINE_BATCH_MIX_FUNC
+
+static gboolean
+gst_audiomixer_can_batch (GstAudioFormat format)
+{
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:
+    case GST_AUDIO_FORMAT_S32:
+    case GST_AUDIO_FORMAT_F32:
+    case GST_AUDIO_FORMAT_F64:
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+/* Called with the object lock */
+static void
+gst_audiomixer_mix_batch (GstAudioMixer * audiomixer, GstBuffer * outbuf)
+{
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR (audiomixer)->srcpad);
+  GstAudioMixerBatchInput *inputs =
+      (GstAudioMixerBatchInput *) audiomixer->batch->data;
+  guint n_inputs = audiomixer->batch->len;
+  GstMapInfo outmap, *inmaps;
+  const guint8 **in_data;
+  guint n_samples, k;
+
+  if (!gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE))
+    return;
+
+  inmaps = g_new (GstMapInfo, n_inputs);
+  in_data = g_new (const guint8 *, n_inputs);
+  for (k = 0; k < n_inputs; k++) {
+    gst_buffer_map (inputs[k].inbuf, &inmaps[k], GST_MAP_READ);
+    in_data[k] = inmaps[k].data;
+  }
+
+  GST_LOG_OBJECT (audiomixer, "mixing %u inputs in one pass", n_inputs);
+
+  n_samples = outmap.size / GST_AUDIO_INFO_BPS (&srcpad->info);
+  switch (GST_AUDIO_INFO_FORMAT (&srcpad->info)) {
+    case GST_AUDIO_FORMAT_S16:
+      gst_audiomixer_mix_batch_s16 (inputs, in_data, n_inputs,
+          (gint16 *) outmap.data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      gst_audiomixer_mix_batch_s32 (inputs, in_data, n_inputs,
+          (gint32 *) outmap.data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      gst_audiomixer_mix_batch_f32 (inputs, in_data, n_inputs,
+          (gfloat *) outmap.data, n_samples);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      gst_audiomixer_mix_batch_f64 (inputs, in_data, n_inputs,
+          (gdouble *) outmap.data, n_samples);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+
+  for (k = 0; k < n_inputs; k++)
+    gst_buffer_unmap (inputs[k].inbuf, &inmaps[k]);
+  g_free (in_data);
+  g_free (inmaps);
+  gst_buffer_unmap (outbuf, &outmap);
+}
+
+/* Called with the object lock held */
+static void
+gst_audiomixer_clear_batch (GstAudioMixer * audiomixer)
+{
+  g_array_set_size (audiomixer->batch, 0);
+  audiomixer->batch_outbuf = NULL;
+}
+
+static GstFlowReturn
+gst_audiomixer_finish_buffer (GstAggregator * agg, GstBuffer * buffer)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  GST_OBJECT_LOCK (audiomixer);
+  if (audiomixer->batch->len > 0 && audiomixer->batch_outbuf == buffer)
+    gst_audiomixer_mix_batch (audiomixer, buffer);
+  gst_audiomixer_clear_batch (audiomixer);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+}
+
+static gboolean
+gst_audiomixer_negotiated_src_caps (GstAggregator * agg, GstCaps * caps)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  /* The base class converts the current output buffer to the new format,
+   * so everything collected for it has to be mixed in the old format first */
+  GST_OBJECT_LOCK (audiomixer);
+  if (audiomixer->batch->len > 0)
+    gst_audiomixer_mix_batch (audiomixer, audiomixer->batch_outbuf);
+  gst_audiomixer_clear_batch (audiomixer);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->negotiated_src_caps (agg, caps);
+}
+
+static GstFlowReturn
+gst_audiomixer_aggregate (GstAggregator * agg, gboolean timeout)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+  GstFlowReturn ret;
+
+  ret = GST_AGGREGATOR_CLASS (parent_class)->aggregate (agg, timeout);
+
+  /* On EOS and errors the base class drops the output buffer without
+   * finishing it. Forget the inputs collected for it, a new output buffer
+   * could otherwise be allocated at the same address and get them mixed in.
+   * When it only needs more data, it keeps the buffer for the next call */
+  if (ret < GST_FLOW_OK) {
+    GST_OBJECT_LOCK (audiomixer);
+    gst_audiomixer_clear_batch (audiomixer);
+    GST_OBJECT_UNLOCK (audiomixer);
+  }
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_audiomixer_flush (GstAggregator * agg)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  GST_OBJECT_LOCK (audiomixer);
+  gst_audiomixer_clear_batch (audiomixer);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->flush (agg);
+}
+
+static gboolean
+gst_audiomixer_stop (GstAggregator * agg)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+
+  GST_OBJECT_LOCK (audiomixer);
+  gst_audiomixer_clear_batch (audiomixer);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->stop (agg);
+}
 
 static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
     GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
     GstBuffer * outbuf, guint out_offset, guint num_frames)
 {
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (aagg);
   GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (aaggpad);
   GstMapInfo inmap;
   GstMapInfo outmap;
@@ -308,6 +775,34 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
 
   bpf = GST_AUDIO_INFO_BPF (&srcpad->info);
 
+  if (audiomixer->batch_threshold > 0
+      && GST_ELEMENT_CAST (aagg)->numsinkpads >= audiomixer->batch_threshold
+      && gst_audiomixer_can_batch (GST_AUDIO_INFO_FORMAT (&srcpad->info))) {
+    GstAudioMixerBatchInput input;
+
+    if (audiomixer->batch_outbuf != outbuf) {
+      gst_audiomixer_clear_batch (audiomixer);
+      audiomixer->batch_outbuf = outbuf;
+    }
+
+    input.inbuf = gst_buffer_ref (inbuf);
+    input.in_offset = in_offset * srcpad->info.channels;
+    input.out_offset = out_offset * srcpad->info.channels;
+    input.n_samples = num_frames * srcpad->info.channels;
+    input.unity = (pad->volume == 1.0);
+    input.volume = pad->volume;
+    input.volume_i16 = pad->volume_i16;
+    input.volume_i32 = pad->volume_i32;
+    g_array_append_val (audiomixer->batch, input);
+
+    GST_LOG_OBJECT (pad, "queued %u frames at offset %u for batch mixing",
+        num_frames, out_offset);
+
+    GST_OBJECT_UNLOCK (aaggpad);
+    GST_OBJECT_UNLOCK (aagg);
+    return TRUE;
+  }
+
   gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
   gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
   GST_LOG_OBJECT (pad, "mixing %u bytes at offset %u from offset %u",
@@ -41,6 +41,12 @@ G_DECLARE_FINAL_TYPE (GstAudioMixer, gst_audiomixer, GST, AUDIO_MIXER,
  */
 struct _GstAudioMixer {
   GstAudioAggregator element;
+
+  /*< private >*/
+  /* protected by the object lock */
+  guint batch_threshold;
+  GArray *batch;                /* inputs collected for batch_outbuf */
+  GstBuffer *batch_outbuf;
 };
 
 #define GST_TYPE_AUDIO_MIXER_PAD (gst_audiomixer_pad_get_type())
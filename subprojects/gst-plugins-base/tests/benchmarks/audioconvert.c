@@ -0,0 +1,179 @@
+/* GStreamer
+ *
+ * audioconvert.c: throughput of common GstAudioConverter conversions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/audio/audio.h>
+
+#define BLOCK_FRAMES 1024
+
+typedef struct
+{
+  const gchar *name;
+  GstAudioFormat in_format;
+  gint in_channels;
+  gint in_rate;
+  GstAudioFormat out_format;
+  gint out_channels;
+  gint out_rate;
+  GstAudioDitherMethod dither;
+  gfloat gain;
+} Conversion;
+
+static const Conversion conversions[] = {
+  {"S16 stereo -> F32 stereo", GST_AUDIO_FORMAT_S16, 2, 48000,
+      GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"S16 stereo -> F32 stereo, gain", GST_AUDIO_FORMAT_S16, 2, 48000,
+      GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_DITHER_NONE, 0.5f},
+  {"F32 stereo -> S16 stereo", GST_AUDIO_FORMAT_F32, 2, 48000,
+      GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 stereo -> S16 stereo, TPDF", GST_AUDIO_FORMAT_F32, 2, 48000,
+      GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_DITHER_TPDF, 1.0f},
+  {"S16 5.1 -> S16 stereo", GST_AUDIO_FORMAT_S16, 6, 48000,
+      GST_AUDIO_FORMAT_S16, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 5.1 -> F32 stereo", GST_AUDIO_FORMAT_F32, 6, 48000,
+      GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 7.1 -> F32 stereo", GST_AUDIO_FORMAT_F32, 8, 48000,
+      GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 stereo -> F32 mono", GST_AUDIO_FORMAT_F32, 2, 48000,
+      GST_AUDIO_FORMAT_F32, 1, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 stereo -> F32 5.1", GST_AUDIO_FORMAT_F32, 2, 48000,
+      GST_AUDIO_FORMAT_F32, 6, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"S16 stereo 48000 -> 44100", GST_AUDIO_FORMAT_S16, 2, 48000,
+      GST_AUDIO_FORMAT_S16, 2, 44100, GST_AUDIO_DITHER_NONE, 1.0f},
+  {"F32 stereo 44100 -> 48000", GST_AUDIO_FORMAT_F32, 2, 44100,
+      GST_AUDIO_FORMAT_F32, 2, 48000, GST_AUDIO_DITHER_NONE, 1.0f},
+};
+
+static GstStructure *
+make_config (const Conversion * c)
+{
+  GstStructure *config;
+
+  config = gst_structure_new ("GstAudioConverter",
+      GST_AUDIO_CONVERTER_OPT_DITHER_METHOD, GST_TYPE_AUDIO_DITHER_METHOD,
+      c->dither, NULL);
+
+  if (c->gain != 1.0f) {
+    GValue matrix = G_VALUE_INIT;
+    gint i, j;
+
+    g_value_init (&matrix, GST_TYPE_ARRAY);
+    for (i = 0; i < c->out_channels; i++) {
+      GValue row = G_VALUE_INIT;
+
+      g_value_init (&row, GST_TYPE_ARRAY);
+      for (j = 0; j < c->in_channels; j++) {
+        GValue v = G_VALUE_INIT;
+
+        g_value_init (&v, G_TYPE_FLOAT);
+        g_value_set_float (&v, i == j ? c->gain : 0.0f);
+        gst_value_array_append_and_take_value (&row, &v);
+      }
+      gst_value_array_append_and_take_value (&matrix, &row);
+    }
+    gst_structure_take_value (config, GST_AUDIO_CONVERTER_OPT_MIX_MATRIX,
+        &matrix);
+  }
+  return config;
+}
+
+static void
+run_conversion (const Conversion * c, guint n_blocks)
+{
+  GstAudioInfo in_info, out_info;
+  GstAudioConverter *convert;
+  GstClockTime start, end;
+  GstClockTimeDiff dur;
+  gpointer in, out;
+  gsize out_frames;
+  guint i;
+
+  gst_audio_info_set_format (&in_info, c->in_format, c->in_rate,
+      c->in_channels, NULL);
+  gst_audio_info_set_format (&out_info, c->out_format, c->out_rate,
+      c->out_channels, NULL);
+
+  convert = gst_audio_converter_new (GST_AUDIO_CONVERTER_FLAG_NONE, &in_info,
+      &out_info, make_config (c));
+  if (convert == NULL) {
+    g_print ("%-34s: not supported\n", c->name);
+    return;
+  }
+
+  out_frames = gst_audio_converter_get_out_frames (convert, BLOCK_FRAMES);
+  in = g_malloc0 (BLOCK_FRAMES * in_info.bpf);
+  out = g_malloc0 ((out_frames + 64) * out_info.bpf);
+
+  /* some non-silent input */
+  for (i = 0; i < BLOCK_FRAMES * in_info.channels; i++) {
+    if (c->in_format == GST_AUDIO_FORMAT_F32)
+      ((gfloat *) in)[i] = (gfloat) ((i * 7919) % 2001 - 1000) / 1000.0f;
+    else
+      ((gint16 *) in)[i] = (i * 7919) % 65536 - 32768;
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_blocks; i++) {
+    out_frames = gst_audio_converter_get_out_frames (convert, BLOCK_FRAMES);
+    gst_audio_converter_samples (convert, 0, &in, BLOCK_FRAMES, &out,
+        out_frames);
+  }
+  end = gst_util_get_timestamp ();
+  dur = GST_CLOCK_DIFF (start, end);
+
+  g_print ("%-34s: %8.2f ns/frame, %8.2f Mframes/s, %6.0fx realtime\n",
+      c->name, (gdouble) dur / ((gdouble) n_blocks * BLOCK_FRAMES),
+      ((gdouble) n_blocks * BLOCK_FRAMES * 1000.0) / dur,
+      ((gdouble) n_blocks * BLOCK_FRAMES * GST_SECOND) / (c->in_rate *
+          (gdouble) dur));
+
+  g_free (in);
+  g_free (out);
+  gst_audio_converter_free (convert);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, n_blocks = 10000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 2) {
+    g_print ("usage: %s [n_blocks]\n", argv[0]);
+    exit (-1);
+  }
+  if (argc == 2)
+    n_blocks = atoi (argv[1]);
+
+  if (n_blocks == 0) {
+    g_print ("number of blocks must be greater than 0\n");
+    exit (-1);
+  }
+
+  g_print ("converting %u blocks of %d frames\n", n_blocks, BLOCK_FRAMES);
+
+  for (i = 0; i < G_N_ELEMENTS (conversions); i++)
+    run_conversion (&conversions[i], n_blocks);
+
+  return 0;
+}
@@ -2220,6 +2220,113 @@ GST_START_TEST (test_qos_message_live)
 
 GST_END_TEST;
 
+static GstBuffer *
+new_buffer_s16 (gsize num_samples, gint16 value, GstClockTime ts,
+    GstClockTime dur)
+{
+  GstMapInfo map;
+  GstBuffer *buffer = gst_buffer_new_and_alloc (num_samples * 2);
+  gsize i;
+
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < num_samples; i++)
+    GST_WRITE_UINT16_LE (map.data + 2 * i, value);
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_TIMESTAMP (buffer) = ts;
+  GST_BUFFER_DURATION (buffer) = dur;
+  return buffer;
+}
+
+static void
+check_buffer_s16 (GstBuffer * buffer, gsize num_samples, gint16 value)
+{
+  GstMapInfo map;
+  gsize i;
+
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, num_samples * 2);
+  for (i = 0; i < num_samples; i++)
+    fail_unless_equals_int ((gint16) GST_READ_UINT16_LE (map.data + 2 * i),
+        value);
+  gst_buffer_unmap (buffer, &map);
+}
+
+/* Mixes three pads, two of which need converting from S8, so that the
+ * conversion runs on multiple threads too. Returns the two output buffers in
+ * @out. */
+static void
+run_batch_mix (guint batch_threshold, GstBuffer * out[2])
+{
+  static const char *s16_caps = "audio/x-raw, format=(string)S16LE, "
+      "rate=(int)1000, channels=(int)1, layout=(string)interleaved";
+  static const char *s8_caps = "audio/x-raw, format=(string)S8, "
+      "rate=(int)1000, channels=(int)1, layout=(string)interleaved";
+  GstHarness *h, *h1, *h2;
+  GstPad *pad;
+
+  h = gst_harness_new_with_padnames ("audiomixer", "sink_0", "src");
+  g_object_set (h->element, "output-buffer-duration", GST_SECOND,
+      "batch-threshold", batch_threshold, "max-threads", 2, NULL);
+  h1 = gst_harness_new_with_element (h->element, "sink_1", NULL);
+  h2 = gst_harness_new_with_element (h->element, "sink_2", NULL);
+
+  pad = gst_element_get_static_pad (h->element, "sink_2");
+  g_object_set (pad, "volume", 0.5, NULL);
+  gst_object_unref (pad);
+
+  gst_harness_play (h);
+  gst_harness_play (h1);
+  gst_harness_play (h2);
+  gst_harness_set_caps_str (h, s16_caps, s16_caps);
+  gst_harness_set_src_caps_str (h1, s8_caps);
+  gst_harness_set_src_caps_str (h2, s8_caps);
+
+  gst_harness_push (h1, new_buffer (1000, 10, 0, GST_SECOND, 0));
+  gst_harness_push (h2, new_buffer (1000, -20, 0, GST_SECOND, 0));
+  gst_harness_push (h, new_buffer_s16 (1000, 1000, 0, GST_SECOND));
+  out[0] = gst_harness_pull (h);
+  fail_unless_equals_int64 (GST_BUFFER_PTS (out[0]), 0);
+
+  gst_harness_push (h1, new_buffer (1000, 100, GST_SECOND, GST_SECOND, 0));
+  gst_harness_push (h2, new_buffer (1000, -100, GST_SECOND, GST_SECOND, 0));
+  gst_harness_push (h, new_buffer_s16 (1000, 30000, GST_SECOND, GST_SECOND));
+  out[1] = gst_harness_pull (h);
+  fail_unless_equals_int64 (GST_BUFFER_PTS (out[1]), GST_SECOND);
+
+  gst_harness_teardown (h2);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h);
+}
+
+/* In batch mode the inputs are added in pad order with saturation, so the
+ * output has to be the same as when mixing pad by pad */
+GST_START_TEST (test_batch_mix)
+{
+  GstBuffer *batch[2], *single[2];
+  GstMapInfo map;
+  guint i;
+
+  run_batch_mix (3, batch);
+  run_batch_mix (0, single);
+
+  /* 1000 + 10 * 256 - 20 * 256 / 2 */
+  check_buffer_s16 (batch[0], 1000, 1000);
+  /* 30000 + 100 * 256 saturates, then - 100 * 256 / 2 */
+  check_buffer_s16 (batch[1], 1000, G_MAXINT16 - 12800);
+
+  for (i = 0; i < 2; i++) {
+    gst_buffer_map (single[i], &map, GST_MAP_READ);
+    fail_unless_equals_int (gst_buffer_get_size (batch[i]), map.size);
+    fail_unless (gst_buffer_memcmp (batch[i], 0, map.data, map.size) == 0);
+    gst_buffer_unmap (single[i], &map);
+
+    gst_buffer_unref (batch[i]);
+    gst_buffer_unref (single[i]);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 audiomixer_suite (void)
 {
@@ -2249,6 +2356,7 @@ audiomixer_suite (void)
   tcase_add_test (tc_chain, test_segment_base_handling);
   tcase_add_test (tc_chain, test_sinkpad_property_controller);
   tcase_add_test (tc_chain, test_qos_message_live);
+  tcase_add_test (tc_chain, test_batch_mix);
   tcase_add_checked_fixture (tc_chain, test_setup, test_teardown);
   tcase_add_test (tc_chain, test_change_output_caps);
   tcase_add_test (tc_chain, test_change_output_caps_mid_output_buffer);
@@ -1678,6 +1678,719 @@ GST_START_TEST (test_audio_meta_serialize_65_chans)
 
 GST_END_TEST;
 
+static gfloat **
+make_downmix_matrix (void)
+{
+  /* FL, FR, FC, LFE, RL, RR -> L, R */
+  static const gfloat m[6][2] = {
+    {1.0, 0.0}, {0.0, 1.0}, {0.5, 0.5}, {0.0, 0.0}, {0.5, 0.0}, {0.0, 0.5}
+  };
+  gfloat **matrix;
+  gint i;
+
+  matrix = g_new (gfloat *, 6);
+  for (i = 0; i < 6; i++)
+    matrix[i] = g_memdup2 (m[i], sizeof (m[i]));
+
+  return matrix;
+}
+
+GST_START_TEST (test_channel_mixer_downmix)
+{
+  GstAudioChannelMixer *mix, *planar;
+  gint16 in[6 * 37], out[2 * 37], planar_out[2 * 37];
+  gfloat fin[6 * 37], fout[2 * 37];
+  gpointer in_p[6], out_p[2];
+  gint i, c;
+
+  for (i = 0; i < 6 * 37; i++) {
+    in[i] = (i * 331) % 8192 - 4096;
+    fin[i] = in[i] / 4096.0;
+  }
+
+  /* interleaved S16 */
+  mix = gst_audio_channel_mixer_new_with_matrix (0, GST_AUDIO_FORMAT_S16, 6, 2,
+      make_downmix_matrix ());
+  fail_if (gst_audio_channel_mixer_is_passthrough (mix));
+  in_p[0] = in;
+  out_p[0] = out;
+  gst_audio_channel_mixer_samples (mix, in_p, out_p, 37);
+  for (i = 0; i < 37; i++) {
+    gint16 *f = &in[i * 6];
+
+    /* coefficients of 0.5 are 512 in 22.10 fixed point */
+    fail_unless_equals_int (out[i * 2],
+        (f[0] * 1024 + f[2] * 512 + f[4] * 512 + 512) >> 10);
+    fail_unless_equals_int (out[i * 2 + 1],
+        (f[1] * 1024 + f[2] * 512 + f[5] * 512 + 512) >> 10);
+  }
+
+  /* planar S16 with the matrix of the first mixer */
+  planar = gst_audio_channel_mixer_new_from_mixer (mix,
+      GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN |
+      GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT, GST_AUDIO_FORMAT_S16);
+  gst_audio_channel_mixer_free (mix);
+  {
+    gint16 planar_in[6 * 37];
+
+    for (c = 0; c < 6; c++) {
+      for (i = 0; i < 37; i++)
+        planar_in[c * 37 + i] = in[i * 6 + c];
+      in_p[c] = &planar_in[c * 37];
+    }
+    for (c = 0; c < 2; c++)
+      out_p[c] = &planar_out[c * 37];
+    gst_audio_channel_mixer_samples (planar, in_p, out_p, 37);
+  }
+  for (i = 0; i < 37; i++) {
+    fail_unless_equals_int (planar_out[i], out[i * 2]);
+    fail_unless_equals_int (planar_out[37 + i], out[i * 2 + 1]);
+  }
+  gst_audio_channel_mixer_free (planar);
+
+  /* interleaved F32 */
+  mix = gst_audio_channel_mixer_new_with_matrix (0, GST_AUDIO_FORMAT_F32, 6, 2,
+      make_downmix_matrix ());
+  in_p[0] = fin;
+  out_p[0] = fout;
+  gst_audio_channel_mixer_samples (mix, in_p, out_p, 37);
+  for (i = 0; i < 37; i++) {
+    gfloat *f = &fin[i * 6];
+
+    fail_unless_equals_float (fout[i * 2], f[0] + f[2] * 0.5 + f[4] * 0.5);
+    fail_unless_equals_float (fout[i * 2 + 1], f[1] + f[2] * 0.5 + f[5] * 0.5);
+  }
+  gst_audio_channel_mixer_free (mix);
+}
+
+GST_END_TEST;
+
+/* Channel mixer matrices, row-major with one row per input channel */
+typedef struct
+{
+  gint in_channels, out_channels;
+  const gfloat *matrix;
+  gboolean passthrough;
+} MixerShape;
+
+static const gfloat mixer_6_2[] = {
+  1.0, 0.0, 0.0, 1.0, 0.5, 0.5, 0.0, 0.0, 0.5, 0.0, 0.0, 0.5
+};
+
+static const gfloat mixer_8_2[] = {
+  1.0, 0.0, 0.0, 1.0, 0.7071, 0.7071, 0.0, 0.0,
+  0.5, 0.0, 0.0, 0.5, 0.35, 0.0, 0.0, 0.35
+};
+
+static const gfloat mixer_2_1[] = { 0.5, 0.5 };
+
+static const gfloat mixer_2_6[] = {
+  1.0, 0.0, 0.5, 0.0, 0.7, 0.0,
+  0.0, 1.0, 0.5, 0.0, 0.0, 0.7
+};
+
+static const gfloat mixer_4_3[] = {
+  0.25, -0.5, 0.0, 0.0, 0.75, -0.125, 0.3, 0.0, 0.0, -1.0, 0.2, 0.6
+};
+
+static const gfloat mixer_identity_2[] = { 1.0, 0.0, 0.0, 1.0 };
+
+static const gfloat mixer_identity_6[] = {
+  1.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+  0.0, 1.0, 0.0, 0.0, 0.0, 0.0,
+  0.0, 0.0, 1.0, 0.0, 0.0, 0.0,
+  0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
+  0.0, 0.0, 0.0, 0.0, 1.0, 0.0,
+  0.0, 0.0, 0.0, 0.0, 0.0, 1.0
+};
+
+/* coefficients that don't fit in 16 bits and saturate */
+static const gfloat mixer_gain_1_2[] = { 40.0, -40.0 };
+
+static const MixerShape mixer_shapes[] = {
+  {6, 2, mixer_6_2, FALSE},
+  {8, 2, mixer_8_2, FALSE},
+  {2, 1, mixer_2_1, FALSE},
+  {2, 6, mixer_2_6, FALSE},
+  {4, 3, mixer_4_3, FALSE},
+  {2, 2, mixer_identity_2, TRUE},
+  {6, 6, mixer_identity_6, TRUE},
+  {1, 2, mixer_gain_1_2, FALSE},
+};
+
+static gfloat **
+make_mixer_matrix (const MixerShape * shape)
+{
+  gfloat **matrix;
+  gint i;
+
+  matrix = g_new (gfloat *, shape->in_channels);
+  for (i = 0; i < shape->in_channels; i++)
+    matrix[i] = g_memdup2 (&shape->matrix[i * shape->out_channels],
+        shape->out_channels * sizeof (gfloat));
+
+  return matrix;
+}
+
+static void
+mixer_set_sample (GstAudioFormat format, gpointer data, gint idx, gint16 v)
+{
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:
+      ((gint16 *) data)[idx] = v;
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      ((gfloat *) data)[idx] = v / 32768.0f;
+      break;
+    default:
+      ((gdouble *) data)[idx] = v / 32768.0;
+      break;
+  }
+}
+
+static gdouble
+mixer_get_sample (GstAudioFormat format, gpointer data, gint idx)
+{
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:
+      return ((gint16 *) data)[idx];
+    case GST_AUDIO_FORMAT_F32:
+      return ((gfloat *) data)[idx];
+    default:
+      return ((gdouble *) data)[idx];
+  }
+}
+
+/* Output channel @out of @frame as computed by the generic mixing loops */
+static gdouble
+mixer_reference (GstAudioFormat format, const MixerShape * shape,
+    const gint16 * frame, gint out)
+{
+  gint in;
+
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16:{
+      gint32 res = 0;
+
+      for (in = 0; in < shape->in_channels; in++) {
+        gfloat coeff = shape->matrix[in * shape->out_channels + out] * 1024;
+
+        res += frame[in] * (gint32) coeff;
+      }
+      res = (res + 512) >> 10;
+      return CLAMP (res, G_MININT16, G_MAXINT16);
+    }
+    case GST_AUDIO_FORMAT_F32:{
+      gfloat res = 0.0;
+
+      for (in = 0; in < shape->in_channels; in++)
+        res += (frame[in] / 32768.0f) *
+            shape->matrix[in * shape->out_channels + out];
+      return res;
+    }
+    default:{
+      gdouble res = 0.0;
+
+      for (in = 0; in < shape->in_channels; in++)
+        res += (frame[in] / 32768.0) *
+            shape->matrix[in * shape->out_channels + out];
+      return res;
+    }
+  }
+}
+
+static void
+check_channel_mixer (const MixerShape * shape, GstAudioFormat format,
+    GstAudioChannelMixerFlags flags, gint samples)
+{
+  GstAudioChannelMixer *mix;
+  gboolean planar_in, planar_out;
+  gint in_channels = shape->in_channels;
+  gint out_channels = shape->out_channels;
+  gint bps = GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info (format))
+      / 8;
+  gpointer in_p[8], out_p[8];
+  gint16 *frames, *frame;
+  guint8 *in, *out;
+  gint i, c;
+
+  planar_in = (flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN) != 0;
+  planar_out = (flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT) != 0;
+
+  /* full scale input, so that the S16 outputs also saturate */
+  frames = g_new (gint16, samples * in_channels);
+  in = g_malloc (samples * in_channels * bps);
+  for (i = 0; i < samples; i++) {
+    for (c = 0; c < in_channels; c++) {
+      gint16 v = (i * 331 + c * 7919) % 65536 - 32768;
+
+      frames[i * in_channels + c] = v;
+      mixer_set_sample (format, in,
+          planar_in ? c * samples + i : i * in_channels + c, v);
+    }
+  }
+  out = g_malloc (samples * out_channels * bps);
+
+  for (c = 0; c < in_channels; c++)
+    in_p[c] = planar_in ? in + c * samples * bps : in;
+  for (c = 0; c < out_channels; c++)
+    out_p[c] = planar_out ? out + c * samples * bps : out;
+
+  mix = gst_audio_channel_mixer_new_with_matrix (flags, format, in_channels,
+      out_channels, make_mixer_matrix (shape));
+  fail_unless_equals_int (gst_audio_channel_mixer_is_passthrough (mix),
+      shape->passthrough);
+  gst_audio_channel_mixer_samples (mix, in_p, out_p, samples);
+  gst_audio_channel_mixer_free (mix);
+
+  for (i = 0; i < samples; i++) {
+    frame = &frames[i * in_channels];
+
+    for (c = 0; c < out_channels; c++) {
+      gdouble res = mixer_get_sample (format, out,
+          planar_out ? c * samples + i : i * out_channels + c);
+      gdouble ref = mixer_reference (format, shape, frame, c);
+
+      if (format == GST_AUDIO_FORMAT_S16)
+        fail_unless_equals_int ((gint) res, (gint) ref);
+      else
+        fail_unless (ABS (res - ref) <= 1e-6 * MAX (1.0, ABS (ref)),
+            "%d -> %d, format %d, flags %d, %d samples: frame %d channel %d "
+            "is %f instead of %f", in_channels, out_channels, format, flags,
+            samples, i, c, res, ref);
+    }
+  }
+
+  g_free (frames);
+  g_free (in);
+  g_free (out);
+}
+
+GST_START_TEST (test_channel_mixer_shapes)
+{
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_F64
+  };
+  /* around the vector widths and the 256 frames blocks of the mixers */
+  static const gint lengths[] = { 1, 7, 8, 9, 255, 256, 257, 600, 1031 };
+  static const GstAudioChannelMixerFlags layouts[] = {
+    0,
+    GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN,
+    GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT,
+    GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN |
+        GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT
+  };
+  guint s, f, k, l;
+
+  for (s = 0; s < G_N_ELEMENTS (mixer_shapes); s++) {
+    for (f = 0; f < G_N_ELEMENTS (formats); f++) {
+      for (k = 0; k < G_N_ELEMENTS (layouts); k++) {
+        for (l = 0; l < G_N_ELEMENTS (lengths); l++)
+          check_channel_mixer (&mixer_shapes[s], formats[f], layouts[k],
+              lengths[l]);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
+#define CACHED_FRAMES 1000
+
+/* Mixes the S16 @in with a mixer for the positions and checks the result
+ * against the generic S32 mixer for the same positions. With 11 bits of
+ * input, the S32 mixer outputs the sum of the products times 64 */
+static void
+check_positions_mixer (GstAudioChannelMixerFlags flags, gint in_channels,
+    GstAudioChannelPosition * in_position, gint out_channels,
+    GstAudioChannelPosition * out_position, gint16 * out)
+{
+  GstAudioChannelMixer *mix, *ref;
+  gint16 in[8 * CACHED_FRAMES], planar[8 * CACHED_FRAMES];
+  gint32 in32[8 * CACHED_FRAMES], out32[8 * CACHED_FRAMES];
+  gpointer in_p[8], out_p[8];
+  gint i, c;
+
+  for (i = 0; i < CACHED_FRAMES * in_channels; i++) {
+    in[i] = (i * 331) % 4096 - 2048;
+    in32[i] = in[i] * 65536;
+  }
+
+  mix = gst_audio_channel_mixer_new (flags, GST_AUDIO_FORMAT_S16,
+      in_channels, in_position, out_channels, out_position);
+  if (flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN) {
+    for (c = 0; c < in_channels; c++) {
+      for (i = 0; i < CACHED_FRAMES; i++)
+        planar[c * CACHED_FRAMES + i] = in[i * in_channels + c];
+      in_p[c] = &planar[c * CACHED_FRAMES];
+    }
+  } else {
+    in_p[0] = in;
+  }
+  for (c = 0; c < out_channels; c++)
+    out_p[c] = &out[c * CACHED_FRAMES];
+  gst_audio_channel_mixer_samples (mix, in_p, out_p, CACHED_FRAMES);
+  gst_audio_channel_mixer_free (mix);
+
+  ref = gst_audio_channel_mixer_new (0, GST_AUDIO_FORMAT_S32,
+      in_channels, in_position, out_channels, out_position);
+  in_p[0] = in32;
+  out_p[0] = out32;
+  gst_audio_channel_mixer_samples (ref, in_p, out_p, CACHED_FRAMES);
+  gst_audio_channel_mixer_free (ref);
+
+  for (i = 0; i < CACHED_FRAMES; i++) {
+    for (c = 0; c < out_channels; c++) {
+      gint16 res;
+
+      if (flags & GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT)
+        res = out[c * CACHED_FRAMES + i];
+      else
+        res = out[i * out_channels + c];
+
+      fail_unless_equals_int (res,
+          (out32[i * out_channels + c] / 64 + 512) >> 10);
+    }
+  }
+}
+
+GST_START_TEST (test_channel_mixer_cached_matrix)
+{
+  GstAudioChannelPosition pos_5_1[] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_LFE1,
+    GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT
+  };
+  GstAudioChannelPosition pos_7_1[] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_CENTER,
+    GST_AUDIO_CHANNEL_POSITION_LFE1,
+    GST_AUDIO_CHANNEL_POSITION_REAR_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT,
+    GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT
+  };
+  GstAudioChannelPosition pos_stereo[] = {
+    GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+    GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT
+  };
+  GstAudioChannelMixerFlags planar =
+      GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_IN |
+      GST_AUDIO_CHANNEL_MIXER_FLAGS_NON_INTERLEAVED_OUT;
+  GstAudioChannelMixer *keep;
+  gint16 out[8 * CACHED_FRAMES];
+
+  /* keep the 5.1 downmix matrix in the cache across the caps changes */
+  keep = gst_audio_channel_mixer_new (0, GST_AUDIO_FORMAT_F32, 6, pos_5_1,
+      2, pos_stereo);
+
+  check_positions_mixer (0, 6, pos_5_1, 2, pos_stereo, out);
+  /* other channel layouts, then back to 5.1 with the cached matrix */
+  check_positions_mixer (0, 8, pos_7_1, 2, pos_stereo, out);
+  check_positions_mixer (0, 2, pos_stereo, 6, pos_5_1, out);
+  check_positions_mixer (planar, 6, pos_5_1, 2, pos_stereo, out);
+  check_positions_mixer (0, 6, pos_5_1, 2, pos_stereo, out);
+
+  /* and with a matrix that is set up again once the cache is empty */
+  gst_audio_channel_mixer_free (keep);
+  check_positions_mixer (planar, 6, pos_5_1, 2, pos_stereo, out);
+}
+
+GST_END_TEST;
+
+#define FUSED_FRAMES 1027
+
+static GstAudioConverter *
+make_fused_test_converter (GstAudioFormat in_format,
+    GstAudioFormat out_format, GstAudioLayout out_layout,
+    GstAudioDitherMethod dither, GstAudioNoiseShapingMethod ns, gfloat gain)
+{
+  GstAudioInfo in_info, out_info;
+  GstStructure *config;
+
+  gst_audio_info_set_format (&in_info, in_format, 48000, 2, NULL);
+  gst_audio_info_set_format (&out_info, out_format, 48000, 2, NULL);
+  out_info.layout = out_layout;
+
+  config = gst_structure_new ("GstAudioConverter",
+      GST_AUDIO_CONVERTER_OPT_DITHER_METHOD, GST_TYPE_AUDIO_DITHER_METHOD,
+      dither, GST_AUDIO_CONVERTER_OPT_NOISE_SHAPING_METHOD,
+      GST_TYPE_AUDIO_NOISE_SHAPING_METHOD, ns, NULL);
+
+  if (gain != 1.0f) {
+    GValue matrix = G_VALUE_INIT;
+    gint i, j;
+
+    g_value_init (&matrix, GST_TYPE_ARRAY);
+    for (i = 0; i < 2; i++) {
+      GValue row = G_VALUE_INIT;
+
+      g_value_init (&row, GST_TYPE_ARRAY);
+      for (j = 0; j < 2; j++) {
+        GValue v = G_VALUE_INIT;
+
+        g_value_init (&v, G_TYPE_FLOAT);
+        g_value_set_float (&v, i == j ? gain : 0.0f);
+        gst_value_array_append_and_take_value (&row, &v);
+      }
+      gst_value_array_append_and_take_value (&matrix, &row);
+    }
+    gst_structure_take_value (config, GST_AUDIO_CONVERTER_OPT_MIX_MATRIX,
+        &matrix);
+  }
+
+  return gst_audio_converter_new (GST_AUDIO_CONVERTER_FLAG_NONE, &in_info,
+      &out_info, config);
+}
+
+/* Converts @in with the single pass conversion, which is only used when
+ * input and output layout are the same, and with the generic conversion
+ * to non-interleaved output. The generic output is interleaved again in
+ * @generic_out. */
+static void
+run_fused_test_conversion (GstAudioFormat in_format,
+    GstAudioFormat out_format, GstAudioDitherMethod dither,
+    GstAudioNoiseShapingMethod ns, gfloat gain, gpointer in,
+    gpointer fused_out, gpointer generic_out)
+{
+  GstAudioConverter *convert;
+  gint bpf = GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info
+      (out_format)) / 8;
+  guint8 *planar, *g = generic_out;
+  gpointer in_p[1], out_p[2];
+  gint i, c;
+
+  convert = make_fused_test_converter (in_format, out_format,
+      GST_AUDIO_LAYOUT_INTERLEAVED, dither, ns, gain);
+  fail_unless (convert != NULL);
+  in_p[0] = in;
+  out_p[0] = fused_out;
+  fail_unless (gst_audio_converter_samples (convert, 0, in_p, FUSED_FRAMES,
+          out_p, FUSED_FRAMES));
+  gst_audio_converter_free (convert);
+
+  convert = make_fused_test_converter (in_format, out_format,
+      GST_AUDIO_LAYOUT_NON_INTERLEAVED, dither, ns, gain);
+  fail_unless (convert != NULL);
+  planar = g_malloc (2 * FUSED_FRAMES * bpf);
+  out_p[0] = planar;
+  out_p[1] = planar + FUSED_FRAMES * bpf;
+  fail_unless (gst_audio_converter_samples (convert, 0, in_p, FUSED_FRAMES,
+          out_p, FUSED_FRAMES));
+  gst_audio_converter_free (convert);
+
+  for (i = 0; i < FUSED_FRAMES; i++) {
+    for (c = 0; c < 2; c++)
+      memcpy (g + (i * 2 + c) * bpf, (guint8 *) out_p[c] + i * bpf, bpf);
+  }
+  g_free (planar);
+}
+
+GST_START_TEST (test_audio_converter_fused)
+{
+  gint16 s16[2 * FUSED_FRAMES], s16_fused[2 * FUSED_FRAMES];
+  gint16 s16_generic[2 * FUSED_FRAMES], s16_plain[2 * FUSED_FRAMES];
+  gfloat f32[2 * FUSED_FRAMES], f32_fused[2 * FUSED_FRAMES];
+  gfloat f32_generic[2 * FUSED_FRAMES];
+  gint i;
+
+  for (i = 0; i < 2 * FUSED_FRAMES; i++) {
+    s16[i] = (i * 4099) % 65536 - 32768;
+    /* a bit outside of [-1.0, 1.0] to hit the clipping */
+    f32[i] = s16[i] / 30000.0f + (i % 7) / 65536.0f;
+  }
+
+  /* S16 -> F32 is exact on both paths */
+  run_fused_test_conversion (GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32,
+      GST_AUDIO_DITHER_NONE, GST_AUDIO_NOISE_SHAPING_NONE, 1.0f, s16,
+      f32_fused, f32_generic);
+  for (i = 0; i < 2 * FUSED_FRAMES; i++)
+    fail_unless_equals_float (f32_fused[i], f32_generic[i]);
+
+  run_fused_test_conversion (GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32,
+      GST_AUDIO_DITHER_NONE, GST_AUDIO_NOISE_SHAPING_NONE, 0.5f, s16,
+      f32_fused, f32_generic);
+  for (i = 0; i < 2 * FUSED_FRAMES; i++)
+    fail_unless_equals_float (f32_fused[i], f32_generic[i]);
+
+  /* F32 -> S16 may round halfway cases differently */
+  run_fused_test_conversion (GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S16,
+      GST_AUDIO_DITHER_NONE, GST_AUDIO_NOISE_SHAPING_NONE, 1.0f, f32,
+      s16_fused, s16_generic);
+  for (i = 0; i < 2 * FUSED_FRAMES; i++)
+    fail_unless (ABS (s16_fused[i] - s16_generic[i]) <= 1,
+        "sample %d: %d != %d", i, s16_fused[i], s16_generic[i]);
+
+  /* both add their own TPDF noise of up to +/- 1 LSB */
+  run_fused_test_conversion (GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S16,
+      GST_AUDIO_DITHER_TPDF, GST_AUDIO_NOISE_SHAPING_NONE, 1.0f, f32,
+      s16_fused, s16_generic);
+  for (i = 0; i < 2 * FUSED_FRAMES; i++)
+    fail_unless (ABS (s16_fused[i] - s16_generic[i]) <= 3,
+        "sample %d: %d != %d", i, s16_fused[i], s16_generic[i]);
+
+  /* noise shaping has no single pass conversion, both outputs come from the
+   * same quantizer and have to be equal. They also differ from the output
+   * without noise shaping. */
+  run_fused_test_conversion (GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S16,
+      GST_AUDIO_DITHER_NONE, GST_AUDIO_NOISE_SHAPING_ERROR_FEEDBACK, 1.0f, f32,
+      s16_fused, s16_generic);
+  for (i = 0; i < 2 * FUSED_FRAMES; i++)
+    fail_unless_equals_int (s16_fused[i], s16_generic[i]);
+
+  run_fused_test_conversion (GST_AUDIO_FORMAT_F32, GST_AUDIO_FORMAT_S16,
+      GST_AUDIO_DITHER_NONE, GST_AUDIO_NOISE_SHAPING_NONE, 1.0f, f32,
+      s16_plain, s16_generic);
+  fail_unless (memcmp (s16_fused, s16_plain, sizeof (s16_plain)) != 0);
+}
+
+GST_END_TEST;
+
+#define RESAMPLER_CHANNELS 3
+#define RESAMPLER_CHUNK 480
+#define RESAMPLER_N_CHUNKS 4
+#define RESAMPLER_FRAMES (RESAMPLER_CHUNK * RESAMPLER_N_CHUNKS)
+
+static GstAudioResampler *
+make_test_resampler (GstAudioFormat format, gint channels,
+    GstAudioResamplerFilterMode mode,
+    GstAudioResamplerFilterInterpolation interpolation)
+{
+  GstAudioResampler *resampler;
+  GstStructure *options;
+
+  options = gst_structure_new_empty ("GstAudioResampler.options");
+  gst_audio_resampler_options_set_quality (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_QUALITY_DEFAULT, 44100, 48000, options);
+  gst_structure_set (options,
+      GST_AUDIO_RESAMPLER_OPT_FILTER_MODE, GST_TYPE_AUDIO_RESAMPLER_FILTER_MODE,
+      mode, GST_AUDIO_RESAMPLER_OPT_FILTER_INTERPOLATION,
+      GST_TYPE_AUDIO_RESAMPLER_FILTER_INTERPOLATION, interpolation, NULL);
+
+  resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_FLAG_NONE, format, channels, 44100, 48000, options);
+  fail_unless (resampler != NULL);
+  gst_structure_free (options);
+
+  return resampler;
+}
+
+/* Resamples the interleaved frames of @in in chunks and returns the number
+ * of frames written to @out */
+static gsize
+run_test_resampler (GstAudioResampler * resampler, guint8 * in, guint8 * out,
+    gint bpf)
+{
+  gsize n_out = 0;
+  guint i;
+
+  for (i = 0; i < RESAMPLER_N_CHUNKS; i++) {
+    gpointer in_p[1] = { in + i * RESAMPLER_CHUNK * bpf };
+    gpointer out_p[1] = { out + n_out * bpf };
+    gsize out_frames;
+
+    out_frames = gst_audio_resampler_get_out_frames (resampler,
+        RESAMPLER_CHUNK);
+    gst_audio_resampler_resample (resampler, in_p, RESAMPLER_CHUNK, out_p,
+        out_frames);
+    n_out += out_frames;
+  }
+  fail_unless (n_out <= 2 * RESAMPLER_FRAMES);
+
+  return n_out;
+}
+
+/* With more than one channel, the resampler may use a function that handles
+ * all channels of an output frame at once. Its output has to be the one of
+ * resampling every channel on its own. */
+static void
+check_resampler_channels (GstAudioFormat format,
+    GstAudioResamplerFilterMode mode,
+    GstAudioResamplerFilterInterpolation interpolation)
+{
+  gint bps = GST_AUDIO_FORMAT_INFO_WIDTH (gst_audio_format_get_info
+      (format)) / 8;
+  GstAudioResampler *resampler;
+  guint8 *in, *out, *in_c, *out_c;
+  gsize n_out, n_out_c;
+  guint i;
+  gint c;
+
+  in = g_malloc (RESAMPLER_FRAMES * RESAMPLER_CHANNELS * bps);
+  out = g_malloc (2 * RESAMPLER_FRAMES * RESAMPLER_CHANNELS * bps);
+  in_c = g_malloc (RESAMPLER_FRAMES * bps);
+  out_c = g_malloc (2 * RESAMPLER_FRAMES * bps);
+
+  /* a different pseudo random signal in [-0.5, 0.5) for every channel */
+  for (i = 0; i < RESAMPLER_FRAMES * RESAMPLER_CHANNELS; i++) {
+    gdouble v = ((i * 2654435761u) >> 16) / 65536.0 - 0.5;
+
+    if (format == GST_AUDIO_FORMAT_S16)
+      ((gint16 *) in)[i] = v * 32767;
+    else
+      ((gfloat *) in)[i] = v;
+  }
+
+  resampler = make_test_resampler (format, RESAMPLER_CHANNELS, mode,
+      interpolation);
+  n_out = run_test_resampler (resampler, in, out, RESAMPLER_CHANNELS * bps);
+  gst_audio_resampler_free (resampler);
+
+  for (c = 0; c < RESAMPLER_CHANNELS; c++) {
+    for (i = 0; i < RESAMPLER_FRAMES; i++)
+      memcpy (in_c + i * bps, in + (i * RESAMPLER_CHANNELS + c) * bps, bps);
+
+    resampler = make_test_resampler (format, 1, mode, interpolation);
+    n_out_c = run_test_resampler (resampler, in_c, out_c, bps);
+    gst_audio_resampler_free (resampler);
+    fail_unless_equals_int (n_out_c, n_out);
+
+    for (i = 0; i < n_out; i++) {
+      if (format == GST_AUDIO_FORMAT_S16) {
+        fail_unless_equals_int (((gint16 *) out)[i * RESAMPLER_CHANNELS + c],
+            ((gint16 *) out_c)[i]);
+      } else {
+        gfloat a = ((gfloat *) out)[i * RESAMPLER_CHANNELS + c];
+        gfloat b = ((gfloat *) out_c)[i];
+
+        fail_unless (ABS (a - b) <= 1e-6, "channel %d frame %u: %f != %f", c,
+            i, a, b);
+      }
+    }
+  }
+
+  g_free (in);
+  g_free (out);
+  g_free (in_c);
+  g_free (out_c);
+}
+
+GST_START_TEST (test_audio_resampler_channels)
+{
+  static const GstAudioFormat formats[] = {
+    GST_AUDIO_FORMAT_S16, GST_AUDIO_FORMAT_F32
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++) {
+    check_resampler_channels (formats[i],
+        GST_AUDIO_RESAMPLER_FILTER_MODE_FULL,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_NONE);
+    check_resampler_channels (formats[i],
+        GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_LINEAR);
+    check_resampler_channels (formats[i],
+        GST_AUDIO_RESAMPLER_FILTER_MODE_INTERPOLATED,
+        GST_AUDIO_RESAMPLER_FILTER_INTERPOLATION_CUBIC);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 audio_suite (void)
 {
@@ -1718,6 +2431,11 @@ audio_suite (void)
   tcase_add_test (tc_chain, test_audio_make_raw_caps);
   tcase_add_test (tc_chain, test_audio_meta_serialize);
   tcase_add_test (tc_chain, test_audio_meta_serialize_65_chans);
+  tcase_add_test (tc_chain, test_channel_mixer_downmix);
+  tcase_add_test (tc_chain, test_channel_mixer_shapes);
+  tcase_add_test (tc_chain, test_channel_mixer_cached_matrix);
+  tcase_add_test (tc_chain, test_audio_converter_fused);
+  tcase_add_test (tc_chain, test_audio_resampler_channels);
 
   return s;
 }
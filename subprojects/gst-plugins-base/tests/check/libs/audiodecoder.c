@@ -1136,6 +1136,228 @@ GST_START_TEST (audiodecoder_plc_on_gap_event_with_delay)
 
 GST_END_TEST;
 
+#define BATCH_FRAMES 4
+
+static guint batch_sizes[NUM_BUFFERS];
+static guint n_batches;
+
+static GstFlowReturn
+_batch_audio_decoder_parse (GstAudioDecoder * dec, GstAdapter * adapter,
+    gint * offset, gint * length)
+{
+  if (gst_adapter_available (adapter) < sizeof (guint64))
+    return GST_FLOW_EOS;
+
+  *offset = 0;
+  *length = sizeof (guint64);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+_batch_audio_decoder_handle_frame_list (GstAudioDecoder * dec,
+    GstBufferList * frames)
+{
+  guint i, len = gst_buffer_list_length (frames);
+  GstBuffer *output_buffer;
+  guint8 *data;
+
+  fail_unless (len > 0 && len <= BATCH_FRAMES);
+  fail_unless (n_batches < NUM_BUFFERS);
+  batch_sizes[n_batches++] = len;
+
+  /* one stereo S32LE sample per frame, all merged into a single buffer */
+  data = g_malloc (len * sizeof (guint64));
+  for (i = 0; i < len; i++) {
+    GstBuffer *frame = gst_buffer_list_get (frames, i);
+
+    fail_unless_equals_int (gst_buffer_get_size (frame), sizeof (guint64));
+    gst_buffer_extract (frame, 0, data + i * sizeof (guint64),
+        sizeof (guint64));
+  }
+  output_buffer = gst_buffer_new_wrapped (data, len * sizeof (guint64));
+
+  return gst_audio_decoder_finish_frame (dec, output_buffer, len);
+}
+
+GST_START_TEST (audiodecoder_batch_decode)
+{
+  GstAudioDecoderClass *klass;
+  GstBuffer *buffer;
+  guint64 *data;
+  guint64 i, num = 0;
+
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+
+  klass = GST_AUDIO_DECODER_CLASS (GST_AUDIO_DECODER_GET_CLASS (h->element));
+  klass->parse = _batch_audio_decoder_parse;
+  klass->handle_frame_list = _batch_audio_decoder_handle_frame_list;
+  gst_audio_decoder_set_max_batch_frames (GST_AUDIO_DECODER (h->element),
+      BATCH_FRAMES);
+  n_batches = 0;
+
+  /* a single input buffer holding all frames */
+  data = g_new (guint64, NUM_BUFFERS);
+  for (i = 0; i < NUM_BUFFERS; i++)
+    data[i] = i;
+  buffer = gst_buffer_new_wrapped (data, NUM_BUFFERS * sizeof (guint64));
+  GST_BUFFER_PTS (buffer) = 0;
+  GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale_round (NUM_BUFFERS,
+      GST_SECOND, TEST_MSECS_PER_SAMPLE);
+  fail_unless (gst_harness_push (h, buffer) == GST_FLOW_OK);
+
+  /* frames were handed over in batches of at most BATCH_FRAMES */
+  fail_unless_equals_int (n_batches, 3);
+  fail_unless_equals_int (batch_sizes[0], BATCH_FRAMES);
+  fail_unless_equals_int (batch_sizes[1], BATCH_FRAMES);
+  fail_unless_equals_int (batch_sizes[2], NUM_BUFFERS - 2 * BATCH_FRAMES);
+
+  /* and each batch resulted in one output buffer */
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 3);
+  while ((buffer = gst_harness_try_pull (h))) {
+    GstMapInfo map;
+    gsize frames;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    frames = map.size / sizeof (guint64);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (num, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    for (i = 0; i < frames; i++)
+      fail_unless_equals_uint64 (((guint64 *) map.data)[i], num++);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+  fail_unless_equals_uint64 (num, NUM_BUFFERS);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* packetized input without parse vfunc, one frame per input buffer */
+GST_START_TEST (audiodecoder_batch_decode_packetized)
+{
+  GstAudioDecoderClass *klass;
+  GstBuffer *buffer;
+  guint64 i, num = 0;
+
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+
+  klass = GST_AUDIO_DECODER_CLASS (GST_AUDIO_DECODER_GET_CLASS (h->element));
+  klass->parse = NULL;
+  klass->handle_frame_list = _batch_audio_decoder_handle_frame_list;
+  gst_audio_decoder_set_max_batch_frames (GST_AUDIO_DECODER (h->element),
+      BATCH_FRAMES);
+  n_batches = 0;
+
+  /* frames are only held back in non-live pipelines, here for up to 3 */
+  gst_harness_set_live (h, FALSE);
+  g_object_set (h->element, "min-latency",
+      (gint64) 3 * gst_util_uint64_scale_round (1, GST_SECOND,
+          TEST_MSECS_PER_SAMPLE), NULL);
+
+  /* frames are collected across input buffers until min-latency is reached */
+  for (i = 0; i < 2; i++)
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+  fail_unless_equals_int (n_batches, 0);
+  for (; i < 7; i++)
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+  fail_unless_equals_int (n_batches, 2);
+  fail_unless_equals_int (batch_sizes[0], 3);
+  fail_unless_equals_int (batch_sizes[1], 3);
+
+  /* a discont hands over what was collected before it */
+  buffer = create_test_buffer (i++);
+  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+  fail_unless (gst_harness_push (h, buffer) == GST_FLOW_OK);
+  fail_unless_equals_int (n_batches, 3);
+  fail_unless_equals_int (batch_sizes[2], 1);
+
+  /* and so does EOS */
+  fail_unless (gst_harness_push (h, create_test_buffer (i++)) ==
+      GST_FLOW_OK);
+  fail_unless_equals_int (n_batches, 3);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (n_batches, 4);
+  fail_unless_equals_int (batch_sizes[3], 2);
+
+  /* all data came out in order */
+  while ((buffer = gst_harness_try_pull (h))) {
+    GstMapInfo map;
+    gsize frames;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    frames = map.size / sizeof (guint64);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (num, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    for (i = 0; i < frames; i++)
+      fail_unless_equals_uint64 (((guint64 *) map.data)[i], num++);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+  fail_unless_equals_uint64 (num, 9);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+_count_buffer_lists (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  guint *n_lists = user_data;
+
+  *n_lists += 1;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (audiodecoder_output_buffer_list)
+{
+  GstBuffer *buffer;
+  guint64 i;
+  guint n_lists = 0;
+
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+
+  /* output aggregation is only done in non-live pipelines */
+  gst_harness_set_live (h, FALSE);
+  g_object_set (h->element, "output-buffer-list", TRUE, "min-latency",
+      (gint64) (NUM_BUFFERS / 2) * gst_util_uint64_scale_round (1, GST_SECOND,
+          TEST_MSECS_PER_SAMPLE), NULL);
+  gst_pad_add_probe (GST_AUDIO_DECODER_SRC_PAD (h->element),
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, _count_buffer_lists, &n_lists, NULL);
+
+  for (i = 0; i < NUM_BUFFERS; i++)
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+
+  /* pushed once the collected duration exceeds min-latency */
+  fail_unless_equals_int (n_lists, 1);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h),
+      NUM_BUFFERS / 2 + 1);
+
+  /* remainder is sent on EOS */
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (n_lists, 2);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), NUM_BUFFERS);
+
+  /* buffers are passed as-is rather than merged */
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    GstMapInfo map;
+
+    buffer = gst_harness_pull (h);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, sizeof (guint64));
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (i, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_audiodecoder_suite (void)
 {
@@ -1166,6 +1388,10 @@ gst_audiodecoder_suite (void)
   tcase_add_test (tc, audiodecoder_plc_on_gap_event);
   tcase_add_test (tc, audiodecoder_plc_on_gap_event_with_delay);
 
+  tcase_add_test (tc, audiodecoder_batch_decode);
+  tcase_add_test (tc, audiodecoder_batch_decode_packetized);
+  tcase_add_test (tc, audiodecoder_output_buffer_list);
+
   return s;
 }
 
@@ -27,6 +27,10 @@
 #include <gst/check/gstcheck.h>
 #include <gst/audio/gstaudiosink.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #define GST_TYPE_AUDIO_FOO_SINK           (gst_audio_foo_sink_get_type())
 #define GST_AUDIO_FOO_SINK(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_AUDIO_FOO_SINK,GstAudioFooSink))
 #define GST_AUDIO_FOO_SINK_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_AUDIO_FOO_SINK,GstAudioFooSinkClass))
@@ -43,6 +47,12 @@ struct _GstAudioFooSink
   GstAudioSink parent;
 
   guint num_clear_all_call;
+
+  /* fake device */
+  GMutex lock;
+  GCond cond;
+  GByteArray *written;
+  guint max_written;
 };
 
 struct _GstAudioFooSinkClass
@@ -61,22 +71,89 @@ gst_audio_foo_sink_clear_all (GstAudioSink * sink)
   self->num_clear_all_call++;
 }
 
+static gboolean
+gst_audio_foo_sink_prepare (GstAudioSink * sink, GstAudioRingBufferSpec * spec)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_audio_foo_sink_unprepare (GstAudioSink * sink)
+{
+  return TRUE;
+}
+
+static gint
+gst_audio_foo_sink_write (GstAudioSink * sink, gpointer data, guint length)
+{
+  GstAudioFooSink *self = GST_AUDIO_FOO_SINK (sink);
+  gboolean full;
+
+  g_mutex_lock (&self->lock);
+  full = self->written->len >= self->max_written;
+  if (!full) {
+    g_byte_array_append (self->written, data, length);
+    g_cond_signal (&self->cond);
+  }
+  g_mutex_unlock (&self->lock);
+
+  /* don't spin once we have everything we want */
+  if (full)
+    g_usleep (G_USEC_PER_SEC / 1000);
+
+  return length;
+}
+
+static guint
+gst_audio_foo_sink_delay (GstAudioSink * sink)
+{
+  return 0;
+}
+
 static void
-gst_audio_foo_sink_init (GstAudioFooSink * src)
+gst_audio_foo_sink_reset (GstAudioSink * sink)
 {
 }
 
+static void
+gst_audio_foo_sink_init (GstAudioFooSink * self)
+{
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  self->written = g_byte_array_new ();
+}
+
+static void
+gst_audio_foo_sink_finalize (GObject * object)
+{
+  GstAudioFooSink *self = GST_AUDIO_FOO_SINK (object);
+
+  g_mutex_clear (&self->lock);
+  g_cond_clear (&self->cond);
+  g_byte_array_unref (self->written);
+
+  G_OBJECT_CLASS (gst_audio_foo_sink_parent_class)->finalize (object);
+}
+
 static void
 gst_audio_foo_sink_class_init (GstAudioFooSinkClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
   GstAudioSinkClass *audiosink_class = GST_AUDIO_SINK_CLASS (klass);
 
+  gobject_class->finalize = gst_audio_foo_sink_finalize;
+
   gst_element_class_add_static_pad_template (element_class, &sink_template);
   gst_element_class_set_metadata (element_class,
       "AudioFooSink", "Sink/Audio",
       "Audio Sink Unit Test element", "Foo Bar <foo@bar.com>");
 
+  audiosink_class->prepare = gst_audio_foo_sink_prepare;
+  audiosink_class->unprepare = gst_audio_foo_sink_unprepare;
+  audiosink_class->write = gst_audio_foo_sink_write;
+  audiosink_class->delay = gst_audio_foo_sink_delay;
+  audiosink_class->reset = gst_audio_foo_sink_reset;
   audiosink_class->extension->clear_all = gst_audio_foo_sink_clear_all;
 }
 
@@ -107,6 +184,221 @@ GST_START_TEST (test_class_extension)
 
 GST_END_TEST;
 
+#define SEGTOTAL 4
+
+static GstAudioRingBuffer *
+acquire_ringbuffer (GstAudioFooSink * foosink, gboolean shared)
+{
+  GstAudioRingBuffer *ringbuffer;
+  GstCaps *caps;
+
+  fail_unless (gst_element_set_state (GST_ELEMENT (foosink),
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS);
+
+  ringbuffer = GST_AUDIO_BASE_SINK (foosink)->ringbuffer;
+  fail_unless (ringbuffer != NULL);
+
+  gst_audio_ring_buffer_set_spsc (ringbuffer, TRUE);
+  fail_unless (gst_audio_ring_buffer_is_spsc (ringbuffer));
+  if (shared && !gst_audio_ring_buffer_set_shared (ringbuffer, TRUE))
+    return NULL;
+
+  /* 4 segments of 10ms */
+  caps = gst_caps_from_string ("audio/x-raw, format=(string)S16LE, "
+      "layout=(string)interleaved, rate=(int)48000, channels=(int)2");
+  ringbuffer->spec.latency_time = 10000;
+  ringbuffer->spec.buffer_time = SEGTOTAL * 10000;
+  fail_unless (gst_audio_ring_buffer_parse_caps (&ringbuffer->spec, caps));
+  gst_caps_unref (caps);
+
+  fail_unless (gst_audio_ring_buffer_acquire (ringbuffer, &ringbuffer->spec));
+  fail_unless_equals_int (ringbuffer->spec.segtotal, SEGTOTAL);
+
+  fail_unless (gst_audio_ring_buffer_activate (ringbuffer, TRUE));
+  gst_audio_ring_buffer_set_flushing (ringbuffer, FALSE);
+  gst_audio_ring_buffer_may_start (ringbuffer, TRUE);
+
+  return ringbuffer;
+}
+
+static void
+release_ringbuffer (GstAudioFooSink * foosink, GstAudioRingBuffer * ringbuffer)
+{
+  fail_unless (gst_audio_ring_buffer_stop (ringbuffer));
+  fail_unless (gst_audio_ring_buffer_activate (ringbuffer, FALSE));
+  fail_unless (gst_audio_ring_buffer_release (ringbuffer));
+
+  gst_element_set_state (GST_ELEMENT (foosink), GST_STATE_NULL);
+}
+
+GST_START_TEST (test_spsc_prepare_write)
+{
+  GstAudioFooSink *foosink;
+  GstAudioRingBuffer *ringbuffer;
+  gint segsize, segment, len, i, j;
+  guint8 *writeptr;
+
+  foosink = g_object_new (GST_TYPE_AUDIO_FOO_SINK, NULL);
+  ringbuffer = acquire_ringbuffer (foosink, FALSE);
+  segsize = ringbuffer->spec.segsize;
+
+  /* write all segments in place, each filled with its index + 1 */
+  for (i = 0; i < SEGTOTAL; i++) {
+    fail_unless (gst_audio_ring_buffer_prepare_write (ringbuffer, &segment,
+            &writeptr, &len));
+    fail_unless_equals_int (segment, i);
+    fail_unless_equals_int (len, segsize);
+    fail_unless (writeptr == ringbuffer->memory + i * segsize);
+
+    memset (writeptr, i + 1, len / 2);
+    gst_audio_ring_buffer_advance_write (ringbuffer, len / 2);
+
+    fail_unless (gst_audio_ring_buffer_prepare_write (ringbuffer, &segment,
+            &writeptr, &len));
+    fail_unless_equals_int (segment, i);
+    fail_unless_equals_int (len, segsize - segsize / 2);
+
+    memset (writeptr, i + 1, len);
+    gst_audio_ring_buffer_advance_write (ringbuffer, len);
+  }
+
+  /* the ringbuffer is full */
+  fail_if (gst_audio_ring_buffer_prepare_write (ringbuffer, &segment,
+          &writeptr, &len));
+
+  /* play the written segments and as many that were not written */
+  g_mutex_lock (&foosink->lock);
+  foosink->max_written = 2 * SEGTOTAL * segsize;
+  g_mutex_unlock (&foosink->lock);
+
+  fail_unless (gst_audio_ring_buffer_start (ringbuffer));
+
+  g_mutex_lock (&foosink->lock);
+  while (foosink->written->len < foosink->max_written)
+    g_cond_wait (&foosink->cond, &foosink->lock);
+  g_mutex_unlock (&foosink->lock);
+
+  for (i = 0; i < 2 * SEGTOTAL; i++) {
+    guint8 expected = i < SEGTOTAL ? i + 1 : 0;
+
+    for (j = 0; j < segsize; j++)
+      fail_unless_equals_int (foosink->written->data[i * segsize + j],
+          expected);
+  }
+
+  /* the data that was played stays in the ringbuffer */
+  fail_unless_equals_int (ringbuffer->memory[0], 1);
+
+  /* the reader overtook the writer, which continues at the read position */
+  fail_unless (gst_audio_ring_buffer_prepare_write (ringbuffer, &segment,
+          &writeptr, &len));
+  fail_unless_equals_int (len, segsize);
+
+  release_ringbuffer (foosink, ringbuffer);
+  gst_object_unref (foosink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_spsc_commit)
+{
+  GstAudioFooSink *foosink;
+  GstAudioRingBuffer *ringbuffer;
+  gint16 *samples;
+  guint64 sample;
+  gint segsize, sps, accum = 0, i;
+
+  foosink = g_object_new (GST_TYPE_AUDIO_FOO_SINK, NULL);
+  ringbuffer = acquire_ringbuffer (foosink, FALSE);
+  segsize = ringbuffer->spec.segsize;
+  sps = ringbuffer->samples_per_seg;
+
+  /* fill the whole ringbuffer with garbage from a previous pass */
+  memset (ringbuffer->memory, 0x55, ringbuffer->size);
+
+  /* one segment and a half of data, starting at a quarter of the first
+   * segment */
+  samples = g_new (gint16, 2 * (sps + sps / 2));
+  for (i = 0; i < 2 * (sps + sps / 2); i++)
+    samples[i] = 1000;
+
+  sample = sps / 4;
+  fail_unless_equals_int (gst_audio_ring_buffer_commit (ringbuffer, &sample,
+          (guint8 *) samples, sps + sps / 2, sps + sps / 2, &accum),
+      sps + sps / 2);
+  g_free (samples);
+
+  g_mutex_lock (&foosink->lock);
+  foosink->max_written = SEGTOTAL * segsize;
+  g_mutex_unlock (&foosink->lock);
+
+  fail_unless (gst_audio_ring_buffer_start (ringbuffer));
+
+  g_mutex_lock (&foosink->lock);
+  while (foosink->written->len < foosink->max_written)
+    g_cond_wait (&foosink->cond, &foosink->lock);
+  g_mutex_unlock (&foosink->lock);
+
+  /* silence before and after the data, never the old contents */
+  for (i = 0; i < SEGTOTAL * sps; i++) {
+    gint16 *s = (gint16 *) foosink->written->data + 2 * i;
+    gint16 expected = (i >= sps / 4 && i < sps / 4 + sps + sps / 2) ? 1000 : 0;
+
+    fail_unless_equals_int (s[0], expected);
+    fail_unless_equals_int (s[1], expected);
+  }
+
+  release_ringbuffer (foosink, ringbuffer);
+  gst_object_unref (foosink);
+}
+
+GST_END_TEST;
+
+#ifdef HAVE_MMAP
+GST_START_TEST (test_shared_memory)
+{
+  GstAudioFooSink *foosink;
+  GstAudioRingBuffer *ringbuffer;
+  gint segment, len, fd;
+  guint8 *writeptr, *map;
+
+  foosink = g_object_new (GST_TYPE_AUDIO_FOO_SINK, NULL);
+  ringbuffer = acquire_ringbuffer (foosink, TRUE);
+  if (ringbuffer == NULL) {
+    GST_INFO ("shared memory not supported");
+    gst_element_set_state (GST_ELEMENT (foosink), GST_STATE_NULL);
+    gst_object_unref (foosink);
+    return;
+  }
+
+  fd = gst_audio_ring_buffer_get_memory_fd (ringbuffer);
+  fail_unless (fd >= 0);
+
+  map = mmap (NULL, ringbuffer->size, PROT_READ, MAP_SHARED, fd, 0);
+  fail_unless (map != MAP_FAILED);
+
+  /* the ringbuffer starts out as silence */
+  fail_unless_equals_int (map[0], 0);
+
+  fail_unless (gst_audio_ring_buffer_prepare_write (ringbuffer, &segment,
+          &writeptr, &len));
+  memset (writeptr, 0x42, len);
+  gst_audio_ring_buffer_advance_write (ringbuffer, len);
+
+  /* visible through the other mapping */
+  fail_unless_equals_int (map[0], 0x42);
+  fail_unless_equals_int (map[len - 1], 0x42);
+  fail_unless_equals_int (map[len], 0);
+
+  munmap (map, ringbuffer->size);
+
+  release_ringbuffer (foosink, ringbuffer);
+  fail_unless_equals_int (gst_audio_ring_buffer_get_memory_fd (ringbuffer), -1);
+  gst_object_unref (foosink);
+}
+
+GST_END_TEST;
+#endif
 
 static Suite *
 audiosink_suite (void)
@@ -116,6 +408,11 @@ audiosink_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_class_extension);
+  tcase_add_test (tc_chain, test_spsc_prepare_write);
+  tcase_add_test (tc_chain, test_spsc_commit);
+#ifdef HAVE_MMAP
+  tcase_add_test (tc_chain, test_shared_memory);
+#endif
 
   return s;
 }
@@ -2311,6 +2311,54 @@ GST_START_TEST (rtp_base_payload_extensions_shrink_ext_data)
 
 GST_END_TEST;
 
+/* the header extension block layout is worked out once per input buffer, also
+ * when the packets are pushed as a buffer list */
+GST_START_TEST (rtp_base_payload_multiple_exts_list)
+{
+  GstRTPHeaderExtension *ext1, *ext2;
+  State *state;
+
+  state = create_payloader ("application/x-rtp", &sinktmpl, NULL);
+  ext1 = rtp_dummy_hdr_ext_new ();
+  GST_RTP_DUMMY_HDR_EXT (ext1)->max_size = 5;
+  gst_rtp_header_extension_set_id (ext1, 1);
+  ext2 = rtp_dummy_hdr_ext_new ();
+  GST_RTP_DUMMY_HDR_EXT (ext2)->max_size = 5;
+  gst_rtp_header_extension_set_id (ext2, 2);
+
+  g_signal_emit_by_name (state->element, "add-extension", ext1);
+  g_signal_emit_by_name (state->element, "add-extension", ext2);
+
+  set_state (state, GST_STATE_PLAYING);
+
+  /* the second buffer is pushed as a list by the dummy payloader */
+  push_buffer (state, "pts", 0 * GST_SECOND, NULL);
+  push_buffer (state, "pts", 1 * GST_SECOND, NULL);
+
+  set_state (state, GST_STATE_NULL);
+
+  validate_buffers_received (2);
+
+  /* both extensions wrote a single byte, so the block is one word */
+  validate_buffer (0, "pts", 0 * GST_SECOND, "size", (gsize) 20, "ext-data",
+      (guint) 0xBEDE, (gsize) 4, NULL);
+  validate_buffer (1, "pts", 1 * GST_SECOND, "size", (gsize) 20, "ext-data",
+      (guint) 0xBEDE, (gsize) 4, NULL);
+
+  validate_events_received (3);
+
+  validate_normal_start_events (0);
+
+  fail_unless_equals_int (GST_RTP_DUMMY_HDR_EXT (ext1)->write_count, 2);
+  fail_unless_equals_int (GST_RTP_DUMMY_HDR_EXT (ext2)->write_count, 2);
+
+  gst_object_unref (ext1);
+  gst_object_unref (ext2);
+  destroy_payloader (state);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (rtp_base_payload_extensions_get_enabled)
 {
   GstElement *pay = GST_ELEMENT (rtp_dummy_pay_new ());
@@ -2413,6 +2461,7 @@ rtp_basepayloading_suite (void)
   tcase_add_test (tc_chain, rtp_base_payload_caps_request_ignored);
   tcase_add_test (tc_chain, rtp_base_payload_extensions_in_output_caps);
   tcase_add_test (tc_chain, rtp_base_payload_extensions_shrink_ext_data);
+  tcase_add_test (tc_chain, rtp_base_payload_multiple_exts_list);
   tcase_add_test (tc_chain, rtp_base_payload_extensions_get_enabled);
   tcase_add_test (tc_chain, rtp_base_payload_extensions_notify_on_change);
 
@@ -31,6 +31,10 @@
 #include <gst/gst.h>
 #include <gst/audio/gstaudiofilter.h>
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "audiofxbasefirfilter.h"
 
 #define GST_CAT_DEFAULT gst_audio_fx_base_fir_filter_debug
@@ -50,11 +54,13 @@ enum
 {
   PROP_0 = 0,
   PROP_LOW_LATENCY,
-  PROP_DRAIN_ON_CHANGES
+  PROP_DRAIN_ON_CHANGES,
+  PROP_PARTITION_SIZE
 };
 
 #define DEFAULT_LOW_LATENCY FALSE
 #define DEFAULT_DRAIN_ON_CHANGES TRUE
+#define DEFAULT_PARTITION_SIZE 0
 
 #define gst_audio_fx_base_fir_filter_parent_class parent_class
 G_DEFINE_TYPE (GstAudioFXBaseFIRFilter, gst_audio_fx_base_fir_filter,
@@ -362,6 +368,196 @@ DEFINE_FFT_PROCESS_FUNC_FIXED_CHANNELS (64, 2, double);
 #undef DEFINE_FFT_PROCESS_FUNC
 #undef DEFINE_FFT_PROCESS_FUNC_FIXED_CHANNELS
 
+/* acc += x * h for the spectra of one input block and one kernel partition.
+ * h holds { r, r, -i, i } for every frequency so that this needs no
+ * shuffling of the kernel spectrum. */
+static inline void
+complex_mac (GstFFTF64Complex * acc, const GstFFTF64Complex * x,
+    const gdouble * h, guint len)
+{
+  guint i;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  for (i = 0; i < len; i++) {
+    __m128d xv = _mm_loadu_pd (&x[i].r);
+    __m128d xs = _mm_shuffle_pd (xv, xv, 1);
+    __m128d a = _mm_loadu_pd (&acc[i].r);
+
+    a = _mm_add_pd (a, _mm_mul_pd (xv, _mm_loadu_pd (h + 4 * i)));
+    a = _mm_add_pd (a, _mm_mul_pd (xs, _mm_loadu_pd (h + 4 * i + 2)));
+    _mm_storeu_pd (&acc[i].r, a);
+  }
+#else
+  for (i = 0; i < len; i++) {
+    gdouble re = x[i].r, im = x[i].i;
+
+    acc[i].r += re * h[4 * i] + im * h[4 * i + 2];
+    acc[i].i += im * h[4 * i + 1] + re * h[4 * i + 3];
+  }
+#endif
+}
+
+/* This implements uniformly partitioned FFT convolution, again with the
+ * overlap-save algorithm.
+ *
+ * The kernel is split into P partitions of B samples each and the input is
+ * processed in blocks of B samples. Every FFT has a length N >= 2 * B and
+ * covers the newest input block plus the N - B samples before it. With
+ * X_k being the spectrum of input block k and H_p the spectrum of kernel
+ * partition p this calculates for every block
+ *
+ * y = IFFT (\sum_{p=0}^{P-1} X_{k-p} * H_p)
+ *
+ * of which the last B samples are the output for block k. The spectra of
+ * the last P input blocks are kept in a frequency-domain delay line, so
+ * every block needs one FFT and one inverse FFT per channel, independent
+ * of the kernel length.
+ *
+ * The latency is B samples instead of the ~3 * M of the single block
+ * convolution above, at the cost of P complex multiply-accumulates per
+ * frequency. The delay line of all channels is processed partition by
+ * partition, so that each kernel partition is loaded once per block.
+ */
+#define DEFINE_PARTITIONED_PROCESS_FUNC(width,ctype) \
+static guint \
+process_partitioned_##width (GstAudioFXBaseFIRFilter * self, \
+    const g##ctype * src, g##ctype * dst, guint input_samples) \
+{ \
+  gint channels = GST_AUDIO_FILTER_CHANNELS (self); \
+  PARTITIONED_CONVOLUTION_BODY (channels); \
+}
+
+#define DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS(width,channels,ctype) \
+static guint \
+process_partitioned_##channels##_##width (GstAudioFXBaseFIRFilter * self, \
+    const g##ctype * src, g##ctype * dst, guint input_samples) \
+{ \
+  PARTITIONED_CONVOLUTION_BODY (channels); \
+}
+
+#define PARTITIONED_CONVOLUTION_BODY(channels) G_STMT_START { \
+  gint i, j; \
+  guint p, pass; \
+  guint block_length = self->block_length; \
+  guint partition_size = self->partition_size; \
+  guint partitions = self->partitions; \
+  guint frequency_response_length = self->frequency_response_length; \
+  guint buffer_fill = self->buffer_fill; \
+  guint fdl_pos; \
+  GstFFTF64 *fft = self->fft; \
+  GstFFTF64 *ifft = self->ifft; \
+  GstFFTF64Complex *fdl = self->fdl; \
+  GstFFTF64Complex *fft_buffer = self->fft_buffer; \
+  gdouble *buffer = self->buffer; \
+  gdouble *ifft_out; \
+  guint generated = 0; \
+  \
+  /* Buffer contains the last block_length time domain samples of every \
+   * channel, followed by space for the inverse FFT. New input is put at \
+   * offset block_length - partition_size. */ \
+  if (!buffer) { \
+    self->buffer_length = block_length; \
+    self->buffer = buffer = g_new0 (gdouble, block_length * (channels + 1)); \
+    self->buffer_fill = buffer_fill = 0; \
+    \
+    g_free (self->fdl); \
+    self->fdl = fdl = NULL; \
+    g_free (self->fft_buffer); \
+    self->fft_buffer = fft_buffer = NULL; \
+  } \
+  if (!fdl) { \
+    self->fdl = fdl = g_new0 (GstFFTF64Complex, \
+        partitions * channels * frequency_response_length); \
+    self->fdl_pos = 0; \
+  } \
+  if (!fft_buffer) \
+    self->fft_buffer = fft_buffer = \
+        g_new (GstFFTF64Complex, channels * frequency_response_length); \
+  \
+  g_assert (self->buffer_length == block_length); \
+  \
+  fdl_pos = self->fdl_pos; \
+  ifft_out = buffer + block_length * channels; \
+  \
+  while (input_samples) { \
+    pass = MIN (partition_size - buffer_fill, input_samples); \
+    \
+    /* Deinterleave channels */ \
+    for (i = 0; i < pass; i++) { \
+      for (j = 0; j < channels; j++) { \
+        buffer[block_length * j + block_length - partition_size + \
+            buffer_fill + i] = src[i * channels + j]; \
+      } \
+    } \
+    buffer_fill += pass; \
+    src += channels * pass; \
+    input_samples -= pass; \
+    \
+    /* If we don't have a complete block go out */ \
+    if (buffer_fill < partition_size) \
+      break; \
+    \
+    /* Calculate the FFT of the newest input block and make room for the \
+     * next one */ \
+    for (j = 0; j < channels; j++) { \
+      gst_fft_f64_fft (fft, buffer + block_length * j, \
+          fdl + (fdl_pos * channels + j) * frequency_response_length); \
+      memmove (buffer + block_length * j, \
+          buffer + block_length * j + partition_size, \
+          (block_length - partition_size) * sizeof (gdouble)); \
+    } \
+    \
+    /* Multiply-accumulate the delay line with the kernel partitions */ \
+    memset (fft_buffer, 0, \
+        channels * frequency_response_length * sizeof (GstFFTF64Complex)); \
+    for (p = 0; p < partitions; p++) { \
+      guint slot = (fdl_pos + partitions - p) % partitions; \
+      const gdouble *h = \
+          self->partition_response + 4 * p * frequency_response_length; \
+      \
+      for (j = 0; j < channels; j++) { \
+        complex_mac (fft_buffer + j * frequency_response_length, \
+            fdl + (slot * channels + j) * frequency_response_length, h, \
+            frequency_response_length); \
+      } \
+    } \
+    \
+    /* Calculate the inverse FFT and copy the valid part to the output */ \
+    for (j = 0; j < channels; j++) { \
+      gst_fft_f64_inverse_fft (ifft, \
+          fft_buffer + j * frequency_response_length, ifft_out); \
+      for (i = 0; i < partition_size; i++) { \
+        dst[i * channels + j] = \
+            ifft_out[block_length - partition_size + i]; \
+      } \
+    } \
+    \
+    fdl_pos = (fdl_pos + 1) % partitions; \
+    generated += partition_size; \
+    dst += channels * partition_size; \
+    buffer_fill = 0; \
+  } \
+  \
+  /* Write back cached values */ \
+  self->buffer_fill = buffer_fill; \
+  self->fdl_pos = fdl_pos; \
+  \
+  return generated; \
+} G_STMT_END
+
+DEFINE_PARTITIONED_PROCESS_FUNC (32, float);
+DEFINE_PARTITIONED_PROCESS_FUNC (64, double);
+
+DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS (32, 1, float);
+DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS (64, 1, double);
+
+DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS (32, 2, float);
+DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS (64, 2, double);
+
+#undef PARTITIONED_CONVOLUTION_BODY
+#undef DEFINE_PARTITIONED_PROCESS_FUNC
+#undef DEFINE_PARTITIONED_PROCESS_FUNC_FIXED_CHANNELS
+
 /* Element class */
 static void
     gst_audio_fx_base_fir_filter_calculate_frequency_response
@@ -375,8 +571,56 @@ static void
   self->frequency_response_length = 0;
   g_free (self->fft_buffer);
   self->fft_buffer = NULL;
+  g_free (self->partition_response);
+  self->partition_response = NULL;
 
   if (self->kernel && self->kernel_length >= FFT_THRESHOLD
+      && !self->low_latency && self->partition_size > 0) {
+    guint block_length, partitions, i, p;
+    gdouble *kernel_tmp;
+    GstFFTF64Complex *spectrum;
+
+    block_length = gst_fft_next_fast_length (2 * self->partition_size);
+    partitions = (self->kernel_length + self->partition_size - 1) /
+        self->partition_size;
+
+    /* The spectra of previous input blocks are only useful as long as the
+     * partitioning stays the same */
+    if (block_length != self->block_length || partitions != self->partitions) {
+      g_free (self->fdl);
+      self->fdl = NULL;
+    }
+    self->block_length = block_length;
+    self->partitions = partitions;
+
+    self->fft = gst_fft_f64_new (block_length, FALSE);
+    self->ifft = gst_fft_f64_new (block_length, TRUE);
+    self->frequency_response_length = block_length / 2 + 1;
+    self->partition_response =
+        g_new (gdouble, 4 * partitions * self->frequency_response_length);
+
+    kernel_tmp = g_new (gdouble, block_length);
+    spectrum = g_new (GstFFTF64Complex, self->frequency_response_length);
+    for (p = 0; p < partitions; p++) {
+      guint offset = p * self->partition_size;
+      guint len = MIN (self->partition_size, self->kernel_length - offset);
+      gdouble *h =
+          self->partition_response + 4 * p * self->frequency_response_length;
+
+      memset (kernel_tmp, 0, block_length * sizeof (gdouble));
+      memcpy (kernel_tmp, self->kernel + offset, len * sizeof (gdouble));
+      gst_fft_f64_fft (self->fft, kernel_tmp, spectrum);
+
+      /* Normalize to make sure IFFT(FFT(x)) == x */
+      for (i = 0; i < self->frequency_response_length; i++) {
+        h[4 * i] = h[4 * i + 1] = spectrum[i].r / block_length;
+        h[4 * i + 2] = -spectrum[i].i / block_length;
+        h[4 * i + 3] = spectrum[i].i / block_length;
+      }
+    }
+    g_free (spectrum);
+    g_free (kernel_tmp);
+  } else if (self->kernel && self->kernel_length >= FFT_THRESHOLD
       && !self->low_latency) {
     guint block_length, i;
     gdouble *kernel_tmp, *kernel = self->kernel;
@@ -403,6 +647,12 @@ static void
       self->frequency_response[i].i /= block_length;
     }
   }
+
+  if (!self->partition_response) {
+    self->partitions = 0;
+    g_free (self->fdl);
+    self->fdl = NULL;
+  }
 }
 
 /* Must be called with base transform lock! */
@@ -412,7 +662,17 @@ gst_audio_fx_base_fir_filter_select_process_function (GstAudioFXBaseFIRFilter *
 {
   switch (format) {
     case GST_AUDIO_FORMAT_F32:
-      if (self->fft && !self->low_latency) {
+      if (self->partitions > 0 && !self->low_latency) {
+        if (channels == 1)
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_1_32;
+        else if (channels == 2)
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_2_32;
+        else
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_32;
+      } else if (self->fft && !self->low_latency) {
         if (channels == 1)
           self->process = (GstAudioFXBaseFIRFilterProcessFunc) process_fft_1_32;
         else if (channels == 2)
@@ -429,7 +689,17 @@ gst_audio_fx_base_fir_filter_select_process_function (GstAudioFXBaseFIRFilter *
       }
       break;
     case GST_AUDIO_FORMAT_F64:
-      if (self->fft && !self->low_latency) {
+      if (self->partitions > 0 && !self->low_latency) {
+        if (channels == 1)
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_1_64;
+        else if (channels == 2)
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_2_64;
+        else
+          self->process =
+              (GstAudioFXBaseFIRFilterProcessFunc) process_partitioned_64;
+      } else if (self->fft && !self->low_latency) {
         if (channels == 1)
           self->process = (GstAudioFXBaseFIRFilterProcessFunc) process_fft_1_64;
         else if (channels == 2)
@@ -462,6 +732,8 @@ gst_audio_fx_base_fir_filter_finalize (GObject * object)
   gst_fft_f64_free (self->ifft);
   g_free (self->frequency_response);
   g_free (self->fft_buffer);
+  g_free (self->partition_response);
+  g_free (self->fdl);
   g_mutex_clear (&self->lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -502,6 +774,27 @@ gst_audio_fx_base_fir_filter_set_property (GObject * object, guint prop_id,
       g_mutex_unlock (&self->lock);
       break;
     }
+    case PROP_PARTITION_SIZE:{
+      guint partition_size;
+
+      if (GST_STATE (self) >= GST_STATE_PAUSED) {
+        g_warning ("Changing the \"partition-size\" property "
+            "is only allowed in states < PAUSED");
+        return;
+      }
+
+      g_mutex_lock (&self->lock);
+      partition_size = g_value_get_uint (value);
+
+      if (self->partition_size != partition_size) {
+        self->partition_size = partition_size;
+        gst_audio_fx_base_fir_filter_calculate_frequency_response (self);
+        gst_audio_fx_base_fir_filter_select_process_function (self,
+            GST_AUDIO_FILTER_FORMAT (self), GST_AUDIO_FILTER_CHANNELS (self));
+      }
+      g_mutex_unlock (&self->lock);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -521,6 +814,9 @@ gst_audio_fx_base_fir_filter_get_property (GObject * object, guint prop_id,
     case PROP_DRAIN_ON_CHANGES:
       g_value_set_boolean (value, self->drain_on_changes);
       break;
+    case PROP_PARTITION_SIZE:
+      g_value_set_uint (value, self->partition_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -569,6 +865,24 @@ gst_audio_fx_base_fir_filter_class_init (GstAudioFXBaseFIRFilterClass * klass)
           DEFAULT_DRAIN_ON_CHANGES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioFXBaseFIRFilter:partition-size:
+   *
+   * Split long filter kernels into partitions of this many samples and
+   * convolve them in the frequency domain one partition at a time. The
+   * latency is then the partition size plus the pre-latency of the filter,
+   * independent of the kernel length. 0 processes the whole kernel in one
+   * block of about four times its length.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_PARTITION_SIZE,
+      g_param_spec_uint ("partition-size", "Partition size",
+          "Size in samples of the kernel partitions for partitioned FFT "
+          "convolution (0 = single block). "
+          "Can only be changed in states < PAUSED!", 0, 1 << 20,
+          DEFAULT_PARTITION_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   caps = gst_caps_from_string (ALLOWED_CAPS);
   gst_audio_filter_class_add_pad_templates (GST_AUDIO_FILTER_CLASS (klass),
       caps);
@@ -602,6 +916,7 @@ gst_audio_fx_base_fir_filter_init (GstAudioFXBaseFIRFilter * self)
 
   self->low_latency = DEFAULT_LOW_LATENCY;
   self->drain_on_changes = DEFAULT_DRAIN_ON_CHANGES;
+  self->partition_size = DEFAULT_PARTITION_SIZE;
 
   g_mutex_init (&self->lock);
 }
@@ -669,7 +984,8 @@ gst_audio_fx_base_fir_filter_push_residue (GstAudioFXBaseFIRFilter * self)
     gst_buffer_map (outbuf, &map, GST_MAP_READWRITE);
 
     while (gensamples < outsamples) {
-      guint step_insamples = self->block_length - self->buffer_fill;
+      guint step_insamples = (self->partitions > 0 ?
+          self->partition_size : self->block_length) - self->buffer_fill;
       guint8 *zeroes = g_new0 (guint8, step_insamples * channels * bps);
       guint8 *out = g_new (guint8, self->block_length * channels * bps);
       guint step_gensamples;
@@ -677,8 +993,8 @@ gst_audio_fx_base_fir_filter_push_residue (GstAudioFXBaseFIRFilter * self)
       step_gensamples = self->process (self, zeroes, out, step_insamples);
       g_free (zeroes);
 
-      memcpy (map.data + gensamples * bps, out, MIN (step_gensamples,
-              outsamples - gensamples) * bps);
+      memcpy (map.data + gensamples * channels * bps, out,
+          MIN (step_gensamples, outsamples - gensamples) * channels * bps);
       gensamples += MIN (step_gensamples, outsamples - gensamples);
 
       g_free (out);
@@ -777,7 +1093,10 @@ gst_audio_fx_base_fir_filter_transform_size (GstBaseTransform * base,
   bpf = GST_AUDIO_INFO_BPF (&info);
 
   size /= bpf;
-  blocklen = self->block_length - self->kernel_length + 1;
+  if (self->partitions > 0)
+    blocklen = self->partition_size;
+  else
+    blocklen = self->block_length - self->kernel_length + 1;
   *othersize = ((size + blocklen - 1) / blocklen) * blocklen;
   *othersize *= bpf;
 
@@ -972,7 +1291,9 @@ gst_audio_fx_base_fir_filter_query (GstBaseTransform * trans,
             GST_TIME_FORMAT " max %" GST_TIME_FORMAT,
             GST_TIME_ARGS (min), GST_TIME_ARGS (max));
 
-        if (self->fft && !self->low_latency)
+        if (self->partitions > 0 && !self->low_latency)
+          latency = self->partition_size;
+        else if (self->fft && !self->low_latency)
           latency = self->block_length - self->kernel_length + 1;
         else
           latency = self->latency;
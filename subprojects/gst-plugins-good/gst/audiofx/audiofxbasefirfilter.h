@@ -65,6 +65,9 @@ struct _GstAudioFXBaseFIRFilter {
   gboolean drain_on_changes;    /* If the filter should be drained when
                                  * coefficients change */
 
+  guint partition_size;         /* partition size for partitioned FFT
+                                 * convolution, 0 to use a single block */
+
   /* < private > */
   GstAudioFXBaseFIRFilterProcessFunc process;
 
@@ -80,6 +83,12 @@ struct _GstAudioFXBaseFIRFilter {
   GstFFTF64Complex *fft_buffer;          /* FFT buffer, has the length of the frequency response */
   guint block_length;                    /* Length of the processing blocks -- time domain */
 
+  /* Partitioned FFT convolution specific data */
+  guint partitions;                      /* number of kernel partitions */
+  gdouble *partition_response;           /* spectra of the kernel partitions */
+  GstFFTF64Complex *fdl;                 /* spectra of the last input blocks of all channels */
+  guint fdl_pos;                         /* slot of the newest input block in fdl */
+
   GstClockTime start_ts;        /* start timestamp after a discont */
   guint64 start_off;            /* start offset after a discont */
   guint64 nsamples_out;         /* number of output samples since last discont */
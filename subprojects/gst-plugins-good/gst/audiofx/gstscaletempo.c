@@ -53,7 +53,8 @@
  * for the best overlap position.  Scaletempo uses a statistical cross
  * correlation (roughly a dot-product).  Scaletempo consumes most of its CPU
  * cycles here. One can use the #GstScaletempo:search propery to tune how far
- * the algorithm looks.
+ * the algorithm looks. The search runs on the sum of all channels, and uses
+ * an FFT based cross correlation when the search window is large.
  *
  * Scaletempo also supports an alternative mode where a scaling factor is dynamically
  * selected to scale input data down to the duration of the input buffers.
@@ -81,6 +82,10 @@
 
 #include "gstscaletempo.h"
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_scaletempo_debug);
 #define GST_CAT_DEFAULT gst_scaletempo_debug
 
@@ -150,89 +155,164 @@ gst_scaletempo_mode_get_type (void)
   return id;
 }
 
-#define CREATE_BEST_OVERLAP_OFFSET_FLOAT_FUNC(type) \
-static guint \
-best_overlap_offset_##type (GstScaletempo * st) \
+/* The overlap search correlates a single F32 signal, the sum of all channels,
+ * instead of every channel separately. This makes the search cost
+ * independent of the number of channels and lets S16 and F64 input share the
+ * F32 kernels; the converted samples are only produced once per stride. */
+#define CREATE_DOWNMIX_FUNC(type) \
+static void \
+downmix_##type (GstScaletempo * st, gfloat * dest, gconstpointer src, \
+    guint frames) \
 { \
-  g##type *pw, *po, *ppc, *search_start; \
-  g##type best_corr = G_MININT; \
-  guint best_off = 0; \
-  gint i, off; \
+  const g##type *ps = src; \
+  guint i, c, nch = st->samples_per_frame; \
   \
-  pw = st->table_window; \
-  po = st->buf_overlap; \
-  po += st->samples_per_frame; \
-  ppc = st->buf_pre_corr; \
-  for (i = st->samples_per_frame; i < st->samples_overlap; i++) { \
-    *ppc++ = *pw++ * *po++; \
-  } \
-  \
-  search_start = (g##type *) st->buf_queue + st->samples_per_frame; \
-  for (off = 0; off < st->frames_search; off++) { \
-    g##type corr = 0; \
-    g##type *ps = search_start; \
-    ppc = st->buf_pre_corr; \
-    for (i = st->samples_per_frame; i < st->samples_overlap; i++) { \
-      corr += *ppc++ * *ps++; \
-    } \
-    if (corr > best_corr) { \
-      best_corr = corr; \
-      best_off = off; \
+  if (nch == 1) { \
+    for (i = 0; i < frames; i++) \
+      dest[i] = ps[i]; \
+  } else if (nch == 2) { \
+    for (i = 0; i < frames; i++, ps += 2) \
+      dest[i] = (gfloat) ps[0] + (gfloat) ps[1]; \
+  } else { \
+    for (i = 0; i < frames; i++) { \
+      gfloat sum = 0; \
+      for (c = 0; c < nch; c++) \
+        sum += *ps++; \
+      dest[i] = sum; \
     } \
-    search_start += st->samples_per_frame; \
   } \
-  \
-  return best_off * st->bytes_per_frame; \
 }
 
-CREATE_BEST_OVERLAP_OFFSET_FLOAT_FUNC (float);
-CREATE_BEST_OVERLAP_OFFSET_FLOAT_FUNC (double);
+CREATE_DOWNMIX_FUNC (int16);
+CREATE_DOWNMIX_FUNC (float);
+CREATE_DOWNMIX_FUNC (double);
+
+static inline gfloat
+dot_product_float (const gfloat * a, const gfloat * b, guint len)
+{
+  gfloat corr = 0;
+  guint i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  __m128 acc0 = _mm_setzero_ps ();
+  __m128 acc1 = _mm_setzero_ps ();
+  gfloat r[4];
+
+  for (; i + 8 <= len; i += 8) {
+    acc0 = _mm_add_ps (acc0,
+        _mm_mul_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i)));
+    acc1 = _mm_add_ps (acc1,
+        _mm_mul_ps (_mm_loadu_ps (a + i + 4), _mm_loadu_ps (b + i + 4)));
+  }
+  _mm_storeu_ps (r, _mm_add_ps (acc0, acc1));
+  corr = (r[0] + r[1]) + (r[2] + r[3]);
+#endif
+
+  for (; i < len; i++)
+    corr += a[i] * b[i];
+
+  return corr;
+}
 
-/* buffer padding for loop optimization: sizeof(gint32) * (loop_size - 1) */
-#define UNROLL_PADDING (4*3)
 static guint
-best_overlap_offset_s16 (GstScaletempo * st)
+best_offset_direct (GstScaletempo * st, const gfloat * proxy, guint n_corr)
 {
-  gint32 *pw, *ppc;
-  gint16 *po, *search_start;
-  gint64 best_corr = G_MININT64;
+  gfloat best_corr = -G_MAXFLOAT;
   guint best_off = 0;
   guint off;
-  glong i;
-
-  pw = st->table_window;
-  po = st->buf_overlap;
-  po += st->samples_per_frame;
-  ppc = st->buf_pre_corr;
-  for (i = st->samples_per_frame; i < st->samples_overlap; i++) {
-    *ppc++ = (*pw++ * *po++) >> 15;
-  }
 
-  search_start = (gint16 *) st->buf_queue + st->samples_per_frame;
   for (off = 0; off < st->frames_search; off++) {
-    gint64 corr = 0;
-    gint16 *ps = search_start;
-    ppc = st->buf_pre_corr;
-    ppc += st->samples_overlap - st->samples_per_frame;
-    ps += st->samples_overlap - st->samples_per_frame;
-    i = -((glong) st->samples_overlap - (glong) st->samples_per_frame);
-    do {
-      corr += ppc[i + 0] * ps[i + 0];
-      corr += ppc[i + 1] * ps[i + 1];
-      corr += ppc[i + 2] * ps[i + 2];
-      corr += ppc[i + 3] * ps[i + 3];
-      i += 4;
-    } while (i < 0);
+    gfloat corr = dot_product_float (st->buf_pre_corr, proxy + off, n_corr);
+
     if (corr > best_corr) {
       best_corr = corr;
       best_off = off;
     }
-    search_start += st->samples_per_frame;
   }
 
+  return best_off;
+}
+
+/* correlation as the product of the spectrum of the proxy with the conjugate
+ * spectrum of the windowed overlap. fft_len covers the whole proxy, so none
+ * of the searched offsets wraps around. */
+static guint
+best_offset_fft (GstScaletempo * st, const gfloat * proxy, guint n_corr)
+{
+  GstFFTF32Complex *fp = st->fft_freq_pre, *fx = st->fft_freq_proxy;
+  guint proxy_len = st->frames_search + n_corr - 1;
+  gfloat best_corr = -G_MAXFLOAT;
+  guint best_off = 0;
+  guint i;
+
+  memcpy (st->fft_buf, st->buf_pre_corr, n_corr * sizeof (gfloat));
+  memset (st->fft_buf + n_corr, 0, (st->fft_len - n_corr) * sizeof (gfloat));
+  gst_fft_f32_fft (st->fft, st->fft_buf, fp);
+
+  memcpy (st->fft_buf, proxy, proxy_len * sizeof (gfloat));
+  memset (st->fft_buf + proxy_len, 0,
+      (st->fft_len - proxy_len) * sizeof (gfloat));
+  gst_fft_f32_fft (st->fft, st->fft_buf, fx);
+
+  for (i = 0; i < st->fft_len / 2 + 1; i++) {
+    gfloat re = fx[i].r * fp[i].r + fx[i].i * fp[i].i;
+    gfloat im = fx[i].i * fp[i].r - fx[i].r * fp[i].i;
+
+    fx[i].r = re;
+    fx[i].i = im;
+  }
+  gst_fft_f32_inverse_fft (st->ifft, fx, st->fft_buf);
+
+  for (i = 0; i < st->frames_search; i++) {
+    if (st->fft_buf[i] > best_corr) {
+      best_corr = st->fft_buf[i];
+      best_off = i;
+    }
+  }
+
+  return best_off;
+}
+
+static guint
+best_overlap_offset (GstScaletempo * st)
+{
+  guint n_corr = st->samples_overlap / st->samples_per_frame - 1;
+  const gfloat *proxy;
+  guint i, best_off;
+
+  /* the first frame of the overlap has a weight of 0 and is skipped */
+  st->downmix (st, st->buf_pre_corr,
+      (gint8 *) st->buf_overlap + st->bytes_per_frame, n_corr);
+  for (i = 0; i < n_corr; i++)
+    st->buf_pre_corr[i] *= st->table_window[i];
+
+  if (st->samples_per_frame == 1 && st->format == GST_AUDIO_FORMAT_F32) {
+    proxy = (gfloat *) (st->buf_queue + st->bytes_per_frame);
+  } else {
+    st->downmix (st, st->buf_proxy, st->buf_queue + st->bytes_per_frame,
+        st->frames_search + n_corr - 1);
+    proxy = st->buf_proxy;
+  }
+
+  if (st->fft)
+    best_off = best_offset_fft (st, proxy, n_corr);
+  else
+    best_off = best_offset_direct (st, proxy, n_corr);
+
   return best_off * st->bytes_per_frame;
 }
 
+static void
+free_fft (GstScaletempo * st)
+{
+  g_clear_pointer (&st->fft, gst_fft_f32_free);
+  g_clear_pointer (&st->ifft, gst_fft_f32_free);
+  g_clear_pointer (&st->fft_buf, g_free);
+  g_clear_pointer (&st->fft_freq_pre, g_free);
+  g_clear_pointer (&st->fft_freq_proxy, g_free);
+  st->fft_len = 0;
+}
+
 #define CREATE_OUTPUT_OVERLAP_FLOAT_FUNC(type) \
 static void \
 output_overlap_##type (GstScaletempo * st, gpointer buf_out, guint bytes_off) \
@@ -377,46 +457,42 @@ reinit_buffers (GstScaletempo * st)
   if (st->frames_search < 1) {  /* if no search */
     st->best_overlap_offset = NULL;
   } else {
-    /* S16 uses gint32 buffer, floats/doubles use their respective type */
-    guint bytes_pre_corr =
-        (st->samples_overlap - st->samples_per_frame) * (st->format ==
-        GST_AUDIO_FORMAT_S16 ? 4 : st->bytes_per_sample);
-    st->buf_pre_corr =
-        g_realloc (st->buf_pre_corr, bytes_pre_corr + UNROLL_PADDING);
-    st->table_window = g_realloc (st->table_window, bytes_pre_corr);
-    if (st->format == GST_AUDIO_FORMAT_S16) {
-      gint64 t = frames_overlap;
-      gint32 n = 8589934588LL / (t * t);        /* 4 * (2^31 - 1) / t^2 */
-      gint32 *pw;
-
-      memset ((guint8 *) st->buf_pre_corr + bytes_pre_corr, 0, UNROLL_PADDING);
-      pw = st->table_window;
-      for (i = 1; i < frames_overlap; i++) {
-        gint32 v = (i * (t - i) * n) >> 15;
-        for (j = 0; j < st->samples_per_frame; j++) {
-          *pw++ = v;
-        }
-      }
-      st->best_overlap_offset = best_overlap_offset_s16;
-    } else if (st->format == GST_AUDIO_FORMAT_F32) {
-      gfloat *pw = st->table_window;
-      for (i = 1; i < frames_overlap; i++) {
-        gfloat v = i * (frames_overlap - i);
-        for (j = 0; j < st->samples_per_frame; j++) {
-          *pw++ = v;
-        }
+    guint n_corr = frames_overlap - 1;
+    guint proxy_len = st->frames_search + n_corr - 1;
+    guint fft_len;
+
+    st->buf_pre_corr = g_renew (gfloat, st->buf_pre_corr, n_corr);
+    st->table_window = g_renew (gfloat, st->table_window, n_corr);
+    st->buf_proxy = g_renew (gfloat, st->buf_proxy, proxy_len);
+    for (i = 1; i < frames_overlap; i++)
+      st->table_window[i - 1] = i * (frames_overlap - i);
+
+    if (st->format == GST_AUDIO_FORMAT_S16)
+      st->downmix = downmix_int16;
+    else if (st->format == GST_AUDIO_FORMAT_F32)
+      st->downmix = downmix_float;
+    else
+      st->downmix = downmix_double;
+
+    /* three transforms of length N beat the direct correlation once
+     * n_corr * frames_search exceeds about 16 * N * log2 (N) */
+    fft_len = gst_fft_next_fast_length (proxy_len);
+    if ((guint64) n_corr * st->frames_search >
+        (guint64) 16 * fft_len * g_bit_storage (fft_len)) {
+      if (fft_len != st->fft_len) {
+        free_fft (st);
+        st->fft_len = fft_len;
+        st->fft = gst_fft_f32_new (fft_len, FALSE);
+        st->ifft = gst_fft_f32_new (fft_len, TRUE);
+        st->fft_buf = g_new (gfloat, fft_len);
+        st->fft_freq_pre = g_new (GstFFTF32Complex, fft_len / 2 + 1);
+        st->fft_freq_proxy = g_new (GstFFTF32Complex, fft_len / 2 + 1);
       }
-      st->best_overlap_offset = best_overlap_offset_float;
     } else {
-      gdouble *pw = st->table_window;
-      for (i = 1; i < frames_overlap; i++) {
-        gdouble v = i * (frames_overlap - i);
-        for (j = 0; j < st->samples_per_frame; j++) {
-          *pw++ = v;
-        }
-      }
-      st->best_overlap_offset = best_overlap_offset_double;
+      free_fft (st);
     }
+
+    st->best_overlap_offset = best_overlap_offset;
   }
 
   new_size =
@@ -838,6 +914,9 @@ gst_scaletempo_stop (GstBaseTransform * trans)
   scaletempo->buf_pre_corr = NULL;
   g_free (scaletempo->table_window);
   scaletempo->table_window = NULL;
+  g_free (scaletempo->buf_proxy);
+  scaletempo->buf_proxy = NULL;
+  free_fft (scaletempo);
   scaletempo->reinit_buffers = TRUE;
 
   return TRUE;
@@ -23,6 +23,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
+#include <gst/fft/gstfftf32.h>
 
 G_BEGIN_DECLS
 
@@ -89,12 +90,20 @@ struct _GstScaletempo
   gpointer table_blend;
   void (*output_overlap) (GstScaletempo * scaletempo, gpointer out_buf, guint bytes_off);
 
-  /* best overlap */
+  /* best overlap, searched on a mono F32 downmix of the input */
   guint frames_search;
-  gpointer buf_pre_corr;
-  gpointer table_window;
+  gfloat *buf_pre_corr;
+  gfloat *table_window;
+  gfloat *buf_proxy;
+  void (*downmix) (GstScaletempo * scaletempo, gfloat * dest, gconstpointer src, guint frames);
   guint (*best_overlap_offset) (GstScaletempo * scaletempo);
 
+  /* FFT cross correlation for large search windows */
+  GstFFTF32 *fft, *ifft;
+  guint fft_len;
+  gfloat *fft_buf;
+  GstFFTF32Complex *fft_freq_pre, *fft_freq_proxy;
+
   /* gstreamer */
   GstSegment in_segment, out_segment;
   GstClockTime latency;
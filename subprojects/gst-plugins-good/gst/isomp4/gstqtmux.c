@@ -115,7 +115,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_qt_mux_debug);
  *  - a 'mfra' box for Fragmented MP4, which is written at the end and
  *    contains a summary of all fragments and seek tables.
  *
- * Currently mp4mux can work in 4 different modes / generate 4 types
+ * Currently mp4mux can work in 5 different modes / generate 5 types
  * of output files/streams:
  *
  * - Normal mp4: mp4mux will write a little ftyp identifier at the
@@ -146,6 +146,16 @@ GST_DEBUG_CATEGORY_STATIC (gst_qt_mux_debug);
  *   out of the temp file at EOS, which can be expensive. Downstream does
  *   not need to be seekable, because of the use of the temp file.
  *
+ * - Reserved fast-start mp4: if faststart is combined with the
+ *   reserved-max-duration property and downstream is seekable, no temp
+ *   file is used. Like in robust muxing mode, space for the moov is
+ *   estimated from reserved-max-duration and reserved-bytes-per-sec and
+ *   left as a free atom before the mdat, and the sample data is written
+ *   out directly. At EOS the moov is written once into that space. If
+ *   it turns out not to fit, the moov is written after the mdat instead
+ *   and the reserved space stays a free atom, so the file is still
+ *   playable but not fast-start.
+ *
  * - Robust Muxing mode: In this mode, qtmux uses the reserved-max-duration
  *   and reserved-moov-update-period properties to reserve free space
  *   at the start of the file and periodically write the MOOV atom out
@@ -508,7 +518,10 @@ gst_qt_mux_class_init (GstQTMuxClass * klass)
 #endif
   g_object_class_install_property (gobject_class, PROP_FAST_START,
       g_param_spec_boolean ("faststart", "Format file to faststart",
-          "If the file should be formatted for faststart (headers first)",
+          "If the file should be formatted for faststart (headers first). "
+          "With reserved-max-duration set and a seekable downstream, the "
+          "headers are written into reserved space instead of going through "
+          "faststart-file, and the file is only faststart if they fit",
           DEFAULT_FAST_START, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (gobject_class, PROP_FAST_START_TEMP_FILE,
       g_param_spec_string ("faststart-file", "File to use for storing buffers",
@@ -535,7 +548,8 @@ gst_qt_mux_class_init (GstQTMuxClass * klass)
       g_param_spec_uint64 ("reserved-max-duration",
           "Reserved maximum file duration (ns)",
           "When set to a value > 0, reserves space for index tables at the "
-          "beginning of the file.",
+          "beginning of the file. Together with faststart, the headers are "
+          "written after the media data if they outgrow the reserved space.",
           0, G_MAXUINT64, DEFAULT_RESERVED_MAX_DURATION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   g_object_class_install_property (gobject_class,
@@ -3155,7 +3169,24 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
       }
       break;
     case GST_QT_MUX_MODE_FAST_START:
-      break;                    /* Don't need seekability, ignore */
+      /* Don't need seekability, unless the headers should be written into
+       * reserved space instead of going through the temp file */
+      if (reserved_max_duration == GST_CLOCK_TIME_NONE)
+        break;
+      if (reserved_max_duration == 0) {
+        GST_ELEMENT_ERROR (qtmux, STREAM, MUX,
+            ("reserved-max-duration of 0 is not allowed"), (NULL));
+        return GST_FLOW_ERROR;
+      }
+      if (qtmux->downstream_seekable) {
+        qtmux->mux_mode = GST_QT_MUX_MODE_FAST_START_RESERVED;
+      } else {
+        GST_WARNING_OBJECT (qtmux, "downstream is not seekable, can't write "
+            "the headers into reserved space. Using the faststart temp file");
+      }
+      break;
+    case GST_QT_MUX_MODE_FAST_START_RESERVED:
+      break;
     case GST_QT_MUX_MODE_FRAGMENTED:
       if (qtmux->fragment_mode == GST_QT_MUX_FRAGMENT_STREAMABLE)
         break;
@@ -3475,6 +3506,56 @@ gst_qt_mux_start_file (GstQTMux * qtmux)
 
       break;
     }
+    case GST_QT_MUX_MODE_FAST_START_RESERVED:
+    {
+      guint64 size = 0, offset = 0;
+
+      ret = gst_qt_mux_prepare_and_send_ftyp (qtmux);
+      if (ret != GST_FLOW_OK)
+        break;
+
+      /* The moov is written over the reserved space at EOS */
+      qtmux->moov_pos = qtmux->header_size;
+
+      /* Measure the moov before any per-trak sample tables are added and
+       * reserve space for the tables on top of that, like in robust
+       * recording mode */
+      gst_qt_mux_configure_moov (qtmux);
+      gst_qt_mux_setup_metadata (qtmux);
+      if (!atom_moov_copy_data (qtmux->moov, NULL, &size, &offset))
+        goto serialize_error;
+      qtmux->base_moov_size = offset;
+      qtmux->reserved_moov_size = qtmux->base_moov_size +
+          gst_util_uint64_scale (reserved_max_duration,
+          reserved_bytes_per_sec_per_trak *
+          atom_moov_get_trak_count (qtmux->moov), GST_SECOND);
+
+      /* Need space for the moov and the free atom padding it */
+      if (qtmux->reserved_moov_size < qtmux->base_moov_size + 8)
+        goto reserved_moov_too_small;
+
+      GST_DEBUG_OBJECT (qtmux, "reserving header area of size %u",
+          qtmux->reserved_moov_size);
+
+      ret = gst_qt_mux_send_free_atom (qtmux, &qtmux->header_size,
+          qtmux->reserved_moov_size, FALSE);
+      if (ret != GST_FLOW_OK)
+        return ret;
+
+      /* extra atoms go after the reserved moov space, before the mdat */
+      ret =
+          gst_qt_mux_send_extra_atoms (qtmux, TRUE, &qtmux->header_size, FALSE);
+      if (ret != GST_FLOW_OK)
+        return ret;
+
+      qtmux->mdat_pos = qtmux->header_size;
+      /* extended atom in case we go over 4GB while writing and need
+       * the full 64-bit atom */
+      ret =
+          gst_qt_mux_send_mdat_header (qtmux, &qtmux->header_size, 0, TRUE,
+          FALSE);
+      break;
+    }
     case GST_QT_MUX_MODE_FAST_START:
       GST_OBJECT_LOCK (qtmux);
       qtmux->fast_start_file = g_fopen (qtmux->fast_start_file_path, "wb+");
@@ -3543,6 +3624,12 @@ reserved_moov_too_small:
         ("Not enough reserved space for creating headers"), (NULL));
     return GST_FLOW_ERROR;
   }
+serialize_error:
+  {
+    GST_ELEMENT_ERROR (qtmux, STREAM, MUX, (NULL),
+        ("Failed to serialize moov"));
+    return GST_FLOW_ERROR;
+  }
 open_failed:
   {
     GST_ELEMENT_ERROR (qtmux, RESOURCE, OPEN_READ_WRITE,
@@ -4162,6 +4249,46 @@ gst_qt_mux_stop_file (GstQTMux * qtmux)
           qtmux->mdat_size, NULL, FALSE);
       return ret;
     }
+    case GST_QT_MUX_MODE_FAST_START_RESERVED:{
+      gst_qt_mux_configure_moov (qtmux);
+      gst_qt_mux_update_edit_lists (qtmux);
+      gst_qt_mux_setup_metadata (qtmux);
+      /* chunks position is set relative to the first byte of the
+       * MDAT atom payload. Set the overall offset into the file */
+      atom_moov_chunks_set_offset (qtmux->moov, qtmux->header_size);
+
+      /* copy into NULL to obtain size */
+      offset = size = 0;
+      if (!atom_moov_copy_data (qtmux->moov, NULL, &size, &offset))
+        goto serialize_error;
+
+      if (offset + 8 <= qtmux->reserved_moov_size) {
+        GST_DEBUG_OBJECT (qtmux, "writing moov of size %" G_GUINT64_FORMAT
+            " into %u reserved bytes", offset, qtmux->reserved_moov_size);
+        gst_qt_mux_seek_to (qtmux, qtmux->moov_pos);
+        ret =
+            gst_qt_mux_send_moov (qtmux, NULL, qtmux->reserved_moov_size,
+            FALSE, FALSE);
+      } else {
+        /* The reserved space stays a free atom and the file ends up as in
+         * moov-at-end mode, which is still better than failing */
+        GST_ELEMENT_WARNING (qtmux, STREAM, MUX,
+            ("Not enough space reserved for the headers, the file will not "
+                "be faststart"),
+            ("moov of size %" G_GUINT64_FORMAT " does not fit into %u "
+                "reserved bytes, writing it after the mdat. Increase "
+                "reserved-max-duration or reserved-bytes-per-sec", offset,
+                qtmux->reserved_moov_size));
+        ret = gst_qt_mux_send_moov (qtmux, NULL, 0, FALSE, FALSE);
+      }
+      if (ret != GST_FLOW_OK)
+        return ret;
+
+      /* Finalise by writing the final size into the mdat. Up until now
+       * it's been 0, which means 'rest of the file' */
+      return gst_qt_mux_update_mdat_size (qtmux, qtmux->mdat_pos,
+          qtmux->mdat_size, NULL, FALSE);
+    }
     default:
       break;
   }
@@ -4899,6 +5026,7 @@ gst_qt_mux_register_and_push_sample (GstQTMux * qtmux, GstQTMuxPad * pad,
     }
     case GST_QT_MUX_MODE_MOOV_AT_END:
     case GST_QT_MUX_MODE_FAST_START:
+    case GST_QT_MUX_MODE_FAST_START_RESERVED:
     case GST_QT_MUX_MODE_ROBUST_RECORDING:
       atom_trak_add_samples (pad->trak, nsamples, (gint32) scaled_duration,
           sample_size, chunk_offset, sync, pts_offset);
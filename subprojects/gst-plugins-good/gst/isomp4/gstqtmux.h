@@ -206,6 +206,7 @@ typedef enum _GstQtMuxMode {
     GST_QT_MUX_MODE_FAST_START,
     GST_QT_MUX_MODE_ROBUST_RECORDING,
     GST_QT_MUX_MODE_ROBUST_RECORDING_PREFILL,
+    GST_QT_MUX_MODE_FAST_START_RESERVED,
 } GstQtMuxMode;
 
 /**
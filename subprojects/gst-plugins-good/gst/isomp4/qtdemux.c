@@ -88,6 +88,11 @@
 /* if the sample index is larger than this, something is likely wrong */
 #define QTDEMUX_MAX_SAMPLE_INDEX_SIZE (200*1024*1024)
 
+/* pull mode: read the samples of all streams in the next readahead window with
+ * one pull, looking at no more than the given number of samples per stream */
+#define QTDEMUX_READAHEAD_SIZE (512*1024)
+#define QTDEMUX_READAHEAD_MAX_SAMPLES 256
+
 /* For converting qt creation times to unix epoch times */
 #define QTDEMUX_SECONDS_PER_DAY (60 * 60 * 24)
 #define QTDEMUX_LEAP_YEARS_FROM_1904_TO_1970 17
@@ -371,6 +376,8 @@ static GstCaps *qtdemux_generic_caps (GstQTDemux * qtdemux,
 
 static gboolean qtdemux_parse_samples (GstQTDemux * qtdemux,
     QtDemuxStream * stream, guint32 n);
+static gboolean qtdemux_parse_samples_full (GstQTDemux * qtdemux,
+    QtDemuxStream * stream, guint32 n, gboolean post_error);
 static GstFlowReturn qtdemux_expose_streams (GstQTDemux * qtdemux);
 static QtDemuxStream *gst_qtdemux_stream_ref (QtDemuxStream * stream);
 static void gst_qtdemux_stream_unref (QtDemuxStream * stream);
@@ -492,6 +499,7 @@ gst_qtdemux_dispose (GObject * object)
 
   g_clear_object (&qtdemux->adapter);
   gst_clear_tag_list (&qtdemux->tag_list);
+  gst_clear_buffer (&qtdemux->readahead);
   g_clear_pointer (&qtdemux->flowcombiner, gst_flow_combiner_unref);
 
   g_queue_clear_full (&qtdemux->protection_event_queue,
@@ -580,6 +588,96 @@ gst_qtdemux_pull_atom (GstQTDemux * qtdemux, guint64 offset, guint64 size,
   return flow;
 }
 
+/* Find how far to read ahead of the @size bytes at @offset: up to the end of
+ * the last sample of any stream that still fits in the readahead window, so
+ * that interleaved samples are pulled together instead of one by one.
+ *
+ * Returns the end offset of the data to pull */
+static guint64
+gst_qtdemux_plan_readahead (GstQTDemux * qtdemux, guint64 offset, guint size)
+{
+  guint64 end = offset + size;
+  guint64 limit = offset + QTDEMUX_READAHEAD_SIZE;
+  gint i;
+
+  if (size >= QTDEMUX_READAHEAD_SIZE || qtdemux->segment.rate < 0 ||
+      (qtdemux->segment.flags & GST_SEGMENT_FLAG_TRICKMODE_KEY_UNITS))
+    return end;
+
+  for (i = 0; i < QTDEMUX_N_STREAMS (qtdemux); i++) {
+    QtDemuxStream *str = QTDEMUX_NTH_STREAM (qtdemux, i);
+    guint32 index, last;
+
+    if (str->sample_index >= str->n_samples || str->use_allocator ||
+        !GST_CLOCK_TIME_IS_VALID (str->time_position))
+      continue;
+
+    last = MIN (str->n_samples, str->sample_index +
+        QTDEMUX_READAHEAD_MAX_SAMPLES);
+
+    for (index = str->sample_index; index < last; index++) {
+      QtDemuxSample *sample;
+
+      /* don't make a fragmented file look for the next fragment here, and
+       * leave a corrupt sample table to be reported when the stream gets
+       * there */
+      if (index > str->stbl_index && (index + 1 >= str->n_samples ||
+              !qtdemux_parse_samples_full (qtdemux, str, index, FALSE)))
+        break;
+
+      sample = &str->samples[index];
+      if (sample->offset < offset)
+        continue;
+      if (sample->offset + sample->size > limit)
+        break;
+
+      end = MAX (end, sample->offset + sample->size);
+    }
+  }
+
+  return end;
+}
+
+/* Pull @size bytes of sample data at @offset, from the data that was read
+ * ahead if possible. The returned buffer shares the memory of the readahead
+ * buffer. */
+static GstFlowReturn
+gst_qtdemux_pull_sample_data (GstQTDemux * qtdemux, guint64 offset,
+    guint size, GstBuffer ** buf)
+{
+  GstFlowReturn ret;
+  guint64 end;
+
+  if (qtdemux->readahead && offset >= qtdemux->readahead_offset &&
+      offset + size <= qtdemux->readahead_offset +
+      gst_buffer_get_size (qtdemux->readahead))
+    goto done;
+
+  gst_clear_buffer (&qtdemux->readahead);
+
+  end = gst_qtdemux_plan_readahead (qtdemux, offset, size);
+  if (end == offset + size)
+    return gst_qtdemux_pull_atom (qtdemux, offset, size, buf);
+
+  GST_LOG_OBJECT (qtdemux, "reading ahead %" G_GUINT64_FORMAT " bytes @ %"
+      G_GUINT64_FORMAT, end - offset, offset);
+
+  ret = gst_qtdemux_pull_atom (qtdemux, offset, end - offset,
+      &qtdemux->readahead);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    /* e.g. a truncated file, read only what is needed */
+    gst_clear_buffer (&qtdemux->readahead);
+    return gst_qtdemux_pull_atom (qtdemux, offset, size, buf);
+  }
+  qtdemux->readahead_offset = offset;
+
+done:
+  *buf = gst_buffer_copy_region (qtdemux->readahead, GST_BUFFER_COPY_MEMORY,
+      offset - qtdemux->readahead_offset, size);
+
+  return *buf ? GST_FLOW_OK : GST_FLOW_ERROR;
+}
+
 #if 1
 static gboolean
 gst_qtdemux_src_convert (GstQTDemux * qtdemux, GstPad * pad,
@@ -905,6 +1003,51 @@ gst_qtdemux_find_index (GstQTDemux * qtdemux, QtDemuxStream * str,
 
 
 
+/* find the index of the first sample with a DTS after @mov_time by walking
+ * the run-length encoded stts atom, so that the sample table only needs to be
+ * parsed up to there and not sample by sample.
+ *
+ * Returns the index of the sample, or the index of the last sample if all
+ * samples start before @mov_time or the stts has negative durations.
+ */
+static guint32
+qtdemux_stts_find_index (QtDemuxStream * str, guint64 mov_time)
+{
+  GstByteReader stts;
+  guint64 time = 0;
+  guint32 index = 0;
+  guint i;
+
+  /* skip version + flags and the number of entries */
+  gst_byte_reader_init (&stts, str->stts.data, str->stts.size);
+  if (!gst_byte_reader_skip (&stts, 4 + 4))
+    return str->n_samples - 1;
+
+  for (i = 0; i < str->n_sample_times && index < str->n_samples; i++) {
+    guint32 stts_samples, stts_duration_raw;
+    gint32 stts_duration;
+
+    if (!gst_byte_reader_get_uint32_be (&stts, &stts_samples) ||
+        !gst_byte_reader_get_uint32_be (&stts, &stts_duration_raw))
+      break;
+    stts_duration = stts_duration_raw;
+
+    if (stts_duration < 0)
+      return str->n_samples - 1;
+
+    if (stts_duration > 0
+        && time + (guint64) stts_samples * stts_duration > mov_time) {
+      index += (mov_time - time) / stts_duration + 1;
+      break;
+    }
+
+    time += (guint64) stts_samples * stts_duration;
+    index += stts_samples;
+  }
+
+  return MIN (index, str->n_samples - 1);
+}
+
 /* find the index of the sample that includes the data for @media_offset using a
  * linear search
  *
@@ -972,7 +1115,24 @@ gst_qtdemux_find_index_linear (GstQTDemux * qtdemux, QtDemuxStream * str,
     index = gst_qtdemux_find_index (qtdemux, str, media_time);
     sample = str->samples + index;
   } else {
-    while (index < str->n_samples - 1) {
+    gboolean linear = TRUE;
+
+    if (str->stts.data) {
+      /* parse up to the first sample after the requested time in one go */
+      if (!qtdemux_parse_samples (qtdemux, str,
+              qtdemux_stts_find_index (str, mov_time)))
+        goto parse_failed;
+
+      index = gst_qtdemux_find_index (qtdemux, str, media_time);
+      sample = str->samples + index;
+
+      /* the stts only covers the samples of the moov, and parsing past them
+       * only adds the next fragment. Continue sample by sample from here
+       * to get to later fragments. */
+      linear = qtdemux->fragmented;
+    }
+
+    while (linear && index < str->n_samples - 1) {
       if (!qtdemux_parse_samples (qtdemux, str, index + 1))
         goto parse_failed;
 
@@ -1679,10 +1839,11 @@ gst_qtdemux_handle_src_event (GstPad * pad, GstObject * parent,
       gst_event_parse_seek_trickmode_interval (event,
           &qtdemux->trickmode_interval);
 
-      /* Build complete index for seeking;
-       * if not a fragmented file at least and we're really doing a seek,
-       * not just an instant-rate-change */
-      if (!qtdemux->fragmented && !instant_rate_change) {
+      /* Build complete index for seeking in push mode, where the samples
+       * are looked up by byte offset; if not a fragmented file at least and
+       * we're really doing a seek, not just an instant-rate-change. In pull
+       * mode the sample tables are only parsed up to the seek position. */
+      if (!qtdemux->pullbased && !qtdemux->fragmented && !instant_rate_change) {
         if (!qtdemux_ensure_index (qtdemux))
           goto index_failed;
       }
@@ -2013,6 +2174,7 @@ gst_qtdemux_reset (GstQTDemux * qtdemux, gboolean hard)
     qtdemux->neededbytes = 16;
     qtdemux->todrop = 0;
     qtdemux->pullbased = FALSE;
+    gst_clear_buffer (&qtdemux->readahead);
     g_clear_pointer (&qtdemux->redirect_location, g_free);
     qtdemux->first_mdat = -1;
     qtdemux->header_size = 0;
@@ -7341,10 +7503,12 @@ gst_qtdemux_loop_state_movie (GstQTDemux * qtdemux)
   if (stream->use_allocator) {
     /* if we have a per-stream allocator, use it */
     buf = gst_buffer_new_allocate (stream->allocator, size, &stream->params);
+    ret = gst_qtdemux_pull_atom (qtdemux, offset + stream->offset_in_sample,
+        size, &buf);
+  } else {
+    ret = gst_qtdemux_pull_sample_data (qtdemux,
+        offset + stream->offset_in_sample, size, &buf);
   }
-
-  ret = gst_qtdemux_pull_atom (qtdemux, offset + stream->offset_in_sample,
-      size, &buf);
   if (G_UNLIKELY (ret != GST_FLOW_OK))
     goto beach;
 
@@ -10233,7 +10397,11 @@ qtdemux_merge_sample_table (GstQTDemux * qtdemux, QtDemuxStream * stream)
   /* Note: we skip fourccs, size, version, flags and other fields of the new
    * atoms as the byte readers with them are already behind that position
    * anyway and only update the values of those inside the stream directly.
+   * The stts keeps its version, flags and number of entries though, as
+   * qtdemux_stts_find_index() walks it again from the start of the data.
    */
+  gst_byte_writer_put_uint32_be (&stts, 0);
+  gst_byte_writer_put_uint32_be (&stts, 0);
   stream->n_sample_times = 0;
   stream->n_samples = 0;
   for (i = 0; i < stream->n_samples_per_chunk; i++) {
@@ -10295,7 +10463,10 @@ qtdemux_merge_sample_table (GstQTDemux * qtdemux, QtDemuxStream * stream)
   gst_byte_reader_init (&stream->stsz, stream->stsz.data, stream->stsz.size);
   stream->stts.size = gst_byte_writer_get_size (&stts);
   stream->stts.data = gst_byte_writer_reset_and_get_data (&stts);
+  GST_WRITE_UINT32_BE ((guint8 *) stream->stts.data + 4,
+      stream->n_sample_times);
   gst_byte_reader_init (&stream->stts, stream->stts.data, stream->stts.size);
+  gst_byte_reader_skip_unchecked (&stream->stts, 4 + 4);
   stream->stsc.size = gst_byte_writer_get_size (&stsc);
   stream->stsc.data = gst_byte_writer_reset_and_get_data (&stsc);
   gst_byte_reader_init (&stream->stsc, stream->stsc.data, stream->stsc.size);
@@ -10307,6 +10478,7 @@ qtdemux_stbl_init (GstQTDemux * qtdemux, QtDemuxStream * stream, GNode * stbl)
 {
   stream->stbl_index = -1;      /* no samples have yet been parsed */
   stream->sample_index = -1;
+  stream->stbl_corrupt = FALSE;
 
   /* time-to-sample atom */
   if (!qtdemux_tree_get_child_by_type_full (stbl, FOURCC_stts, &stream->stts))
@@ -10601,7 +10773,12 @@ done:
       stream->n_samples, (guint) sizeof (QtDemuxSample),
       stream->n_samples * sizeof (QtDemuxSample) / (1024.0 * 1024.0));
 
-  if (stream->n_samples >=
+  /* The sample table is allocated zeroed and only written as it is parsed, so
+   * the pages of samples that are not reached yet are not backed by memory.
+   * A size per sample in the stsz atom bounds the number of samples by the
+   * atom size, otherwise the number of samples is not backed by any data */
+  if ((stream->sample_size != 0 || stream->chunks_are_samples) &&
+      stream->n_samples >=
       QTDEMUX_MAX_SAMPLE_INDEX_SIZE / sizeof (QtDemuxSample)) {
     GST_WARNING_OBJECT (qtdemux, "not allocating index of %d samples, would "
         "be larger than %uMB (broken file?)", stream->n_samples,
@@ -10647,6 +10824,15 @@ no_samples:
  */
 static gboolean
 qtdemux_parse_samples (GstQTDemux * qtdemux, QtDemuxStream * stream, guint32 n)
+{
+  return qtdemux_parse_samples_full (qtdemux, stream, n, TRUE);
+}
+
+/* like qtdemux_parse_samples(), but only posts an error message for a corrupt
+ * sample table if @post_error is TRUE */
+static gboolean
+qtdemux_parse_samples_full (GstQTDemux * qtdemux, QtDemuxStream * stream,
+    guint32 n, gboolean post_error)
 {
   gint i, j, k;
   QtDemuxSample *samples, *first, *cur, *last;
@@ -10667,6 +10853,10 @@ qtdemux_parse_samples (GstQTDemux * qtdemux, QtDemuxStream * stream, guint32 n)
   if (n <= stream->stbl_index)
     goto already_parsed;
 
+  /* the parser state is not usable anymore after an error */
+  if (G_UNLIKELY (stream->stbl_corrupt))
+    goto corrupt_file;
+
   GST_DEBUG_OBJECT (qtdemux, "parsing up to sample %u", n);
 
   if (!stream->stsz.data) {
@@ -11063,15 +11253,20 @@ out_of_samples:
     GST_LOG_OBJECT (qtdemux,
         "Tried to parse up to sample %u but there are only %u samples", n + 1,
         stream->n_samples);
-    GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
-        (_("This file is corrupt and cannot be played.")), (NULL));
+    if (post_error)
+      GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
+          (_("This file is corrupt and cannot be played.")), (NULL));
     return FALSE;
   }
 corrupt_file:
   {
+    stream->stbl_corrupt = TRUE;
     GST_OBJECT_UNLOCK (qtdemux);
-    GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
-        (_("This file is corrupt and cannot be played.")), (NULL));
+    if (post_error)
+      GST_ELEMENT_ERROR (qtdemux, STREAM, DEMUX,
+          (_("This file is corrupt and cannot be played.")), (NULL));
+    else
+      GST_DEBUG_OBJECT (qtdemux, "corrupt sample table for sample %u", n);
     return FALSE;
   }
 }
@@ -121,6 +121,11 @@ struct _GstQTDemux {
   /* TRUE if pull-based */
   gboolean pullbased;
 
+  /* pull mode: data read ahead of the current sample at readahead_offset,
+   * the samples in it are output as sub-buffers */
+  GstBuffer *readahead;
+  guint64 readahead_offset;
+
   gchar *redirect_location;
 
   /* Protect pad exposing from flush event */
@@ -485,6 +490,7 @@ struct _QtDemuxStream
 
   gboolean chunks_are_samples;  /* TRUE means treat chunks as samples */
   gint64 stbl_index;
+  gboolean stbl_corrupt;        /* parsing the sample table failed before */
   /* stco */
   guint co_size;
   GstByteReader co_chunk;
@@ -62,6 +62,10 @@
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
 
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "gstlevel.h"
 
 GST_DEBUG_CATEGORY_STATIC (level_debug);
@@ -216,6 +220,7 @@ static void
 gst_level_init (GstLevel * filter)
 {
   filter->CS = NULL;
+  filter->block_CS = NULL;
   filter->peak = NULL;
   filter->last_peak = NULL;
   filter->decay_peak = NULL;
@@ -242,6 +247,7 @@ gst_level_finalize (GObject * obj)
   GstLevel *filter = GST_LEVEL (obj);
 
   g_free (filter->CS);
+  g_free (filter->block_CS);
   g_free (filter->peak);
   g_free (filter->last_peak);
   g_free (filter->decay_peak);
@@ -249,6 +255,7 @@ gst_level_finalize (GObject * obj)
   g_free (filter->decay_peak_age);
 
   filter->CS = NULL;
+  filter->block_CS = NULL;
   filter->peak = NULL;
   filter->last_peak = NULL;
   filter->decay_peak = NULL;
@@ -334,15 +341,16 @@ gst_level_get_property (GObject * object, guint prop_id,
 }
 
 
-/* process one (interleaved) channel of incoming samples
- * calculate square sum of samples
+/* process all (interleaved) channels of incoming samples
+ * calculate square sum of samples per channel
  * normalize and average over number of samples
- * returns a normalized cumulative square value, which can be averaged
+ * returns normalized cumulative square values, which can be averaged
  * to return the average power as a double between 0 and 1
- * also returns the normalized peak power (square of the highest amplitude)
+ * also returns the normalized peak powers (square of the highest amplitude)
  *
- * caller must assure num is a multiple of channels
- * samples for multiple channels are interleaved
+ * NCS and NPS hold one value per channel
+ * samples for multiple channels are interleaved, all channels are
+ * accumulated in a single pass over the frames
  * input sample data enters in *in_data and is not modified
  * this filter only accepts signed audio data, so mid level is always 0
  *
@@ -350,75 +358,197 @@ gst_level_get_property (GObject * object, guint prop_id,
  * full-scale; so max-1 will not map to 1.0
  */
 
-#define DEFINE_INT_LEVEL_CALCULATOR(TYPE, RESOLUTION)                         \
+/* accumulate square sums and peak squares of all channels into CS and PS,
+ * which the caller has to clear */
+#define DEFINE_LEVEL_ACCUMULATOR(TYPE)                                        \
 static void inline                                                            \
-gst_level_calculate_##TYPE (gpointer data, guint num, guint channels,         \
+gst_level_accumulate_##TYPE##_c (const TYPE * in, guint frames,               \
+    guint channels, guint first, gdouble * CS, gdouble * PS)                  \
+{                                                                             \
+  guint i, c;                                                                 \
+  gdouble square;                                                             \
+                                                                              \
+  for (i = 0; i < frames; i++, in += channels) {                              \
+    for (c = first; c < channels; c++) {                                      \
+      square = ((gdouble) in[c]) * in[c];                                     \
+      if (square > PS[c]) PS[c] = square;                                     \
+      CS[c] += square;                                                        \
+    }                                                                         \
+  }                                                                           \
+}
+
+DEFINE_LEVEL_ACCUMULATOR (gint8);
+DEFINE_LEVEL_ACCUMULATOR (gint16);
+DEFINE_LEVEL_ACCUMULATOR (gint32);
+DEFINE_LEVEL_ACCUMULATOR (gfloat);
+DEFINE_LEVEL_ACCUMULATOR (gdouble);
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+/* load two consecutive samples as doubles */
+static inline __m128d
+load2_gint8 (const gint8 * p)
+{
+  return _mm_set_pd (p[1], p[0]);
+}
+
+static inline __m128d
+load2_gint16 (const gint16 * p)
+{
+  gint32 v;
+  __m128i t;
+
+  memcpy (&v, p, sizeof (v));
+  t = _mm_cvtsi32_si128 (v);
+  t = _mm_srai_epi32 (_mm_unpacklo_epi16 (t, t), 16);
+  return _mm_cvtepi32_pd (t);
+}
+
+static inline __m128d
+load2_gint32 (const gint32 * p)
+{
+  return _mm_cvtepi32_pd (_mm_loadl_epi64 ((const __m128i *) p));
+}
+
+static inline __m128d
+load2_gfloat (const gfloat * p)
+{
+  return _mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 ((const __m128i *)
+              p)));
+}
+
+static inline __m128d
+load2_gdouble (const gdouble * p)
+{
+  return _mm_loadu_pd (p);
+}
+
+/* The squares are computed in double precision exactly like the C version.
+ * Mono and stereo keep the accumulators in registers, other layouts handle
+ * the channels in pairs. The peak is the first operand of the max so that
+ * NaN samples are ignored like in the C version. */
+#define DEFINE_LEVEL_ACCUMULATOR_SSE2(TYPE)                                   \
+static void inline                                                            \
+gst_level_accumulate_##TYPE (const TYPE * in, guint frames, guint channels,   \
+    gdouble * CS, gdouble * PS)                                               \
+{                                                                             \
+  __m128d v, s0, s1, p0, p1;                                                  \
+  guint i, c, pairs = channels & ~1;                                          \
+                                                                              \
+  s0 = s1 = p0 = p1 = _mm_setzero_pd ();                                      \
+                                                                              \
+  if (channels == 1) {                                                        \
+    for (i = 0; i + 4 <= frames; i += 4) {                                    \
+      v = load2_##TYPE (in + i);                                              \
+      v = _mm_mul_pd (v, v);                                                  \
+      s0 = _mm_add_pd (s0, v);                                                \
+      p0 = _mm_max_pd (v, p0);                                                \
+      v = load2_##TYPE (in + i + 2);                                          \
+      v = _mm_mul_pd (v, v);                                                  \
+      s1 = _mm_add_pd (s1, v);                                                \
+      p1 = _mm_max_pd (v, p1);                                                \
+    }                                                                         \
+    s0 = _mm_add_pd (s0, s1);                                                 \
+    p0 = _mm_max_pd (p0, p1);                                                 \
+    s0 = _mm_add_sd (s0, _mm_unpackhi_pd (s0, s0));                           \
+    p0 = _mm_max_sd (p0, _mm_unpackhi_pd (p0, p0));                           \
+    CS[0] += _mm_cvtsd_f64 (s0);                                              \
+    if (_mm_cvtsd_f64 (p0) > PS[0]) PS[0] = _mm_cvtsd_f64 (p0);               \
+    gst_level_accumulate_##TYPE##_c (in + i, frames - i, 1, 0, CS, PS);       \
+  } else if (channels == 2) {                                                 \
+    for (i = 0; i + 2 <= frames; i += 2) {                                    \
+      v = load2_##TYPE (in + 2 * i);                                          \
+      v = _mm_mul_pd (v, v);                                                  \
+      s0 = _mm_add_pd (s0, v);                                                \
+      p0 = _mm_max_pd (v, p0);                                                \
+      v = load2_##TYPE (in + 2 * i + 2);                                      \
+      v = _mm_mul_pd (v, v);                                                  \
+      s1 = _mm_add_pd (s1, v);                                                \
+      p1 = _mm_max_pd (v, p1);                                                \
+    }                                                                         \
+    if (i < frames) {                                                         \
+      v = load2_##TYPE (in + 2 * i);                                          \
+      v = _mm_mul_pd (v, v);                                                  \
+      s0 = _mm_add_pd (s0, v);                                                \
+      p0 = _mm_max_pd (v, p0);                                                \
+    }                                                                         \
+    _mm_storeu_pd (CS, _mm_add_pd (_mm_loadu_pd (CS), _mm_add_pd (s0, s1)));  \
+    _mm_storeu_pd (PS, _mm_max_pd (_mm_max_pd (p0, p1), _mm_loadu_pd (PS)));  \
+  } else {                                                                    \
+    const TYPE *ip = in;                                                      \
+                                                                              \
+    for (i = 0; i < frames; i++, ip += channels) {                            \
+      for (c = 0; c < pairs; c += 2) {                                        \
+        v = load2_##TYPE (ip + c);                                            \
+        v = _mm_mul_pd (v, v);                                                \
+        _mm_storeu_pd (CS + c, _mm_add_pd (_mm_loadu_pd (CS + c), v));        \
+        _mm_storeu_pd (PS + c, _mm_max_pd (v, _mm_loadu_pd (PS + c)));        \
+      }                                                                       \
+    }                                                                         \
+    if (pairs < channels)                                                     \
+      gst_level_accumulate_##TYPE##_c (in, frames, channels, pairs, CS, PS);  \
+  }                                                                           \
+}
+
+DEFINE_LEVEL_ACCUMULATOR_SSE2 (gint8);
+DEFINE_LEVEL_ACCUMULATOR_SSE2 (gint16);
+DEFINE_LEVEL_ACCUMULATOR_SSE2 (gint32);
+DEFINE_LEVEL_ACCUMULATOR_SSE2 (gfloat);
+DEFINE_LEVEL_ACCUMULATOR_SSE2 (gdouble);
+#else
+#define gst_level_accumulate_gint8(in,frames,channels,CS,PS) \
+  gst_level_accumulate_gint8_c (in, frames, channels, 0, CS, PS)
+#define gst_level_accumulate_gint16(in,frames,channels,CS,PS) \
+  gst_level_accumulate_gint16_c (in, frames, channels, 0, CS, PS)
+#define gst_level_accumulate_gint32(in,frames,channels,CS,PS) \
+  gst_level_accumulate_gint32_c (in, frames, channels, 0, CS, PS)
+#define gst_level_accumulate_gfloat(in,frames,channels,CS,PS) \
+  gst_level_accumulate_gfloat_c (in, frames, channels, 0, CS, PS)
+#define gst_level_accumulate_gdouble(in,frames,channels,CS,PS) \
+  gst_level_accumulate_gdouble_c (in, frames, channels, 0, CS, PS)
+#endif
+
+#define DEFINE_INT_LEVEL_CALCULATOR(TYPE, RESOLUTION)                         \
+static void                                                                   \
+gst_level_calculate_##TYPE (gpointer data, guint frames, guint channels,      \
                             gdouble *NCS, gdouble *NPS)                       \
 {                                                                             \
-  TYPE * in = (TYPE *)data;                                                   \
-  register guint j;                                                           \
-  gdouble squaresum = 0.0;           /* square sum of the input samples */    \
-  register gdouble square = 0.0;     /* Square */                             \
-  register gdouble peaksquare = 0.0; /* Peak Square Sample */                 \
+  guint c;                                                                    \
   gdouble normalizer;                /* divisor to get a [-1.0, 1.0] range */ \
                                                                               \
-  /* *NCS = 0.0; Normalized Cumulative Square */                              \
-  /* *NPS = 0.0; Normalized Peak Square */                                    \
+  for (c = 0; c < channels; c++)                                              \
+    NCS[c] = NPS[c] = 0.0;                                                    \
                                                                               \
-  for (j = 0; j < num; j += channels) {                                       \
-    square = ((gdouble) in[j]) * in[j];                                       \
-    if (square > peaksquare) peaksquare = square;                             \
-    squaresum += square;                                                      \
-  }                                                                           \
+  gst_level_accumulate_##TYPE ((const TYPE *) data, frames, channels,         \
+      NCS, NPS);                                                              \
                                                                               \
   normalizer = (gdouble) (G_GINT64_CONSTANT(1) << (RESOLUTION * 2));          \
-  *NCS = squaresum / normalizer;                                              \
-  *NPS = peaksquare / normalizer;                                             \
+  for (c = 0; c < channels; c++) {                                            \
+    NCS[c] /= normalizer;                                                     \
+    NPS[c] /= normalizer;                                                     \
+  }                                                                           \
 }
 
 DEFINE_INT_LEVEL_CALCULATOR (gint32, 31);
 DEFINE_INT_LEVEL_CALCULATOR (gint16, 15);
 DEFINE_INT_LEVEL_CALCULATOR (gint8, 7);
 
-/* FIXME: use orc to calculate squaresums? */
 #define DEFINE_FLOAT_LEVEL_CALCULATOR(TYPE)                                   \
-static void inline                                                            \
-gst_level_calculate_##TYPE (gpointer data, guint num, guint channels,         \
+static void                                                                   \
+gst_level_calculate_##TYPE (gpointer data, guint frames, guint channels,      \
                             gdouble *NCS, gdouble *NPS)                       \
 {                                                                             \
-  TYPE * in = (TYPE *)data;                                                   \
-  register guint j;                                                           \
-  gdouble squaresum = 0.0;           /* square sum of the input samples */    \
-  register gdouble square = 0.0;     /* Square */                             \
-  register gdouble peaksquare = 0.0; /* Peak Square Sample */                 \
+  guint c;                                                                    \
                                                                               \
-  /* *NCS = 0.0; Normalized Cumulative Square */                              \
-  /* *NPS = 0.0; Normalized Peak Square */                                    \
+  for (c = 0; c < channels; c++)                                              \
+    NCS[c] = NPS[c] = 0.0;                                                    \
                                                                               \
-  /* orc_level_squaresum_f64(&squaresum,in,num); */                           \
-  for (j = 0; j < num; j += channels) {                                       \
-    square = ((gdouble) in[j]) * in[j];                                       \
-    if (square > peaksquare) peaksquare = square;                             \
-    squaresum += square;                                                      \
-  }                                                                           \
-                                                                              \
-  *NCS = squaresum;                                                           \
-  *NPS = peaksquare;                                                          \
+  gst_level_accumulate_##TYPE ((const TYPE *) data, frames, channels,         \
+      NCS, NPS);                                                              \
 }
 
 DEFINE_FLOAT_LEVEL_CALCULATOR (gfloat);
 DEFINE_FLOAT_LEVEL_CALCULATOR (gdouble);
 
-/* we would need stride to deinterleave also
-static void inline
-gst_level_calculate_gdouble (gpointer data, guint num, guint channels,
-                            gdouble *NCS, gdouble *NPS)
-{
-  orc_level_squaresum_f64(NCS,(gdouble *)data,num);
-  *NPS = 0.0;
-}
-*/
-
 /* called with object lock */
 static void
 gst_level_recalc_interval_frames (GstLevel * level)
@@ -483,12 +613,14 @@ gst_level_set_caps (GstBaseTransform * trans, GstCaps * in, GstCaps * out)
 
   /* allocate channel variable arrays */
   g_free (filter->CS);
+  g_free (filter->block_CS);
   g_free (filter->peak);
   g_free (filter->last_peak);
   g_free (filter->decay_peak);
   g_free (filter->decay_peak_base);
   g_free (filter->decay_peak_age);
   filter->CS = g_new (gdouble, channels);
+  filter->block_CS = g_new (gdouble, channels);
   filter->peak = g_new (gdouble, channels);
   filter->last_peak = g_new (gdouble, channels);
   filter->decay_peak = g_new (gdouble, channels);
@@ -657,10 +789,13 @@ gst_level_transform_ip (GstBaseTransform * trans, GstBuffer * in)
     block_size = MIN (block_size, num_frames);
     block_int_size = block_size * channels;
 
+    if (!GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_GAP))
+      filter->process (in_data, block_size, channels, filter->block_CS,
+          filter->peak);
+
     for (i = 0; i < channels; ++i) {
       if (!GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_GAP)) {
-        filter->process (in_data + (bps * i), block_int_size, channels, &CS,
-            &filter->peak[i]);
+        CS = filter->block_CS[i];
         CS_tot += CS;
         GST_LOG_OBJECT (filter,
             "[%d]: cumulative squares %lf, over %d samples/%d channels",
@@ -0,0 +1,1059 @@
+/* GStreamer
+ * Copyright (C) 2026 GStreamer developers
+ *
+ * gstloudness.c: EBU R128 / ITU-R BS.1770 loudness meter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-loudness
+ * @title: loudness
+ *
+ * Loudness measures the loudness of the incoming audio as specified by
+ * ITU-R BS.1770-4 and EBU R128 and, if the #GstLoudness:post-messages
+ * property is %TRUE, generates an element message named `loudness` after each
+ * interval of time given by the #GstLoudness:interval property.
+ * The message's structure contains these fields:
+ *
+ * * #GstClockTime `timestamp`: the timestamp of the buffer that triggered the message.
+ * * #GstClockTime `stream-time`: the stream time of the buffer.
+ * * #GstClockTime `running-time`: the running_time of the buffer.
+ * * #GstClockTime `duration`: the duration of the buffer.
+ * * #gdouble `momentary`: the momentary loudness (400ms window) in LUFS
+ * * #gdouble `short-term`: the short-term loudness (3s window) in LUFS
+ * * #gdouble `integrated`: the gated integrated loudness since the start of
+ *   the stream in LUFS
+ * * #gdouble `loudness-range`: the loudness range (LRA) since the start of
+ *   the stream in LU
+ * * #GstValueArray of #gdouble `true-peak`: the maximum true-peak level since
+ *   the start of the stream in dBTP for each channel
+ *
+ * Loudness values of silence are reported as -inf.
+ *
+ * The audio is K-weighted and the gating blocks are kept in fixed size
+ * histograms, so the memory used by the meter does not grow with the length
+ * of the stream. The true-peak is measured on a 4 times (2 times above
+ * 96kHz) oversampled signal, see #GstLoudness:true-peak.
+ *
+ * ## Example launch line
+ * |[
+ * gst-launch-1.0 -m uridecodebin uri=file:///path/to/music.ogg ! audioconvert ! loudness ! fakesink
+ * ]|
+ *
+ * Since: 1.26
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <math.h>
+
+#include "gstloudness.h"
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+GST_DEBUG_CATEGORY_STATIC (loudness_debug);
+#define GST_CAT_DEFAULT loudness_debug
+
+#define DEFAULT_POST_MESSAGES TRUE
+#define DEFAULT_INTERVAL (GST_SECOND / 10)
+#define DEFAULT_TRUE_PEAK TRUE
+
+/* sub-blocks per momentary (400ms) window */
+#define MOMENTARY_BLOCKS 4
+
+#define ABSOLUTE_GATE -70.0
+#define INTEGRATED_RELATIVE_GATE -10.0
+#define RANGE_RELATIVE_GATE -20.0
+
+#define LOUDNESS_CAPS \
+    "audio/x-raw, " \
+    "format = (string) { " \
+    GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (S32) ", " \
+    GST_AUDIO_NE (F32) ", " GST_AUDIO_NE (F64) " }, " \
+    "layout = (string) interleaved, " \
+    "rate = (int) [ 8000, MAX ], " \
+    "channels = (int) [ 1, MAX ]"
+
+static GstStaticPadTemplate sink_template_factory =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (LOUDNESS_CAPS)
+    );
+
+static GstStaticPadTemplate src_template_factory =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (LOUDNESS_CAPS)
+    );
+
+enum
+{
+  PROP_0,
+  PROP_POST_MESSAGES,
+  PROP_INTERVAL,
+  PROP_TRUE_PEAK,
+};
+
+#define gst_loudness_parent_class parent_class
+G_DEFINE_TYPE (GstLoudness, gst_loudness, GST_TYPE_BASE_TRANSFORM);
+GST_ELEMENT_REGISTER_DEFINE (loudness, "loudness", GST_RANK_NONE,
+    GST_TYPE_LOUDNESS);
+
+static void gst_loudness_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_loudness_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_loudness_finalize (GObject * obj);
+
+static gboolean gst_loudness_set_caps (GstBaseTransform * trans, GstCaps * in,
+    GstCaps * out);
+static gboolean gst_loudness_start (GstBaseTransform * trans);
+static GstFlowReturn gst_loudness_transform_ip (GstBaseTransform * trans,
+    GstBuffer * in);
+static gboolean gst_loudness_sink_event (GstBaseTransform * trans,
+    GstEvent * event);
+static void gst_loudness_post_message (GstLoudness * self);
+static void gst_loudness_recalc_interval_frames (GstLoudness * self);
+
+static void
+gst_loudness_class_init (GstLoudnessClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstBaseTransformClass *trans_class = GST_BASE_TRANSFORM_CLASS (klass);
+
+  gobject_class->set_property = gst_loudness_set_property;
+  gobject_class->get_property = gst_loudness_get_property;
+  gobject_class->finalize = gst_loudness_finalize;
+
+  /**
+   * GstLoudness:post-messages:
+   *
+   * Post messages on the bus with loudness information.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_POST_MESSAGES,
+      g_param_spec_boolean ("post-messages", "Post Messages",
+          "Whether to post a 'loudness' element message on the bus for each "
+          "passed interval", DEFAULT_POST_MESSAGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstLoudness:interval:
+   *
+   * Interval of time between message posts. The loudness windows themselves
+   * are fixed by BS.1770 and are independent of this interval.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_INTERVAL,
+      g_param_spec_uint64 ("interval", "Interval",
+          "Interval of time between message posts (in nanoseconds)",
+          1, G_MAXUINT64, DEFAULT_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstLoudness:true-peak:
+   *
+   * If %TRUE, the peak level is measured on an oversampled signal as
+   * specified by BS.1770 annex 2, otherwise only the sample peak is measured.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_TRUE_PEAK,
+      g_param_spec_boolean ("true-peak", "True Peak",
+          "Measure the true-peak on an oversampled signal instead of the "
+          "sample peak", DEFAULT_TRUE_PEAK,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  GST_DEBUG_CATEGORY_INIT (loudness_debug, "loudness", 0,
+      "Loudness measurement");
+
+  gst_element_class_add_static_pad_template (element_class,
+      &sink_template_factory);
+  gst_element_class_add_static_pad_template (element_class,
+      &src_template_factory);
+  gst_element_class_set_static_metadata (element_class, "Loudness",
+      "Filter/Analyzer/Audio",
+      "EBU R128 / ITU-R BS.1770 loudness and true-peak messager for audio/raw",
+      "GStreamer developers <gstreamer-devel@lists.freedesktop.org>");
+
+  trans_class->set_caps = GST_DEBUG_FUNCPTR (gst_loudness_set_caps);
+  trans_class->start = GST_DEBUG_FUNCPTR (gst_loudness_start);
+  trans_class->transform_ip = GST_DEBUG_FUNCPTR (gst_loudness_transform_ip);
+  trans_class->sink_event = GST_DEBUG_FUNCPTR (gst_loudness_sink_event);
+}
+
+static void
+gst_loudness_init (GstLoudness * self)
+{
+  gst_audio_info_init (&self->info);
+
+  self->post_messages = DEFAULT_POST_MESSAGES;
+  self->interval = DEFAULT_INTERVAL;
+  self->true_peak = DEFAULT_TRUE_PEAK;
+  self->message_ts = GST_CLOCK_TIME_NONE;
+
+  gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (self), TRUE);
+  gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM (self), TRUE);
+}
+
+static void
+gst_loudness_free_channels (GstLoudness * self)
+{
+  g_clear_pointer (&self->shelf_z1, g_free);
+  g_clear_pointer (&self->shelf_z2, g_free);
+  g_clear_pointer (&self->hp_z1, g_free);
+  g_clear_pointer (&self->hp_z2, g_free);
+  g_clear_pointer (&self->weight, g_free);
+  g_clear_pointer (&self->sum, g_free);
+  g_clear_pointer (&self->peak, g_free);
+  g_clear_pointer (&self->resampler, gst_audio_resampler_free);
+}
+
+static void
+gst_loudness_finalize (GObject * obj)
+{
+  GstLoudness *self = GST_LOUDNESS (obj);
+
+  gst_loudness_free_channels (self);
+  g_free (self->samples);
+  g_free (self->oversampled);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_loudness_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstLoudness *self = GST_LOUDNESS (object);
+
+  GST_OBJECT_LOCK (self);
+
+  switch (prop_id) {
+    case PROP_POST_MESSAGES:
+      self->post_messages = g_value_get_boolean (value);
+      break;
+    case PROP_INTERVAL:
+      self->interval = g_value_get_uint64 (value);
+      if (GST_AUDIO_INFO_RATE (&self->info))
+        gst_loudness_recalc_interval_frames (self);
+      break;
+    case PROP_TRUE_PEAK:
+      if (self->true_peak != g_value_get_boolean (value)) {
+        self->true_peak = g_value_get_boolean (value);
+        self->true_peak_changed = TRUE;
+      }
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_loudness_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstLoudness *self = GST_LOUDNESS (object);
+
+  GST_OBJECT_LOCK (self);
+
+  switch (prop_id) {
+    case PROP_POST_MESSAGES:
+      g_value_set_boolean (value, self->post_messages);
+      break;
+    case PROP_INTERVAL:
+      g_value_set_uint64 (value, self->interval);
+      break;
+    case PROP_TRUE_PEAK:
+      g_value_set_boolean (value, self->true_peak);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* sample conversion to the gdouble working format */
+
+#define DEFINE_CONVERT(TYPE,SCALE)                                          \
+static void                                                                 \
+gst_loudness_convert_##TYPE (gdouble * dest, gconstpointer src,             \
+    guint samples)                                                          \
+{                                                                           \
+  const TYPE *s = src;                                                      \
+  guint i;                                                                  \
+                                                                            \
+  for (i = 0; i < samples; i++)                                             \
+    dest[i] = s[i] * (1.0 / (SCALE));                                       \
+}
+
+DEFINE_CONVERT (gint16, 32768.0);
+DEFINE_CONVERT (gint32, 2147483648.0);
+DEFINE_CONVERT (gfloat, 1.0);
+
+static void
+gst_loudness_convert_gdouble (gdouble * dest, gconstpointer src, guint samples)
+{
+  memcpy (dest, src, samples * sizeof (gdouble));
+}
+
+/* K-weighting
+ *
+ * Both stages are recomputed for the actual sample rate from the analog
+ * prototypes of the 48kHz coefficients given in BS.1770, and run as
+ * transposed direct form II biquads. */
+
+static void
+gst_loudness_setup_filters (GstLoudness * self, gint rate)
+{
+  gdouble f0, G, Q, K, Vh, Vb, a0;
+
+  /* stage 1: high shelf modelling the acoustic effect of the head */
+  f0 = 1681.974450955533;
+  G = 3.999843853973347;
+  Q = 0.7071752369554196;
+  K = tan (G_PI * f0 / rate);
+  Vh = pow (10.0, G / 20.0);
+  Vb = pow (Vh, 0.4996667741545416);
+  a0 = 1.0 + K / Q + K * K;
+
+  self->shelf_b[0] = (Vh + Vb * K / Q + K * K) / a0;
+  self->shelf_b[1] = 2.0 * (K * K - Vh) / a0;
+  self->shelf_b[2] = (Vh - Vb * K / Q + K * K) / a0;
+  self->shelf_a[0] = 1.0;
+  self->shelf_a[1] = 2.0 * (K * K - 1.0) / a0;
+  self->shelf_a[2] = (1.0 - K / Q + K * K) / a0;
+
+  /* stage 2: RLB high pass */
+  f0 = 38.13547087602444;
+  Q = 0.5003270373238773;
+  K = tan (G_PI * f0 / rate);
+  a0 = 1.0 + K / Q + K * K;
+
+  self->hp_b[0] = 1.0;
+  self->hp_b[1] = -2.0;
+  self->hp_b[2] = 1.0;
+  self->hp_a[0] = 1.0;
+  self->hp_a[1] = 2.0 * (K * K - 1.0) / a0;
+  self->hp_a[2] = (1.0 - K / Q + K * K) / a0;
+}
+
+/* filters channels @first to the last one of @frames interleaved frames and
+ * adds the squares of the filtered samples to the per channel sums */
+static void
+gst_loudness_k_weight_c (GstLoudness * self, const gdouble * x, guint frames,
+    guint first)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  const gdouble sb0 = self->shelf_b[0], sb1 = self->shelf_b[1];
+  const gdouble sb2 = self->shelf_b[2], sa1 = self->shelf_a[1];
+  const gdouble sa2 = self->shelf_a[2];
+  const gdouble hb0 = self->hp_b[0], hb1 = self->hp_b[1];
+  const gdouble hb2 = self->hp_b[2], ha1 = self->hp_a[1];
+  const gdouble ha2 = self->hp_a[2];
+  guint c, i;
+
+  for (c = first; c < channels; c++) {
+    gdouble s1 = self->shelf_z1[c], s2 = self->shelf_z2[c];
+    gdouble h1 = self->hp_z1[c], h2 = self->hp_z2[c];
+    gdouble acc = 0.0;
+    const gdouble *p = x + c;
+
+    for (i = 0; i < frames; i++, p += channels) {
+      gdouble in = *p, y, out;
+
+      y = sb0 * in + s1;
+      s1 = sb1 * in - sa1 * y + s2;
+      s2 = sb2 * in - sa2 * y;
+
+      out = hb0 * y + h1;
+      h1 = hb1 * y - ha1 * out + h2;
+      h2 = hb2 * y - ha2 * out;
+
+      acc += out * out;
+    }
+    self->shelf_z1[c] = s1;
+    self->shelf_z2[c] = s2;
+    self->hp_z1[c] = h1;
+    self->hp_z2[c] = h2;
+    self->sum[c] += acc;
+  }
+}
+
+static void
+gst_loudness_peak_c (GstLoudness * self, const gdouble * x, guint frames,
+    guint first)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  guint c, i;
+
+  for (c = first; c < channels; c++) {
+    gdouble peak = self->peak[c];
+    const gdouble *p = x + c;
+
+    for (i = 0; i < frames; i++, p += channels)
+      peak = MAX (peak, fabs (*p));
+
+    self->peak[c] = peak;
+  }
+}
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+/* The biquad recursion is serial in time, so the SIMD lanes are used for
+ * neighbouring channels instead. Returns the first channel that was not
+ * processed. */
+static guint
+gst_loudness_k_weight_sse2 (GstLoudness * self, const gdouble * x,
+    guint frames)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  const __m128d sb0 = _mm_set1_pd (self->shelf_b[0]);
+  const __m128d sb1 = _mm_set1_pd (self->shelf_b[1]);
+  const __m128d sb2 = _mm_set1_pd (self->shelf_b[2]);
+  const __m128d sa1 = _mm_set1_pd (self->shelf_a[1]);
+  const __m128d sa2 = _mm_set1_pd (self->shelf_a[2]);
+  const __m128d hb0 = _mm_set1_pd (self->hp_b[0]);
+  const __m128d hb1 = _mm_set1_pd (self->hp_b[1]);
+  const __m128d hb2 = _mm_set1_pd (self->hp_b[2]);
+  const __m128d ha1 = _mm_set1_pd (self->hp_a[1]);
+  const __m128d ha2 = _mm_set1_pd (self->hp_a[2]);
+  guint c, i;
+
+  for (c = 0; c + 1 < channels; c += 2) {
+    __m128d s1 = _mm_loadu_pd (&self->shelf_z1[c]);
+    __m128d s2 = _mm_loadu_pd (&self->shelf_z2[c]);
+    __m128d h1 = _mm_loadu_pd (&self->hp_z1[c]);
+    __m128d h2 = _mm_loadu_pd (&self->hp_z2[c]);
+    __m128d acc = _mm_setzero_pd ();
+    const gdouble *p = x + c;
+
+    for (i = 0; i < frames; i++, p += channels) {
+      __m128d in = _mm_loadu_pd (p), y, out;
+
+      y = _mm_add_pd (_mm_mul_pd (sb0, in), s1);
+      s1 = _mm_add_pd (_mm_sub_pd (_mm_mul_pd (sb1, in),
+              _mm_mul_pd (sa1, y)), s2);
+      s2 = _mm_sub_pd (_mm_mul_pd (sb2, in), _mm_mul_pd (sa2, y));
+
+      out = _mm_add_pd (_mm_mul_pd (hb0, y), h1);
+      h1 = _mm_add_pd (_mm_sub_pd (_mm_mul_pd (hb1, y),
+              _mm_mul_pd (ha1, out)), h2);
+      h2 = _mm_sub_pd (_mm_mul_pd (hb2, y), _mm_mul_pd (ha2, out));
+
+      acc = _mm_add_pd (acc, _mm_mul_pd (out, out));
+    }
+    _mm_storeu_pd (&self->shelf_z1[c], s1);
+    _mm_storeu_pd (&self->shelf_z2[c], s2);
+    _mm_storeu_pd (&self->hp_z1[c], h1);
+    _mm_storeu_pd (&self->hp_z2[c], h2);
+    _mm_storeu_pd (&self->sum[c], _mm_add_pd (_mm_loadu_pd (&self->sum[c]),
+            acc));
+  }
+  return c;
+}
+
+static guint
+gst_loudness_peak_sse2 (GstLoudness * self, const gdouble * x, guint frames)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  const __m128d sign = _mm_set1_pd (-0.0);
+  guint c, i;
+
+  if (channels == 1) {
+    __m128d peak = _mm_set1_pd (self->peak[0]);
+    gdouble r[2];
+
+    for (i = 0; i + 1 < frames; i += 2)
+      peak = _mm_max_pd (peak, _mm_andnot_pd (sign, _mm_loadu_pd (x + i)));
+    _mm_storeu_pd (r, peak);
+    self->peak[0] = MAX (r[0], r[1]);
+    if (i < frames)
+      self->peak[0] = MAX (self->peak[0], fabs (x[i]));
+    return 1;
+  }
+
+  for (c = 0; c + 1 < channels; c += 2) {
+    __m128d peak = _mm_loadu_pd (&self->peak[c]);
+    const gdouble *p = x + c;
+
+    for (i = 0; i < frames; i++, p += channels)
+      peak = _mm_max_pd (peak, _mm_andnot_pd (sign, _mm_loadu_pd (p)));
+
+    _mm_storeu_pd (&self->peak[c], peak);
+  }
+  return c;
+}
+#endif
+
+static void
+gst_loudness_k_weight (GstLoudness * self, const gdouble * x, guint frames)
+{
+  guint first = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  first = gst_loudness_k_weight_sse2 (self, x, frames);
+#endif
+  gst_loudness_k_weight_c (self, x, frames, first);
+}
+
+static void
+gst_loudness_peak (GstLoudness * self, const gdouble * x, guint frames)
+{
+  guint first = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  first = gst_loudness_peak_sse2 (self, x, frames);
+#endif
+  gst_loudness_peak_c (self, x, frames, first);
+}
+
+static void
+gst_loudness_true_peak (GstLoudness * self, gdouble * x, guint frames)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  gsize out_frames;
+  gpointer in[1], out[1];
+
+  /* the sample peak is a lower bound of the true-peak, and the resampler
+   * delays the signal so this also covers the very first samples */
+  gst_loudness_peak (self, x, frames);
+
+  if (self->resampler == NULL)
+    return;
+
+  out_frames = gst_audio_resampler_get_out_frames (self->resampler, frames);
+  if (out_frames * channels > self->oversampled_len) {
+    self->oversampled_len = out_frames * channels;
+    self->oversampled = g_renew (gdouble, self->oversampled,
+        self->oversampled_len);
+  }
+
+  in[0] = x;
+  out[0] = self->oversampled;
+  gst_audio_resampler_resample (self->resampler, in, frames, out, out_frames);
+
+  if (out_frames > 0)
+    gst_loudness_peak (self, self->oversampled, out_frames);
+}
+
+/* gating */
+
+static inline gdouble
+gst_loudness_energy_to_lufs (gdouble energy)
+{
+  return -0.691 + 10.0 * log10 (energy);
+}
+
+static void
+gst_loudness_histogram_add (GstLoudnessHistogram * hist, gdouble energy)
+{
+  gdouble lufs;
+  gint bin;
+
+  if (energy <= 0.0)
+    return;
+
+  lufs = gst_loudness_energy_to_lufs (energy);
+  if (lufs < ABSOLUTE_GATE)
+    return;
+
+  bin = (gint) ((lufs - GST_LOUDNESS_HIST_MIN) * 10.0);
+  bin = CLAMP (bin, 0, GST_LOUDNESS_HIST_BINS - 1);
+
+  hist->count[bin]++;
+  hist->energy[bin] += energy;
+}
+
+/* returns the first bin that passes a gate @offset LU below the mean
+ * loudness of all blocks in @hist, or -1 if @hist is empty */
+static gint
+gst_loudness_histogram_gate (const GstLoudnessHistogram * hist, gdouble offset)
+{
+  gdouble energy = 0.0, gate;
+  guint64 count = 0;
+  gint i;
+
+  for (i = 0; i < GST_LOUDNESS_HIST_BINS; i++) {
+    count += hist->count[i];
+    energy += hist->energy[i];
+  }
+  if (count == 0)
+    return -1;
+
+  gate = gst_loudness_energy_to_lufs (energy / count) + offset;
+
+  /* a bin passes when its centre is above the gate */
+  i = (gint) ceil ((gate - GST_LOUDNESS_HIST_MIN) * 10.0 - 0.5);
+
+  return CLAMP (i, 0, GST_LOUDNESS_HIST_BINS - 1);
+}
+
+static gdouble
+gst_loudness_integrated (GstLoudness * self)
+{
+  const GstLoudnessHistogram *hist = &self->integrated_hist;
+  gdouble energy = 0.0;
+  guint64 count = 0;
+  gint i;
+
+  i = gst_loudness_histogram_gate (hist, INTEGRATED_RELATIVE_GATE);
+  if (i < 0)
+    return -INFINITY;
+
+  for (; i < GST_LOUDNESS_HIST_BINS; i++) {
+    count += hist->count[i];
+    energy += hist->energy[i];
+  }
+  if (count == 0)
+    return -INFINITY;
+
+  return gst_loudness_energy_to_lufs (energy / count);
+}
+
+/* EBU Tech 3342 loudness range, the distance between the 10th and the 95th
+ * percentile of the gated short-term loudness distribution */
+static gdouble
+gst_loudness_range (GstLoudness * self)
+{
+  const GstLoudnessHistogram *hist = &self->range_hist;
+  guint64 count = 0, low_idx, high_idx, seen;
+  gdouble low = 0.0, high = 0.0;
+  gint first, i;
+
+  first = gst_loudness_histogram_gate (hist, RANGE_RELATIVE_GATE);
+  if (first < 0)
+    return 0.0;
+
+  for (i = first; i < GST_LOUDNESS_HIST_BINS; i++)
+    count += hist->count[i];
+  if (count == 0)
+    return 0.0;
+
+  low_idx = (guint64) ((count - 1) * 0.10 + 0.5);
+  high_idx = (guint64) ((count - 1) * 0.95 + 0.5);
+
+  seen = 0;
+  for (i = first; i < GST_LOUDNESS_HIST_BINS; i++) {
+    if (hist->count[i] == 0)
+      continue;
+    if (seen <= low_idx && low_idx < seen + hist->count[i])
+      low = GST_LOUDNESS_HIST_MIN + (i + 0.5) / 10.0;
+    if (seen <= high_idx && high_idx < seen + hist->count[i]) {
+      high = GST_LOUDNESS_HIST_MIN + (i + 0.5) / 10.0;
+      break;
+    }
+    seen += hist->count[i];
+  }
+
+  return high - low;
+}
+
+/* mean energy of the last @n sub-blocks, sub-blocks before the start of the
+ * stream count as silence */
+static gdouble
+gst_loudness_window_energy (GstLoudness * self, guint n)
+{
+  gdouble energy = 0.0;
+  guint i, idx = self->block_idx;
+
+  for (i = 0; i < MIN (n, self->n_blocks); i++) {
+    idx = idx == 0 ? GST_LOUDNESS_SUB_BLOCKS - 1 : idx - 1;
+    energy += self->blocks[idx];
+  }
+
+  return energy / n;
+}
+
+static void
+gst_loudness_finish_block (GstLoudness * self)
+{
+  guint c, channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+  gdouble energy = 0.0;
+
+  for (c = 0; c < channels; c++) {
+    energy += self->weight[c] * self->sum[c];
+    self->sum[c] = 0.0;
+  }
+  energy /= self->block_frames;
+
+  self->blocks[self->block_idx] = energy;
+  if (++self->block_idx == GST_LOUDNESS_SUB_BLOCKS)
+    self->block_idx = 0;
+  if (self->n_blocks < GST_LOUDNESS_SUB_BLOCKS)
+    self->n_blocks++;
+  self->block_pos = 0;
+
+  /* gating blocks overlap by 75% for the integrated loudness and are
+   * taken every 100ms for the loudness range */
+  if (self->n_blocks >= MOMENTARY_BLOCKS)
+    gst_loudness_histogram_add (&self->integrated_hist,
+        gst_loudness_window_energy (self, MOMENTARY_BLOCKS));
+  if (self->n_blocks >= GST_LOUDNESS_SUB_BLOCKS)
+    gst_loudness_histogram_add (&self->range_hist,
+        gst_loudness_window_energy (self, GST_LOUDNESS_SUB_BLOCKS));
+}
+
+static gdouble
+gst_loudness_channel_weight (GstAudioChannelPosition pos)
+{
+  switch (pos) {
+    case GST_AUDIO_CHANNEL_POSITION_LFE1:
+    case GST_AUDIO_CHANNEL_POSITION_LFE2:
+      return 0.0;
+    case GST_AUDIO_CHANNEL_POSITION_REAR_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_REAR_RIGHT:
+    case GST_AUDIO_CHANNEL_POSITION_SIDE_LEFT:
+    case GST_AUDIO_CHANNEL_POSITION_SIDE_RIGHT:
+      return 1.41;
+    default:
+      return 1.0;
+  }
+}
+
+/* resets the measurement, called on start and on format changes */
+static void
+gst_loudness_reset (GstLoudness * self)
+{
+  guint channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+
+  if (self->sum) {
+    memset (self->shelf_z1, 0, channels * sizeof (gdouble));
+    memset (self->shelf_z2, 0, channels * sizeof (gdouble));
+    memset (self->hp_z1, 0, channels * sizeof (gdouble));
+    memset (self->hp_z2, 0, channels * sizeof (gdouble));
+    memset (self->sum, 0, channels * sizeof (gdouble));
+    memset (self->peak, 0, channels * sizeof (gdouble));
+  }
+  if (self->resampler)
+    gst_audio_resampler_reset (self->resampler);
+
+  memset (self->blocks, 0, sizeof (self->blocks));
+  self->block_idx = 0;
+  self->n_blocks = 0;
+  self->block_pos = 0;
+  memset (&self->integrated_hist, 0, sizeof (self->integrated_hist));
+  memset (&self->range_hist, 0, sizeof (self->range_hist));
+}
+
+static void
+gst_loudness_setup_resampler (GstLoudness * self)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&self->info);
+  gint factor;
+
+  g_clear_pointer (&self->resampler, gst_audio_resampler_free);
+  /* not retried before the property or the caps change again, also when
+   * no resampler can be used */
+  self->true_peak_changed = FALSE;
+
+  if (!self->true_peak || !GST_AUDIO_INFO_IS_VALID (&self->info))
+    return;
+
+  /* BS.1770 requires at least 192kHz for the oversampled signal */
+  if (rate < 96000)
+    factor = 4;
+  else if (rate < 192000)
+    factor = 2;
+  else
+    return;
+
+  self->resampler = gst_audio_resampler_new (GST_AUDIO_RESAMPLER_METHOD_KAISER,
+      GST_AUDIO_RESAMPLER_FLAG_NONE, GST_AUDIO_FORMAT_F64,
+      GST_AUDIO_INFO_CHANNELS (&self->info), rate, rate * factor, NULL);
+  if (self->resampler == NULL)
+    GST_WARNING_OBJECT (self, "could not create %dx oversampler, measuring "
+        "sample peak only", factor);
+}
+
+static gboolean
+gst_loudness_set_caps (GstBaseTransform * trans, GstCaps * in, GstCaps * out)
+{
+  GstLoudness *self = GST_LOUDNESS (trans);
+  GstAudioInfo info;
+  guint i, channels;
+
+  if (!gst_audio_info_from_caps (&info, in))
+    return FALSE;
+
+  GST_OBJECT_LOCK (self);
+
+  switch (GST_AUDIO_INFO_FORMAT (&info)) {
+    case GST_AUDIO_FORMAT_S16:
+      self->convert = gst_loudness_convert_gint16;
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      self->convert = gst_loudness_convert_gint32;
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      self->convert = gst_loudness_convert_gfloat;
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      self->convert = gst_loudness_convert_gdouble;
+      break;
+    default:
+      GST_OBJECT_UNLOCK (self);
+      return FALSE;
+  }
+
+  self->info = info;
+  channels = GST_AUDIO_INFO_CHANNELS (&info);
+
+  gst_loudness_free_channels (self);
+  self->shelf_z1 = g_new (gdouble, channels);
+  self->shelf_z2 = g_new (gdouble, channels);
+  self->hp_z1 = g_new (gdouble, channels);
+  self->hp_z2 = g_new (gdouble, channels);
+  self->sum = g_new (gdouble, channels);
+  self->peak = g_new (gdouble, channels);
+  self->weight = g_new (gdouble, channels);
+
+  for (i = 0; i < channels; i++) {
+    if (GST_AUDIO_INFO_IS_UNPOSITIONED (&info))
+      self->weight[i] = 1.0;
+    else
+      self->weight[i] = gst_loudness_channel_weight (info.position[i]);
+  }
+
+  gst_loudness_setup_filters (self, GST_AUDIO_INFO_RATE (&info));
+  self->block_frames = GST_AUDIO_INFO_RATE (&info) / 10;
+  gst_loudness_setup_resampler (self);
+  gst_loudness_reset (self);
+  gst_loudness_recalc_interval_frames (self);
+
+  GST_OBJECT_UNLOCK (self);
+  return TRUE;
+}
+
+static gboolean
+gst_loudness_start (GstBaseTransform * trans)
+{
+  GstLoudness *self = GST_LOUDNESS (trans);
+
+  GST_OBJECT_LOCK (self);
+  gst_loudness_reset (self);
+  self->num_frames = 0;
+  self->message_ts = GST_CLOCK_TIME_NONE;
+  GST_OBJECT_UNLOCK (self);
+
+  return TRUE;
+}
+
+static GstMessage *
+gst_loudness_message_new (GstLoudness * self, GstClockTime timestamp,
+    GstClockTime duration)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM_CAST (self);
+  GstStructure *s;
+  GValue peaks = G_VALUE_INIT;
+  GstClockTime running_time, stream_time;
+  guint i, channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+
+  running_time = gst_segment_to_running_time (&trans->segment, GST_FORMAT_TIME,
+      timestamp);
+  stream_time = gst_segment_to_stream_time (&trans->segment, GST_FORMAT_TIME,
+      timestamp);
+
+  s = gst_structure_new ("loudness",
+      "timestamp", G_TYPE_UINT64, timestamp,
+      "stream-time", G_TYPE_UINT64, stream_time,
+      "running-time", G_TYPE_UINT64, running_time,
+      "duration", G_TYPE_UINT64, duration,
+      "momentary", G_TYPE_DOUBLE,
+      gst_loudness_energy_to_lufs (gst_loudness_window_energy (self,
+              MOMENTARY_BLOCKS)),
+      "short-term", G_TYPE_DOUBLE,
+      gst_loudness_energy_to_lufs (gst_loudness_window_energy (self,
+              GST_LOUDNESS_SUB_BLOCKS)),
+      "integrated", G_TYPE_DOUBLE, gst_loudness_integrated (self),
+      "loudness-range", G_TYPE_DOUBLE, gst_loudness_range (self), NULL);
+
+  g_value_init (&peaks, GST_TYPE_ARRAY);
+  for (i = 0; i < channels; i++) {
+    GValue v = G_VALUE_INIT;
+
+    g_value_init (&v, G_TYPE_DOUBLE);
+    g_value_set_double (&v, 20.0 * log10 (self->peak[i]));
+    gst_value_array_append_and_take_value (&peaks, &v);
+  }
+  gst_structure_take_value (s, "true-peak", &peaks);
+
+  return gst_message_new_element (GST_OBJECT (self), s);
+}
+
+static void
+gst_loudness_post_message (GstLoudness * self)
+{
+  gint frames = self->num_frames;
+  GstClockTime duration;
+
+  if (!GST_AUDIO_INFO_IS_VALID (&self->info))
+    return;
+
+  duration = GST_FRAMES_TO_CLOCK_TIME (frames,
+      GST_AUDIO_INFO_RATE (&self->info));
+
+  if (self->post_messages) {
+    GstMessage *m = gst_loudness_message_new (self, self->message_ts,
+        duration);
+
+    GST_LOG_OBJECT (self, "message: %" GST_PTR_FORMAT,
+        gst_message_get_structure (m));
+
+    GST_OBJECT_UNLOCK (self);
+    gst_element_post_message (GST_ELEMENT (self), m);
+    GST_OBJECT_LOCK (self);
+  }
+  self->num_frames -= frames;
+  self->message_ts += duration;
+}
+
+static GstFlowReturn
+gst_loudness_transform_ip (GstBaseTransform * trans, GstBuffer * in)
+{
+  GstLoudness *self = GST_LOUDNESS (trans);
+  GstMapInfo map;
+  gdouble *x;
+  guint channels, frames, block_size;
+
+  channels = GST_AUDIO_INFO_CHANNELS (&self->info);
+
+  gst_buffer_map (in, &map, GST_MAP_READ);
+  frames = map.size / GST_AUDIO_INFO_BPF (&self->info);
+
+  GST_LOG_OBJECT (self, "analyzing %u sample frames at ts %" GST_TIME_FORMAT,
+      frames, GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (in)));
+
+  GST_OBJECT_LOCK (self);
+
+  if (GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_DISCONT)) {
+    self->message_ts = GST_BUFFER_TIMESTAMP (in);
+    self->num_frames = 0;
+  }
+  if (G_UNLIKELY (!GST_CLOCK_TIME_IS_VALID (self->message_ts))) {
+    self->message_ts = GST_BUFFER_TIMESTAMP (in);
+  }
+
+  if (self->true_peak_changed)
+    gst_loudness_setup_resampler (self);
+
+  if (frames * channels > self->samples_len) {
+    self->samples_len = frames * channels;
+    self->samples = g_renew (gdouble, self->samples, self->samples_len);
+  }
+  /* gap buffers are silence, whatever their content */
+  if (GST_BUFFER_FLAG_IS_SET (in, GST_BUFFER_FLAG_GAP))
+    memset (self->samples, 0, frames * channels * sizeof (gdouble));
+  else
+    self->convert (self->samples, map.data, frames * channels);
+
+  x = self->samples;
+  while (frames > 0) {
+    /* the interval may have been made shorter in the meantime */
+    if (self->num_frames >= self->interval_frames)
+      gst_loudness_post_message (self);
+
+    /* subdivide so that neither sub-blocks nor message intervals are
+     * skipped */
+    block_size = self->block_frames - self->block_pos;
+    block_size = MIN (block_size, self->interval_frames - self->num_frames);
+    block_size = MIN (block_size, frames);
+
+    gst_loudness_k_weight (self, x, block_size);
+    gst_loudness_true_peak (self, x, block_size);
+
+    self->block_pos += block_size;
+    if (self->block_pos == self->block_frames)
+      gst_loudness_finish_block (self);
+
+    self->num_frames += block_size;
+    if (self->num_frames >= self->interval_frames)
+      gst_loudness_post_message (self);
+
+    x += block_size * channels;
+    frames -= block_size;
+  }
+
+  GST_OBJECT_UNLOCK (self);
+
+  gst_buffer_unmap (in, &map);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_loudness_sink_event (GstBaseTransform * trans, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    GstLoudness *self = GST_LOUDNESS (trans);
+
+    GST_OBJECT_LOCK (self);
+    if (self->num_frames > 0)
+      gst_loudness_post_message (self);
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->sink_event (trans, event);
+}
+
+static void
+gst_loudness_recalc_interval_frames (GstLoudness * self)
+{
+  GstClockTime interval = self->interval;
+  guint sample_rate = GST_AUDIO_INFO_RATE (&self->info);
+  guint interval_frames;
+
+  interval_frames = GST_CLOCK_TIME_TO_FRAMES (interval, sample_rate);
+
+  if (interval_frames == 0) {
+    GST_WARNING_OBJECT (self, "interval %" GST_TIME_FORMAT " is too small, "
+        "should be at least %" GST_TIME_FORMAT " for sample rate %u",
+        GST_TIME_ARGS (interval),
+        GST_TIME_ARGS (GST_FRAMES_TO_CLOCK_TIME (1, sample_rate)), sample_rate);
+    interval_frames = 1;
+  }
+
+  self->interval_frames = interval_frames;
+
+  GST_INFO_OBJECT (self, "interval_frames now %u for interval "
+      "%" GST_TIME_FORMAT " and sample rate %u", interval_frames,
+      GST_TIME_ARGS (interval), sample_rate);
+}
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  return GST_ELEMENT_REGISTER (loudness, plugin);
+}
+
+GST_PLUGIN_DEFINE (GST_VERSION_MAJOR,
+    GST_VERSION_MINOR,
+    loudness,
+    "EBU R128 loudness measurement plugin",
+    plugin_init, VERSION, GST_LICENSE, GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN);
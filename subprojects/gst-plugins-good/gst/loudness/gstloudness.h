@@ -0,0 +1,109 @@
+/* GStreamer
+ * Copyright (C) 2026 GStreamer developers
+ *
+ * gstloudness.h: EBU R128 / ITU-R BS.1770 loudness meter
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_LOUDNESS_H__
+#define __GST_LOUDNESS_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstbasetransform.h>
+#include <gst/audio/audio.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_LOUDNESS (gst_loudness_get_type())
+G_DECLARE_FINAL_TYPE (GstLoudness, gst_loudness, GST, LOUDNESS,
+    GstBaseTransform);
+
+/* number of 100ms sub-blocks in the longest (short-term, 3s) window */
+#define GST_LOUDNESS_SUB_BLOCKS 30
+
+/* histogram of gating blocks, 0.1 LU per bin from -70 to +30 LUFS */
+#define GST_LOUDNESS_HIST_MIN  -70.0
+#define GST_LOUDNESS_HIST_BINS 1000
+
+typedef struct
+{
+  guint64 count[GST_LOUDNESS_HIST_BINS];
+  gdouble energy[GST_LOUDNESS_HIST_BINS];
+} GstLoudnessHistogram;
+
+typedef void (*GstLoudnessConvertFunc) (gdouble * dest, gconstpointer src,
+    guint samples);
+
+/**
+ * GstLoudness:
+ *
+ * Opaque data structure.
+ */
+struct _GstLoudness
+{
+  GstBaseTransform element;
+
+  /* properties, protected by object lock */
+  gboolean post_messages;
+  GstClockTime interval;
+  gboolean true_peak;
+
+  GstAudioInfo info;
+  GstLoudnessConvertFunc convert;
+
+  guint interval_frames;        /* frames between message posts */
+  guint num_frames;             /* frames processed since last message */
+  GstClockTime message_ts;
+
+  /* K-weighting, two cascaded biquads, shared by all channels */
+  gdouble shelf_b[3], shelf_a[3];
+  gdouble hp_b[3], hp_a[3];
+  /* per channel filter state, one array per delay element so that
+   * neighbouring channels can be loaded together */
+  gdouble *shelf_z1, *shelf_z2;
+  gdouble *hp_z1, *hp_z2;
+  gdouble *weight;              /* per channel BS.1770 weighting */
+  gdouble *sum;                 /* per channel sum of squares of sub-block */
+
+  /* 100ms sub-blocks */
+  guint block_frames;
+  guint block_pos;
+  gdouble blocks[GST_LOUDNESS_SUB_BLOCKS];
+  guint block_idx;
+  guint n_blocks;
+
+  /* gating state, fixed size independent of stream duration */
+  GstLoudnessHistogram integrated_hist;
+  GstLoudnessHistogram range_hist;
+
+  /* true-peak */
+  gboolean true_peak_changed;   /* resampler needs to be set up again */
+  GstAudioResampler *resampler;
+  gdouble *peak;                /* per channel linear peak */
+
+  /* scratch */
+  gdouble *samples;
+  gsize samples_len;
+  gdouble *oversampled;
+  gsize oversampled_len;
+};
+
+GST_ELEMENT_REGISTER_DECLARE (loudness);
+
+G_END_DECLS
+
+#endif /* __GST_LOUDNESS_H__ */
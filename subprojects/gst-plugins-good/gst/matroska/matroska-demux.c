@@ -332,6 +332,11 @@ gst_matroska_demux_reset (GstElement * element)
     demux->clusters = NULL;
   }
 
+  if (demux->cluster_index) {
+    g_array_unref (demux->cluster_index);
+    demux->cluster_index = NULL;
+  }
+
   g_list_foreach (demux->seek_parsed,
       (GFunc) gst_matroska_read_common_free_parsed_el, NULL);
   g_list_free (demux->seek_parsed);
@@ -344,6 +349,7 @@ gst_matroska_demux_reset (GstElement * element)
   demux->cluster_time = GST_CLOCK_TIME_NONE;
   demux->cluster_offset = 0;
   demux->cluster_prevsize = 0;
+  demux->cluster_size = 0;
   demux->seen_cluster_prevsize = FALSE;
   demux->next_cluster_offset = 0;
   demux->stream_last_time = GST_CLOCK_TIME_NONE;
@@ -2268,6 +2274,173 @@ gst_matroska_cluster_compare (gint64 * i1, gint64 * i2)
     return 0;
 }
 
+typedef struct
+{
+  guint64 offset;
+  guint64 size;                 /* 0 if unknown */
+  GstClockTime time;
+} GstMatroskaClusterIndexEntry;
+
+static gint
+gst_matroska_cluster_index_compare_offset (GstMatroskaClusterIndexEntry * e,
+    guint64 * offset)
+{
+  if (e->offset < *offset)
+    return -1;
+  else if (e->offset > *offset)
+    return 1;
+  else
+    return 0;
+}
+
+static gint
+gst_matroska_cluster_index_compare_time (GstMatroskaClusterIndexEntry * e,
+    GstClockTime * time)
+{
+  if (e->time < *time)
+    return -1;
+  else if (e->time > *time)
+    return 1;
+  else
+    return 0;
+}
+
+/* Remembers the position and time of every cluster the parser comes across,
+ * during playback as well as while scanning for a seek target, so later
+ * seeks in files without Cues can skip (part of) the bisection.
+ * Entries are kept sorted by offset. */
+static void
+gst_matroska_demux_add_cluster_index_entry (GstMatroskaDemux * demux,
+    guint64 offset, guint64 size, GstClockTime time)
+{
+  GstMatroskaClusterIndexEntry entry = { offset, size, time };
+  GstMatroskaClusterIndexEntry *e;
+  guint idx;
+
+  /* only used for seeking in pull mode */
+  if (demux->streaming || !GST_CLOCK_TIME_IS_VALID (time))
+    return;
+
+  if (G_UNLIKELY (!demux->cluster_index))
+    demux->cluster_index = g_array_sized_new (FALSE, FALSE,
+        sizeof (GstMatroskaClusterIndexEntry), 100);
+
+  /* clusters are mostly seen in file order, so check the last one first */
+  idx = demux->cluster_index->len;
+  if (idx > 0 && g_array_index (demux->cluster_index,
+          GstMatroskaClusterIndexEntry, idx - 1).offset >= offset) {
+    /* can't be NULL, the last entry is at or after offset */
+    e = gst_util_array_binary_search (demux->cluster_index->data, idx,
+        sizeof (GstMatroskaClusterIndexEntry),
+        (GCompareDataFunc) gst_matroska_cluster_index_compare_offset,
+        GST_SEARCH_MODE_AFTER, &offset, NULL);
+    if (e->offset == offset) {
+      if (size > 0)
+        e->size = size;
+      return;
+    }
+    idx = e - (GstMatroskaClusterIndexEntry *) demux->cluster_index->data;
+  }
+
+  GST_LOG_OBJECT (demux, "indexing cluster at offset %" G_GUINT64_FORMAT
+      ", size %" G_GUINT64_FORMAT ", time %" GST_TIME_FORMAT, offset, size,
+      GST_TIME_ARGS (time));
+  g_array_insert_val (demux->cluster_index, idx, entry);
+}
+
+/* Fills in the size of an indexed cluster, learnt from the PrevSize of the
+ * cluster following it */
+static void
+gst_matroska_demux_set_cluster_index_size (GstMatroskaDemux * demux,
+    guint64 offset, guint64 size)
+{
+  GstMatroskaClusterIndexEntry *e;
+
+  if (!demux->cluster_index)
+    return;
+
+  e = gst_util_array_binary_search (demux->cluster_index->data,
+      demux->cluster_index->len, sizeof (GstMatroskaClusterIndexEntry),
+      (GCompareDataFunc) gst_matroska_cluster_index_compare_offset,
+      GST_SEARCH_MODE_EXACT, &offset, NULL);
+  if (e && e->size == 0)
+    e->size = size;
+}
+
+/* Narrows down the [@apos, @opos] bisection range for @time using the
+ * clusters indexed so far. Returns TRUE if the cluster in @apos / @atime
+ * is known to be the one containing @time, because the indexed cluster
+ * directly following it starts after @time. */
+static gboolean
+gst_matroska_demux_search_cluster_index (GstMatroskaDemux * demux,
+    GstClockTime time, gint64 * apos, GstClockTime * atime, gint64 * opos,
+    GstClockTime * otime)
+{
+  GstMatroskaClusterIndexEntry *entries, *before, *after;
+  guint n;
+
+  if (!demux->cluster_index || demux->cluster_index->len == 0)
+    return FALSE;
+
+  entries = (GstMatroskaClusterIndexEntry *) demux->cluster_index->data;
+  n = demux->cluster_index->len;
+
+  /* cluster times increase with their offsets, bisection relies on that
+   * as well */
+  before = gst_util_array_binary_search (entries, n,
+      sizeof (GstMatroskaClusterIndexEntry),
+      (GCompareDataFunc) gst_matroska_cluster_index_compare_time,
+      GST_SEARCH_MODE_BEFORE, &time, NULL);
+  after = before ? before + 1 : entries;
+  if (after == entries + n)
+    after = NULL;
+
+  if (before && (gint64) before->offset >= *apos && before->time >= *atime) {
+    *apos = before->offset;
+    *atime = before->time;
+  } else {
+    before = NULL;
+  }
+
+  if (after && (gint64) after->offset >= *apos && after->time >= *atime) {
+    *opos = after->offset;
+    *otime = after->time;
+  } else {
+    after = NULL;
+  }
+
+  *otime = MAX (*otime, *atime);
+  *opos = MAX (*opos, *apos);
+
+  GST_DEBUG_OBJECT (demux, "cluster index narrowed search for %"
+      GST_TIME_FORMAT " to %" G_GINT64_FORMAT " - %" G_GINT64_FORMAT,
+      GST_TIME_ARGS (time), *apos, *opos);
+
+  return before && after && before->size > 0 &&
+      before->offset + before->size == after->offset;
+}
+
+/* Returns the offset of the first Cluster ID in @data, or -1.
+ * The first byte of the ID is looked up with memchr(), which C libraries
+ * vectorize, and is rare enough in compressed data that this skips over
+ * most of the data without looking at every byte. */
+static gint
+gst_matroska_demux_scan_cluster_id (const guint8 * data, gsize size)
+{
+  const guint8 *p = data, *end = data + size;
+
+  while (end - p >= 4) {
+    p = memchr (p, GST_MATROSKA_ID_CLUSTER >> 24, end - p - 3);
+    if (p == NULL)
+      break;
+    if (GST_READ_UINT32_BE (p) == GST_MATROSKA_ID_CLUSTER)
+      return p - data;
+    p++;
+  }
+
+  return -1;
+}
+
 /* searches for a cluster start from @pos,
  * return GST_FLOW_OK and cluster position in @pos if found */
 static GstFlowReturn
@@ -2316,8 +2489,8 @@ gst_matroska_demux_search_cluster (GstMatroskaDemux * demux, gint64 * pos,
   /* read in at newpos and scan for ebml cluster id */
   oldpos = oldlength = -1;
   while (1) {
-    GstByteReader reader;
     gint cluster_pos;
+    gsize scan_pos;
     guint toread = chunk;
 
     if (!forward) {
@@ -2352,22 +2525,19 @@ gst_matroska_demux_search_cluster (GstMatroskaDemux * demux, gint64 * pos,
       oldlength = map.size;
     }
 
-    gst_byte_reader_init (&reader, data, size);
     cluster_pos = -1;
+    scan_pos = 0;
     while (1) {
-      gint found = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffffff,
-          GST_MATROSKA_ID_CLUSTER, 0, gst_byte_reader_get_remaining (&reader));
-      if (forward) {
-        cluster_pos = found;
+      gint found =
+          gst_matroska_demux_scan_cluster_id ((const guint8 *) data + scan_pos,
+          size - scan_pos);
+      if (found < 0)
         break;
-      }
+      cluster_pos = scan_pos + found;
       /* need last occurrence when searching backwards */
-      if (found >= 0) {
-        cluster_pos = gst_byte_reader_get_pos (&reader) + found;
-        gst_byte_reader_skip (&reader, found + 4);
-      } else {
+      if (forward)
         break;
-      }
+      scan_pos = cluster_pos + 4;
     }
 
     if (cluster_pos >= 0) {
@@ -2414,8 +2584,7 @@ gst_matroska_demux_search_cluster (GstMatroskaDemux * demux, gint64 * pos,
         newpos += 1;
     } else {
       /* partial cluster id may have been in tail of buffer */
-      newpos +=
-          forward ? MAX (gst_byte_reader_get_remaining (&reader), 4) - 3 : 3;
+      newpos += forward ? MAX (size, 4) - 3 : 3;
     }
   }
 
@@ -2743,6 +2912,18 @@ gst_matroska_demux_search_pos (GstMatroskaDemux * demux, GstClockTime time)
   otime = MAX (otime, atime);
   opos = MAX (opos, apos);
 
+  /* start from what is known about the clusters seen so far */
+  if (time != GST_CLOCK_TIME_NONE &&
+      gst_matroska_demux_search_cluster_index (demux, time, &apos, &atime,
+          &opos, &otime)) {
+    GST_DEBUG_OBJECT (demux, "found cluster at offset %" G_GINT64_FORMAT
+        " with time %" GST_TIME_FORMAT " in cluster index", apos,
+        GST_TIME_ARGS (atime));
+    prev_cluster_offset = apos;
+    prev_cluster_time = atime;
+    goto found;
+  }
+
   maxpos = gst_matroska_read_common_get_length (&demux->common);
 
   /* invariants;
@@ -2905,6 +3086,7 @@ retry:
   /* In the bisect loop above we always undershoot and then jump forward
    * cluster-by-cluster until we overshoot, so if we get here we've gone
    * over and the previous cluster is where we need to go to. */
+found:
   cluster_offset = prev_cluster_offset;
   cluster_time = prev_cluster_time;
 
@@ -5966,6 +6148,7 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
           demux->cluster_time = GST_CLOCK_TIME_NONE;
           demux->cluster_offset = demux->common.offset;
           demux->cluster_prevsize = 0;
+          demux->cluster_size = (read != G_MAXUINT64) ? read : 0;
           if (G_UNLIKELY (!demux->seek_first && demux->seek_block)) {
             GST_DEBUG_OBJECT (demux, "seek target block %" G_GUINT64_FORMAT
                 " not found in Cluster, trying next Cluster's first block instead",
@@ -5994,6 +6177,9 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
             demux->stream_last_time =
                 demux->cluster_time * demux->common.time_scale;
           }
+          gst_matroska_demux_add_cluster_index_entry (demux,
+              demux->cluster_offset, demux->cluster_size,
+              demux->cluster_time * demux->common.time_scale);
 #if 0
           if (demux->common.element_index) {
             if (demux->common.element_index_writer_id == -1)
@@ -6106,6 +6292,9 @@ gst_matroska_demux_parse_id (GstMatroskaDemux * demux, guint32 id,
           GST_LOG_OBJECT (demux, "ClusterPrevSize: %" G_GUINT64_FORMAT, num);
           demux->cluster_prevsize = num;
           demux->seen_cluster_prevsize = TRUE;
+          if (num > 0 && demux->cluster_offset > num)
+            gst_matroska_demux_set_cluster_index_size (demux,
+                demux->cluster_offset - num, num);
           break;
         }
         case GST_MATROSKA_ID_POSITION:
@@ -75,6 +75,8 @@ typedef struct _GstMatroskaDemux {
 
   /* cluster positions (optional) */
   GArray                  *clusters;
+  /* positions, sizes and times of the clusters seen so far (pull mode) */
+  GArray                  *cluster_index;
 
   /* keeping track of playback position */
   GstClockTime             last_stop_end;
@@ -88,6 +90,7 @@ typedef struct _GstMatroskaDemux {
   GstClockTime             cluster_time;
   guint64                  cluster_offset;
   guint64                  cluster_prevsize;       /* 0 if unknown */
+  guint64                  cluster_size;           /* 0 if unknown */
   guint64                  first_cluster_offset;
   guint64                  next_cluster_offset;
   GstClockTime             requested_seek_time;
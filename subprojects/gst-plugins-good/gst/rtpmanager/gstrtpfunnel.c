@@ -230,19 +230,24 @@ gst_rtp_funnel_set_twcc_seqnum (GstRtpFunnel * funnel,
   GstRtpFunnelPad *fpad = GST_RTP_FUNNEL_PAD_CAST (pad);
   guint8 twcc_seq[2] = { 0, };
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  guint ext_id = gst_rtp_header_extension_get_id (funnel->twcc_ext);
+  guint ext_id;
   guint8 *existing;
   guint size;
 
   if (!funnel->twcc_ext || !fpad->has_twcc)
     return;
 
-  *buf = gst_buffer_make_writable (*buf);
+  ext_id = gst_rtp_header_extension_get_id (funnel->twcc_ext);
+
+  /* only the extension in the header is rewritten, don't copy the payload if
+   * it is shared */
+  *buf = gst_rtp_make_header_writable (*buf);
 
   gst_rtp_header_extension_write (funnel->twcc_ext, *buf,
       GST_RTP_HEADER_EXTENSION_ONE_BYTE, *buf, twcc_seq, sizeof (twcc_seq));
 
-  if (!gst_rtp_buffer_map (*buf, GST_MAP_READWRITE, &rtp))
+  if (!gst_rtp_buffer_map (*buf,
+          GST_MAP_READWRITE | GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING, &rtp))
     goto map_failed;
 
   if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, ext_id,
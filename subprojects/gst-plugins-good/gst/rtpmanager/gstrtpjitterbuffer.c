@@ -3242,16 +3242,19 @@ _get_inband_ntp_time (GstRtpJitterBuffer * jitterbuffer, GstRTPBuffer * rtp)
   return ntpnstime;
 }
 
+/* Handles one RTP packet, called with JBUF_LOCK. Messages to post are
+ * appended to @messages and must be posted after releasing the lock. When
+ * the jitterbuffer had to be reset, the lock was released and @locked is set
+ * to %FALSE. */
 static GstFlowReturn
-gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
-    GstBuffer * buffer)
+gst_rtp_jitter_buffer_chain_locked (GstRtpJitterBuffer * jitterbuffer,
+    GstPad * pad, GstObject * parent, GstBuffer * buffer, GstClockTime now,
+    GQueue * messages, gboolean * locked)
 {
-  GstRtpJitterBuffer *jitterbuffer;
   GstRtpJitterBufferPrivate *priv;
   guint16 seqnum;
   guint32 expected, rtptime;
   GstFlowReturn ret = GST_FLOW_OK;
-  GstClockTime now;
   GstClockTime dts, pts;
   GstClockTime ntp_time;
   GstClockTime inband_ntp_time;
@@ -3270,8 +3273,6 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
   RtpTimer *timer = NULL;
   gboolean is_rtx;
 
-  jitterbuffer = GST_RTP_JITTER_BUFFER_CAST (parent);
-
   priv = jitterbuffer->priv;
 
   if (G_UNLIKELY (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp)))
@@ -3285,7 +3286,6 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
   gst_rtp_buffer_unmap (&rtp);
 
   is_rtx = GST_BUFFER_IS_RETRANSMISSION (buffer);
-  now = get_current_running_time (jitterbuffer);
 
   /* make sure we have PTS and DTS set */
   pts = GST_BUFFER_PTS (buffer);
@@ -3322,7 +3322,8 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
       GST_TIME_ARGS (dts), GST_BUFFER_IS_DISCONT (buffer), is_rtx,
       GST_TIME_ARGS (inband_ntp_time));
 
-  JBUF_LOCK_CHECK (priv, out_flushing);
+  if (G_UNLIKELY (priv->srcresult != GST_FLOW_OK))
+    goto out_flushing;
 
   if (G_UNLIKELY (priv->last_pt != pt)) {
     GstCaps *caps;
@@ -3469,6 +3470,7 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
           rtp_timer_queue_length (priv->timers), max_dropout);
       g_queue_insert_sorted (&priv->gap_packets, buffer,
           (GCompareDataFunc) compare_buffer_seqnum, NULL);
+      *locked = FALSE;
       return gst_rtp_jitter_buffer_reset (jitterbuffer, pad, parent, seqnum);
     }
 
@@ -3477,6 +3479,7 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
       gboolean reset = handle_big_gap_buffer (jitterbuffer, buffer, pt, seqnum,
           gap, max_dropout, max_misorder);
       if (reset) {
+        *locked = FALSE;
         return gst_rtp_jitter_buffer_reset (jitterbuffer, pad, parent, seqnum);
       } else {
         GST_DEBUG_OBJECT (jitterbuffer,
@@ -3730,22 +3733,29 @@ gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
   msg = check_buffering_percent (jitterbuffer, percent);
 
 finished:
-  update_current_timer (jitterbuffer);
-  JBUF_UNLOCK (priv);
-
   if (msg)
-    gst_element_post_message (GST_ELEMENT_CAST (jitterbuffer), msg);
+    g_queue_push_tail (messages, msg);
   if (drop_msg)
-    gst_element_post_message (GST_ELEMENT_CAST (jitterbuffer), drop_msg);
+    g_queue_push_tail (messages, drop_msg);
 
   return ret;
 
   /* ERRORS */
 invalid_buffer:
   {
-    /* this is not fatal but should be filtered earlier */
-    GST_ELEMENT_WARNING (jitterbuffer, STREAM, DECODE, (NULL),
-        ("Received invalid RTP payload, dropping"));
+    GError *err;
+    gchar *text;
+
+    /* this is not fatal but should be filtered earlier. The lock is held, so
+     * the warning is posted along with the other messages */
+    GST_WARNING_OBJECT (jitterbuffer, "Received invalid RTP payload, dropping");
+    text = gst_error_get_message (GST_STREAM_ERROR, GST_STREAM_ERROR_DECODE);
+    err = g_error_new_literal (GST_STREAM_ERROR, GST_STREAM_ERROR_DECODE, text);
+    g_queue_push_tail (messages,
+        gst_message_new_warning (GST_OBJECT_CAST (jitterbuffer), err,
+            "Received invalid RTP payload, dropping"));
+    g_error_free (err);
+    g_free (text);
     gst_buffer_unref (buffer);
     return GST_FLOW_OK;
   }
@@ -3813,28 +3823,84 @@ discard_invalid:
   }
 }
 
-/* FIXME: hopefully we can do something more efficient here, especially when
- * all packets are in order and/or outside of the currently cached range.
- * Still worthwhile to have it, avoids taking/releasing object lock and pad
- * stream lock for every single buffer in the default chain_list fallback. */
+static void
+gst_rtp_jitter_buffer_post_messages (GstRtpJitterBuffer * jitterbuffer,
+    GQueue * messages)
+{
+  GstMessage *msg;
+
+  while ((msg = g_queue_pop_head (messages)))
+    gst_element_post_message (GST_ELEMENT_CAST (jitterbuffer), msg);
+}
+
+static GstFlowReturn
+gst_rtp_jitter_buffer_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstRtpJitterBuffer *jitterbuffer = GST_RTP_JITTER_BUFFER_CAST (parent);
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GQueue messages = G_QUEUE_INIT;
+  gboolean locked = TRUE;
+  GstClockTime now;
+  GstFlowReturn ret;
+
+  now = get_current_running_time (jitterbuffer);
+
+  JBUF_LOCK (priv);
+  ret = gst_rtp_jitter_buffer_chain_locked (jitterbuffer, pad, parent, buffer,
+      now, &messages, &locked);
+  if (locked) {
+    update_current_timer (jitterbuffer);
+    JBUF_UNLOCK (priv);
+  }
+
+  gst_rtp_jitter_buffer_post_messages (jitterbuffer, &messages);
+
+  return ret;
+}
+
+/* All packets of a list arrived at about the same time, so the running time
+ * is only sampled once and the jitterbuffer lock is held for the whole list.
+ * The timer and the pushing thread are woken up once the list is handled and
+ * messages are posted after releasing the lock. */
 static GstFlowReturn
 gst_rtp_jitter_buffer_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * buffer_list)
 {
+  GstRtpJitterBuffer *jitterbuffer = GST_RTP_JITTER_BUFFER_CAST (parent);
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  GQueue messages = G_QUEUE_INIT;
   GstFlowReturn flow_ret = GST_FLOW_OK;
+  gboolean locked = FALSE;
+  GstClockTime now;
   guint i, n;
 
+  now = get_current_running_time (jitterbuffer);
+
   n = gst_buffer_list_length (buffer_list);
   for (i = 0; i < n; ++i) {
     GstBuffer *buf = gst_buffer_list_get (buffer_list, i);
 
-    flow_ret = gst_rtp_jitter_buffer_chain (pad, parent, gst_buffer_ref (buf));
+    /* a reset releases the lock and pushes the pending gap packets */
+    if (!locked) {
+      JBUF_LOCK (priv);
+      locked = TRUE;
+    }
+
+    flow_ret = gst_rtp_jitter_buffer_chain_locked (jitterbuffer, pad, parent,
+        gst_buffer_ref (buf), now, &messages, &locked);
 
     if (flow_ret != GST_FLOW_OK)
       break;
   }
+  if (locked) {
+    update_current_timer (jitterbuffer);
+    JBUF_UNLOCK (priv);
+  }
   gst_buffer_list_unref (buffer_list);
 
+  gst_rtp_jitter_buffer_post_messages (jitterbuffer, &messages);
+
   return flow_ret;
 }
 
@@ -57,6 +57,7 @@
 #include <string.h>
 
 #include "gstrtpmux.h"
+#include "gstrtputils.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtp_mux_debug);
 #define GST_CAT_DEFAULT gst_rtp_mux_debug
@@ -377,7 +378,7 @@ process_buffer_locked (GstRTPMux * rtp_mux, GstRTPMuxPadPrivate * padpriv,
   gst_rtp_mux_readjust_rtp_timestamp_locked (rtp_mux, padpriv, rtpbuffer);
   GST_LOG_OBJECT (rtp_mux,
       "Pushing packet size %" G_GSIZE_FORMAT ", seq=%d, ts=%u, ssrc=%x",
-      rtpbuffer->map[0].size, rtp_mux->seqnum,
+      gst_buffer_get_size (rtpbuffer->buffer), rtp_mux->seqnum,
       gst_rtp_buffer_get_timestamp (rtpbuffer), rtp_mux->current_ssrc);
 
   if (padpriv) {
@@ -407,9 +408,18 @@ process_list_item (GstBuffer ** buffer, guint idx, gpointer user_data)
   struct BufferListData *bd = user_data;
   GstRTPBuffer rtpbuffer = GST_RTP_BUFFER_INIT;
 
-  *buffer = gst_buffer_make_writable (*buffer);
+  *buffer = gst_rtp_make_header_writable (*buffer);
 
-  gst_rtp_buffer_map (*buffer, GST_MAP_READWRITE, &rtpbuffer);
+  if (!gst_rtp_buffer_map (*buffer,
+          GST_MAP_READWRITE | GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING,
+          &rtpbuffer)) {
+    /* remove only this buffer from the list, the others are still valid */
+    GST_ERROR_OBJECT (bd->rtp_mux, "Invalid RTP buffer %u in list, dropping it",
+        idx);
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    return TRUE;
+  }
 
   bd->drop = !process_buffer_locked (bd->rtp_mux, bd->padpriv, &rtpbuffer);
 
@@ -475,6 +485,10 @@ gst_rtp_mux_chain_list (GstPad * pad, GstObject * parent,
   bufferlist = gst_buffer_list_make_writable (bufferlist);
   gst_buffer_list_foreach (bufferlist, process_list_item, &bd);
 
+  /* every buffer of the list was invalid */
+  if (gst_buffer_list_length (bufferlist) == 0)
+    bd.drop = TRUE;
+
   if (!bd.drop && pad != rtp_mux->last_pad) {
     changed = TRUE;
     g_clear_object (&rtp_mux->last_pad);
@@ -555,9 +569,12 @@ gst_rtp_mux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     return GST_FLOW_NOT_LINKED;
   }
 
-  buffer = gst_buffer_make_writable (buffer);
+  /* only the header is rewritten, don't copy the payload if it is shared */
+  buffer = gst_rtp_make_header_writable (buffer);
 
-  if (!gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtpbuffer)) {
+  if (!gst_rtp_buffer_map (buffer,
+          GST_MAP_READWRITE | GST_RTP_BUFFER_MAP_FLAG_SKIP_PADDING,
+          &rtpbuffer)) {
     GST_OBJECT_UNLOCK (rtp_mux);
     gst_buffer_unref (buffer);
     GST_ERROR_OBJECT (rtp_mux, "Invalid RTP buffer");
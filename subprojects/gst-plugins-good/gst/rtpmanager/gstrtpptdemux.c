@@ -134,6 +134,8 @@ static gboolean gst_rtp_pt_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 static GstFlowReturn gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static GstFlowReturn gst_rtp_pt_demux_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstStateChangeReturn gst_rtp_pt_demux_change_state (GstElement * element,
     GstStateChange transition);
 static void gst_rtp_pt_demux_clear_pt_map (GstRtpPtDemux * rtpdemux);
@@ -282,6 +284,7 @@ gst_rtp_pt_demux_class_init (GstRtpPtDemuxClass * klass)
       "rtpptdemux", 0, "RTP codec demuxer");
 
   GST_DEBUG_REGISTER_FUNCPTR (gst_rtp_pt_demux_chain);
+  GST_DEBUG_REGISTER_FUNCPTR (gst_rtp_pt_demux_chain_list);
 }
 
 static void
@@ -295,6 +298,7 @@ gst_rtp_pt_demux_init (GstRtpPtDemux * ptdemux)
   g_assert (ptdemux->sink != NULL);
 
   gst_pad_set_chain_function (ptdemux->sink, gst_rtp_pt_demux_chain);
+  gst_pad_set_chain_list_function (ptdemux->sink, gst_rtp_pt_demux_chain_list);
   gst_pad_set_event_function (ptdemux->sink, gst_rtp_pt_demux_sink_event);
 
   gst_element_add_pad (GST_ELEMENT (ptdemux), ptdemux->sink);
@@ -469,26 +473,34 @@ gst_rtp_pt_demux_pt_is_ignored (GstRtpPtDemux * ptdemux, guint8 pt)
   return ret;
 }
 
-static GstFlowReturn
-gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+static gboolean
+gst_rtp_pt_demux_get_pt (GstBuffer * buf, guint8 * pt)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
-  GstRtpPtDemux *rtpdemux;
-  guint8 pt;
-  GstPad *srcpad;
-  GstCaps *caps;
   GstRTPBuffer rtp = { NULL };
 
-  rtpdemux = GST_RTP_PT_DEMUX (parent);
-
   if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
-    goto invalid_buffer;
+    return FALSE;
 
-  pt = gst_rtp_buffer_get_payload_type (&rtp);
+  *pt = gst_rtp_buffer_get_payload_type (&rtp);
   gst_rtp_buffer_unmap (&rtp);
 
+  return TRUE;
+}
+
+/* Returns a reference to the src pad for @pt in @out_srcpad, creating the pad
+ * and updating its caps when needed. @out_srcpad is set to %NULL when the
+ * packets of @pt must be dropped. */
+static GstFlowReturn
+gst_rtp_pt_demux_get_srcpad (GstRtpPtDemux * rtpdemux, guint8 pt,
+    GstPad ** out_srcpad)
+{
+  GstPad *srcpad;
+  GstCaps *caps;
+
+  *out_srcpad = NULL;
+
   if (gst_rtp_pt_demux_pt_is_ignored (rtpdemux, pt))
-    goto ignored;
+    return GST_FLOW_OK;
 
   GST_DEBUG_OBJECT (rtpdemux, "received buffer for pt %d", pt);
 
@@ -508,7 +520,7 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
      * (e.g. rtpbin) to update the ignored-pt list */
     if (gst_rtp_pt_demux_pt_is_ignored (rtpdemux, pt)) {
       gst_clear_caps (&caps);
-      goto ignored;
+      return GST_FLOW_OK;
     }
 
     klass = GST_ELEMENT_GET_CLASS (rtpdemux);
@@ -596,6 +608,42 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     gst_caps_unref (caps);
   }
 
+  *out_srcpad = srcpad;
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+no_caps:
+  {
+    GST_ELEMENT_ERROR (rtpdemux, STREAM, DECODE, (NULL),
+        ("Could not get caps for payload"));
+    if (srcpad)
+      gst_object_unref (srcpad);
+    return GST_FLOW_ERROR;
+  }
+}
+
+static GstFlowReturn
+gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstRtpPtDemux *rtpdemux;
+  guint8 pt;
+  GstPad *srcpad;
+
+  rtpdemux = GST_RTP_PT_DEMUX (parent);
+
+  if (!gst_rtp_pt_demux_get_pt (buf, &pt))
+    goto invalid_buffer;
+
+  ret = gst_rtp_pt_demux_get_srcpad (rtpdemux, pt, &srcpad);
+  if (ret != GST_FLOW_OK) {
+    gst_buffer_unref (buf);
+    return ret;
+  }
+  if (srcpad == NULL)
+    goto ignored;
+
   /* push to srcpad */
   ret = gst_pad_push (srcpad, buf);
 
@@ -619,15 +667,68 @@ invalid_buffer:
     gst_buffer_unref (buf);
     return GST_FLOW_OK;
   }
-no_caps:
-  {
-    GST_ELEMENT_ERROR (rtpdemux, STREAM, DECODE, (NULL),
-        ("Could not get caps for payload"));
-    gst_buffer_unref (buf);
-    if (srcpad)
-      gst_object_unref (srcpad);
-    return GST_FLOW_ERROR;
+}
+
+/* The payload type changes rarely and the order of the packets matters for
+ * the payload-type-changed signal, so the list is split in runs of packets
+ * with the same payload type, which are pushed as lists. */
+static GstFlowReturn
+gst_rtp_pt_demux_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstRtpPtDemux *rtpdemux;
+  guint8 pt, next_pt;
+  guint i, start, end, n;
+
+  rtpdemux = GST_RTP_PT_DEMUX (parent);
+
+  n = gst_buffer_list_length (list);
+  for (start = 0; start < n && ret == GST_FLOW_OK; start = end) {
+    GstBufferList *run;
+    GstPad *srcpad;
+
+    if (!gst_rtp_pt_demux_get_pt (gst_buffer_list_get (list, start), &pt)) {
+      /* this should not be fatal */
+      GST_ELEMENT_WARNING (rtpdemux, STREAM, DEMUX, (NULL),
+          ("Dropping invalid RTP payload"));
+      end = start + 1;
+      continue;
+    }
+
+    for (end = start + 1; end < n; end++) {
+      if (!gst_rtp_pt_demux_get_pt (gst_buffer_list_get (list, end), &next_pt)
+          || next_pt != pt)
+        break;
+    }
+
+    ret = gst_rtp_pt_demux_get_srcpad (rtpdemux, pt, &srcpad);
+    if (ret != GST_FLOW_OK)
+      break;
+    if (srcpad == NULL) {
+      GST_DEBUG_OBJECT (rtpdemux, "Dropped %u buffers for pt %d", end - start,
+          pt);
+      continue;
+    }
+
+    if (start == 0 && end == n) {
+      run = g_steal_pointer (&list);
+    } else {
+      run = gst_buffer_list_new_sized (end - start);
+      for (i = start; i < end; i++)
+        gst_buffer_list_add (run,
+            gst_buffer_ref (gst_buffer_list_get (list, i)));
+    }
+
+    ret = gst_pad_push_list (srcpad, run);
+
+    gst_object_unref (srcpad);
   }
+
+  if (list)
+    gst_buffer_list_unref (list);
+
+  return ret;
 }
 
 static GstPad *
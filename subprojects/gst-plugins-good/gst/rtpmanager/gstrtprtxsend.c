@@ -34,6 +34,11 @@
  * look up the requested seqnum in its list of stored packets. If the packet
  * is available, it will create a RTX packet according to RFC 4588 and send
  * this as an auxiliary stream. RTX is SSRC-multiplexed
+ *
+ * Like a generic NACK, a request can carry a "blp" bitmask of the following
+ * 16 seqnums that are requested as well. The retransmissions of one request,
+ * and any others that are already waiting to be sent, are pushed downstream
+ * as one buffer list.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -165,12 +170,12 @@ typedef struct
   GstBuffer *buffer;
 } BufferQueueItem;
 
-static void
-buffer_queue_item_free (BufferQueueItem * item)
-{
-  gst_buffer_unref (item->buffer);
-  g_free (item);
-}
+/* the history ring grows up to half of the seqnum space, so that the seqnums
+ * it holds can always be ordered */
+#define HISTORY_MIN_SIZE 64
+#define HISTORY_MAX_SIZE 32768
+/* like RTP_MAX_MISORDER in rtpsource.c */
+#define HISTORY_MAX_MISORDER 100
 
 typedef struct
 {
@@ -178,8 +183,14 @@ typedef struct
   guint16 seqnum_base, next_seqnum;
   gint clock_rate;
 
-  /* history of rtp packets */
-  GSequence *queue;
+  /* history of rtp packets, a ring of history_size (a power of two) items
+   * indexed by seqnum. It holds history_len packets with seqnums from
+   * first_seqnum to last_seqnum, both of which are always present, and
+   * empty items for the missing seqnums in between */
+  BufferQueueItem *history;
+  guint history_size;
+  guint history_len;
+  guint16 first_seqnum, last_seqnum;
 } SSRCRtxData;
 
 static SSRCRtxData *
@@ -189,18 +200,141 @@ ssrc_rtx_data_new (guint32 rtx_ssrc)
 
   data->rtx_ssrc = rtx_ssrc;
   data->next_seqnum = data->seqnum_base = g_random_int_range (0, G_MAXUINT16);
-  data->queue = g_sequence_new ((GDestroyNotify) buffer_queue_item_free);
+  data->history = g_new0 (BufferQueueItem, HISTORY_MIN_SIZE);
+  data->history_size = HISTORY_MIN_SIZE;
 
   return data;
 }
 
+static void
+ssrc_rtx_data_clear_history (SSRCRtxData * data)
+{
+  guint i;
+
+  for (i = 0; i < data->history_size && data->history_len > 0; i++) {
+    if (data->history[i].buffer) {
+      gst_buffer_replace (&data->history[i].buffer, NULL);
+      data->history_len--;
+    }
+  }
+}
+
 static void
 ssrc_rtx_data_free (SSRCRtxData * data)
 {
-  g_sequence_free (data->queue);
+  ssrc_rtx_data_clear_history (data);
+  g_free (data->history);
   g_free (data);
 }
 
+static inline BufferQueueItem *
+ssrc_rtx_data_get_item (SSRCRtxData * data, guint16 seqnum)
+{
+  return &data->history[seqnum & (data->history_size - 1)];
+}
+
+/* returns the stored packet with @seqnum or NULL */
+static BufferQueueItem *
+ssrc_rtx_data_lookup (SSRCRtxData * data, guint16 seqnum)
+{
+  BufferQueueItem *item = ssrc_rtx_data_get_item (data, seqnum);
+
+  if (item->buffer == NULL || item->seqnum != seqnum)
+    return NULL;
+
+  return item;
+}
+
+/* removes the oldest packet from the history */
+static void
+ssrc_rtx_data_pop (SSRCRtxData * data)
+{
+  BufferQueueItem *item = ssrc_rtx_data_get_item (data, data->first_seqnum);
+
+  gst_buffer_replace (&item->buffer, NULL);
+  if (--data->history_len == 0)
+    return;
+
+  /* skip the seqnums that never made it into the history. Every item is
+   * skipped at most once, so this is O(1) amortized */
+  do {
+    item = ssrc_rtx_data_get_item (data, ++data->first_seqnum);
+  } while (item->buffer == NULL);
+}
+
+static void
+ssrc_rtx_data_resize (SSRCRtxData * data, guint size)
+{
+  BufferQueueItem *history = g_new0 (BufferQueueItem, size);
+  guint i;
+
+  for (i = 0; i < data->history_size; i++) {
+    BufferQueueItem *item = &data->history[i];
+
+    if (item->buffer)
+      history[item->seqnum & (size - 1)] = *item;
+  }
+  g_free (data->history);
+  data->history = history;
+  data->history_size = size;
+}
+
+/* adds @buffer to the history, evicting the oldest packets when the seqnums
+ * would no longer fit into the ring */
+static void
+ssrc_rtx_data_push (SSRCRtxData * data, GstBuffer * buffer, guint16 seqnum,
+    guint32 timestamp)
+{
+  BufferQueueItem *item;
+
+  if (data->history_len == 0) {
+    data->first_seqnum = data->last_seqnum = seqnum;
+  } else if ((guint16) (seqnum - data->first_seqnum) >
+      (guint16) (data->last_seqnum - data->first_seqnum)) {
+    guint gap = (guint16) (seqnum - data->last_seqnum);
+    guint back = (guint16) (data->first_seqnum - seqnum);
+
+    if (gap >= HISTORY_MAX_SIZE) {
+      /* older than the history. Keep it when it still fits into the ring,
+       * drop it when it is just late and restart the history when the
+       * seqnums jumped back */
+      if ((guint16) (data->last_seqnum - seqnum) < data->history_size) {
+        data->first_seqnum = seqnum;
+        goto store;
+      }
+      if (back <= MAX (data->history_size, HISTORY_MAX_MISORDER))
+        return;
+      ssrc_rtx_data_clear_history (data);
+    } else {
+      guint span = (guint16) (data->last_seqnum - data->first_seqnum) + gap + 1;
+      guint size = data->history_size;
+
+      while (size < span && size < HISTORY_MAX_SIZE)
+        size <<= 1;
+      if (size != data->history_size)
+        ssrc_rtx_data_resize (data, size);
+
+      while (data->history_len > 0 &&
+          (guint16) (seqnum - data->first_seqnum) >= data->history_size)
+        ssrc_rtx_data_pop (data);
+    }
+
+    if (data->history_len == 0)
+      data->first_seqnum = seqnum;
+    data->last_seqnum = seqnum;
+  }
+
+store:
+  item = ssrc_rtx_data_get_item (data, seqnum);
+  if (item->buffer)
+    gst_buffer_unref (item->buffer);
+  else
+    data->history_len++;
+  item->seqnum = seqnum;
+  item->timestamp = timestamp;
+  item->buffer = gst_buffer_ref (buffer);
+}
+
 typedef enum
 {
   RTX_TASK_START,
@@ -353,6 +487,10 @@ static void
 gst_rtp_rtx_send_reset (GstRtpRtxSend * rtx)
 {
   GST_OBJECT_LOCK (rtx);
+  /* the task peeks at the queue when merging retransmissions, so make it
+   * return rather than wait on the emptied queue. Starting the task clears
+   * the flushing state again */
+  gst_data_queue_set_flushing (rtx->queue, TRUE);
   gst_data_queue_flush (rtx->queue);
   g_hash_table_remove_all (rtx->ssrc_data);
   g_hash_table_remove_all (rtx->rtx_ssrcs);
@@ -740,14 +878,32 @@ gst_rtp_rtx_buffer_new (GstRtpRtxSend * rtx, GstBuffer * buffer)
   return new_buffer;
 }
 
-static gint
-buffer_queue_items_cmp (BufferQueueItem * a, BufferQueueItem * b,
-    gpointer user_data)
+/* Must be called with lock */
+static GstBuffer *
+gst_rtp_rtx_send_lookup (GstRtpRtxSend * rtx, SSRCRtxData * data,
+    guint16 seqnum)
 {
-  /* gst_rtp_buffer_compare_seqnum returns the opposite of what we want,
-   * it returns negative when seqnum1 > seqnum2 and we want negative
-   * when b > a, i.e. a is smaller, so it comes first in the sequence */
-  return gst_rtp_buffer_compare_seqnum (b->seqnum, a->seqnum);
+  BufferQueueItem *item;
+
+  item = ssrc_rtx_data_lookup (data, seqnum);
+  if (item) {
+    GST_LOG_OBJECT (rtx, "found %u", item->seqnum);
+    return gst_rtp_rtx_buffer_new (rtx, item->buffer);
+  }
+#ifndef GST_DISABLE_DEBUG
+  if (data->history_len > 0 &&
+      gst_rtp_buffer_compare_seqnum (seqnum, data->first_seqnum) > 0) {
+    GST_DEBUG_OBJECT (rtx, "requested seqnum %u has already been "
+        "removed from the rtx queue; the first available is %u",
+        seqnum, data->first_seqnum);
+  } else {
+    GST_WARNING_OBJECT (rtx, "requested seqnum %u has not been "
+        "transmitted yet in the original stream; either the remote end "
+        "is not configured correctly, or the source is too slow", seqnum);
+  }
+#endif
+
+  return NULL;
 }
 
 static gboolean
@@ -765,6 +921,8 @@ gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
       if (gst_structure_has_name (s, "GstRTPRetransmissionRequest")) {
         guint seqnum = 0;
         guint ssrc = 0;
+        guint blp = 0;
+        GstBufferList *rtx_list = NULL;
         GstBuffer *rtx_buf = NULL;
 
         /* retrieve seqnum of the packet that need to be retransmitted */
@@ -775,53 +933,52 @@ gst_rtp_rtx_send_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         if (!gst_structure_get_uint (s, "ssrc", &ssrc))
           ssrc = -1;
 
-        GST_DEBUG_OBJECT (rtx, "got rtx request for seqnum: %u, ssrc: %X",
-            seqnum, ssrc);
+        /* bitmask of the following lost packets, like in a generic NACK */
+        if (!gst_structure_get_uint (s, "blp", &blp))
+          blp = 0;
+
+        GST_DEBUG_OBJECT (rtx, "got rtx request for seqnum: %u, blp: %04x, "
+            "ssrc: %X", seqnum, blp, ssrc);
 
         GST_OBJECT_LOCK (rtx);
         /* check if request is for us */
         if (g_hash_table_contains (rtx->ssrc_data, GUINT_TO_POINTER (ssrc))) {
           SSRCRtxData *data;
-          GSequenceIter *iter;
-          BufferQueueItem search_item;
 
-          /* update statistics */
+          /* update statistics, once per requested seqnum */
           ++rtx->num_rtx_requests;
 
           data = gst_rtp_rtx_send_get_ssrc_data (rtx, ssrc);
 
-          search_item.seqnum = seqnum;
-          iter = g_sequence_lookup (data->queue, &search_item,
-              (GCompareDataFunc) buffer_queue_items_cmp, NULL);
-          if (iter) {
-            BufferQueueItem *item = g_sequence_get (iter);
-            GST_LOG_OBJECT (rtx, "found %u", item->seqnum);
-            rtx_buf = gst_rtp_rtx_buffer_new (rtx, item->buffer);
-          }
-#ifndef GST_DISABLE_DEBUG
-          else {
-            BufferQueueItem *item = NULL;
-
-            iter = g_sequence_get_begin_iter (data->queue);
-            if (!g_sequence_iter_is_end (iter))
-              item = g_sequence_get (iter);
-
-            if (item && seqnum < item->seqnum) {
-              GST_DEBUG_OBJECT (rtx, "requested seqnum %u has already been "
-                  "removed from the rtx queue; the first available is %u",
-                  seqnum, item->seqnum);
-            } else {
-              GST_WARNING_OBJECT (rtx, "requested seqnum %u has not been "
-                  "transmitted yet in the original stream; either the remote end "
-                  "is not configured correctly, or the source is too slow",
-                  seqnum);
+          rtx_buf = gst_rtp_rtx_send_lookup (rtx, data, seqnum);
+
+          /* answer all the packets of the request with one list */
+          blp &= 0xffff;
+          while (blp) {
+            GstBuffer *buf;
+
+            seqnum++;
+            if (blp & 1) {
+              ++rtx->num_rtx_requests;
+              buf = gst_rtp_rtx_send_lookup (rtx, data, seqnum);
+              if (buf && rtx_buf) {
+                if (!rtx_list) {
+                  rtx_list = gst_buffer_list_new ();
+                  gst_buffer_list_add (rtx_list, rtx_buf);
+                }
+                gst_buffer_list_add (rtx_list, buf);
+              } else if (buf) {
+                rtx_buf = buf;
+              }
             }
+            blp >>= 1;
           }
-#endif
         }
         GST_OBJECT_UNLOCK (rtx);
 
-        if (rtx_buf)
+        if (rtx_list)
+          gst_rtp_rtx_send_push_out (rtx, rtx_list);
+        else if (rtx_buf)
           gst_rtp_rtx_send_push_out (rtx, rtx_buf);
 
         gst_event_unref (event);
@@ -981,14 +1138,12 @@ gst_rtp_rtx_send_get_ts_diff (SSRCRtxData * data)
   BufferQueueItem *high_buf, *low_buf;
   guint32 result;
 
-  high_buf =
-      g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter
-          (data->queue)));
-  low_buf = g_sequence_get (g_sequence_get_begin_iter (data->queue));
-
-  if (!high_buf || !low_buf || high_buf == low_buf)
+  if (data->history_len < 2)
     return 0;
 
+  high_buf = ssrc_rtx_data_get_item (data, data->last_seqnum);
+  low_buf = ssrc_rtx_data_get_item (data, data->first_seqnum);
+
   if (data->clock_rate) {
     high_ts = high_buf->timestamp;
     low_ts = low_buf->timestamp;
@@ -1014,7 +1169,6 @@ static void
 process_buffer (GstRtpRtxSend * rtx, GstBuffer * buffer)
 {
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  BufferQueueItem *item;
   SSRCRtxData *data;
   guint16 seqnum;
   guint8 payload_type;
@@ -1042,20 +1196,16 @@ process_buffer (GstRtpRtxSend * rtx, GstBuffer * buffer)
     }
 
     /* add current rtp buffer to queue history */
-    item = g_new0 (BufferQueueItem, 1);
-    item->seqnum = seqnum;
-    item->timestamp = rtptime;
-    item->buffer = gst_buffer_ref (buffer);
-    g_sequence_append (data->queue, item);
+    ssrc_rtx_data_push (data, buffer, seqnum, rtptime);
 
     /* remove oldest packets from history if they are too many */
     if (rtx->max_size_packets) {
-      while (g_sequence_get_length (data->queue) > rtx->max_size_packets)
-        g_sequence_remove (g_sequence_get_begin_iter (data->queue));
+      while (data->history_len > rtx->max_size_packets)
+        ssrc_rtx_data_pop (data);
     }
     if (rtx->max_size_time) {
       while (gst_rtp_rtx_send_get_ts_diff (data) > rtx->max_size_time)
-        g_sequence_remove (g_sequence_get_begin_iter (data->queue));
+        ssrc_rtx_data_pop (data);
     }
   }
 }
@@ -1098,6 +1248,52 @@ gst_rtp_rtx_send_chain_list (GstPad * pad, GstObject * parent,
   return ret;
 }
 
+/* Adds the retransmissions that are already waiting in the queue behind
+ * @object, e.g. the ones requested by the same NACK, to a buffer list so that
+ * they are pushed together */
+static GstBufferList *
+gst_rtp_rtx_send_pop_list (GstRtpRtxSend * rtx, GstMiniObject * object)
+{
+  GstBufferList *list = NULL;
+  GstDataQueueItem *data;
+
+  /* only the streaming task pops. A flush can still empty the queue between
+   * the check and the peek, but it sets the queue flushing first, so the
+   * peek fails instead of blocking */
+  while (!gst_data_queue_is_empty (rtx->queue)) {
+    if (!gst_data_queue_peek (rtx->queue, &data))
+      break;
+    if (!GST_IS_BUFFER (data->object) && !GST_IS_BUFFER_LIST (data->object))
+      break;
+    if (!gst_data_queue_pop (rtx->queue, &data))
+      break;
+
+    if (list == NULL) {
+      if (GST_IS_BUFFER_LIST (object)) {
+        list = gst_buffer_list_make_writable (GST_BUFFER_LIST (object));
+      } else {
+        list = gst_buffer_list_new ();
+        gst_buffer_list_add (list, GST_BUFFER (object));
+      }
+    }
+
+    if (GST_IS_BUFFER_LIST (data->object)) {
+      GstBufferList *other = GST_BUFFER_LIST (data->object);
+      guint i, len = gst_buffer_list_length (other);
+
+      for (i = 0; i < len; i++)
+        gst_buffer_list_add (list,
+            gst_buffer_ref (gst_buffer_list_get (other, i)));
+    } else {
+      gst_buffer_list_add (list, GST_BUFFER (data->object));
+      data->object = NULL;
+    }
+    data->destroy (data);
+  }
+
+  return list;
+}
+
 static void
 gst_rtp_rtx_send_src_loop (GstRtpRtxSend * rtx)
 {
@@ -1106,13 +1302,23 @@ gst_rtp_rtx_send_src_loop (GstRtpRtxSend * rtx)
   if (gst_data_queue_pop (rtx->queue, &data)) {
     GST_LOG_OBJECT (rtx, "pushing rtx buffer %p", data->object);
 
-    if (G_LIKELY (GST_IS_BUFFER (data->object))) {
+    if (G_LIKELY (GST_IS_BUFFER (data->object) ||
+            GST_IS_BUFFER_LIST (data->object))) {
+      GstBufferList *list;
+
+      list = gst_rtp_rtx_send_pop_list (rtx, data->object);
+      if (list == NULL && GST_IS_BUFFER_LIST (data->object))
+        list = GST_BUFFER_LIST (data->object);
+
       GST_OBJECT_LOCK (rtx);
       /* Update statistics just before pushing. */
-      rtx->num_rtx_packets++;
+      rtx->num_rtx_packets += list ? gst_buffer_list_length (list) : 1;
       GST_OBJECT_UNLOCK (rtx);
 
-      gst_pad_push (rtx->srcpad, GST_BUFFER (data->object));
+      if (list)
+        gst_pad_push_list (rtx->srcpad, list);
+      else
+        gst_pad_push (rtx->srcpad, GST_BUFFER (data->object));
     } else if (GST_IS_EVENT (data->object)) {
       gst_pad_push_event (rtx->srcpad, GST_EVENT (data->object));
 
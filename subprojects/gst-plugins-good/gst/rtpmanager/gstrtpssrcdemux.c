@@ -128,6 +128,8 @@ static void gst_rtp_ssrc_demux_clear_ssrc (GstRtpSsrcDemux * demux,
 /* sinkpad stuff */
 static GstFlowReturn gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static GstFlowReturn gst_rtp_ssrc_demux_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static gboolean gst_rtp_ssrc_demux_sink_event (GstPad * pad, GstObject * parent,
     GstEvent * event);
 
@@ -504,6 +506,7 @@ gst_rtp_ssrc_demux_class_init (GstRtpSsrcDemuxClass * klass)
       "rtpssrcdemux", 0, "RTP SSRC demuxer");
 
   GST_DEBUG_REGISTER_FUNCPTR (gst_rtp_ssrc_demux_chain);
+  GST_DEBUG_REGISTER_FUNCPTR (gst_rtp_ssrc_demux_chain_list);
   GST_DEBUG_REGISTER_FUNCPTR (gst_rtp_ssrc_demux_rtcp_chain);
 }
 
@@ -516,6 +519,8 @@ gst_rtp_ssrc_demux_init (GstRtpSsrcDemux * demux)
       gst_pad_new_from_template (gst_element_class_get_pad_template (klass,
           "sink"), "sink");
   gst_pad_set_chain_function (demux->rtp_sink, gst_rtp_ssrc_demux_chain);
+  gst_pad_set_chain_list_function (demux->rtp_sink,
+      gst_rtp_ssrc_demux_chain_list);
   gst_pad_set_event_function (demux->rtp_sink, gst_rtp_ssrc_demux_sink_event);
   gst_pad_set_iterate_internal_links_function (demux->rtp_sink,
       gst_rtp_ssrc_demux_iterate_internal_links_sink);
@@ -672,28 +677,42 @@ gst_rtp_ssrc_demux_sink_event (GstPad * pad, GstObject * parent,
   return fdata.res;
 }
 
-static GstFlowReturn
-gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+static gboolean
+gst_rtp_ssrc_demux_get_ssrc (GstBuffer * buf, guint32 * ssrc)
 {
-  GstFlowReturn ret;
-  GstRtpSsrcDemux *demux;
-  guint32 ssrc;
   GstRTPBuffer rtp = { NULL };
-  GstPad *srcpad;
-
-  demux = GST_RTP_SSRC_DEMUX (parent);
 
   if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
-    goto invalid_payload;
+    return FALSE;
 
-  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  *ssrc = gst_rtp_buffer_get_ssrc (&rtp);
   gst_rtp_buffer_unmap (&rtp);
 
-  GST_DEBUG_OBJECT (demux, "received buffer of SSRC %08x", ssrc);
+  return TRUE;
+}
+
+/* push a buffer or a list of packets that all have the same SSRC */
+static GstFlowReturn
+gst_rtp_ssrc_demux_push_rtp (GstRtpSsrcDemux * demux, guint32 ssrc,
+    GstMiniObject * obj)
+{
+  GstFlowReturn ret;
+  GstPad *srcpad;
+  guint n = 1;
+
+  if (GST_IS_BUFFER_LIST (obj))
+    n = gst_buffer_list_length (GST_BUFFER_LIST_CAST (obj));
+
+  GST_DEBUG_OBJECT (demux, "received %u buffers of SSRC %08x", n, ssrc);
 
   srcpad = find_or_create_demux_pad_for_ssrc (demux, ssrc, RTP_PAD);
-  if (srcpad == NULL)
-    goto create_failed;
+  if (srcpad == NULL) {
+    GST_WARNING_OBJECT (demux,
+        "Dropping %u buffers SSRC %08x. "
+        "Max streams number reached (%u)", n, ssrc, demux->max_streams);
+    gst_mini_object_unref (obj);
+    return GST_FLOW_OK;
+  }
 
   if (!GST_PAD_STICKIES_SENT (srcpad)) {
     forward_initial_events (demux, ssrc, srcpad, RTP_PAD);
@@ -701,7 +720,10 @@ gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   }
 
   /* push to srcpad */
-  ret = gst_pad_push (srcpad, buf);
+  if (GST_IS_BUFFER_LIST (obj))
+    ret = gst_pad_push_list (srcpad, GST_BUFFER_LIST_CAST (obj));
+  else
+    ret = gst_pad_push (srcpad, GST_BUFFER_CAST (obj));
 
   if (ret != GST_FLOW_OK) {
     GstPad *active_pad;
@@ -720,6 +742,20 @@ gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   gst_object_unref (srcpad);
 
   return ret;
+}
+
+static GstFlowReturn
+gst_rtp_ssrc_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstRtpSsrcDemux *demux;
+  guint32 ssrc;
+
+  demux = GST_RTP_SSRC_DEMUX (parent);
+
+  if (!gst_rtp_ssrc_demux_get_ssrc (buf, &ssrc))
+    goto invalid_payload;
+
+  return gst_rtp_ssrc_demux_push_rtp (demux, ssrc, GST_MINI_OBJECT_CAST (buf));
 
   /* ERRORS */
 invalid_payload:
@@ -728,14 +764,87 @@ invalid_payload:
     gst_buffer_unref (buf);
     return GST_FLOW_OK;
   }
-create_failed:
-  {
-    gst_buffer_unref (buf);
-    GST_WARNING_OBJECT (demux,
-        "Dropping buffer SSRC %08x. "
-        "Max streams number reached (%u)", ssrc, demux->max_streams);
+}
+
+typedef struct
+{
+  guint32 ssrc;
+  GstBufferList *list;
+} GstRtpSsrcDemuxSubList;
+
+static GstFlowReturn
+gst_rtp_ssrc_demux_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpSsrcDemux *demux;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GArray *sublists;
+  guint32 ssrc, first_ssrc = 0;
+  guint i, j, n;
+
+  demux = GST_RTP_SSRC_DEMUX (parent);
+
+  n = gst_buffer_list_length (list);
+  if (n == 0) {
+    gst_buffer_list_unref (list);
     return GST_FLOW_OK;
   }
+
+  /* usually all packets of a list come from the same sender, then the list
+   * can be pushed as is */
+  for (i = 0; i < n; i++) {
+    if (!gst_rtp_ssrc_demux_get_ssrc (gst_buffer_list_get (list, i), &ssrc))
+      break;
+    if (i == 0)
+      first_ssrc = ssrc;
+    else if (ssrc != first_ssrc)
+      break;
+  }
+  if (i == n)
+    return gst_rtp_ssrc_demux_push_rtp (demux, first_ssrc,
+        GST_MINI_OBJECT_CAST (list));
+
+  /* otherwise split it in one list per SSRC, keeping the order of the
+   * packets of each SSRC */
+  sublists = g_array_new (FALSE, FALSE, sizeof (GstRtpSsrcDemuxSubList));
+  for (i = 0; i < n; i++) {
+    GstBuffer *buf = gst_buffer_list_get (list, i);
+    GstRtpSsrcDemuxSubList *sublist = NULL;
+
+    if (!gst_rtp_ssrc_demux_get_ssrc (buf, &ssrc)) {
+      GST_DEBUG_OBJECT (demux, "Dropping invalid RTP packet");
+      continue;
+    }
+
+    for (j = 0; j < sublists->len; j++) {
+      sublist = &g_array_index (sublists, GstRtpSsrcDemuxSubList, j);
+      if (sublist->ssrc == ssrc)
+        break;
+    }
+    if (j == sublists->len) {
+      GstRtpSsrcDemuxSubList new_sublist = { ssrc, gst_buffer_list_new () };
+
+      g_array_append_val (sublists, new_sublist);
+      sublist = &g_array_index (sublists, GstRtpSsrcDemuxSubList, j);
+    }
+
+    gst_buffer_list_add (sublist->list, gst_buffer_ref (buf));
+  }
+  gst_buffer_list_unref (list);
+
+  for (j = 0; j < sublists->len; j++) {
+    GstRtpSsrcDemuxSubList *sublist =
+        &g_array_index (sublists, GstRtpSsrcDemuxSubList, j);
+
+    if (ret == GST_FLOW_OK)
+      ret = gst_rtp_ssrc_demux_push_rtp (demux, sublist->ssrc,
+          GST_MINI_OBJECT_CAST (sublist->list));
+    else
+      gst_buffer_list_unref (sublist->list);
+  }
+  g_array_free (sublists, TRUE);
+
+  return ret;
 }
 
 static GstFlowReturn
@@ -45,6 +45,10 @@
  * packets will arrive after the media packets, causing no reconstruction to
  * take place, just a few checks upon chaining.
  *
+ * Media packets, and the row and column FEC packets protecting each media
+ * packet, are stored in rings indexed by seqnum, so that these checks are
+ * constant-time lookups.
+ *
  * ## sender / receiver example
  *
  * ``` shell
@@ -87,12 +91,20 @@
 #include <gst/rtp/gstrtpbuffer.h>
 
 #include "gstrtpst2022-1-fecdec.h"
+#include "gstrtpst2022-1-fecxor.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtpst_2022_1_fecdec_debug);
 #define GST_CAT_DEFAULT gst_rtpst_2022_1_fecdec_debug
 
 #define DEFAULT_SIZE_TIME (GST_SECOND)
 
+/* the rings grow up to half of the seqnum space, so that the seqnums they
+ * hold can always be ordered */
+#define RING_MIN_SIZE 256
+#define RING_MAX_SIZE 32768
+/* like RTP_MAX_MISORDER in rtpsource.c */
+#define MAX_MISORDER 100
+
 typedef struct
 {
   guint16 seq;
@@ -100,7 +112,7 @@ typedef struct
 } Item;
 
 static GstFlowReturn store_media_item (GstRTPST_2022_1_FecDec * dec,
-    GstRTPBuffer * rtp, Item * item);
+    guint16 seq, GstBuffer * buffer);
 
 static void
 free_item (Item * item)
@@ -110,12 +122,6 @@ free_item (Item * item)
   g_free (item);
 }
 
-static gint
-cmp_items (Item * a, Item * b, gpointer unused)
-{
-  return gst_rtp_buffer_compare_seqnum (b->seq, a->seq);
-}
-
 enum
 {
   PROP_0,
@@ -136,9 +142,21 @@ struct _GstRTPST_2022_1_FecDec
   GList *fec_sinkpads;
 
   /* All the following field are protected by the OBJECT_LOCK */
-  GSequence *packets;
-  GHashTable *column_fec_packets;
-  GSequence *fec_packets[2];
+
+  /* media packets, a ring of packets_size (a power of two) items indexed
+   * by seqnum. It holds n_packets packets with seqnums from first_seq to
+   * last_seq, both of which are always present */
+  Item *packets;
+  guint packets_size;
+  guint n_packets;
+  guint16 first_seq, last_seq;
+
+  /* stored column (0) and row (1) FEC packets in arrival order, and for
+   * each media seqnum the FEC packet protecting it, in a ring of
+   * fec_index_size items indexed by seqnum */
+  GQueue fec_packets[2];
+  Item **fec_index[2];
+  guint fec_index_size[2];
   /* N columns */
   guint l;
   /* N rows */
@@ -195,94 +213,267 @@ G_DEFINE_TYPE (GstRTPST_2022_1_FecDec, gst_rtpst_2022_1_fecdec,
 GST_ELEMENT_REGISTER_DEFINE (rtpst2022_1_fecdec, "rtpst2022-1-fecdec",
     GST_RANK_NONE, GST_TYPE_RTPST_2022_1_FECDEC);
 
+static inline Item *
+get_media_item (GstRTPST_2022_1_FecDec * dec, guint16 seqnum)
+{
+  return &dec->packets[seqnum & (dec->packets_size - 1)];
+}
+
+static GstBuffer *
+lookup_media_packet (GstRTPST_2022_1_FecDec * dec, guint16 seqnum)
+{
+  Item *item = get_media_item (dec, seqnum);
+
+  if (item->buffer == NULL || item->seq != seqnum)
+    return NULL;
+
+  return item->buffer;
+}
+
+/* removes the media packet with the lowest seqnum */
 static void
-trim_items (GstRTPST_2022_1_FecDec * dec)
+pop_media_packet (GstRTPST_2022_1_FecDec * dec)
 {
-  GSequenceIter *tmp_iter, *iter = NULL;
+  Item *item = get_media_item (dec, dec->first_seq);
 
-  for (tmp_iter = g_sequence_get_begin_iter (dec->packets);
-      tmp_iter; tmp_iter = g_sequence_iter_next (tmp_iter)) {
-    Item *item;
+  gst_buffer_replace (&item->buffer, NULL);
+  if (--dec->n_packets == 0)
+    return;
 
-    if (g_sequence_iter_is_end (tmp_iter))
-      break;
+  /* skip the lost packets, each item is only skipped once so this is
+   * O(1) amortized */
+  do {
+    item = get_media_item (dec, ++dec->first_seq);
+  } while (item->buffer == NULL);
+}
+
+static void
+clear_media_packets (GstRTPST_2022_1_FecDec * dec)
+{
+  guint i;
+
+  for (i = 0; i < dec->packets_size && dec->n_packets > 0; i++) {
+    if (dec->packets[i].buffer) {
+      gst_buffer_replace (&dec->packets[i].buffer, NULL);
+      dec->n_packets--;
+    }
+  }
+}
+
+static void
+resize_media_packets (GstRTPST_2022_1_FecDec * dec, guint size)
+{
+  Item *packets = g_new0 (Item, size);
+  guint i;
+
+  for (i = 0; i < dec->packets_size; i++) {
+    Item *item = &dec->packets[i];
+
+    if (item->buffer)
+      packets[item->seq & (size - 1)] = *item;
+  }
+  g_free (dec->packets);
+  dec->packets = packets;
+  dec->packets_size = size;
+}
+
+/* Stores a ref to @buffer, unless it is too old to fit in the ring */
+static void
+insert_media_packet (GstRTPST_2022_1_FecDec * dec, guint16 seq,
+    GstBuffer * buffer)
+{
+  Item *item;
+
+  if (dec->n_packets == 0) {
+    dec->first_seq = dec->last_seq = seq;
+  } else if ((guint16) (seq - dec->first_seq) >
+      (guint16) (dec->last_seq - dec->first_seq)) {
+    guint gap = (guint16) (seq - dec->last_seq);
+    guint back = (guint16) (dec->first_seq - seq);
+
+    if (gap >= RING_MAX_SIZE) {
+      /* older than all the stored packets. Keep it when it still fits into
+       * the ring, ignore it when it is just late and start over when the
+       * seqnums jumped back */
+      if ((guint16) (dec->last_seq - seq) < dec->packets_size) {
+        dec->first_seq = seq;
+        goto store;
+      }
+      if (back <= MAX (dec->packets_size, MAX_MISORDER))
+        return;
+      clear_media_packets (dec);
+    } else {
+      guint span = (guint16) (dec->last_seq - dec->first_seq) + gap + 1;
+      guint size = dec->packets_size;
+
+      while (size < span && size < RING_MAX_SIZE)
+        size <<= 1;
+      if (size != dec->packets_size)
+        resize_media_packets (dec, size);
+
+      while (dec->n_packets > 0 &&
+          (guint16) (seq - dec->first_seq) >= dec->packets_size)
+        pop_media_packet (dec);
+    }
 
-    item = g_sequence_get (tmp_iter);
+    if (dec->n_packets == 0)
+      dec->first_seq = seq;
+    dec->last_seq = seq;
+  }
+
+store:
+  item = get_media_item (dec, seq);
+  if (item->buffer)
+    gst_buffer_unref (item->buffer);
+  else
+    dec->n_packets++;
+  item->seq = seq;
+  item->buffer = gst_buffer_ref (buffer);
+}
+
+static void
+trim_items (GstRTPST_2022_1_FecDec * dec)
+{
+  Item *item = NULL;
+  guint n_trimmed = 0;
+
+  while (dec->n_packets > 0) {
+    item = get_media_item (dec, dec->first_seq);
 
     if (dec->max_arrival_time - GST_BUFFER_DTS_OR_PTS (item->buffer) <
         dec->size_time)
       break;
 
-    iter = tmp_iter;
+    if (n_trimmed++ == 0)
+      GST_TRACE_OBJECT (dec,
+          "Trimming packets from %" GST_TIME_FORMAT " (seq: %u)",
+          GST_TIME_ARGS (GST_BUFFER_DTS_OR_PTS (item->buffer)), item->seq);
+
+    pop_media_packet (dec);
   }
+}
 
-  if (iter) {
-    Item *item = g_sequence_get (iter);
-    GST_TRACE_OBJECT (dec,
-        "Trimming packets up to %" GST_TIME_FORMAT " (seq: %u)",
-        GST_TIME_ARGS (GST_BUFFER_DTS_OR_PTS (item->buffer)), item->seq);
-    g_sequence_remove_range (g_sequence_get_begin_iter (dec->packets),
-        g_sequence_iter_next (iter));
+/* Whether the FEC packet @item, with base seqnum item->seq, protects the
+ * media packet @seq */
+static gboolean
+fec_item_protects (GstRTPST_2022_1_FecDec * dec, Item * item, guint D,
+    guint16 seq)
+{
+  guint diff = (guint16) (seq - item->seq);
+
+  if (D)
+    return diff < dec->l;
+
+  return diff % dec->l == 0 && diff / dec->l < dec->d;
+}
+
+static void
+index_fec_item (GstRTPST_2022_1_FecDec * dec, guint D, Item * item)
+{
+  guint n = D ? dec->l : dec->d;
+  guint step = D ? 1 : dec->l;
+  guint mask = dec->fec_index_size[D] - 1;
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    guint16 seq = item->seq + i * step;
+
+    dec->fec_index[D][seq & mask] = item;
   }
 }
 
 static void
-trim_fec_items (GstRTPST_2022_1_FecDec * dec, guint D)
+resize_fec_index (GstRTPST_2022_1_FecDec * dec, guint D, guint size)
 {
-  GSequenceIter *tmp_iter, *iter = NULL;
+  GList *l;
 
-  for (tmp_iter = g_sequence_get_begin_iter (dec->fec_packets[D]);
-      tmp_iter; tmp_iter = g_sequence_iter_next (tmp_iter)) {
-    Item *item;
+  g_free (dec->fec_index[D]);
+  dec->fec_index[D] = g_new0 (Item *, size);
+  dec->fec_index_size[D] = size;
 
-    if (g_sequence_iter_is_end (tmp_iter))
-      break;
+  for (l = dec->fec_packets[D].head; l; l = l->next)
+    index_fec_item (dec, D, l->data);
+}
 
-    item = g_sequence_get (tmp_iter);
+static void
+store_fec_item (GstRTPST_2022_1_FecDec * dec, guint D, Item * item)
+{
+  guint n = D ? dec->l : dec->d;
+  guint step = D ? 1 : dec->l;
+  guint i;
 
-    if (dec->max_fec_arrival_time[D] - GST_BUFFER_DTS_OR_PTS (item->buffer) <
-        dec->size_time)
-      break;
+  g_queue_push_tail (&dec->fec_packets[D], item);
 
-    if (!D) {
-      guint i;
-      guint16 seq;
+  /* make sure no other stored FEC packet protects a seqnum that maps to
+   * the same slot. A later FEC packet protecting the same seqnum (a
+   * duplicate) replaces the earlier one */
+  for (i = 0; i < n && dec->fec_index_size[D] <= G_MAXUINT16;) {
+    guint16 seq = item->seq + i * step;
+    Item *other = dec->fec_index[D][seq & (dec->fec_index_size[D] - 1)];
 
-      for (i = 0; i < dec->d; i++) {
-        seq = item->seq + i * dec->l;
-        g_hash_table_remove (dec->column_fec_packets, GUINT_TO_POINTER (seq));
-      }
+    if (other && !fec_item_protects (dec, other, D, seq)) {
+      resize_fec_index (dec, D, dec->fec_index_size[D] * 2);
+      i = 0;
+      continue;
     }
+    i++;
+  }
+
+  index_fec_item (dec, D, item);
+}
+
+static void
+unindex_fec_item (GstRTPST_2022_1_FecDec * dec, guint D, Item * item)
+{
+  guint n = D ? dec->l : dec->d;
+  guint step = D ? 1 : dec->l;
+  guint mask = dec->fec_index_size[D] - 1;
+  guint i;
 
-    iter = tmp_iter;
+  for (i = 0; i < n; i++) {
+    guint16 seq = item->seq + i * step;
+
+    if (dec->fec_index[D][seq & mask] == item)
+      dec->fec_index[D][seq & mask] = NULL;
   }
+}
+
+static void
+trim_fec_items (GstRTPST_2022_1_FecDec * dec, guint D)
+{
+  Item *item;
+  guint n_trimmed = 0;
+
+  while ((item = g_queue_peek_head (&dec->fec_packets[D]))) {
+    if (dec->max_fec_arrival_time[D] - GST_BUFFER_DTS_OR_PTS (item->buffer) <
+        dec->size_time)
+      break;
 
-  if (iter) {
-    Item *item = g_sequence_get (iter);
-    GST_TRACE_OBJECT (dec,
-        "Trimming %s FEC packets up to %" GST_TIME_FORMAT " (seq: %u)",
-        D ? "row" : "column",
-        GST_TIME_ARGS (GST_BUFFER_DTS_OR_PTS (item->buffer)), item->seq);
-    g_sequence_remove_range (g_sequence_get_begin_iter (dec->fec_packets[D]),
-        g_sequence_iter_next (iter));
+    if (n_trimmed++ == 0)
+      GST_TRACE_OBJECT (dec,
+          "Trimming %s FEC packets from %" GST_TIME_FORMAT " (seq: %u)",
+          D ? "row" : "column",
+          GST_TIME_ARGS (GST_BUFFER_DTS_OR_PTS (item->buffer)), item->seq);
+
+    g_queue_pop_head (&dec->fec_packets[D]);
+    unindex_fec_item (dec, D, item);
+    free_item (item);
   }
 }
 
 static Item *
-lookup_media_packet (GstRTPST_2022_1_FecDec * dec, guint16 seqnum)
+lookup_fec_item (GstRTPST_2022_1_FecDec * dec, guint D, guint16 seqnum)
 {
-  GSequenceIter *iter;
-  Item *ret = NULL;
-  Item dummy = { seqnum, NULL };
+  Item *item;
 
-  iter =
-      g_sequence_lookup (dec->packets, &dummy, (GCompareDataFunc) cmp_items,
-      NULL);
+  if (dec->fec_index[D] == NULL)
+    return NULL;
 
-  if (iter)
-    ret = g_sequence_get (iter);
+  item = dec->fec_index[D][seqnum & (dec->fec_index_size[D] - 1)];
+  if (item && !fec_item_protects (dec, item, D, seqnum))
+    item = NULL;
 
-  return ret;
+  return item;
 }
 
 static gboolean
@@ -326,94 +517,43 @@ done:
 static Item *
 get_row_fec (GstRTPST_2022_1_FecDec * dec, guint16 seqnum)
 {
-  GSequenceIter *iter;
-  Item *ret = NULL;
-  Item dummy = { 0, };
-
   if (dec->l == G_MAXUINT)
-    goto done;
-
-  /* Potential underflow is intended */
-  dummy.seq = seqnum - dec->l;
-
-  iter =
-      g_sequence_search (dec->fec_packets[1], &dummy,
-      (GCompareDataFunc) cmp_items, NULL);
-
-  if (!g_sequence_iter_is_end (iter)) {
-    gint seqdiff;
-    ret = g_sequence_get (iter);
+    return NULL;
 
-    seqdiff = gst_rtp_buffer_compare_seqnum (ret->seq, seqnum);
-
-    /* Now check whether the fec packet does apply */
-    if (seqdiff < 0 || seqdiff >= dec->l)
-      ret = NULL;
-  }
-
-done:
-  return ret;
+  return lookup_fec_item (dec, 1, seqnum);
 }
 
 static Item *
 get_column_fec (GstRTPST_2022_1_FecDec * dec, guint16 seqnum)
 {
-  Item *ret = NULL;
-
   if (dec->l == G_MAXUINT || dec->d == G_MAXUINT)
-    goto done;
-
-  ret =
-      g_hash_table_lookup (dec->column_fec_packets, GUINT_TO_POINTER (seqnum));
-
-done:
-  return ret;
-}
-
-static void
-_xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
-{
-  guint i;
+    return NULL;
 
-  for (i = 0; i < (length / sizeof (guint64)); ++i) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    GST_WRITE_UINT64_LE (dst,
-        GST_READ_UINT64_LE (dst) ^ GST_READ_UINT64_LE (src));
-#else
-    GST_WRITE_UINT64_BE (dst,
-        GST_READ_UINT64_BE (dst) ^ GST_READ_UINT64_BE (src));
-#endif
-    dst += sizeof (guint64);
-    src += sizeof (guint64);
-  }
-  for (i = 0; i < (length % sizeof (guint64)); ++i)
-    dst[i] ^= src[i];
+  return lookup_fec_item (dec, 0, seqnum);
 }
 
 static GstFlowReturn
-xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
-    guint16 seqnum)
+xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec,
+    GstBuffer ** packets, guint n_packets, guint16 seqnum)
 {
   guint8 *xored;
   guint32 xored_timestamp;
   guint8 xored_pt;
   guint16 xored_payload_len;
-  Item *item;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
-  GList *tmp;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *buffer;
   gboolean xored_marker;
   gboolean xored_padding;
   gboolean xored_extension;
+  guint i;
 
   /* Figure out the recovered packet length first */
   xored_payload_len = fec->len;
-  for (tmp = packets; tmp; tmp = tmp->next) {
+  for (i = 0; i < n_packets; i++) {
     GstRTPBuffer media_rtp = GST_RTP_BUFFER_INIT;
-    Item *item = (Item *) tmp->data;
 
-    gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &media_rtp);
+    gst_rtp_buffer_map (packets[i], GST_MAP_READ, &media_rtp);
     xored_payload_len ^= gst_rtp_buffer_get_payload_len (&media_rtp);
     gst_rtp_buffer_unmap (&media_rtp);
   }
@@ -424,10 +564,8 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
     goto done;
   }
 
-  item = g_malloc0 (sizeof (Item));
-  item->seq = seqnum;
-  item->buffer = gst_rtp_buffer_new_allocate (xored_payload_len, 0, 0);
-  gst_rtp_buffer_map (item->buffer, GST_MAP_WRITE, &rtp);
+  buffer = gst_rtp_buffer_new_allocate (xored_payload_len, 0, 0);
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
 
   xored = gst_rtp_buffer_get_payload (&rtp);
   memcpy (xored, fec->payload, xored_payload_len);
@@ -437,12 +575,12 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
   xored_padding = fec->padding;
   xored_extension = fec->extension;
 
-  for (tmp = packets; tmp; tmp = tmp->next) {
+  for (i = 0; i < n_packets; i++) {
     GstRTPBuffer media_rtp = GST_RTP_BUFFER_INIT;
-    Item *item = (Item *) tmp->data;
 
-    gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &media_rtp);
-    _xor_mem (xored, gst_rtp_buffer_get_payload (&media_rtp),
+    gst_rtp_buffer_map (packets[i], GST_MAP_READ, &media_rtp);
+    gst_rtpst_2022_1_fec_xor_mem (xored,
+        gst_rtp_buffer_get_payload (&media_rtp),
         MIN (gst_rtp_buffer_get_payload_len (&media_rtp), xored_payload_len));
     xored_timestamp ^= gst_rtp_buffer_get_timestamp (&media_rtp);
     xored_pt ^= gst_rtp_buffer_get_payload_type (&media_rtp);
@@ -457,7 +595,7 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
       "Recovered buffer through %s FEC with seqnum %u, payload len %u and timestamp %u",
       fec->D ? "row" : "column", seqnum, xored_payload_len, xored_timestamp);
 
-  GST_BUFFER_DTS (item->buffer) = dec->max_arrival_time;
+  GST_BUFFER_DTS (buffer) = dec->max_arrival_time;
 
   gst_rtp_buffer_set_timestamp (&rtp, xored_timestamp);
   gst_rtp_buffer_set_seq (&rtp, seqnum);
@@ -468,18 +606,11 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
 
   gst_rtp_buffer_unmap (&rtp);
 
-  /* Store a ref on item->buffer as store_media_item may
-   * recurse and call this method again, potentially releasing
-   * the object lock and leaving our item unprotected in
-   * dec->packets
-   */
-  buffer = gst_buffer_ref (item->buffer);
-
   /* It is right that we should celebrate,
-   * for your brother was dead, and is alive again */
-  gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &rtp);
-  ret = store_media_item (dec, &rtp, item);
-  gst_rtp_buffer_unmap (&rtp);
+   * for your brother was dead, and is alive again. store_media_item
+   * keeps its own ref on the buffer, it may recurse and call this method
+   * again, potentially releasing the object lock */
+  ret = store_media_item (dec, seqnum, buffer);
 
   if (ret == GST_FLOW_OK) {
     /* Unlocking here is safe */
@@ -498,7 +629,8 @@ done:
 static GstFlowReturn
 check_fec (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec)
 {
-  GList *packets = NULL;
+  /* L and D are at most 255 */
+  GstBuffer *packets[256];
   gint missing_seq = -1;
   guint n_packets = 0;
   guint required_n_packets;
@@ -510,11 +642,10 @@ check_fec (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec)
     required_n_packets = dec->l;
 
     for (i = 0; i < dec->l; i++) {
-      Item *item = lookup_media_packet (dec, fec->seq + i);
+      GstBuffer *buffer = lookup_media_packet (dec, fec->seq + i);
 
-      if (item) {
-        packets = g_list_prepend (packets, item);
-        n_packets += 1;
+      if (buffer) {
+        packets[n_packets++] = buffer;
       } else {
         missing_seq = fec->seq + i;
       }
@@ -525,11 +656,10 @@ check_fec (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec)
     required_n_packets = dec->d;
 
     for (i = 0; i < dec->d; i++) {
-      Item *item = lookup_media_packet (dec, fec->seq + i * dec->l);
+      GstBuffer *buffer = lookup_media_packet (dec, fec->seq + i * dec->l);
 
-      if (item) {
-        packets = g_list_prepend (packets, item);
-        n_packets += 1;
+      if (buffer) {
+        packets[n_packets++] = buffer;
       } else {
         missing_seq = fec->seq + i * dec->l;
       }
@@ -542,13 +672,12 @@ check_fec (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec)
         "All media packets present, we can discard that FEC packet");
   } else if (n_packets + 1 == required_n_packets) {
     g_assert (missing_seq != -1);
-    ret = xor_items (dec, fec, packets, missing_seq);
+    ret = xor_items (dec, fec, packets, n_packets, missing_seq);
     GST_LOG_OBJECT (dec, "We have enough info to reconstruct %u", missing_seq);
   } else {
     ret = GST_FLOW_CUSTOM_SUCCESS;
     GST_LOG_OBJECT (dec, "Too many media packets missing, storing FEC packet");
   }
-  g_list_free (packets);
 
   return ret;
 }
@@ -558,30 +687,32 @@ check_fec_item (GstRTPST_2022_1_FecDec * dec, Item * item)
 {
   Rtp2DFecHeader fec;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
   GstFlowReturn ret;
 
-  gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &rtp);
+  /* check_fec may release the object lock, during which the FEC packet
+   * could get trimmed */
+  buffer = gst_buffer_ref (item->buffer);
+  gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp);
 
   parse_header (&rtp, &fec);
 
   ret = check_fec (dec, &fec);
 
   gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
 
   return ret;
 }
 
 static GstFlowReturn
-store_media_item (GstRTPST_2022_1_FecDec * dec, GstRTPBuffer * rtp, Item * item)
+store_media_item (GstRTPST_2022_1_FecDec * dec, guint16 seq,
+    GstBuffer * buffer)
 {
   GstFlowReturn ret = GST_FLOW_OK;
   Item *fec_item;
-  guint16 seq;
 
-  seq = gst_rtp_buffer_get_seq (rtp);
-
-  g_sequence_insert_sorted (dec->packets, item, (GCompareDataFunc) cmp_items,
-      NULL);
+  insert_media_packet (dec, seq, buffer);
 
   if ((fec_item = get_row_fec (dec, seq))) {
     ret = check_fec_item (dec, fec_item);
@@ -598,21 +729,6 @@ store_media_item (GstRTPST_2022_1_FecDec * dec, GstRTPBuffer * rtp, Item * item)
   return ret;
 }
 
-static GstFlowReturn
-store_media (GstRTPST_2022_1_FecDec * dec, GstRTPBuffer * rtp,
-    GstBuffer * buffer)
-{
-  Item *item;
-  guint16 seq;
-
-  seq = gst_rtp_buffer_get_seq (rtp);
-  item = g_malloc0 (sizeof (Item));
-  item->buffer = gst_buffer_ref (buffer);
-  item->seq = seq;
-
-  return store_media_item (dec, rtp, item);
-}
-
 static GstFlowReturn
 gst_rtpst_2022_1_fecdec_sink_chain_fec (GstPad * pad, GstObject * parent,
     GstBuffer * buffer)
@@ -685,18 +801,7 @@ gst_rtpst_2022_1_fecdec_sink_chain_fec (GstPad * pad, GstObject * parent,
     item->buffer = buffer;
     item->seq = fec.seq;
 
-    if (!fec.D) {
-      guint i;
-      guint16 seq;
-
-      for (i = 0; i < dec->d; i++) {
-        seq = fec.seq + i * dec->l;
-        g_hash_table_insert (dec->column_fec_packets, GUINT_TO_POINTER (seq),
-            item);
-      }
-    }
-    g_sequence_insert_sorted (dec->fec_packets[fec.D], item,
-        (GCompareDataFunc) cmp_items, NULL);
+    store_fec_item (dec, fec.D, item);
     ret = GST_FLOW_OK;
   } else {
     goto discard;
@@ -734,7 +839,7 @@ gst_rtpst_2022_1_fecdec_sink_chain (GstPad * pad, GstObject * parent,
   dec->max_arrival_time =
       MAX (dec->max_arrival_time, GST_BUFFER_DTS_OR_PTS (buffer));
   trim_items (dec);
-  ret = store_media (dec, &rtp, buffer);
+  ret = store_media_item (dec, gst_rtp_buffer_get_seq (&rtp), buffer);
   GST_OBJECT_UNLOCK (dec);
 
   gst_rtp_buffer_unmap (&rtp);
@@ -773,28 +878,27 @@ gst_rtpst_2022_1_fecdec_reset (GstRTPST_2022_1_FecDec * dec, gboolean allocate)
   GST_OBJECT_LOCK (dec);
 
   if (dec->packets) {
-    g_sequence_free (dec->packets);
+    clear_media_packets (dec);
+    g_free (dec->packets);
     dec->packets = NULL;
-  }
-
-  if (dec->column_fec_packets) {
-    g_hash_table_unref (dec->column_fec_packets);
-    dec->column_fec_packets = NULL;
+    dec->packets_size = 0;
   }
 
   if (allocate) {
-    dec->packets = g_sequence_new ((GDestroyNotify) free_item);
-    dec->column_fec_packets = g_hash_table_new (g_direct_hash, g_direct_equal);
+    dec->packets = g_new0 (Item, RING_MIN_SIZE);
+    dec->packets_size = RING_MIN_SIZE;
   }
 
   for (i = 0; i < 2; i++) {
-    if (dec->fec_packets[i]) {
-      g_sequence_free (dec->fec_packets[i]);
-      dec->fec_packets[i] = NULL;
+    g_queue_clear_full (&dec->fec_packets[i], (GDestroyNotify) free_item);
+    g_free (dec->fec_index[i]);
+    dec->fec_index[i] = NULL;
+    dec->fec_index_size[i] = 0;
+
+    if (allocate) {
+      dec->fec_index[i] = g_new0 (Item *, RING_MIN_SIZE);
+      dec->fec_index_size[i] = RING_MIN_SIZE;
     }
-
-    if (allocate)
-      dec->fec_packets[i] = g_sequence_new ((GDestroyNotify) free_item);
   }
 
   dec->d = G_MAXUINT;
@@ -69,6 +69,7 @@
 #include <gst/rtp/gstrtpbuffer.h>
 
 #include "gstrtpst2022-1-fecenc.h"
+#include "gstrtpst2022-1-fecxor.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtpst_2022_1_fecenc_debug);
 #define GST_CAT_DEFAULT gst_rtpst_2022_1_fecenc_debug
@@ -98,7 +99,9 @@ typedef struct
 
 typedef struct
 {
+  /* kept allocated from one FEC packet to the next */
   guint8 *xored_payload;
+  guint16 payload_alloc;
   guint32 xored_timestamp;
   guint8 xored_pt;
   guint16 xored_payload_len;
@@ -220,51 +223,50 @@ free_fec_packet (FecPacket * packet)
   g_free (packet);
 }
 
+/* Makes room for @len bytes of payload, zero-filling the new bytes */
 static void
-_xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
+fec_packet_ensure_payload (FecPacket * fec, guint16 len)
 {
-  guint i;
-
-  for (i = 0; i < (length / sizeof (guint64)); ++i) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    GST_WRITE_UINT64_LE (dst,
-        GST_READ_UINT64_LE (dst) ^ GST_READ_UINT64_LE (src));
-#else
-    GST_WRITE_UINT64_BE (dst,
-        GST_READ_UINT64_BE (dst) ^ GST_READ_UINT64_BE (src));
-#endif
-    dst += sizeof (guint64);
-    src += sizeof (guint64);
+  if (fec->payload_alloc < len) {
+    fec->xored_payload = g_realloc (fec->xored_payload, len);
+    fec->payload_alloc = len;
+  }
+  if (fec->payload_len < len) {
+    memset (fec->xored_payload + fec->payload_len, 0, len - fec->payload_len);
+    fec->payload_len = len;
   }
-  for (i = 0; i < (length % sizeof (guint64)); ++i)
-    dst[i] ^= src[i];
+}
+
+/* Starts a new FEC packet, keeping the payload allocation */
+static void
+fec_packet_reset (FecPacket * fec)
+{
+  guint8 *xored_payload = fec->xored_payload;
+  guint16 payload_alloc = fec->payload_alloc;
+
+  memset (fec, 0x00, sizeof (FecPacket));
+  fec->xored_payload = xored_payload;
+  fec->payload_alloc = payload_alloc;
 }
 
 static void
 fec_packet_update (FecPacket * fec, GstRTPBuffer * rtp)
 {
+  guint plen = gst_rtp_buffer_get_payload_len (rtp);
+
   if (fec->n_packets == 0) {
     fec->seq_base = gst_rtp_buffer_get_seq (rtp);
-    fec->payload_len = gst_rtp_buffer_get_payload_len (rtp);
-    fec->xored_payload_len = gst_rtp_buffer_get_payload_len (rtp);
+    fec->payload_len = 0;
+    fec_packet_ensure_payload (fec, plen);
+    fec->xored_payload_len = plen;
     fec->xored_pt = gst_rtp_buffer_get_payload_type (rtp);
     fec->xored_timestamp = gst_rtp_buffer_get_timestamp (rtp);
     fec->xored_marker = gst_rtp_buffer_get_marker (rtp);
     fec->xored_padding = gst_rtp_buffer_get_padding (rtp);
     fec->xored_extension = gst_rtp_buffer_get_extension (rtp);
-    fec->xored_payload = g_malloc (sizeof (guint8) * fec->payload_len);
-    memcpy (fec->xored_payload, gst_rtp_buffer_get_payload (rtp),
-        fec->payload_len);
+    memcpy (fec->xored_payload, gst_rtp_buffer_get_payload (rtp), plen);
   } else {
-    guint plen = gst_rtp_buffer_get_payload_len (rtp);
-
-    if (fec->payload_len < plen) {
-      fec->xored_payload =
-          g_realloc (fec->xored_payload, sizeof (guint8) * plen);
-      memset (fec->xored_payload + fec->payload_len, 0,
-          plen - fec->payload_len);
-      fec->payload_len = plen;
-    }
+    fec_packet_ensure_payload (fec, plen);
 
     fec->xored_payload_len ^= plen;
     fec->xored_pt ^= gst_rtp_buffer_get_payload_type (rtp);
@@ -272,7 +274,8 @@ fec_packet_update (FecPacket * fec, GstRTPBuffer * rtp)
     fec->xored_marker ^= gst_rtp_buffer_get_marker (rtp);
     fec->xored_padding ^= gst_rtp_buffer_get_padding (rtp);
     fec->xored_extension ^= gst_rtp_buffer_get_extension (rtp);
-    _xor_mem (fec->xored_payload, gst_rtp_buffer_get_payload (rtp), plen);
+    gst_rtpst_2022_1_fec_xor_mem (fec->xored_payload,
+        gst_rtp_buffer_get_payload (rtp), plen);
   }
 
   fec->n_packets += 1;
@@ -445,8 +448,7 @@ gst_rtpst_2022_1_fecenc_sink_chain (GstPad * pad, GstObject * parent,
     fec_packet_update (enc->row, &rtp);
     if (enc->row->n_packets == enc->l) {
       queue_fec_packet (enc, enc->row, TRUE);
-      g_free (enc->row->xored_payload);
-      memset (enc->row, 0x00, sizeof (FecPacket));
+      fec_packet_reset (enc->row);
     }
   }
 
@@ -456,8 +458,7 @@ gst_rtpst_2022_1_fecenc_sink_chain (GstPad * pad, GstObject * parent,
     fec_packet_update (column, &rtp);
     if (column->n_packets == enc->d) {
       queue_fec_packet (enc, column, FALSE);
-      g_free (column->xored_payload);
-      memset (column, 0x00, sizeof (FecPacket));
+      fec_packet_reset (column);
     }
 
     enc->current_column++;
@@ -633,8 +634,7 @@ gst_rtpst_2022_1_fecenc_set_property (GObject * object, guint prop_id,
         if (enc->columns) {
           for (i = 0; i < enc->l; i++) {
             FecPacket *column = g_ptr_array_index (enc->columns, i);
-            g_free (column->xored_payload);
-            memset (column, 0x00, sizeof (FecPacket));
+            fec_packet_reset (column);
           }
         }
         enc->current_column = 0;
@@ -0,0 +1,85 @@
+/* GStreamer
+ * Copyright (C) <2020> Mathieu Duponchelle <mathieu@centricular.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTPST_2022_1_FECXOR_H__
+#define __GST_RTPST_2022_1_FECXOR_H__
+
+#include <string.h>
+#include <glib.h>
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+G_BEGIN_DECLS
+
+/* XORs @length bytes of @src into @dst, the payloads of media packets are
+ * usually 1316 bytes long (7 MPEG-TS packets) so most of the work is done
+ * 64 bytes at a time */
+static inline void
+gst_rtpst_2022_1_fec_xor_mem (guint8 * restrict dst,
+    const guint8 * restrict src, gsize length)
+{
+  gsize i = 0;
+
+#if defined (HAVE_EMMINTRIN_H) && defined (__SSE2__)
+  for (; i + 64 <= length; i += 64) {
+    __m128i d0 = _mm_loadu_si128 ((const __m128i *) (dst + i));
+    __m128i d1 = _mm_loadu_si128 ((const __m128i *) (dst + i + 16));
+    __m128i d2 = _mm_loadu_si128 ((const __m128i *) (dst + i + 32));
+    __m128i d3 = _mm_loadu_si128 ((const __m128i *) (dst + i + 48));
+
+    d0 = _mm_xor_si128 (d0, _mm_loadu_si128 ((const __m128i *) (src + i)));
+    d1 = _mm_xor_si128 (d1,
+        _mm_loadu_si128 ((const __m128i *) (src + i + 16)));
+    d2 = _mm_xor_si128 (d2,
+        _mm_loadu_si128 ((const __m128i *) (src + i + 32)));
+    d3 = _mm_xor_si128 (d3,
+        _mm_loadu_si128 ((const __m128i *) (src + i + 48)));
+
+    _mm_storeu_si128 ((__m128i *) (dst + i), d0);
+    _mm_storeu_si128 ((__m128i *) (dst + i + 16), d1);
+    _mm_storeu_si128 ((__m128i *) (dst + i + 32), d2);
+    _mm_storeu_si128 ((__m128i *) (dst + i + 48), d3);
+  }
+  for (; i + 16 <= length; i += 16) {
+    __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i));
+
+    d = _mm_xor_si128 (d, _mm_loadu_si128 ((const __m128i *) (src + i)));
+    _mm_storeu_si128 ((__m128i *) (dst + i), d);
+  }
+#endif
+
+  /* the byte order doesn't matter for XOR, so let the compiler turn these
+   * into plain unaligned loads and stores */
+  for (; i + sizeof (guint64) <= length; i += sizeof (guint64)) {
+    guint64 d, s;
+
+    memcpy (&d, dst + i, sizeof (guint64));
+    memcpy (&s, src + i, sizeof (guint64));
+    d ^= s;
+    memcpy (dst + i, &d, sizeof (guint64));
+  }
+  for (; i < length; i++)
+    dst[i] ^= src[i];
+}
+
+G_END_DECLS
+
+#endif /* __GST_RTPST_2022_1_FECXOR_H__ */
@@ -17,6 +17,8 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <string.h>
+
 #include "gstrtputils.h"
 
 guint8
@@ -42,3 +44,61 @@ gst_rtp_get_extmap_id_for_attribute (const GstStructure * s,
   }
   return extmap_id;
 }
+
+/* Returns a writable @buffer in which the RTP header, including the CSRCs and
+ * the header extension, can be changed without the whole packet being copied.
+ * If the memory holding the header is shared with other buffers, only the
+ * header is copied into a memory of its own and the payload stays shared. */
+GstBuffer *
+gst_rtp_make_header_writable (GstBuffer * buffer)
+{
+  GstMemory *mem, *header, *payload;
+  GstMapInfo map, header_map;
+  gsize header_len;
+
+  buffer = gst_buffer_make_writable (buffer);
+
+  if (gst_buffer_n_memory (buffer) == 0 ||
+      gst_buffer_n_memory (buffer) >= gst_buffer_get_max_memory ())
+    return buffer;
+
+  mem = gst_buffer_peek_memory (buffer, 0);
+  if ((gst_memory_is_writable (mem) && !GST_MEMORY_IS_READONLY (mem)) ||
+      GST_MEMORY_FLAG_IS_SET (mem, GST_MEMORY_FLAG_NO_SHARE))
+    return buffer;
+
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    return buffer;
+
+  /* fixed header and CSRCs */
+  header_len = 12;
+  if (map.size >= header_len)
+    header_len += (map.data[0] & 0x0f) * 4;
+  /* header extension */
+  if (map.size >= header_len + 4 && (map.data[0] & 0x10))
+    header_len += 4 + GST_READ_UINT16_BE (map.data + header_len + 2) * 4;
+
+  /* nothing but the header in this memory, or not a valid RTP packet. Let
+   * the mapping copy it */
+  if (header_len >= map.size) {
+    gst_memory_unmap (mem, &map);
+    return buffer;
+  }
+
+  header = gst_allocator_alloc (NULL, header_len, NULL);
+  if (!gst_memory_map (header, &header_map, GST_MAP_WRITE)) {
+    gst_memory_unref (header);
+    gst_memory_unmap (mem, &map);
+    return buffer;
+  }
+  memcpy (header_map.data, map.data, header_len);
+  gst_memory_unmap (header, &header_map);
+  gst_memory_unmap (mem, &map);
+
+  payload = gst_memory_share (mem, header_len, -1);
+
+  gst_buffer_replace_memory (buffer, 0, header);
+  gst_buffer_insert_memory (buffer, 1, payload);
+
+  return buffer;
+}
@@ -30,6 +30,8 @@ GST_DEBUG_CATEGORY_STATIC (rtp_jitter_buffer_debug);
 
 #define MAX_WINDOW	RTP_JITTER_BUFFER_MAX_WINDOW
 #define MAX_TIME	(2 * GST_SECOND)
+#define MIN_INDEX	256
+#define MAX_INDEX	RTP_JITTER_BUFFER_MAX_INDEX
 
 /* signals and args */
 enum
@@ -45,6 +47,8 @@ enum
 /* GObject vmethods */
 static void rtp_jitter_buffer_finalize (GObject * object);
 
+static void index_rebuild (RTPJitterBuffer * jbuf, guint span);
+
 GType
 rtp_jitter_buffer_mode_get_type (void)
 {
@@ -90,6 +94,8 @@ rtp_jitter_buffer_init (RTPJitterBuffer * jbuf)
 
   g_queue_init (&jbuf->packets);
   jbuf->mode = RTP_JITTER_BUFFER_MODE_SLAVE;
+  jbuf->use_index = TRUE;
+  index_rebuild (jbuf, 0);
 
   rtp_jitter_buffer_reset_skew (jbuf);
 }
@@ -114,6 +120,8 @@ rtp_jitter_buffer_finalize (GObject * object)
     gst_object_unref (jbuf->pipeline_clock);
 
   rtp_jitter_buffer_flush (jbuf, NULL, NULL);
+  g_free (jbuf->index);
+  g_free (jbuf->index_map);
 
   g_mutex_clear (&jbuf->clock_lock);
 
@@ -380,6 +388,44 @@ rtp_jitter_buffer_set_rfc7273_sync (RTPJitterBuffer * jbuf,
   jbuf->rfc7273_sync = rfc7273_sync;
 }
 
+/**
+ * rtp_jitter_buffer_get_seqnum_index:
+ * @jbuf: an #RTPJitterBuffer
+ *
+ * Returns: %TRUE if packets are indexed by seqnum.
+ */
+gboolean
+rtp_jitter_buffer_get_seqnum_index (RTPJitterBuffer * jbuf)
+{
+  return jbuf->use_index;
+}
+
+/**
+ * rtp_jitter_buffer_set_seqnum_index:
+ * @jbuf: an #RTPJitterBuffer
+ * @enabled: whether to index packets by seqnum
+ *
+ * Enables or disables indexing the packets by seqnum. With the index,
+ * inserting a packet does not need to walk the queue as long as the packets
+ * span less than %RTP_JITTER_BUFFER_MAX_INDEX seqnums. This is enabled by
+ * default.
+ */
+void
+rtp_jitter_buffer_set_seqnum_index (RTPJitterBuffer * jbuf, gboolean enabled)
+{
+  if (jbuf->use_index == enabled)
+    return;
+
+  jbuf->use_index = enabled;
+  if (enabled) {
+    index_rebuild (jbuf, 0);
+  } else {
+    g_clear_pointer (&jbuf->index, g_free);
+    g_clear_pointer (&jbuf->index_map, g_free);
+    jbuf->index_size = 0;
+  }
+}
+
 /**
  * rtp_jitter_buffer_reset_skew:
  * @jbuf: an #RTPJitterBuffer
@@ -758,6 +804,220 @@ queue_do_insert (RTPJitterBuffer * jbuf, GList * list, GList * item)
   queue->length++;
 }
 
+/* The packets of the queue are sorted by seqnum. When the index is valid,
+ * each of them is also stored in the index slot of its seqnum, and all of
+ * them span less than index_size seqnums so that slots are never shared. A
+ * bitmap of the occupied slots is used to find the packet preceding a
+ * seqnum. When the packets span too many seqnums the index is invalidated
+ * and the queue is walked until they fit again. */
+#define INDEX_SLOT(jbuf,seqnum) ((seqnum) & ((jbuf)->index_size - 1))
+#define INDEX_ITEM(l) ((RTPJitterBufferItem *) (l))
+
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define index_msb64(x) (63 - __builtin_clzll (x))
+#else
+static inline gint
+index_msb64_inline (guint64 mask)
+{
+  gint nth_bit = 63;
+
+  do {
+    if (mask & (G_GUINT64_CONSTANT (1) << nth_bit))
+      return nth_bit;
+  } while (--nth_bit >= 0);
+
+  return -1;                    /* should not be reached, since mask must not be 0 */
+}
+
+#define index_msb64 index_msb64_inline
+#endif
+
+static inline gboolean
+index_is_set (RTPJitterBuffer * jbuf, guint slot)
+{
+  return (jbuf->index_map[slot >> 6] >> (slot & 63)) & 1;
+}
+
+static inline void
+index_add (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item)
+{
+  guint slot = INDEX_SLOT (jbuf, item->seqnum);
+
+  jbuf->index[slot] = item;
+  jbuf->index_map[slot >> 6] |= G_GUINT64_CONSTANT (1) << (slot & 63);
+}
+
+static inline void
+index_remove (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item)
+{
+  guint slot = INDEX_SLOT (jbuf, item->seqnum);
+
+  jbuf->index_map[slot >> 6] &= ~(G_GUINT64_CONSTANT (1) << (slot & 63));
+}
+
+/* Makes the index large enough for the packets in the queue and @span
+ * seqnums, and indexes all packets. */
+static void
+index_rebuild (RTPJitterBuffer * jbuf, guint span)
+{
+  guint size = MAX (jbuf->index_size, MIN_INDEX);
+  RTPJitterBufferItem *prev = NULL;
+  guint total = 0;
+  GList *l;
+
+  /* the walk in rtp_jitter_buffer_insert() may leave the packets out of
+   * order or spanning more than the seqnum range */
+  for (l = jbuf->packets.head; l; l = l->next) {
+    RTPJitterBufferItem *item = INDEX_ITEM (l);
+    gint gap;
+
+    if (item->seqnum == -1)
+      continue;
+
+    if (prev) {
+      gap = gst_rtp_buffer_compare_seqnum (prev->seqnum, item->seqnum);
+      if (gap <= 0 || (total += gap) >= MAX_INDEX) {
+        GST_DEBUG ("packets out of order, not indexing");
+        jbuf->index_valid = FALSE;
+        return;
+      }
+    }
+    prev = item;
+  }
+
+  span = MAX (span, total);
+  while (size <= span && size < MAX_INDEX)
+    size <<= 1;
+
+  if (size <= span) {
+    GST_DEBUG ("packets span %u seqnums, not indexing", span);
+    jbuf->index_valid = FALSE;
+    return;
+  }
+
+  if (size != jbuf->index_size) {
+    GST_DEBUG ("resizing index to %u", size);
+    g_free (jbuf->index);
+    g_free (jbuf->index_map);
+    jbuf->index = g_new (RTPJitterBufferItem *, size);
+    jbuf->index_map = g_new0 (guint64, size / 64);
+    jbuf->index_size = size;
+  } else {
+    memset (jbuf->index_map, 0, size / 8);
+  }
+  jbuf->index_valid = TRUE;
+
+  for (l = jbuf->packets.head; l; l = l->next) {
+    if (INDEX_ITEM (l)->seqnum != -1)
+      index_add (jbuf, INDEX_ITEM (l));
+  }
+}
+
+/* Returns the packet before @seqnum, searching at most @count slots */
+static RTPJitterBufferItem *
+index_find_prev (RTPJitterBuffer * jbuf, guint16 seqnum, guint count)
+{
+  guint slot = INDEX_SLOT (jbuf, (guint16) (seqnum - 1));
+  guint scanned = 0;
+
+  while (scanned < count) {
+    guint bit = slot & 63;
+    guint64 word = jbuf->index_map[slot >> 6];
+
+    if (bit < 63)
+      word &= (G_GUINT64_CONSTANT (2) << bit) - 1;
+
+    if (word)
+      return jbuf->index[(slot & ~63) | index_msb64 (word)];
+
+    scanned += bit + 1;
+    slot = (slot - bit - 1) & (jbuf->index_size - 1);
+  }
+
+  return NULL;
+}
+
+/* Finds the position where the walk in rtp_jitter_buffer_insert() would
+ * insert @seqnum, returns %FALSE when the index can't be used. */
+static gboolean
+index_find_position (RTPJitterBuffer * jbuf, guint16 seqnum, GList ** list,
+    gboolean * duplicate)
+{
+  GList *first, *last;
+  RTPJitterBufferItem *prev;
+  guint16 first_seq, last_seq;
+  guint span;
+
+  *duplicate = FALSE;
+
+  for (last = jbuf->packets.tail; last; last = last->prev)
+    if (INDEX_ITEM (last)->seqnum != -1)
+      break;
+
+  /* only events, append */
+  if (last == NULL) {
+    *list = jbuf->packets.tail;
+    return TRUE;
+  }
+
+  for (first = jbuf->packets.head; first; first = first->next)
+    if (INDEX_ITEM (first)->seqnum != -1)
+      break;
+
+  first_seq = INDEX_ITEM (first)->seqnum;
+  last_seq = INDEX_ITEM (last)->seqnum;
+
+  if (seqnum == first_seq || seqnum == last_seq) {
+    *duplicate = TRUE;
+    return TRUE;
+  }
+
+  if (gst_rtp_buffer_compare_seqnum (last_seq, seqnum) > 0) {
+    /* after the last packet, append after any event */
+    span = (guint16) (seqnum - first_seq);
+    *list = jbuf->packets.tail;
+  } else if (gst_rtp_buffer_compare_seqnum (first_seq, seqnum) < 0) {
+    /* before the first packet, insert after the leading events */
+    span = (guint16) (last_seq - seqnum);
+    *list = first->prev;
+  } else {
+    guint slot = INDEX_SLOT (jbuf, seqnum);
+
+    if (index_is_set (jbuf, slot)) {
+      if (jbuf->index[slot]->seqnum != seqnum)
+        goto invalid;
+      *duplicate = TRUE;
+      return TRUE;
+    }
+
+    /* insert after the previous packet and the events following it */
+    prev = index_find_prev (jbuf, seqnum, (guint16) (seqnum - first_seq));
+    if (prev == NULL)
+      goto invalid;
+
+    for (*list = (GList *) prev; (*list)->next; *list = (*list)->next)
+      if (INDEX_ITEM ((*list)->next)->seqnum != -1)
+        break;
+
+    return TRUE;
+  }
+
+  if (span >= jbuf->index_size) {
+    index_rebuild (jbuf, span);
+    if (!jbuf->index_valid)
+      return FALSE;
+  }
+
+  return TRUE;
+
+invalid:
+  {
+    GST_WARNING ("seqnum index out of sync");
+    jbuf->index_valid = FALSE;
+    return FALSE;
+  }
+}
+
 GstClockTime
 rtp_jitter_buffer_calculate_pts (RTPJitterBuffer * jbuf, GstClockTime dts,
     gboolean estimated_dts, guint32 rtptime, GstClockTime base_time,
@@ -1171,6 +1431,17 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item,
 
   seqnum = item->seqnum;
 
+  if (jbuf->use_index && jbuf->index_valid) {
+    gboolean duplicate;
+
+    if (index_find_position (jbuf, seqnum, &list, &duplicate)) {
+      if (duplicate)
+        goto duplicate;
+      goto append;
+    }
+    list = jbuf->packets.tail;
+  }
+
   /* loop the list to skip strictly larger seqnum buffers */
   for (; list; list = g_list_previous (list)) {
     guint16 qseq;
@@ -1212,6 +1483,9 @@ rtp_jitter_buffer_insert (RTPJitterBuffer * jbuf, RTPJitterBufferItem * item,
 append:
   queue_do_insert (jbuf, list, (GList *) item);
 
+  if (item->seqnum != -1 && jbuf->use_index && jbuf->index_valid)
+    index_add (jbuf, item);
+
   /* buffering mode, update buffer stats */
   if (jbuf->mode == RTP_JITTER_BUFFER_MODE_BUFFER)
     update_buffer_level (jbuf, percent);
@@ -1410,6 +1684,17 @@ rtp_jitter_buffer_pop (RTPJitterBuffer * jbuf, gint * percent)
     else
       queue->tail = NULL;
     queue->length--;
+
+    if (jbuf->use_index) {
+      if (jbuf->index_valid) {
+        if (INDEX_ITEM (item)->seqnum != -1)
+          index_remove (jbuf, INDEX_ITEM (item));
+      } else if (++jbuf->index_pops > queue->length) {
+        /* try again once in a while, the packets may fit now */
+        jbuf->index_pops = 0;
+        index_rebuild (jbuf, 0);
+      }
+    }
   }
 
   /* buffering mode, update buffer stats */
@@ -1466,6 +1751,9 @@ rtp_jitter_buffer_flush (RTPJitterBuffer * jbuf, GFunc free_func,
 
   while ((item = g_queue_pop_head_link (&jbuf->packets)))
     free_func ((RTPJitterBufferItem *) item, user_data);
+
+  if (jbuf->use_index)
+    index_rebuild (jbuf, 0);
 }
 
 /**
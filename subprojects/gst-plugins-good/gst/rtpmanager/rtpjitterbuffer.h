@@ -65,6 +65,7 @@ typedef enum {
 GType rtp_jitter_buffer_mode_get_type (void);
 
 #define RTP_JITTER_BUFFER_MAX_WINDOW 512
+#define RTP_JITTER_BUFFER_MAX_INDEX 32768
 /**
  * RTPJitterBuffer:
  *
@@ -112,6 +113,14 @@ struct _RTPJitterBuffer {
   gboolean       media_clock_reference_timestamp_meta_only;
 
   gboolean       rfc7273_sync;
+
+  /* packets indexed by seqnum, in a ring of index_size slots */
+  gboolean       use_index;
+  gboolean       index_valid;
+  guint          index_pops;
+  guint          index_size;
+  RTPJitterBufferItem **index;
+  guint64       *index_map;
 };
 
 struct _RTPJitterBufferClass {
@@ -182,6 +191,9 @@ void                  rtp_jitter_buffer_set_rfc7273_sync (RTPJitterBuffer *jbuf,
 
 void                  rtp_jitter_buffer_reset_skew       (RTPJitterBuffer *jbuf);
 
+gboolean              rtp_jitter_buffer_get_seqnum_index (RTPJitterBuffer *jbuf);
+void                  rtp_jitter_buffer_set_seqnum_index (RTPJitterBuffer *jbuf, gboolean enabled);
+
 gboolean              rtp_jitter_buffer_append_event      (RTPJitterBuffer * jbuf, GstEvent * event);
 gboolean              rtp_jitter_buffer_append_query      (RTPJitterBuffer * jbuf, GstQuery * query);
 gboolean              rtp_jitter_buffer_append_lost_event (RTPJitterBuffer * jbuf, GstEvent * event,
@@ -693,6 +693,7 @@ rtp_session_init (RTPSession * sess)
   gchar *str;
 
   g_mutex_init (&sess->lock);
+  g_rw_lock_init (&sess->ssrcs_lock);
   sess->key = g_random_int ();
   sess->mask_idx = 0;
   sess->mask = 0;
@@ -712,7 +713,7 @@ rtp_session_init (RTPSession * sess)
   rtp_stats_set_min_interval (&sess->stats,
       (gdouble) DEFAULT_RTCP_MIN_INTERVAL / GST_SECOND);
 
-  sess->recalc_bandwidth = TRUE;
+  g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
   sess->bandwidth = DEFAULT_BANDWIDTH;
   sess->rtcp_bandwidth = DEFAULT_RTCP_FRACTION;
   sess->rtcp_rr_bandwidth = DEFAULT_RTCP_RR_BANDWIDTH;
@@ -793,6 +794,7 @@ rtp_session_finalize (GObject * object)
   g_object_unref (sess->twcc);
   rtp_twcc_stats_free (sess->twcc_stats);
 
+  g_rw_lock_clear (&sess->ssrcs_lock);
   g_mutex_clear (&sess->lock);
 
   G_OBJECT_CLASS (rtp_session_parent_class)->finalize (object);
@@ -890,25 +892,25 @@ rtp_session_set_property (GObject * object, guint prop_id,
     case PROP_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->bandwidth = g_value_get_double (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_FRACTION:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_bandwidth = g_value_get_double (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_RR_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_rr_bandwidth = g_value_get_int (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_RS_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_rs_bandwidth = g_value_get_int (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_MTU:
@@ -1215,7 +1217,9 @@ rtp_session_reset (RTPSession * sess)
 
   RTP_SESSION_LOCK (sess);
   /* remove all sources */
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
   g_hash_table_remove_all (sess->ssrcs[sess->mask_idx]);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
   sess->total_sources = 0;
   sess->stats.sender_sources = 0;
   sess->stats.internal_sender_sources = 0;
@@ -1586,6 +1590,24 @@ source_push_rtp (RTPSource * source, gpointer data, RTPSession * session)
     }
   } else {
     GST_LOG ("source %08x pushed receiver RTP packet", source->ssrc);
+
+    /* packets of remote sources are only pushed from the receiving thread,
+     * which may hold only the lock of the source */
+    if (source == session->unlocked_source) {
+      RTP_SOURCE_UNLOCK (source);
+
+      if (session->callbacks.process_rtp)
+        result =
+            session->callbacks.process_rtp (session, source,
+            GST_BUFFER_CAST (data), session->process_rtp_user_data);
+      else
+        gst_buffer_unref (GST_BUFFER_CAST (data));
+
+      RTP_SOURCE_LOCK (source);
+
+      return result;
+    }
+
     RTP_SESSION_UNLOCK (session);
 
     if (session->callbacks.process_rtp)
@@ -1870,8 +1892,10 @@ session_update_ptp (RTPSession * sess)
 static void
 add_source (RTPSession * sess, RTPSource * src)
 {
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
   g_hash_table_insert (sess->ssrcs[sess->mask_idx],
       GINT_TO_POINTER (src->ssrc), src);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
   /* report the new source ASAP */
   src->generation = sess->generation;
   /* we have one more source now */
@@ -2328,6 +2352,83 @@ source_update_sender (RTPSession * sess, RTPSource * source,
   return TRUE;
 }
 
+/* Handles a packet of a known remote source with only the lock of the source,
+ * so that receiving does not contend with RTCP generation and the handling of
+ * other sources. This is only possible when the packet can't change anything
+ * in the session: the source must be an active sender, the packet must come
+ * from the known address of the source, have no CSRCs and a payload type with
+ * known caps.
+ *
+ * Returns: %FALSE when the packet needs to be handled with the session lock.
+ */
+static gboolean
+process_rtp_unlocked (RTPSession * sess, RTPPacketInfo * pinfo,
+    GstFlowReturn * result)
+{
+  RTPSource *source;
+  gboolean twcc;
+  guint64 oldrate;
+
+  if (pinfo->csrc_count > 0)
+    return FALSE;
+
+  g_rw_lock_reader_lock (&sess->ssrcs_lock);
+  source = find_source (sess, pinfo->ssrc);
+  if (source)
+    g_object_ref (source);
+  g_rw_lock_reader_unlock (&sess->ssrcs_lock);
+
+  if (!source)
+    return FALSE;
+
+  RTP_SOURCE_LOCK (source);
+  if (source->internal || !RTP_SOURCE_IS_ACTIVE (source)
+      || !RTP_SOURCE_IS_SENDER (source) || source->payload != pinfo->pt
+      || source->clock_rate == -1 || !source->caps)
+    goto locked;
+
+  if (pinfo->address && (!source->rtp_from
+          || !__g_socket_address_equal (source->rtp_from, pinfo->address)))
+    goto locked;
+
+  source->last_activity = pinfo->current_time;
+  source->last_rtp_activity = pinfo->current_time;
+  oldrate = source->bitrate;
+
+  sess->unlocked_source = source;
+  *result = rtp_source_process_rtp (source, pinfo);
+  sess->unlocked_source = NULL;
+
+  if (oldrate != source->bitrate)
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
+  RTP_SOURCE_UNLOCK (source);
+
+  /* processing the packet never changes whether the source is active or a
+   * sender. A BYE or sender timeout handled while the packet was pushed
+   * changes it with the source lock and updates the session counters itself,
+   * so there is nothing to account for here */
+
+  /* the TWCC state is shared with RTCP generation. The extension id is only
+   * configured from the receiving thread */
+  twcc = pinfo->header_ext
+      && rtp_twcc_manager_get_recv_ext_id (sess->twcc) != 0;
+  if (twcc) {
+    RTP_SESSION_LOCK (sess);
+    process_twcc_packet (sess, pinfo);
+    RTP_SESSION_UNLOCK (sess);
+  }
+  g_object_unref (source);
+
+  return TRUE;
+
+locked:
+  {
+    RTP_SOURCE_UNLOCK (source);
+    g_object_unref (source);
+    return FALSE;
+  }
+}
+
 /**
  * rtp_session_process_rtp:
  * @sess: and #RTPSession
@@ -2355,17 +2456,22 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
-  RTP_SESSION_LOCK (sess);
-
-  /* update pinfo stats */
+  /* update pinfo stats, for received packets this only uses the header length
+   * of the session, which never changes, so no need for the session lock */
   if (!update_packet_info (sess, &pinfo, FALSE, TRUE, FALSE, buffer,
           current_time, running_time, ntpnstime)) {
     GST_DEBUG ("invalid RTP packet received");
-    RTP_SESSION_UNLOCK (sess);
     return rtp_session_process_rtcp (sess, buffer, current_time, running_time,
         ntpnstime);
   }
 
+  if (process_rtp_unlocked (sess, &pinfo, &result)) {
+    clean_packet_info (&pinfo);
+    return result;
+  }
+
+  RTP_SESSION_LOCK (sess);
+
   ssrc = pinfo.ssrc;
 
   source = obtain_source (sess, ssrc, &created, &pinfo, TRUE);
@@ -2390,7 +2496,7 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   source_update_sender (sess, source, prevsender);
 
   if (oldrate != source->bitrate)
-    sess->recalc_bandwidth = TRUE;
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
 
 
   if (source->validated) {
@@ -2696,11 +2802,13 @@ rtp_session_process_bye (RTPSession * sess, GstRTCPPacket * packet,
     /* store time for when we need to time out this source */
     source->bye_time = pinfo->current_time;
 
+    RTP_SOURCE_LOCK (source);
     prevactive = RTP_SOURCE_IS_ACTIVE (source);
     prevsender = RTP_SOURCE_IS_SENDER (source);
 
     /* mark the source BYE */
     rtp_source_mark_bye (source, reason);
+    RTP_SOURCE_UNLOCK (source);
 
     pmembers = sess->stats.active_sources;
 
@@ -3527,7 +3635,7 @@ rtp_session_send_rtp (RTPSession * sess, gpointer data, gboolean is_list,
   source_update_sender (sess, source, prevsender);
 
   if (oldrate != source->bitrate)
-    sess->recalc_bandwidth = TRUE;
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
   RTP_SESSION_UNLOCK (sess);
 
   g_object_unref (source);
@@ -3556,7 +3664,9 @@ collision:
 static void
 add_bitrates (gpointer key, RTPSource * source, gdouble * bandwidth)
 {
+  RTP_SOURCE_LOCK (source);
   *bandwidth += source->bitrate;
+  RTP_SOURCE_UNLOCK (source);
 }
 
 /* must be called with session lock */
@@ -3567,8 +3677,9 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
   GstClockTime result;
   RTPSessionStats *stats;
 
-  /* recalculate bandwidth when it changed */
-  if (sess->recalc_bandwidth) {
+  /* recalculate bandwidth when it changed, the receiving thread can flag this
+   * without the session lock */
+  if (g_atomic_int_compare_and_exchange (&sess->recalc_bandwidth, TRUE, FALSE)) {
     gdouble bandwidth;
 
     if (sess->bandwidth > 0)
@@ -3585,8 +3696,6 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
 
     rtp_stats_set_bandwidths (&sess->stats, bandwidth,
         sess->rtcp_bandwidth, sess->rtcp_rs_bandwidth, sess->rtcp_rr_bandwidth);
-
-    sess->recalc_bandwidth = FALSE;
   }
 
   if (sess->scheduled_bye) {
@@ -3922,8 +4031,10 @@ session_report_blocks (const gchar * key, RTPSource * source, ReportData * data)
   GST_DEBUG ("create RB for SSRC %08x", source->ssrc);
 
   /* get new stats */
+  RTP_SOURCE_LOCK (source);
   rtp_source_get_new_rb (source, data->current_time, &fractionlost,
       &packetslost, &exthighestseq, &jitter, &lsr, &dlsr);
+  RTP_SOURCE_UNLOCK (source);
 
   /* store last generated RR packet */
   source->last_rr.is_valid = TRUE;
@@ -4177,6 +4288,10 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
   if (data->interval == GST_CLOCK_TIME_NONE)
     return;
 
+  /* the receiving thread updates the activity of remote sources with only
+   * their lock */
+  RTP_SOURCE_LOCK (source);
+
   is_sender = RTP_SOURCE_IS_SENDER (source);
   is_active = RTP_SOURCE_IS_ACTIVE (source);
 
@@ -4261,6 +4376,11 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
     }
   }
 
+  if (!remove && sendertimeout)
+    source->is_sender = FALSE;
+
+  RTP_SOURCE_UNLOCK (source);
+
   if (remove) {
     sess->total_sources--;
     if (is_sender) {
@@ -4280,7 +4400,6 @@ session_cleanup (const gchar * key, RTPSource * source, ReportData * data)
       on_timeout (sess, source);
   } else {
     if (sendertimeout) {
-      source->is_sender = FALSE;
       sess->stats.sender_sources--;
       if (source->internal)
         sess->stats.internal_sender_sources--;
@@ -4737,8 +4856,10 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
   g_hash_table_destroy (table_copy);
 
   /* Now remove the marked sources */
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
   g_hash_table_foreach_remove (sess->ssrcs[sess->mask_idx],
       (GHRFunc) remove_closing_sources, &data);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
 
   /* update point-to-point status */
   session_update_ptp (sess);
@@ -227,6 +227,7 @@ typedef struct {
  * @lock: lock to protect the session
  * @source: the source of this session
  * @ssrcs: Hashtable of sources indexed by SSRC
+ * @ssrcs_lock: lock to look up sources in @ssrcs without the session lock
  * @num_sources: the number of sources
  * @activecount: the number of active sources
  * @callbacks: callbacks
@@ -254,7 +255,7 @@ struct _RTPSession {
 
   gboolean      reduced_size_rtcp;
 
-  /* bandwidths */
+  /* bandwidths, recalc_bandwidth is only accessed atomically */
   gboolean     recalc_bandwidth;
   guint        bandwidth;
   gdouble      rtcp_bandwidth;
@@ -270,7 +271,12 @@ struct _RTPSession {
   guint32       mask_idx;
   guint32       mask;
   GHashTable   *ssrcs[32];
+  /* taken for writing, with the session lock, when changing ssrcs and for
+   * reading when looking up a source without the session lock */
+  GRWLock       ssrcs_lock;
   guint         total_sources;
+  /* the source handled with only its own lock by the receiving thread */
+  RTPSource    *unlocked_source;
 
   guint16       generation;
   GstClockTime  next_rtcp_check_time; /* tn */
@@ -333,6 +333,7 @@ rtp_source_init (RTPSource * src)
   src->closing = FALSE;
   src->max_dropout_time = DEFAULT_MAX_DROPOUT_TIME;
   src->max_misorder_time = DEFAULT_MAX_MISORDER_TIME;
+  g_mutex_init (&src->lock);
 
   src->sdes = gst_structure_new_empty ("application/x-rtp-source-sdes");
 
@@ -372,6 +373,7 @@ rtp_source_finalize (GObject * object)
 
   g_queue_foreach (src->packets, (GFunc) gst_buffer_unref, NULL);
   g_queue_free (src->packets);
+  g_mutex_clear (&src->lock);
 
   gst_structure_free (src->sdes);
 
@@ -672,7 +674,9 @@ rtp_source_get_property (GObject * object, guint prop_id,
       g_value_set_boxed (value, rtp_source_get_sdes_struct (src));
       break;
     case PROP_STATS:
+      RTP_SOURCE_LOCK (src);
       g_value_take_boxed (value, rtp_source_create_stats (src));
+      RTP_SOURCE_UNLOCK (src);
       break;
     case PROP_PROBATION:
       g_value_set_uint (value, src->probation);
@@ -70,6 +70,18 @@ typedef struct _RTPSourceClass RTPSourceClass;
  */
 #define RTP_SOURCE_IS_MARKED_BYE(src)  (src->marked_bye)
 
+/**
+ * RTP_SOURCE_LOCK:
+ * @src: an #RTPSource
+ *
+ * Lock the receiver state of @src. The session handles most RTP packets of
+ * remote sources with only this lock held, so it must be taken, after the
+ * session lock, to read or update the receiver statistics or the sender and
+ * active state of a remote source.
+ */
+#define RTP_SOURCE_LOCK(src)    (g_mutex_lock (&(src)->lock))
+#define RTP_SOURCE_UNLOCK(src)  (g_mutex_unlock (&(src)->lock))
+
 
 /**
  * RTPSourcePushRTP:
@@ -135,6 +147,7 @@ struct _RTPSource {
   GObject       object;
 
   /*< private >*/
+  GMutex        lock;
   guint32       ssrc;
 
   /* If not -1 then this is the SSRC of the corresponding media RTPSource */
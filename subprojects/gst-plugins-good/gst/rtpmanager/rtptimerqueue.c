@@ -24,12 +24,48 @@
 
 #include "rtptimerqueue.h"
 
+/* The timers are kept in a list sorted by timeout. To avoid walking that
+ * list when inserting or rescheduling, timers with a valid timeout are also
+ * indexed in a wheel of RTP_TIMER_WHEEL_SIZE slots (ticks) of
+ * 2^RTP_TIMER_WHEEL_SHIFT ns each, covering the ticks starting at
+ * wheel_base. A slot points to the first and last timer of its tick, which
+ * are contiguous in the list, and a bitmap of the occupied slots is used to
+ * find neighbouring ticks. Timers that do not fit in the wheel are only kept
+ * in the list. Their ticks are kept out of the range the wheel may cover, so
+ * they never sit between the timers of the wheel. */
+#define RTP_TIMER_WHEEL_SHIFT 21
+#define RTP_TIMER_WHEEL_SIZE 4096
+#define RTP_TIMER_WHEEL_MASK (RTP_TIMER_WHEEL_SIZE - 1)
+
+#define RTP_TIMER_TICK_NONE G_MAXUINT64
+#define RTP_TIMER_TICK_OVERFLOW (G_MAXUINT64 - 1)
+
+typedef struct
+{
+  RtpTimer *first;
+  RtpTimer *last;
+} RtpTimerSlot;
+
 struct _RtpTimerQueue
 {
   GObject parent;
 
   GQueue timers;
   GHashTable *hashtable;
+
+  gboolean use_wheel;
+  RtpTimerSlot *wheel;
+  guint64 wheel_map[RTP_TIMER_WHEEL_SIZE / 64];
+  guint64 wheel_base;
+  /* number of timers in the wheel */
+  guint wheel_count;
+  /* number of timers with a valid timeout that are not in the wheel */
+  guint overflow_count;
+  /* ticks the wheel may cover without overlapping those timers */
+  guint64 wheel_start;
+  guint64 wheel_end;
+  /* number of insertions since the wheel was last rebuilt */
+  guint wheel_inserts;
 };
 
 G_DEFINE_TYPE (RtpTimerQueue, rtp_timer_queue, G_TYPE_OBJECT);
@@ -288,10 +324,363 @@ rtp_timer_queue_insert_head (RtpTimerQueue * queue, RtpTimer * timer)
     rtp_timer_queue_insert_before (queue, it, timer);
 }
 
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define rtp_timer_wheel_msb64(x) (63 - __builtin_clzll (x))
+#define rtp_timer_wheel_lsb64(x) __builtin_ctzll (x)
+#else
+static inline gint
+rtp_timer_wheel_msb64_inline (guint64 mask)
+{
+  gint nth_bit = 63;
+
+  do {
+    if (mask & (G_GUINT64_CONSTANT (1) << nth_bit))
+      return nth_bit;
+  } while (--nth_bit >= 0);
+
+  return -1;                    /* should not be reached, since mask must not be 0 */
+}
+
+static inline gint
+rtp_timer_wheel_lsb64_inline (guint64 mask)
+{
+  gint nth_bit = 0;
+
+  do {
+    if ((mask & 1))
+      return nth_bit;
+    mask = mask >> 1;
+  } while (++nth_bit < 64);
+
+  return -1;                    /* should not be reached, since mask must not be 0 */
+}
+
+#define rtp_timer_wheel_msb64 rtp_timer_wheel_msb64_inline
+#define rtp_timer_wheel_lsb64 rtp_timer_wheel_lsb64_inline
+#endif
+
+static inline gboolean
+rtp_timer_wheel_is_set (RtpTimerQueue * queue, guint slot)
+{
+  return (queue->wheel_map[slot >> 6] >> (slot & 63)) & 1;
+}
+
+/* Returns the highest occupied tick in [tick - count, tick - 1], or
+ * RTP_TIMER_TICK_NONE. @count must not exceed RTP_TIMER_WHEEL_SIZE. */
+static guint64
+rtp_timer_wheel_find_prev (RtpTimerQueue * queue, guint64 tick, guint64 count)
+{
+  guint slot = (tick - 1) & RTP_TIMER_WHEEL_MASK;
+  guint64 scanned = 0;
+
+  while (scanned < count) {
+    guint bit = slot & 63;
+    guint64 word = queue->wheel_map[slot >> 6];
+
+    if (bit < 63)
+      word &= (G_GUINT64_CONSTANT (2) << bit) - 1;
+
+    if (word) {
+      guint found = (slot & ~63) | rtp_timer_wheel_msb64 (word);
+      guint64 dist = ((tick - 1 - found) & RTP_TIMER_WHEEL_MASK) + 1;
+
+      return dist <= count ? tick - dist : RTP_TIMER_TICK_NONE;
+    }
+
+    scanned += bit + 1;
+    slot = (slot - bit - 1) & RTP_TIMER_WHEEL_MASK;
+  }
+
+  return RTP_TIMER_TICK_NONE;
+}
+
+/* Returns the lowest occupied tick in [tick + 1, tick + count], or
+ * RTP_TIMER_TICK_NONE. @count must not exceed RTP_TIMER_WHEEL_SIZE. */
+static guint64
+rtp_timer_wheel_find_next (RtpTimerQueue * queue, guint64 tick, guint64 count)
+{
+  guint slot = (tick + 1) & RTP_TIMER_WHEEL_MASK;
+  guint64 scanned = 0;
+
+  while (scanned < count) {
+    guint bit = slot & 63;
+    guint64 word = queue->wheel_map[slot >> 6] >> bit;
+
+    if (word) {
+      guint found = slot + rtp_timer_wheel_lsb64 (word);
+      guint64 dist = ((found - tick - 1) & RTP_TIMER_WHEEL_MASK) + 1;
+
+      return dist <= count ? tick + dist : RTP_TIMER_TICK_NONE;
+    }
+
+    scanned += 64 - bit;
+    slot = (slot + 64 - bit) & RTP_TIMER_WHEEL_MASK;
+  }
+
+  return RTP_TIMER_TICK_NONE;
+}
+
+/* Moves the wheel window so it covers @tick, if possible without dropping
+ * any timer and without overlapping the timers that are not in the wheel. */
+static gboolean
+rtp_timer_wheel_fit (RtpTimerQueue * queue, guint64 tick)
+{
+  guint64 min_base, max_base;
+
+  if (G_UNLIKELY (queue->wheel == NULL))
+    queue->wheel = g_new0 (RtpTimerSlot, RTP_TIMER_WHEEL_SIZE);
+
+  if (tick < queue->wheel_start || tick >= queue->wheel_end ||
+      queue->wheel_end - queue->wheel_start < RTP_TIMER_WHEEL_SIZE)
+    return FALSE;
+
+  min_base = queue->wheel_start;
+  if (tick >= RTP_TIMER_WHEEL_SIZE)
+    min_base = MAX (min_base, tick + 1 - RTP_TIMER_WHEEL_SIZE);
+  max_base = MIN (queue->wheel_end - RTP_TIMER_WHEEL_SIZE, tick);
+
+  if (queue->wheel_base >= min_base && queue->wheel_base <= max_base)
+    return TRUE;
+
+  if (queue->wheel_count > 0) {
+    guint64 lo, hi;
+
+    lo = rtp_timer_wheel_find_next (queue, queue->wheel_base - 1,
+        RTP_TIMER_WHEEL_SIZE);
+    hi = rtp_timer_wheel_find_prev (queue,
+        queue->wheel_base + RTP_TIMER_WHEEL_SIZE, RTP_TIMER_WHEEL_SIZE);
+
+    if (hi >= RTP_TIMER_WHEEL_SIZE)
+      min_base = MAX (min_base, hi + 1 - RTP_TIMER_WHEEL_SIZE);
+    max_base = MIN (max_base, lo);
+  }
+
+  if (min_base > max_base)
+    return FALSE;
+
+  queue->wheel_base = CLAMP (queue->wheel_base, min_base, max_base);
+
+  return TRUE;
+}
+
+/* keeps @timer, with a timeout in @tick, out of the wheel */
+static void
+rtp_timer_wheel_add_overflow (RtpTimerQueue * queue, RtpTimer * timer,
+    guint64 tick)
+{
+  if (tick >= queue->wheel_start && tick < queue->wheel_end) {
+    /* split the range at @tick, keeping the wheel timers on their side or
+     * else the larger part */
+    if (queue->wheel_count > 0 ? tick < queue->wheel_base :
+        tick - queue->wheel_start < queue->wheel_end - tick)
+      queue->wheel_start = tick + 1;
+    else
+      queue->wheel_end = tick;
+  }
+
+  timer->tick = RTP_TIMER_TICK_OVERFLOW;
+  queue->overflow_count++;
+}
+
+/* indexes @timer, which has just been linked into the list. Returns %FALSE
+ * if the list is not sorted around @timer. */
+static gboolean
+rtp_timer_wheel_add (RtpTimerQueue * queue, RtpTimer * timer, guint64 tick)
+{
+  guint pos = tick & RTP_TIMER_WHEEL_MASK;
+  RtpTimerSlot *slot = &queue->wheel[pos];
+  RtpTimer *prev = rtp_timer_get_prev (timer);
+  RtpTimer *next = rtp_timer_get_next (timer);
+
+  if (!rtp_timer_wheel_is_set (queue, pos)) {
+    slot->first = slot->last = timer;
+    queue->wheel_map[pos >> 6] |= G_GUINT64_CONSTANT (1) << (pos & 63);
+  } else if (prev == slot->last) {
+    slot->last = timer;
+  } else if (next == slot->first) {
+    slot->first = timer;
+  } else if (prev == NULL || prev->tick != tick) {
+    return FALSE;
+  }
+
+  timer->tick = tick;
+  queue->wheel_count++;
+
+  return TRUE;
+}
+
+/* removes @timer from the index, must be called before unlinking it */
+static void
+rtp_timer_wheel_remove (RtpTimerQueue * queue, RtpTimer * timer)
+{
+  if (timer->tick == RTP_TIMER_TICK_OVERFLOW) {
+    if (--queue->overflow_count == 0) {
+      queue->wheel_start = 0;
+      queue->wheel_end = G_MAXUINT64;
+    }
+  } else if (timer->tick != RTP_TIMER_TICK_NONE) {
+    guint pos = timer->tick & RTP_TIMER_WHEEL_MASK;
+    RtpTimerSlot *slot = &queue->wheel[pos];
+
+    if (slot->first == timer && slot->last == timer) {
+      slot->first = slot->last = NULL;
+      queue->wheel_map[pos >> 6] &= ~(G_GUINT64_CONSTANT (1) << (pos & 63));
+    } else if (slot->first == timer) {
+      slot->first = rtp_timer_get_next (timer);
+    } else if (slot->last == timer) {
+      slot->last = rtp_timer_get_prev (timer);
+    }
+    queue->wheel_count--;
+  }
+
+  timer->tick = RTP_TIMER_TICK_NONE;
+}
+
+static gboolean
+rtp_timer_wheel_splits_slot (RtpTimer * timer, guint64 tick)
+{
+  RtpTimer *prev = rtp_timer_get_prev (timer);
+  RtpTimer *next = rtp_timer_get_next (timer);
+
+  return prev && next && prev->tick == next->tick && prev->tick != tick &&
+      prev->tick < RTP_TIMER_TICK_OVERFLOW;
+}
+
+/* finds the position of @timer using the wheel, equivalent to
+ * rtp_timer_queue_insert_tail() */
+static void
+rtp_timer_queue_insert_wheel (RtpTimerQueue * queue, RtpTimer * timer,
+    guint64 tick)
+{
+  guint64 other;
+
+  if (rtp_timer_wheel_is_set (queue, tick & RTP_TIMER_WHEEL_MASK)) {
+    RtpTimer *it = queue->wheel[tick & RTP_TIMER_WHEEL_MASK].last;
+
+    /* timers of earlier ticks are sooner, only look at this tick */
+    while (it && it->tick == tick) {
+      if (!GST_CLOCK_TIME_IS_VALID (it->timeout))
+        break;
+
+      if (timer->timeout > it->timeout)
+        break;
+
+      if (timer->timeout == it->timeout &&
+          gst_rtp_buffer_compare_seqnum (timer->seqnum, it->seqnum) < 0)
+        break;
+
+      it = rtp_timer_get_prev (it);
+    }
+
+    if (it == NULL)
+      g_queue_push_head_link (&queue->timers, (GList *) timer);
+    else
+      rtp_timer_queue_insert_after (queue, it, timer);
+    return;
+  }
+
+  other = rtp_timer_wheel_find_prev (queue, tick, tick - queue->wheel_base);
+  if (other != RTP_TIMER_TICK_NONE) {
+    rtp_timer_queue_insert_after (queue,
+        queue->wheel[other & RTP_TIMER_WHEEL_MASK].last, timer);
+    return;
+  }
+
+  other = rtp_timer_wheel_find_next (queue, tick,
+      queue->wheel_base + RTP_TIMER_WHEEL_SIZE - 1 - tick);
+  if (other != RTP_TIMER_TICK_NONE) {
+    rtp_timer_queue_insert_before (queue,
+        queue->wheel[other & RTP_TIMER_WHEEL_MASK].first, timer);
+    return;
+  }
+
+  /* at most timers without timeout left, which are at the head */
+  rtp_timer_queue_insert_tail (queue, timer);
+}
+
+static void rtp_timer_queue_rebuild (RtpTimerQueue * queue);
+
+static void
+rtp_timer_queue_insert_sorted (RtpTimerQueue * queue, RtpTimer * timer)
+{
+  guint64 tick;
+
+  timer->tick = RTP_TIMER_TICK_NONE;
+
+  if (!queue->use_wheel) {
+    if (!GST_CLOCK_TIME_IS_VALID (timer->timeout))
+      rtp_timer_queue_insert_head (queue, timer);
+    else
+      rtp_timer_queue_insert_tail (queue, timer);
+    return;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID (timer->timeout)) {
+    tick = RTP_TIMER_TICK_NONE;
+    rtp_timer_queue_insert_head (queue, timer);
+  } else {
+    tick = timer->timeout >> RTP_TIMER_WHEEL_SHIFT;
+    if (rtp_timer_wheel_fit (queue, tick)) {
+      rtp_timer_queue_insert_wheel (queue, timer, tick);
+      if (!rtp_timer_wheel_add (queue, timer, tick))
+        rtp_timer_queue_rebuild (queue);
+      return;
+    }
+    rtp_timer_queue_insert_tail (queue, timer);
+  }
+
+  if (rtp_timer_wheel_splits_slot (timer, tick)) {
+    rtp_timer_queue_rebuild (queue);
+  } else if (tick != RTP_TIMER_TICK_NONE) {
+    rtp_timer_wheel_add_overflow (queue, timer, tick);
+
+    /* the timers out of the wheel may have been keeping it from moving, once
+     * in a while index everything again */
+    if (++queue->wheel_inserts > queue->timers.length)
+      rtp_timer_queue_rebuild (queue);
+  }
+}
+
+/* Timeouts modified without rescheduling leave the list unsorted, which
+ * breaks the wheel. This sorts the list again and indexes all timers. */
+static void
+rtp_timer_queue_rebuild (RtpTimerQueue * queue)
+{
+  GList *l = queue->timers.head;
+
+  GST_DEBUG ("Timer queue out of order, rebuilding %u timers",
+      queue->timers.length);
+
+  g_queue_init (&queue->timers);
+  memset (queue->wheel_map, 0, sizeof (queue->wheel_map));
+  queue->wheel_count = 0;
+  queue->overflow_count = 0;
+  queue->wheel_start = 0;
+  queue->wheel_end = G_MAXUINT64;
+  queue->wheel_inserts = 0;
+
+  while (l) {
+    GList *next = l->next;
+
+    l->prev = l->next = NULL;
+    rtp_timer_queue_insert_sorted (queue, (RtpTimer *) l);
+    l = next;
+  }
+}
+
+static void
+rtp_timer_queue_unlink (RtpTimerQueue * queue, RtpTimer * timer)
+{
+  rtp_timer_wheel_remove (queue, timer);
+  g_queue_unlink (&queue->timers, (GList *) timer);
+}
+
 static void
 rtp_timer_queue_init (RtpTimerQueue * queue)
 {
   queue->hashtable = g_hash_table_new (NULL, NULL);
+  queue->use_wheel = TRUE;
+  queue->wheel_end = G_MAXUINT64;
 }
 
 static void
@@ -304,6 +693,7 @@ rtp_timer_queue_finalize (GObject * object)
     rtp_timer_free (timer);
   g_hash_table_unref (queue->hashtable);
   g_assert (queue->timers.length == 0);
+  g_free (queue->wheel);
 
   G_OBJECT_CLASS (rtp_timer_queue_parent_class)->finalize (object);
 }
@@ -396,9 +786,10 @@ rtp_timer_queue_new (void)
  * @timer: (transfer full): the #RtpTimer to insert
  *
  * Insert a timer into the queue. Earliest timer are at the head and then
- * timer are sorted by seqnum (smaller seqnum first). This function is o(n)
- * but it is expected that most timers added are schedule later, in which case
- * the insertion will be faster.
+ * timer are sorted by seqnum (smaller seqnum first). When the timer wheel is
+ * in use, this function is o(1) for timers within its range, otherwise it is
+ * o(n) but it is expected that most timers added are schedule later, in which
+ * case the insertion will be faster.
  *
  * Returns: %FALSE if a timer with the same seqnum already existed
  */
@@ -413,10 +804,7 @@ rtp_timer_queue_insert (RtpTimerQueue * queue, RtpTimer * timer)
     return FALSE;
   }
 
-  if (timer->timeout == -1)
-    rtp_timer_queue_insert_head (queue, timer);
-  else
-    rtp_timer_queue_insert_tail (queue, timer);
+  rtp_timer_queue_insert_sorted (queue, timer);
 
   g_hash_table_insert (queue->hashtable,
       GINT_TO_POINTER (timer->seqnum), timer);
@@ -431,8 +819,8 @@ rtp_timer_queue_insert (RtpTimerQueue * queue, RtpTimer * timer)
  * @timer: the #RtpTimer to reschedule
  *
  * This function moves @timer inside the queue to put it back to it's new
- * location. This function is o(n) but it is assumed that nearby modification
- * of the timeout will occure.
+ * location. This function is o(1) with the timer wheel, otherwise o(n) but it
+ * is assumed that nearby modification of the timeout will occure.
  *
  * Returns: %TRUE if the timer was moved
  */
@@ -443,6 +831,17 @@ rtp_timer_queue_reschedule (RtpTimerQueue * queue, RtpTimer * timer)
 
   g_return_val_if_fail (timer->queued == TRUE, FALSE);
 
+  if (queue->use_wheel) {
+    RtpTimer *prev = rtp_timer_get_prev (timer);
+    RtpTimer *next = rtp_timer_get_next (timer);
+
+    rtp_timer_queue_unlink (queue, timer);
+    rtp_timer_queue_insert_sorted (queue, timer);
+
+    return prev != rtp_timer_get_prev (timer) ||
+        next != rtp_timer_get_next (timer);
+  }
+
   if (rtp_timer_is_closer_to_head (timer, rtp_timer_queue_get_head (queue))) {
     g_queue_unlink (&queue->timers, (GList *) timer);
     rtp_timer_queue_insert_head (queue, timer);
@@ -489,7 +888,7 @@ rtp_timer_queue_unschedule (RtpTimerQueue * queue, RtpTimer * timer)
 {
   g_return_if_fail (timer->queued == TRUE);
 
-  g_queue_unlink (&queue->timers, (GList *) timer);
+  rtp_timer_queue_unlink (queue, timer);
   g_hash_table_remove (queue->hashtable, GINT_TO_POINTER (timer->seqnum));
   timer->queued = FALSE;
 }
@@ -742,3 +1141,43 @@ rtp_timer_queue_length (RtpTimerQueue * queue)
 {
   return queue->timers.length;
 }
+
+/**
+ * rtp_timer_queue_set_use_wheel:
+ * @queue: the #RtpTimerQueue
+ * @enabled: whether to use the timer wheel
+ *
+ * Enables or disables indexing the timers in a timer wheel, which makes
+ * insertion and rescheduling o(1) for timers within a few seconds of each
+ * other. This is enabled by default.
+ */
+void
+rtp_timer_queue_set_use_wheel (RtpTimerQueue * queue, gboolean enabled)
+{
+  GList *l;
+
+  if (queue->use_wheel == enabled)
+    return;
+
+  queue->use_wheel = enabled;
+
+  if (enabled) {
+    rtp_timer_queue_rebuild (queue);
+    return;
+  }
+
+  for (l = queue->timers.head; l; l = l->next)
+    ((RtpTimer *) l)->tick = RTP_TIMER_TICK_NONE;
+}
+
+/**
+ * rtp_timer_queue_get_use_wheel:
+ * @queue: the #RtpTimerQueue
+ *
+ * Returns: whether the timers are indexed in a timer wheel
+ */
+gboolean
+rtp_timer_queue_get_use_wheel (RtpTimerQueue * queue)
+{
+  return queue->use_wheel;
+}
@@ -68,6 +68,9 @@ typedef struct
   GstClockTime rtx_last;
   guint num_rtx_retry;
   guint num_rtx_received;
+
+  /* private: the timer wheel slot this timer is indexed in */
+  guint64 tick;
 } RtpTimer;
 
 void         rtp_timer_free (RtpTimer * timer);
@@ -122,4 +125,7 @@ void            rtp_timer_queue_update_timer (RtpTimerQueue * queue, RtpTimer *
                                               GstClockTimeDiff offset, gboolean reset);
 guint           rtp_timer_queue_length       (RtpTimerQueue * queue);
 
+void            rtp_timer_queue_set_use_wheel (RtpTimerQueue * queue, gboolean enabled);
+gboolean        rtp_timer_queue_get_use_wheel (RtpTimerQueue * queue);
+
 #endif
@@ -19,8 +19,6 @@
  */
 #include "rtptwcc.h"
 #include <gst/rtp/gstrtcpbuffer.h>
-#include <gst/base/gstbitreader.h>
-#include <gst/base/gstbitwriter.h>
 
 #include "gstrtputils.h"
 
@@ -36,6 +34,14 @@ GST_DEBUG_CATEGORY_EXTERN (rtp_session_debug);
 #define STATUS_VECTOR_MAX_CAPACITY 14
 #define STATUS_VECTOR_TWO_BIT_MAX_CAPACITY 7
 
+/* packets are stored in rings indexed by their twcc-seqnum, these grow when
+ * more packets are in flight. Sent packets are kept until they were reported
+ * on, with at most half the seqnum space to keep the lookups unambiguous */
+#define RECV_RING_MIN_SIZE 1024
+#define RECV_RING_MAX_SIZE 65536
+#define SENT_RING_MIN_SIZE 1024
+#define SENT_RING_MAX_SIZE 32768
+
 typedef enum
 {
   RTP_TWCC_CHUNK_TYPE_RUN_LENGTH = 0,
@@ -61,6 +67,15 @@ typedef struct
   guint equal_run;
 } RecvPacket;
 
+/* a packet in the receive ring, only valid for the feedback it was received
+ * for */
+typedef struct
+{
+  GstClockTime ts;
+  guint32 gen;
+  guint16 seqnum;
+} RecvSlot;
+
 typedef struct
 {
   GstClockTime ts;
@@ -82,13 +97,31 @@ struct _RTPTWCCManager
 
   guint mtu;
   guint max_packets_per_rtcp;
+
+  /* packets received since the last feedback, from recv_first to recv_last */
+  RecvSlot *recv_ring;
+  guint recv_ring_size;
+  guint32 recv_gen;
+  guint recv_count;
+  /* duplicates are not stored, but still count as received packets for
+   * deciding when to send a feedback */
+  guint recv_duplicates;
+  guint16 recv_first;
+  guint16 recv_last;
+
+  /* scratch space for building the feedback */
   GArray *recv_packets;
+  GArray *packet_chunks;
 
   guint64 fb_pkt_count;
   gint32 last_seqnum;
 
-  GArray *sent_packets;
-  GArray *parsed_packets;
+  /* packets sent and not reported on yet, from sent_first on */
+  SentPacket *sent_ring;
+  guint sent_ring_size;
+  guint sent_count;
+  guint16 sent_first;
+
   GQueue *rtcp_buffers;
 
   guint64 recv_sender_ssrc;
@@ -113,9 +146,14 @@ G_DEFINE_TYPE (RTPTWCCManager, rtp_twcc_manager, G_TYPE_OBJECT);
 static void
 rtp_twcc_manager_init (RTPTWCCManager * twcc)
 {
+  twcc->recv_ring_size = RECV_RING_MIN_SIZE;
+  twcc->recv_ring = g_new0 (RecvSlot, twcc->recv_ring_size);
+  twcc->recv_gen = 1;
   twcc->recv_packets = g_array_new (FALSE, FALSE, sizeof (RecvPacket));
-  twcc->sent_packets = g_array_new (FALSE, FALSE, sizeof (SentPacket));
-  twcc->parsed_packets = g_array_new (FALSE, FALSE, sizeof (RecvPacket));
+  twcc->packet_chunks = g_array_new (FALSE, FALSE, 2);
+
+  twcc->sent_ring_size = SENT_RING_MIN_SIZE;
+  twcc->sent_ring = g_new0 (SentPacket, twcc->sent_ring_size);
 
   twcc->rtcp_buffers = g_queue_new ();
 
@@ -136,9 +174,10 @@ rtp_twcc_manager_finalize (GObject * object)
 {
   RTPTWCCManager *twcc = RTP_TWCC_MANAGER_CAST (object);
 
+  g_free (twcc->recv_ring);
   g_array_unref (twcc->recv_packets);
-  g_array_unref (twcc->sent_packets);
-  g_array_unref (twcc->parsed_packets);
+  g_array_unref (twcc->packet_chunks);
+  g_free (twcc->sent_ring);
   g_queue_free_full (twcc->rtcp_buffers, (GDestroyNotify) gst_buffer_unref);
 
   G_OBJECT_CLASS (rtp_twcc_manager_parent_class)->finalize (object);
@@ -162,15 +201,133 @@ rtp_twcc_manager_new (guint mtu)
 }
 
 static void
-recv_packet_init (RecvPacket * packet, guint16 seqnum, RTPPacketInfo * pinfo)
+recv_packet_init (RecvPacket * packet, guint16 seqnum, GstClockTime ts)
 {
   memset (packet, 0, sizeof (RecvPacket));
   packet->seqnum = seqnum;
+  packet->ts = ts;
+}
 
-  if (GST_CLOCK_TIME_IS_VALID (pinfo->arrival_time))
-    packet->ts = pinfo->arrival_time;
-  else
-    packet->ts = pinfo->current_time;
+static void
+recv_ring_resize (RTPTWCCManager * twcc, guint size)
+{
+  RecvSlot *ring = g_new0 (RecvSlot, size);
+  guint i;
+
+  GST_DEBUG ("Resizing receive ring from %u to %u", twcc->recv_ring_size,
+      size);
+
+  /* keep the packets received for the current feedback */
+  for (i = 0; i < twcc->recv_ring_size; i++) {
+    RecvSlot *slot = &twcc->recv_ring[i];
+
+    if (slot->gen == twcc->recv_gen)
+      ring[slot->seqnum & (size - 1)] = *slot;
+  }
+
+  g_free (twcc->recv_ring);
+  twcc->recv_ring = ring;
+  twcc->recv_ring_size = size;
+}
+
+/* Stores a received packet for the next feedback, returns FALSE if the
+ * packet was already received */
+static gboolean
+recv_ring_insert (RTPTWCCManager * twcc, guint16 seqnum, GstClockTime ts)
+{
+  guint16 first = twcc->recv_first;
+  guint16 last = twcc->recv_last;
+  guint span, size;
+  RecvSlot *slot;
+
+  if (twcc->recv_count == 0) {
+    first = last = seqnum;
+  } else if (gst_rtp_buffer_compare_seqnum (first, seqnum) < 0) {
+    first = seqnum;
+  } else if ((guint16) (seqnum - first) > (guint16) (last - first)) {
+    last = seqnum;
+  }
+
+  span = (guint16) (last - first) + 1;
+  for (size = twcc->recv_ring_size; size < span && size < RECV_RING_MAX_SIZE;)
+    size <<= 1;
+  if (size != twcc->recv_ring_size)
+    recv_ring_resize (twcc, size);
+
+  slot = &twcc->recv_ring[seqnum & (twcc->recv_ring_size - 1)];
+  if (slot->gen == twcc->recv_gen && slot->seqnum == seqnum) {
+    GST_DEBUG ("Ignoring duplicate packet #%u", seqnum);
+    twcc->recv_duplicates++;
+    return FALSE;
+  }
+
+  slot->ts = ts;
+  slot->gen = twcc->recv_gen;
+  slot->seqnum = seqnum;
+
+  twcc->recv_first = first;
+  twcc->recv_last = last;
+  twcc->recv_count++;
+
+  return TRUE;
+}
+
+/* forget about all received packets, they were reported */
+static void
+recv_ring_clear (RTPTWCCManager * twcc)
+{
+  twcc->recv_count = 0;
+  twcc->recv_duplicates = 0;
+  if (++twcc->recv_gen == 0) {
+    memset (twcc->recv_ring, 0, twcc->recv_ring_size * sizeof (RecvSlot));
+    twcc->recv_gen = 1;
+  }
+}
+
+static SentPacket *
+sent_ring_lookup (RTPTWCCManager * twcc, guint16 seqnum)
+{
+  SentPacket *pkt;
+
+  if ((guint16) (seqnum - twcc->sent_first) >= twcc->sent_count)
+    return NULL;
+
+  pkt = &twcc->sent_ring[seqnum & (twcc->sent_ring_size - 1)];
+  if (pkt->seqnum != seqnum)
+    return NULL;
+
+  return pkt;
+}
+
+static void
+sent_ring_append (RTPTWCCManager * twcc, const SentPacket * packet)
+{
+  if (twcc->sent_count == twcc->sent_ring_size) {
+    if (twcc->sent_ring_size < SENT_RING_MAX_SIZE) {
+      guint size = twcc->sent_ring_size * 2;
+      SentPacket *ring = g_new0 (SentPacket, size);
+      guint i;
+
+      for (i = 0; i < twcc->sent_count; i++) {
+        guint16 seqnum = twcc->sent_first + i;
+
+        ring[seqnum & (size - 1)] =
+            twcc->sent_ring[seqnum & (twcc->sent_ring_size - 1)];
+      }
+      g_free (twcc->sent_ring);
+      twcc->sent_ring = ring;
+      twcc->sent_ring_size = size;
+    } else {
+      /* nothing was reported on for a long time, forget the oldest */
+      twcc->sent_first++;
+      twcc->sent_count--;
+    }
+  }
+
+  if (twcc->sent_count == 0)
+    twcc->sent_first = packet->seqnum;
+  twcc->sent_ring[packet->seqnum & (twcc->sent_ring_size - 1)] = *packet;
+  twcc->sent_count++;
 }
 
 void
@@ -185,6 +342,12 @@ rtp_twcc_manager_parse_recv_ext_id (RTPTWCCManager * twcc,
   }
 }
 
+guint8
+rtp_twcc_manager_get_recv_ext_id (RTPTWCCManager * twcc)
+{
+  return twcc->recv_ext_id;
+}
+
 void
 rtp_twcc_manager_parse_send_ext_id (RTPTWCCManager * twcc,
     const GstStructure * s)
@@ -265,7 +428,7 @@ _set_twcc_seqnum_data (RTPTWCCManager * twcc, RTPPacketInfo * pinfo,
 
       GST_WRITE_UINT16_BE (data, seqnum);
       sent_packet_init (&packet, seqnum, pinfo, &rtp);
-      g_array_append_val (twcc->sent_packets, packet);
+      sent_ring_append (twcc, &packet);
 
       GST_LOG ("Send: twcc-seqnum: %u, pt: %u, marker: %d, len: %u, ts: %"
           GST_TIME_FORMAT, seqnum, packet.pt, pinfo->marker, packet.size,
@@ -317,19 +480,6 @@ rtp_twcc_manager_get_recv_twcc_seqnum (RTPTWCCManager * twcc,
   return val;
 }
 
-static gint
-_twcc_seqnum_sort (gconstpointer a, gconstpointer b)
-{
-  gint32 seqa = ((RecvPacket *) a)->seqnum;
-  gint32 seqb = ((RecvPacket *) b)->seqnum;
-  gint res = seqa - seqb;
-  if (res < -65000)
-    res = 1;
-  if (res > 65000)
-    res = -1;
-  return res;
-}
-
 static void
 rtp_twcc_write_recv_deltas (guint8 * fci_data, GArray * twcc_packets)
 {
@@ -353,16 +503,14 @@ rtp_twcc_write_run_length_chunk (GArray * packet_chunks,
 {
   guint written = 0;
   while (written < run_length) {
-    GstBitWriter writer;
-    guint16 data = 0;
+    guint16 data;
     guint len = MIN (run_length - written, 8191);
 
     GST_LOG ("Writing a run-length of %u with status %u", len, status);
 
-    gst_bit_writer_init_with_data (&writer, (guint8 *) & data, 2, FALSE);
-    gst_bit_writer_put_bits_uint8 (&writer, RTP_TWCC_CHUNK_TYPE_RUN_LENGTH, 1);
-    gst_bit_writer_put_bits_uint8 (&writer, status, 2);
-    gst_bit_writer_put_bits_uint16 (&writer, len, 13);
+    /* 1 bit chunk type, 2 bits status and 13 bits run-length */
+    GST_WRITE_UINT16_BE (&data, (RTP_TWCC_CHUNK_TYPE_RUN_LENGTH << 15) |
+        ((status & 0x3) << 13) | len);
     g_array_append_val (packet_chunks, data);
     written += len;
   }
@@ -371,22 +519,18 @@ rtp_twcc_write_run_length_chunk (GArray * packet_chunks,
 typedef struct
 {
   GArray *packet_chunks;
-  GstBitWriter writer;
   guint16 data;
+  guint bit_size;
   guint symbol_size;
 } ChunkBitWriter;
 
 static void
 chunk_bit_writer_reset (ChunkBitWriter * writer)
 {
-  writer->data = 0;
-  gst_bit_writer_init_with_data (&writer->writer,
-      (guint8 *) & writer->data, 2, FALSE);
-
-  gst_bit_writer_put_bits_uint8 (&writer->writer,
-      RTP_TWCC_CHUNK_TYPE_STATUS_VECTOR, 1);
+  writer->data = RTP_TWCC_CHUNK_TYPE_STATUS_VECTOR << 15;
   /* 1 for 2-bit symbol-size, 0 for 1-bit */
-  gst_bit_writer_put_bits_uint8 (&writer->writer, writer->symbol_size - 1, 1);
+  writer->data |= (writer->symbol_size - 1) << 14;
+  writer->bit_size = 2;
 }
 
 static void
@@ -399,19 +543,19 @@ chunk_bit_writer_configure (ChunkBitWriter * writer, guint symbol_size)
 static gboolean
 chunk_bit_writer_is_empty (ChunkBitWriter * writer)
 {
-  return writer->writer.bit_size == 2;
+  return writer->bit_size == 2;
 }
 
 static gboolean
 chunk_bit_writer_is_full (ChunkBitWriter * writer)
 {
-  return writer->writer.bit_size == 16;
+  return writer->bit_size == 16;
 }
 
 static guint
 chunk_bit_writer_get_available_slots (ChunkBitWriter * writer)
 {
-  return (16 - writer->writer.bit_size) / writer->symbol_size;
+  return (16 - writer->bit_size) / writer->symbol_size;
 }
 
 static guint
@@ -425,7 +569,10 @@ chunk_bit_writer_flush (ChunkBitWriter * writer)
 {
   /* don't append a chunk if no bits have been written */
   if (!chunk_bit_writer_is_empty (writer)) {
-    g_array_append_val (writer->packet_chunks, writer->data);
+    guint16 data;
+
+    GST_WRITE_UINT16_BE (&data, writer->data);
+    g_array_append_val (writer->packet_chunks, data);
     chunk_bit_writer_reset (writer);
   }
 }
@@ -441,7 +588,9 @@ chunk_bit_writer_init (ChunkBitWriter * writer,
 static void
 chunk_bit_writer_write (ChunkBitWriter * writer, RTPTWCCPacketStatus status)
 {
-  gst_bit_writer_put_bits_uint8 (&writer->writer, status, writer->symbol_size);
+  writer->bit_size += writer->symbol_size;
+  writer->data |= (status & ((1 << writer->symbol_size) - 1)) <<
+      (16 - writer->bit_size);
   if (chunk_bit_writer_is_full (writer)) {
     chunk_bit_writer_flush (writer);
   }
@@ -585,8 +734,8 @@ rtp_twcc_manager_add_fci (RTPTWCCManager * twcc, GstRTCPPacket * packet)
   guint16 packet_count;
   GstClockTime base_time;
   GstClockTime ts_rounded;
-  guint i;
-  GArray *packet_chunks = g_array_new (FALSE, FALSE, 2);
+  guint i, n;
+  GArray *packet_chunks = twcc->packet_chunks;
   RTPTWCCHeader header;
   guint header_size = sizeof (RTPTWCCHeader);
   guint packet_chunks_size;
@@ -601,20 +750,19 @@ rtp_twcc_manager_add_fci (RTPTWCCManager * twcc, GstRTCPPacket * packet)
   gint64 delta_ts_rounded;
   guint8 fb_pkt_count;
 
-  g_array_sort (twcc->recv_packets, _twcc_seqnum_sort);
+  /* the ring has the packets in seqnum order and without duplicates */
+  g_array_set_size (twcc->recv_packets, twcc->recv_count);
+  g_array_set_size (packet_chunks, 0);
+  for (i = 0, n = 0; n < twcc->recv_count; i++) {
+    guint16 seqnum = twcc->recv_first + i;
+    RecvSlot *slot = &twcc->recv_ring[seqnum & (twcc->recv_ring_size - 1)];
 
-  /* Quick scan to remove duplicates */
-  prev = &g_array_index (twcc->recv_packets, RecvPacket, 0);
-  for (i = 1; i < twcc->recv_packets->len;) {
-    RecvPacket *cur = &g_array_index (twcc->recv_packets, RecvPacket, i);
+    if (slot->gen != twcc->recv_gen || slot->seqnum != seqnum)
+      continue;
 
-    if (prev->seqnum == cur->seqnum) {
-      GST_DEBUG ("Removing duplicate packet #%u", cur->seqnum);
-      g_array_remove_index (twcc->recv_packets, i);
-    } else {
-      prev = cur;
-      i += 1;
-    }
+    recv_packet_init (&g_array_index (twcc->recv_packets, RecvPacket, n),
+        seqnum, slot->ts);
+    n++;
   }
 
   /* get first and last packet */
@@ -703,8 +851,8 @@ rtp_twcc_manager_add_fci (RTPTWCCManager * twcc, GstRTCPPacket * packet)
       packet_chunks_size);
   GST_MEMDUMP ("full fci:", fci_data, fci_length);
 
-  g_array_unref (packet_chunks);
   g_array_set_size (twcc->recv_packets, 0);
+  recv_ring_clear (twcc);
 }
 
 static void
@@ -737,7 +885,8 @@ rtp_twcc_manager_create_feedback (RTPTWCCManager * twcc)
 static gboolean
 _exceeds_max_packets (RTPTWCCManager * twcc, guint16 seqnum)
 {
-  if (twcc->recv_packets->len + 1 > twcc->max_packets_per_rtcp)
+  if (twcc->recv_count + twcc->recv_duplicates + 1 >
+      twcc->max_packets_per_rtcp)
     return TRUE;
 
   return FALSE;
@@ -749,15 +898,13 @@ _exceeds_max_packets (RTPTWCCManager * twcc, guint16 seqnum)
 static gboolean
 _many_packets_some_lost (RTPTWCCManager * twcc, guint16 seqnum)
 {
-  RecvPacket *first;
   guint16 packet_count;
-  guint received_packets = twcc->recv_packets->len;
+  guint received_packets = twcc->recv_count + twcc->recv_duplicates;
   guint lost_packets;
   if (received_packets == 0)
     return FALSE;
 
-  first = &g_array_index (twcc->recv_packets, RecvPacket, 0);
-  packet_count = seqnum - first->seqnum + 1;
+  packet_count = seqnum - twcc->recv_first + 1;
 
   /* If there are a high number of duplicates, we can't use the following
    * metrics */
@@ -780,7 +927,7 @@ gboolean
 rtp_twcc_manager_recv_packet (RTPTWCCManager * twcc, RTPPacketInfo * pinfo)
 {
   gboolean send_feedback = FALSE;
-  RecvPacket packet;
+  GstClockTime ts;
   gint32 seqnum;
   gint diff;
 
@@ -812,8 +959,11 @@ rtp_twcc_manager_recv_packet (RTPTWCCManager * twcc, RTPPacketInfo * pinfo)
   }
 
   /* store the packet for Transport-wide RTCP feedback message */
-  recv_packet_init (&packet, seqnum, pinfo);
-  g_array_append_val (twcc->recv_packets, packet);
+  if (GST_CLOCK_TIME_IS_VALID (pinfo->arrival_time))
+    ts = pinfo->arrival_time;
+  else
+    ts = pinfo->current_time;
+  recv_ring_insert (twcc, seqnum, ts);
   twcc->last_seqnum = seqnum;
 
   GST_LOG ("Receive: twcc-seqnum: %u, pt: %u, marker: %d, ts: %"
@@ -900,16 +1050,13 @@ _add_twcc_packet (GArray * twcc_packets, guint16 seqnum, guint status)
 }
 
 static guint
-_parse_run_length_chunk (GstBitReader * reader, GArray * twcc_packets,
+_parse_run_length_chunk (guint16 chunk, GArray * twcc_packets,
     guint16 seqnum_offset, guint remaining_packets)
 {
-  guint16 run_length;
-  guint8 status_code;
+  guint16 run_length = chunk & 0x1fff;
+  guint8 status_code = (chunk >> 13) & 0x3;
   guint i;
 
-  gst_bit_reader_get_bits_uint8 (reader, &status_code, 2);
-  gst_bit_reader_get_bits_uint16 (reader, &run_length, 13);
-
   run_length = MIN (remaining_packets, run_length);
 
   for (i = 0; i < run_length; i++) {
@@ -920,21 +1067,19 @@ _parse_run_length_chunk (GstBitReader * reader, GArray * twcc_packets,
 }
 
 static guint
-_parse_status_vector_chunk (GstBitReader * reader, GArray * twcc_packets,
+_parse_status_vector_chunk (guint16 chunk, GArray * twcc_packets,
     guint16 seqnum_offset, guint remaining_packets)
 {
-  guint8 symbol_size;
+  guint symbol_size = ((chunk >> 14) & 0x1) + 1;
   guint num_bits;
   guint i;
 
-  gst_bit_reader_get_bits_uint8 (reader, &symbol_size, 1);
-  symbol_size += 1;
   num_bits = MIN (remaining_packets, 14 / symbol_size);
 
   for (i = 0; i < num_bits; i++) {
-    guint8 status_code;
-    if (gst_bit_reader_get_bits_uint8 (reader, &status_code, symbol_size))
-      _add_twcc_packet (twcc_packets, seqnum_offset + i, status_code);
+    guint8 status_code = (chunk >> (14 - (i + 1) * symbol_size)) &
+        ((1 << symbol_size) - 1);
+    _add_twcc_packet (twcc_packets, seqnum_offset + i, status_code);
   }
 
   return num_bits;
@@ -945,20 +1090,20 @@ _parse_status_vector_chunk (GstBitReader * reader, GArray * twcc_packets,
 static void
 _prune_sent_packets (RTPTWCCManager * twcc, GArray * twcc_packets)
 {
-  SentPacket *first;
   RTPTWCCPacket *last;
   guint16 last_idx;
 
-  if (twcc_packets->len == 0 || twcc->sent_packets->len == 0)
+  if (twcc_packets->len == 0 || twcc->sent_count == 0)
     return;
 
-  first = &g_array_index (twcc->sent_packets, SentPacket, 0);
   last = &g_array_index (twcc_packets, RTPTWCCPacket, twcc_packets->len - 1);
 
-  last_idx = last->seqnum - first->seqnum;
+  last_idx = last->seqnum - twcc->sent_first;
 
-  if (last_idx < twcc->sent_packets->len)
-    g_array_remove_range (twcc->sent_packets, 0, last_idx);
+  if (last_idx < twcc->sent_count) {
+    twcc->sent_first += last_idx;
+    twcc->sent_count -= last_idx;
+  }
 }
 
 static void
@@ -1026,7 +1171,6 @@ rtp_twcc_manager_parse_fci (RTPTWCCManager * twcc,
   guint packets_parsed = 0;
   guint fci_parsed;
   guint i;
-  SentPacket *first_sent_pkt = NULL;
 
   if (fci_length < 10) {
     GST_WARNING ("Malformed TWCC RTCP feedback packet");
@@ -1055,26 +1199,20 @@ rtp_twcc_manager_parse_fci (RTPTWCCManager * twcc,
 
   fci_parsed = 8;
   while (packets_parsed < packet_count && (fci_parsed + 1) < fci_length) {
-    GstBitReader reader = GST_BIT_READER_INIT (&fci_data[fci_parsed], 2);
-    guint8 chunk_type;
+    guint16 chunk = GST_READ_UINT16_BE (&fci_data[fci_parsed]);
     guint seqnum_offset = base_seqnum + packets_parsed;
     guint remaining_packets = packet_count - packets_parsed;
 
-    gst_bit_reader_get_bits_uint8 (&reader, &chunk_type, 1);
-
-    if (chunk_type == RTP_TWCC_CHUNK_TYPE_RUN_LENGTH) {
-      packets_parsed += _parse_run_length_chunk (&reader,
+    if ((chunk >> 15) == RTP_TWCC_CHUNK_TYPE_RUN_LENGTH) {
+      packets_parsed += _parse_run_length_chunk (chunk,
           twcc_packets, seqnum_offset, remaining_packets);
     } else {
-      packets_parsed += _parse_status_vector_chunk (&reader,
+      packets_parsed += _parse_status_vector_chunk (chunk,
           twcc_packets, seqnum_offset, remaining_packets);
     }
     fci_parsed += 2;
   }
 
-  if (twcc->sent_packets->len > 0)
-    first_sent_pkt = &g_array_index (twcc->sent_packets, SentPacket, 0);
-
   if (twcc->remote_ts_base == -1) {
     /* Add an initial offset of 1 << 24 so that we don't risk going below 0 if
      * a future extended timestamp is earlier than the first. */
@@ -1094,6 +1232,7 @@ rtp_twcc_manager_parse_fci (RTPTWCCManager * twcc,
     RTPTWCCPacket *pkt = &g_array_index (twcc_packets, RTPTWCCPacket, i);
     gint16 delta = 0;
     GstClockTimeDiff delta_ts;
+    SentPacket *found;
 
     if (pkt->status == RTP_TWCC_PACKET_STATUS_SMALL_DELTA) {
       delta = fci_data[fci_parsed];
@@ -1121,23 +1260,18 @@ rtp_twcc_manager_parse_fci (RTPTWCCManager * twcc,
           pkt->status);
     }
 
-    if (first_sent_pkt) {
-      SentPacket *found = NULL;
-      guint16 sent_idx = pkt->seqnum - first_sent_pkt->seqnum;
-      if (sent_idx < twcc->sent_packets->len)
-        found = &g_array_index (twcc->sent_packets, SentPacket, sent_idx);
-      if (found && found->seqnum == pkt->seqnum) {
-        if (GST_CLOCK_TIME_IS_VALID (found->socket_ts)) {
-          pkt->local_ts = found->socket_ts;
-        } else {
-          pkt->local_ts = found->ts;
-        }
-        pkt->size = found->size;
-        pkt->pt = found->pt;
-
-        GST_LOG ("matching pkt: #%u with local_ts: %" GST_TIME_FORMAT
-            " size: %u", pkt->seqnum, GST_TIME_ARGS (pkt->local_ts), pkt->size);
+    found = sent_ring_lookup (twcc, pkt->seqnum);
+    if (found) {
+      if (GST_CLOCK_TIME_IS_VALID (found->socket_ts)) {
+        pkt->local_ts = found->socket_ts;
+      } else {
+        pkt->local_ts = found->ts;
       }
+      pkt->size = found->size;
+      pkt->pt = found->pt;
+
+      GST_LOG ("matching pkt: #%u with local_ts: %" GST_TIME_FORMAT
+          " size: %u", pkt->seqnum, GST_TIME_ARGS (pkt->local_ts), pkt->size);
     }
   }
 
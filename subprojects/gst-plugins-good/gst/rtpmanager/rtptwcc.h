@@ -58,6 +58,7 @@ void rtp_twcc_manager_parse_recv_ext_id (RTPTWCCManager * twcc,
     const GstStructure * s);
 void rtp_twcc_manager_parse_send_ext_id (RTPTWCCManager * twcc,
     const GstStructure * s);
+guint8 rtp_twcc_manager_get_recv_ext_id (RTPTWCCManager * twcc);
 
 void rtp_twcc_manager_set_mtu (RTPTWCCManager * twcc, guint mtu);
 void rtp_twcc_manager_set_feedback_interval (RTPTWCCManager * twcc,
@@ -221,13 +221,20 @@ gst_spectrum_alloc_channel_data (GstSpectrum * spectrum)
   spectrum->channel_data = g_new (GstSpectrumChannel, spectrum->num_channels);
   for (i = 0; i < spectrum->num_channels; i++) {
     cd = &spectrum->channel_data[i];
-    cd->fft_ctx = gst_fft_f32_new (nfft, FALSE);
     cd->input = g_new0 (gfloat, nfft);
-    cd->input_tmp = g_new0 (gfloat, nfft);
-    cd->freqdata = g_new0 (GstFFTF32Complex, bands);
     cd->spect_magnitude = g_new0 (gfloat, bands);
     cd->spect_phase = g_new0 (gfloat, bands);
   }
+
+  /* all channels have the same size, so they share the FFT context, the
+   * scratch buffers and a precomputed Hamming window (the same as
+   * gst_fft_f32_window() computes on every call) */
+  spectrum->fft_ctx = gst_fft_f32_new (nfft, FALSE);
+  spectrum->input_tmp = g_new0 (gfloat, nfft);
+  spectrum->freqdata = g_new0 (GstFFTF32Complex, bands);
+  spectrum->window = g_new (gdouble, nfft);
+  for (i = 0; i < nfft; i++)
+    spectrum->window[i] = 0.53836 - 0.46164 * cos (2.0 * G_PI * i / nfft);
 }
 
 static void
@@ -242,16 +249,21 @@ gst_spectrum_free_channel_data (GstSpectrum * spectrum)
 
     for (i = 0; i < spectrum->num_channels; i++) {
       cd = &spectrum->channel_data[i];
-      if (cd->fft_ctx)
-        gst_fft_f32_free (cd->fft_ctx);
       g_free (cd->input);
-      g_free (cd->input_tmp);
-      g_free (cd->freqdata);
       g_free (cd->spect_magnitude);
       g_free (cd->spect_phase);
     }
     g_free (spectrum->channel_data);
     spectrum->channel_data = NULL;
+
+    gst_fft_f32_free (spectrum->fft_ctx);
+    spectrum->fft_ctx = NULL;
+    g_free (spectrum->input_tmp);
+    spectrum->input_tmp = NULL;
+    g_free (spectrum->freqdata);
+    spectrum->freqdata = NULL;
+    g_free (spectrum->window);
+    spectrum->window = NULL;
   }
 }
 
@@ -408,7 +420,8 @@ input_data_mixed_float (const guint8 * _in, gfloat * out, guint len,
     for (i = 1; i < channels; i++)
       v += in[ip++];
     out[op] = v / channels;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -425,7 +438,8 @@ input_data_mixed_double (const guint8 * _in, gfloat * out, guint len,
     for (i = 1; i < channels; i++)
       v += in[ip++];
     out[op] = v / channels;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -442,7 +456,8 @@ input_data_mixed_int32_max (const guint8 * _in, gfloat * out, guint len,
     for (i = 1; i < channels; i++)
       v += in[ip++] / max_value;
     out[op] = v / channels;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -466,7 +481,8 @@ input_data_mixed_int24_max (const guint8 * _in, gfloat * out, guint len,
       _in += 3;
     }
     out[op] = v / channels;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -483,7 +499,8 @@ input_data_mixed_int16_max (const guint8 * _in, gfloat * out, guint len,
     for (i = 1; i < channels; i++)
       v += in[ip++] / max_value;
     out[op] = v / channels;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -498,7 +515,8 @@ input_data_float (const guint8 * _in, gfloat * out, guint len, guint channels,
 
   for (j = 0, ip = 0; j < len; j++, ip += channels) {
     out[op] = in[ip];
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -511,7 +529,8 @@ input_data_double (const guint8 * _in, gfloat * out, guint len, guint channels,
 
   for (j = 0, ip = 0; j < len; j++, ip += channels) {
     out[op] = in[ip];
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -524,7 +543,8 @@ input_data_int32_max (const guint8 * _in, gfloat * out, guint len,
 
   for (j = 0, ip = 0; j < len; j++, ip += channels) {
     out[op] = in[ip] / max_value;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -544,7 +564,8 @@ input_data_int24_max (const guint8 * _in, gfloat * out, guint len,
       v |= 0xff000000;
     _in += 3 * channels;
     out[op] = v / max_value;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -557,7 +578,8 @@ input_data_int16_max (const guint8 * _in, gfloat * out, guint len,
 
   for (j = 0, ip = 0; j < len; j++, ip += channels) {
     out[op] = in[ip] / max_value;
-    op = (op + 1) % nfft;
+    if (++op == nfft)
+      op = 0;
   }
 }
 
@@ -716,23 +738,25 @@ static void
 gst_spectrum_run_fft (GstSpectrum * spectrum, GstSpectrumChannel * cd,
     guint input_pos)
 {
-  guint i;
+  guint i, n;
   guint bands = spectrum->bands;
   guint nfft = 2 * bands - 2;
   gint threshold = spectrum->threshold;
   gfloat *input = cd->input;
-  gfloat *input_tmp = cd->input_tmp;
+  gfloat *input_tmp = spectrum->input_tmp;
   gfloat *spect_magnitude = cd->spect_magnitude;
   gfloat *spect_phase = cd->spect_phase;
-  GstFFTF32Complex *freqdata = cd->freqdata;
-  GstFFTF32 *fft_ctx = cd->fft_ctx;
+  GstFFTF32Complex *freqdata = spectrum->freqdata;
+  const gdouble *window = spectrum->window;
 
-  for (i = 0; i < nfft; i++)
-    input_tmp[i] = input[(input_pos + i) % nfft];
-
-  gst_fft_f32_window (fft_ctx, input_tmp, GST_FFT_WINDOW_HAMMING);
+  /* unwrap the ringbuffer and apply the window in one pass */
+  n = nfft - input_pos;
+  for (i = 0; i < n; i++)
+    input_tmp[i] = input[input_pos + i] * window[i];
+  for (; i < nfft; i++)
+    input_tmp[i] = input[i - n] * window[i];
 
-  gst_fft_f32_fft (fft_ctx, input_tmp, freqdata);
+  gst_fft_f32_fft (spectrum->fft_ctx, input_tmp, freqdata);
 
   if (spectrum->message_magnitude) {
     gdouble val;
@@ -755,6 +779,16 @@ gst_spectrum_run_fft (GstSpectrum * spectrum, GstSpectrumChannel * cd,
   }
 }
 
+/* run the FFTs of all channels with the shared context */
+static void
+gst_spectrum_run_ffts (GstSpectrum * spectrum, guint input_pos)
+{
+  guint c;
+
+  for (c = 0; c < spectrum->num_channels; c++)
+    gst_spectrum_run_fft (spectrum, &spectrum->channel_data[c], input_pos);
+}
+
 static void
 gst_spectrum_prepare_message_data (GstSpectrum * spectrum,
     GstSpectrumChannel * cd)
@@ -894,10 +928,7 @@ gst_spectrum_transform_ip (GstBaseTransform * trans, GstBuffer * buffer)
      * the interval and we haven't run a FFT, then run an FFT */
     if ((spectrum->num_frames % nfft == 0) ||
         (have_full_interval && !spectrum->num_fft)) {
-      for (c = 0; c < output_channels; c++) {
-        cd = &spectrum->channel_data[c];
-        gst_spectrum_run_fft (spectrum, cd, input_pos);
-      }
+      gst_spectrum_run_ffts (spectrum, input_pos);
       spectrum->num_fft++;
     }
 
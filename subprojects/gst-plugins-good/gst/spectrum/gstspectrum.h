@@ -43,11 +43,8 @@ typedef void (*GstSpectrumInputData)(const guint8 * in, gfloat * out,
 struct _GstSpectrumChannel
 {
   gfloat *input;
-  gfloat *input_tmp;
-  GstFFTF32Complex *freqdata;
   gfloat *spect_magnitude;      /* accumulated mangitude and phase */
   gfloat *spect_phase;          /* will be scaled by num_fft before sending */
-  GstFFTF32 *fft_ctx;
 };
 
 struct _GstSpectrum
@@ -74,6 +71,12 @@ struct _GstSpectrum
   GstSpectrumChannel *channel_data;
   guint num_channels;
 
+  /* shared by all channels */
+  GstFFTF32 *fft_ctx;
+  gdouble *window;
+  gfloat *input_tmp;
+  GstFFTF32Complex *freqdata;
+
   guint input_pos;
   guint64 error_per_interval;
   guint64 accumulated_error;
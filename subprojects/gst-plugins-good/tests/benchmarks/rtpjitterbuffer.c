@@ -0,0 +1,183 @@
+/* GStreamer
+ *
+ * rtpjitterbuffer.c: packet and timer queue operations with many packets
+ *     in flight
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#include "../../gst/rtpmanager/rtpjitterbuffer.h"
+#include "../../gst/rtpmanager/rtptimerqueue.h"
+
+/* 1 in REORDER_RATE packets arrives late */
+#define REORDER_RATE 10
+#define PACKET_DURATION (GST_MSECOND / 10)
+
+/* RTP seqnums limit how many packets can be in flight, with the reordering
+ * the packets of the jitterbuffer span up to 1.5 times these */
+static const guint packets_in_flight[] = { 1000, 10000, 20000 };
+static const guint timers_in_flight[] = { 1000, 10000, 20000, 40000 };
+
+/* Returns @n_packets extended seqnums, starting at 0 and mostly in order,
+ * where some packets are delayed by up to half of @window */
+static guint *
+make_arrival_order (guint n_packets, guint window)
+{
+  guint *order = g_new (guint, n_packets);
+  GRand *rand = g_rand_new_with_seed (window);
+  guint i;
+
+  for (i = 0; i < n_packets; i++)
+    order[i] = i;
+
+  for (i = 0; i + window < n_packets; i++) {
+    if (g_rand_int_range (rand, 0, REORDER_RATE) == 0) {
+      guint j = i + g_rand_int_range (rand, 1, window / 2);
+      guint tmp = order[i];
+
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+  }
+
+  g_rand_free (rand);
+  return order;
+}
+
+static void
+run_jitterbuffer (guint window, guint n_packets, gboolean use_index)
+{
+  RTPJitterBuffer *jbuf;
+  RTPJitterBufferItem *item;
+  GstClockTime start, end;
+  guint *order;
+  gboolean duplicate;
+  guint i, n_duplicates = 0;
+
+  order = make_arrival_order (n_packets, window);
+
+  jbuf = rtp_jitter_buffer_new ();
+  rtp_jitter_buffer_set_seqnum_index (jbuf, use_index);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++) {
+    GstClockTime pts = order[i] * PACKET_DURATION;
+
+    rtp_jitter_buffer_append_buffer (jbuf, gst_buffer_new (), pts, pts,
+        order[i], order[i] * 9, &duplicate, NULL);
+    n_duplicates += duplicate;
+
+    while (rtp_jitter_buffer_num_packets (jbuf) > window) {
+      item = rtp_jitter_buffer_pop (jbuf, NULL);
+      rtp_jitter_buffer_free_item (item);
+    }
+  }
+  end = gst_util_get_timestamp ();
+
+  g_print ("jitterbuffer %6u in flight, %-6s: %8.1f ns/packet\n", window,
+      use_index ? "index" : "list",
+      (gdouble) GST_CLOCK_DIFF (start, end) / n_packets);
+  g_assert (n_duplicates == 0);
+
+  rtp_jitter_buffer_flush (jbuf, NULL, NULL);
+  g_object_unref (jbuf);
+  g_free (order);
+}
+
+static void
+run_timers (guint window, guint n_packets, gboolean use_wheel)
+{
+  RtpTimerQueue *queue;
+  RtpTimer *timer;
+  GstClockTime start, end, latency;
+  guint *order;
+  guint i;
+
+  order = make_arrival_order (n_packets, window);
+  latency = window * PACKET_DURATION;
+
+  queue = rtp_timer_queue_new ();
+  rtp_timer_queue_set_use_wheel (queue, use_wheel);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++) {
+    guint seqnum = order[i];
+    GstClockTime now = (GstClockTime) i * PACKET_DURATION;
+
+    /* a late packet gets a deadline, otherwise expect the next one */
+    if (seqnum < i)
+      rtp_timer_queue_set_deadline (queue, seqnum,
+          seqnum * PACKET_DURATION + latency, 0);
+    else
+      rtp_timer_queue_set_expected (queue, seqnum + 1,
+          (seqnum + 1) * PACKET_DURATION, latency, PACKET_DURATION);
+
+    /* retransmission requests push expected timers back */
+    if (i % REORDER_RATE == 0 && (timer = rtp_timer_queue_find (queue,
+                (guint16) (seqnum + 1))))
+      rtp_timer_queue_update_timer (queue, timer, timer->seqnum,
+          timer->timeout + latency / 8, 0, 0, FALSE);
+
+    while ((timer = rtp_timer_queue_pop_until (queue, now)))
+      rtp_timer_free (timer);
+  }
+  end = gst_util_get_timestamp ();
+
+  g_print ("timers       %6u in flight, %-6s: %8.1f ns/packet\n", window,
+      use_wheel ? "wheel" : "list",
+      (gdouble) GST_CLOCK_DIFF (start, end) / n_packets);
+
+  rtp_timer_queue_remove_all (queue);
+  g_object_unref (queue);
+  g_free (order);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, n_packets = 500000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 2) {
+    g_print ("usage: %s [n_packets]\n", argv[0]);
+    exit (-1);
+  }
+  if (argc == 2)
+    n_packets = atoi (argv[1]);
+
+  if (n_packets <= timers_in_flight[G_N_ELEMENTS (timers_in_flight) - 1]) {
+    g_print ("number of packets must be greater than %u\n",
+        timers_in_flight[G_N_ELEMENTS (timers_in_flight) - 1]);
+    exit (-1);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (packets_in_flight); i++) {
+    run_jitterbuffer (packets_in_flight[i], n_packets, FALSE);
+    run_jitterbuffer (packets_in_flight[i], n_packets, TRUE);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (timers_in_flight); i++) {
+    run_timers (timers_in_flight[i], n_packets, FALSE);
+    run_timers (timers_in_flight[i], n_packets, TRUE);
+  }
+
+  return 0;
+}
@@ -0,0 +1,316 @@
+/* GStreamer
+ *
+ * rtpst2022-1-fec.c: SMPTE 2022-1 FEC encoding and recovery under
+ *     synthetic packet loss
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "../../gst/rtpmanager/gstrtpst2022-1-fecdec.h"
+#include "../../gst/rtpmanager/gstrtpst2022-1-fecenc.h"
+
+/* 7 MPEG-TS packets per RTP packet, at ~50 Mbit/s */
+#define PAYLOAD_SIZE 1316
+#define PACKET_DURATION (210 * GST_USECOND)
+
+enum
+{
+  STREAM_MEDIA,
+  STREAM_COLUMN,
+  STREAM_ROW,
+};
+
+static const struct
+{
+  guint columns, rows;
+} matrices[] = { {5, 5}, {10, 10}, {20, 5} };
+
+static const guint loss_percent[] = { 1, 2, 3, 4, 5 };
+
+/* the packets in the order the encoder produced them */
+static GPtrArray *packets;
+static GArray *streams;
+
+static GstFlowReturn
+collect_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  guint stream = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (pad),
+          "stream"));
+
+  g_ptr_array_add (packets, buffer);
+  g_array_append_val (streams, stream);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+count_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  guint *count = g_object_get_data (G_OBJECT (pad), "count");
+
+  *count += 1;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+drop_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static GstPad *
+make_sinkpad (GstPadChainFunction chain)
+{
+  GstPad *pad = gst_pad_new ("sink", GST_PAD_SINK);
+
+  gst_pad_set_chain_function (pad, chain);
+  gst_pad_set_event_function (pad, drop_event);
+  gst_pad_set_active (pad, TRUE);
+
+  return pad;
+}
+
+static GstPad *
+make_srcpad (GstElement * element, const gchar * name)
+{
+  GstPad *pad = gst_pad_new ("src", GST_PAD_SRC);
+  GstPad *sinkpad = gst_element_get_static_pad (element, name);
+  GstSegment segment;
+
+  if (!sinkpad)
+    sinkpad = gst_element_request_pad_simple (element, name);
+
+  gst_pad_set_active (pad, TRUE);
+  g_assert (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  gst_pad_push_event (pad, gst_event_new_stream_start (name));
+  gst_pad_push_event (pad,
+      gst_event_new_caps (gst_caps_new_empty_simple ("application/x-rtp")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (pad, gst_event_new_segment (&segment));
+
+  return pad;
+}
+
+static void
+link_sink (GstElement * element, const gchar * name, GstPad * sinkpad)
+{
+  GstPad *srcpad = gst_element_get_static_pad (element, name);
+
+  g_assert (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (srcpad);
+}
+
+static GstBuffer *
+make_media_packet (guint16 seq, GRand * rand)
+{
+  GstBuffer *buffer = gst_rtp_buffer_new_allocate (PAYLOAD_SIZE, 0, 0);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint32 *payload;
+  guint i;
+
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 33);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, seq * 19);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < PAYLOAD_SIZE / 4; i++)
+    payload[i] = g_rand_int (rand);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buffer;
+}
+
+static void
+run_encoder (guint columns, guint rows, guint n_packets)
+{
+  GstElement *enc;
+  GstPad *srcpad, *sinkpads[3];
+  GPtrArray *media;
+  GstClockTime start, end;
+  GRand *rand = g_rand_new_with_seed (columns * rows);
+  guint i;
+
+  enc = gst_element_factory_make ("rtpst2022-1-fecenc", NULL);
+  g_object_set (enc, "columns", columns, "rows", rows, NULL);
+  gst_element_set_state (enc, GST_STATE_PLAYING);
+
+  for (i = 0; i < 3; i++) {
+    sinkpads[i] = make_sinkpad (collect_chain);
+    g_object_set_data (G_OBJECT (sinkpads[i]), "stream", GUINT_TO_POINTER (i));
+  }
+  link_sink (enc, "src", sinkpads[STREAM_MEDIA]);
+  link_sink (enc, "fec_0", sinkpads[STREAM_COLUMN]);
+  link_sink (enc, "fec_1", sinkpads[STREAM_ROW]);
+  srcpad = make_srcpad (enc, "sink");
+
+  /* start close to the seqnum wraparound */
+  media = g_ptr_array_new ();
+  for (i = 0; i < n_packets; i++)
+    g_ptr_array_add (media, make_media_packet (60000 + i, rand));
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++)
+    gst_pad_push (srcpad, g_ptr_array_index (media, i));
+  end = gst_util_get_timestamp ();
+
+  g_print ("encode %3ux%-3u                : %8.1f ns/packet\n", columns,
+      rows, (gdouble) GST_CLOCK_DIFF (start, end) / n_packets);
+
+  gst_element_set_state (enc, GST_STATE_NULL);
+  gst_object_unref (enc);
+
+  /* the decoder trims its storage based on the arrival times */
+  for (i = 0; i < packets->len; i++) {
+    GstBuffer *buffer = gst_buffer_make_writable (packets->pdata[i]);
+
+    GST_BUFFER_DTS (buffer) = i * PACKET_DURATION;
+    packets->pdata[i] = buffer;
+  }
+  gst_object_unref (srcpad);
+  for (i = 0; i < 3; i++)
+    gst_object_unref (sinkpads[i]);
+  g_ptr_array_unref (media);
+  g_rand_free (rand);
+}
+
+/* Marks @percent of the media packets as lost, either independently or in
+ * bursts of up to 4 packets */
+static gboolean *
+make_loss_pattern (guint percent, gboolean bursty, guint n_packets)
+{
+  gboolean *lost = g_new0 (gboolean, n_packets);
+  GRand *rand = g_rand_new_with_seed (percent + bursty);
+  guint i, j;
+
+  for (i = 0; i < n_packets; i++) {
+    if (bursty) {
+      /* bursts of 1 to 4, 2.5 packets on average */
+      if (g_rand_int_range (rand, 0, 250) < percent) {
+        guint len = g_rand_int_range (rand, 1, 5);
+
+        for (j = 0; j < len && i + j < n_packets; j++)
+          lost[i + j] = TRUE;
+        i += len;
+      }
+    } else {
+      lost[i] = g_rand_int_range (rand, 0, 100) < percent;
+    }
+  }
+
+  g_rand_free (rand);
+  return lost;
+}
+
+static void
+run_decoder (guint columns, guint rows, guint percent, gboolean bursty)
+{
+  GstElement *dec;
+  GstPad *srcpads[3], *sinkpad;
+  GstClockTime start, end;
+  gboolean *lost;
+  guint i, n_media = 0, n_lost = 0, n_received = 0, n_out = 0;
+
+  lost = make_loss_pattern (percent, bursty, packets->len);
+
+  dec = gst_element_factory_make ("rtpst2022-1-fecdec", NULL);
+  gst_element_set_state (dec, GST_STATE_PLAYING);
+
+  sinkpad = make_sinkpad (count_chain);
+  g_object_set_data (G_OBJECT (sinkpad), "count", &n_out);
+  link_sink (dec, "src", sinkpad);
+  srcpads[STREAM_MEDIA] = make_srcpad (dec, "sink");
+  srcpads[STREAM_COLUMN] = make_srcpad (dec, "fec_0");
+  srcpads[STREAM_ROW] = make_srcpad (dec, "fec_1");
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < packets->len; i++) {
+    guint stream = g_array_index (streams, guint, i);
+
+    if (stream == STREAM_MEDIA) {
+      n_media++;
+      if (lost[i]) {
+        n_lost++;
+        continue;
+      }
+      n_received++;
+    }
+
+    gst_pad_push (srcpads[stream],
+        gst_buffer_ref (g_ptr_array_index (packets, i)));
+  }
+  end = gst_util_get_timestamp ();
+
+  g_print ("decode %3ux%-3u %u%% %-6s loss: %8.1f ns/packet, "
+      "recovered %5.1f%% of %u lost\n", columns, rows, percent,
+      bursty ? "bursty" : "random",
+      (gdouble) GST_CLOCK_DIFF (start, end) / n_media,
+      n_lost ? 100.0 * (n_out - n_received) / n_lost : 100.0, n_lost);
+
+  gst_element_set_state (dec, GST_STATE_NULL);
+  gst_object_unref (dec);
+  for (i = 0; i < 3; i++)
+    gst_object_unref (srcpads[i]);
+  gst_object_unref (sinkpad);
+  g_free (lost);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, j, n_packets = 200000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 2) {
+    g_print ("usage: %s [n_packets]\n", argv[0]);
+    exit (-1);
+  }
+  if (argc == 2)
+    n_packets = atoi (argv[1]);
+
+  GST_ELEMENT_REGISTER (rtpst2022_1_fecenc, NULL);
+  GST_ELEMENT_REGISTER (rtpst2022_1_fecdec, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (matrices); i++) {
+    packets = g_ptr_array_new_with_free_func ((GDestroyNotify)
+        gst_buffer_unref);
+    streams = g_array_new (FALSE, FALSE, sizeof (guint));
+
+    run_encoder (matrices[i].columns, matrices[i].rows, n_packets);
+
+    for (j = 0; j < G_N_ELEMENTS (loss_percent); j++) {
+      run_decoder (matrices[i].columns, matrices[i].rows, loss_percent[j],
+          FALSE);
+      run_decoder (matrices[i].columns, matrices[i].rows, loss_percent[j],
+          TRUE);
+    }
+
+    g_ptr_array_unref (packets);
+    g_array_unref (streams);
+  }
+
+  return 0;
+}
@@ -0,0 +1,235 @@
+/* GStreamer
+ *
+ * rtptwcc.c: transport-wide congestion control feedback generation and
+ *     parsing at high packet rates
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/rtp/gstrtcpbuffer.h>
+
+#include "../../gst/rtpmanager/rtptwcc.h"
+
+GST_DEBUG_CATEGORY (rtp_session_debug);
+
+#define TWCC_EXTMAP_STR "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"
+#define TWCC_EXT_ID 5
+
+/* 5000 packets per second */
+#define PACKET_DURATION (200 * GST_USECOND)
+#define PACKETS_PER_FRAME 10
+#define FEEDBACK_INTERVAL (100 * GST_MSECOND)
+/* packets are sent, received and reported on in batches of this size */
+#define BATCH_SIZE 1000
+/* 1 in REORDER_RATE packets arrives after the next one */
+#define REORDER_RATE 50
+
+static const guint loss_percent[] = { 0, 1, 5 };
+
+static RTPTWCCManager *
+make_manager (gboolean send)
+{
+  RTPTWCCManager *twcc = rtp_twcc_manager_new (1400);
+  GstStructure *s = gst_structure_new ("application/x-rtp",
+      "extmap-5", G_TYPE_STRING, TWCC_EXTMAP_STR, NULL);
+
+  if (send)
+    rtp_twcc_manager_parse_send_ext_id (twcc, s);
+  else
+    rtp_twcc_manager_parse_recv_ext_id (twcc, s);
+  gst_structure_free (s);
+
+  return twcc;
+}
+
+static GstBuffer *
+make_packet (void)
+{
+  GstBuffer *buffer = gst_rtp_buffer_new_allocate (1200, 0, 0);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 twcc_seqnum[2] = { 0, };
+
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_add_extension_onebyte_header (&rtp, TWCC_EXT_ID,
+      twcc_seqnum, sizeof (twcc_seqnum));
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buffer;
+}
+
+/* Returns the order in which @n_packets arrive, with -1 for lost packets */
+static gint *
+make_arrival_order (guint n_packets, guint percent)
+{
+  gint *order = g_new (gint, n_packets);
+  GRand *rand = g_rand_new_with_seed (percent);
+  guint i;
+
+  for (i = 0; i < n_packets; i++)
+    order[i] = g_rand_int_range (rand, 0, 100) < percent ? -1 : i;
+
+  for (i = 0; i + 1 < n_packets; i++) {
+    if (g_rand_int_range (rand, 0, REORDER_RATE) == 0) {
+      gint tmp = order[i];
+
+      order[i] = order[i + 1];
+      order[i + 1] = tmp;
+      i++;
+    }
+  }
+
+  g_rand_free (rand);
+  return order;
+}
+
+static void
+run_twcc (guint n_packets, guint percent, gboolean use_interval)
+{
+  RTPTWCCManager *sender, *receiver;
+  RTPPacketInfo pinfo;
+  GstBuffer *packet;
+  GPtrArray *feedback;
+  GBytes *header_ext;
+  guint8 ext_data[4] = { (TWCC_EXT_ID << 4) | 1, 0, 0, 0 };
+  GstClockTime start, send_time = 0, recv_time = 0, parse_time = 0;
+  gint *order;
+  guint i, j, n_received = 0, n_reported = 0, n_feedback = 0;
+
+  order = make_arrival_order (n_packets, percent);
+
+  sender = make_manager (TRUE);
+  receiver = make_manager (FALSE);
+  if (use_interval)
+    rtp_twcc_manager_set_feedback_interval (receiver, FEEDBACK_INTERVAL);
+
+  packet = make_packet ();
+  header_ext = g_bytes_new_static (ext_data, sizeof (ext_data));
+  feedback = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_buffer_unref);
+
+  for (i = 0; i < n_packets; i += BATCH_SIZE) {
+    guint batch = MIN (BATCH_SIZE, n_packets - i);
+
+    /* sender, assigns twcc-seqnums and remembers the packets */
+    start = gst_util_get_timestamp ();
+    for (j = i; j < i + batch; j++) {
+      memset (&pinfo, 0, sizeof (RTPPacketInfo));
+      pinfo.data = packet;
+      pinfo.current_time = j * PACKET_DURATION;
+      rtp_twcc_manager_send_packet (sender, &pinfo);
+      packet = pinfo.data;
+    }
+    send_time += gst_util_get_timestamp () - start;
+
+    /* receiver, the twcc-seqnums start at 0 like the ones of the sender */
+    start = gst_util_get_timestamp ();
+    for (j = i; j < i + batch; j++) {
+      GstClockTime arrival = j * PACKET_DURATION + 20 * GST_MSECOND;
+
+      if (order[j] < 0)
+        continue;
+
+      GST_WRITE_UINT16_BE (ext_data + 1, order[j]);
+
+      memset (&pinfo, 0, sizeof (RTPPacketInfo));
+      pinfo.ssrc = 0x12345678;
+      pinfo.pt = 96;
+      pinfo.marker = order[j] % PACKETS_PER_FRAME == PACKETS_PER_FRAME - 1;
+      pinfo.arrival_time = arrival;
+      pinfo.current_time = arrival;
+      pinfo.running_time = arrival;
+      pinfo.header_ext = header_ext;
+      pinfo.header_ext_bit_pattern = 0xBEDE;
+
+      if (rtp_twcc_manager_recv_packet (receiver, &pinfo)) {
+        GstBuffer *buf;
+
+        while ((buf = rtp_twcc_manager_get_feedback (receiver, 0xabcdef)))
+          g_ptr_array_add (feedback, buf);
+      }
+      n_received++;
+    }
+    recv_time += gst_util_get_timestamp () - start;
+
+    /* sender, matches the feedback with the sent packets */
+    start = gst_util_get_timestamp ();
+    for (j = 0; j < feedback->len; j++) {
+      GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+      GstRTCPPacket rtcp_packet;
+      GArray *packets;
+
+      gst_rtcp_buffer_map (g_ptr_array_index (feedback, j), GST_MAP_READ,
+          &rtcp);
+      gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet);
+      packets = rtp_twcc_manager_parse_fci (sender,
+          gst_rtcp_packet_fb_get_fci (&rtcp_packet),
+          gst_rtcp_packet_fb_get_fci_length (&rtcp_packet) * 4);
+      gst_rtcp_buffer_unmap (&rtcp);
+
+      if (packets) {
+        n_reported += packets->len;
+        g_array_unref (packets);
+      }
+    }
+    parse_time += gst_util_get_timestamp () - start;
+
+    n_feedback += feedback->len;
+    g_ptr_array_set_size (feedback, 0);
+  }
+
+  g_print ("twcc %u%% loss, %-8s: send %6.1f ns/packet, receive %6.1f "
+      "ns/packet, parse %8.1f ns/feedback (%u feedback, %.1f packets each)\n",
+      percent, use_interval ? "interval" : "marker",
+      (gdouble) send_time / n_packets, (gdouble) recv_time / n_received,
+      n_feedback ? (gdouble) parse_time / n_feedback : 0.0, n_feedback,
+      n_feedback ? (gdouble) n_reported / n_feedback : 0.0);
+
+  g_ptr_array_unref (feedback);
+  g_bytes_unref (header_ext);
+  gst_buffer_unref (packet);
+  g_object_unref (sender);
+  g_object_unref (receiver);
+  g_free (order);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, n_packets = 500000;
+
+  gst_init (&argc, &argv);
+  GST_DEBUG_CATEGORY_INIT (rtp_session_debug, "rtpsession", 0,
+      "RTP session");
+
+  if (argc > 2) {
+    g_print ("usage: %s [n_packets]\n", argv[0]);
+    exit (-1);
+  }
+  if (argc == 2)
+    n_packets = atoi (argv[1]);
+
+  for (i = 0; i < G_N_ELEMENTS (loss_percent); i++) {
+    run_twcc (n_packets, loss_percent[i], FALSE);
+    run_twcc (n_packets, loss_percent[i], TRUE);
+  }
+
+  return 0;
+}
@@ -22,6 +22,8 @@
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#include <math.h>
+
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 
@@ -85,6 +87,30 @@ on_rate_changed (GstElement * element, gint rate, gpointer user_data)
   g_value_array_free (va);
 }
 
+/* Long enough to use FFT convolution, delays by 5 samples like above */
+static void
+on_rate_changed_long (GstElement * element, gint rate, gpointer user_data)
+{
+  GValueArray *va;
+  GValue v = { 0, };
+  gint i;
+
+  fail_unless (rate > 0);
+
+  va = g_value_array_new (64);
+
+  g_value_init (&v, G_TYPE_DOUBLE);
+  for (i = 0; i < 64; i++) {
+    g_value_set_double (&v, i == 5 ? 1.0 : 0.0);
+    g_value_array_append (va, &v);
+    g_value_reset (&v);
+  }
+
+  g_object_set (G_OBJECT (element), "kernel", va, NULL);
+
+  g_value_array_free (va);
+}
+
 static gboolean have_data = FALSE;
 
 static void
@@ -111,7 +137,33 @@ on_handoff (GstElement * object, GstBuffer * buffer, GstPad * pad,
   }
 }
 
-GST_START_TEST (test_pipeline)
+/* Frequency domain convolution is only exact up to rounding errors */
+static void
+on_handoff_fft (GstElement * object, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  if (!have_data) {
+    GstMapInfo map;
+    gdouble *data;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    data = (gdouble *) map.data;
+
+    fail_unless (map.size > 5 * sizeof (gdouble));
+    fail_unless (fabs (data[0]) < 1e-10);
+    fail_unless (fabs (data[1]) < 1e-10);
+    fail_unless (fabs (data[2]) < 1e-10);
+    fail_unless (fabs (data[3]) < 1e-10);
+    fail_unless (fabs (data[4]) < 1e-10);
+    fail_unless (fabs (data[5]) > 1e-10);
+
+    gst_buffer_unmap (buffer, &map);
+    have_data = TRUE;
+  }
+}
+
+static void
+run_pipeline (guint partition_size)
 {
   GstElement *pipeline, *src, *cfilter, *filter, *sink;
   GstCaps *caps;
@@ -142,13 +194,21 @@ GST_START_TEST (test_pipeline)
 
   filter = gst_element_factory_make ("audiofirfilter", NULL);
   fail_unless (filter != NULL);
-  g_signal_connect (G_OBJECT (filter), "rate-changed",
-      G_CALLBACK (on_rate_changed), NULL);
+  if (partition_size > 0) {
+    g_object_set (G_OBJECT (filter), "partition-size", partition_size, NULL);
+    g_signal_connect (G_OBJECT (filter), "rate-changed",
+        G_CALLBACK (on_rate_changed_long), NULL);
+  } else {
+    g_signal_connect (G_OBJECT (filter), "rate-changed",
+        G_CALLBACK (on_rate_changed), NULL);
+  }
 
   sink = gst_element_factory_make ("fakesink", NULL);
   fail_unless (sink != NULL);
   g_object_set (G_OBJECT (sink), "signal-handoffs", TRUE, NULL);
-  g_signal_connect (G_OBJECT (sink), "handoff", G_CALLBACK (on_handoff), NULL);
+  g_signal_connect (G_OBJECT (sink), "handoff",
+      partition_size > 0 ? G_CALLBACK (on_handoff_fft) :
+      G_CALLBACK (on_handoff), NULL);
 
   gst_bin_add_many (GST_BIN (pipeline), src, cfilter, filter, sink, NULL);
   fail_unless (gst_element_link_many (src, cfilter, filter, sink, NULL));
@@ -176,6 +236,18 @@ GST_START_TEST (test_pipeline)
   gst_object_unref (pipeline);
 }
 
+GST_START_TEST (test_pipeline)
+{
+  run_pipeline (0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pipeline_partitioned)
+{
+  run_pipeline (16);
+}
+
 GST_END_TEST;
 
 static Suite *
@@ -186,6 +258,7 @@ audiofirfilter_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_pipeline);
+  tcase_add_test (tc_chain, test_pipeline_partitioned);
 
   return s;
 }
@@ -24,6 +24,8 @@
  * with newer GLib versions (>= 2.31.0) */
 #define GLIB_DISABLE_DEPRECATION_WARNINGS
 
+#include <math.h>
+
 #include <gst/audio/audio.h>
 #include <gst/check/gstcheck.h>
 
@@ -56,6 +58,14 @@ static GstPad *mysrcpad, *mysinkpad;
     "channels = (int) 2, "  \
     "channel-mask = (bitmask) 3"
 
+#define LEVEL_F32_5CH_CAPS_STRING \
+  "audio/x-raw, " \
+    "format = (string) "GST_AUDIO_NE(F32)", " \
+    "layout = (string) interleaved, " \
+    "rate = (int) 1000, " \
+    "channels = (int) 5, "  \
+    "channel-mask = (bitmask) 0"
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -436,6 +446,75 @@ GST_START_TEST (test_float)
 
 GST_END_TEST;
 
+GST_START_TEST (test_float_multichannel)
+{
+  GstElement *level;
+  GstBuffer *inbuffer;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+  GstMapInfo map;
+  gint i, j;
+  const GValue *list, *value;
+  gdouble dB;
+  gfloat *data;
+  const gchar *fields[3] = { "rms", "peak", "decay" };
+  const gfloat amplitudes[5] = { 0.5, -0.25, 1.0, 0.125, -0.5 };
+
+  level = setup_level (LEVEL_F32_5CH_CAPS_STRING);
+  g_object_set (level, "post-messages", TRUE,
+      "interval", (guint64) GST_SECOND / 10, NULL);
+  gst_element_set_state (level, GST_STATE_PLAYING);
+  /* create a bus to get the level message on */
+  bus = gst_bus_new ();
+  gst_element_set_bus (level, bus);
+
+  /* create a fake 0.1 sec buffer with a different block signal per channel */
+  inbuffer = gst_buffer_new_and_alloc (5 * 100 * sizeof (gfloat));
+  gst_buffer_map (inbuffer, &map, GST_MAP_WRITE);
+  data = (gfloat *) map.data;
+  for (j = 0; j < 100; ++j) {
+    for (i = 0; i < 5; ++i)
+      *(data++) = amplitudes[i];
+  }
+  gst_buffer_unmap (inbuffer, &map);
+  GST_BUFFER_TIMESTAMP (inbuffer) = G_GUINT64_CONSTANT (0);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  message = gst_bus_poll (bus, GST_MESSAGE_ELEMENT, -1);
+  structure = gst_message_get_structure (message);
+
+  /* rms, peak and decay of a block wave are its amplitude */
+  for (i = 0; i < 5; ++i) {
+    gdouble expected = 20 * log10 (fabs (amplitudes[i]));
+
+    for (j = 0; j < 3; ++j) {
+      GValueArray *arr;
+
+      list = gst_structure_get_value (structure, fields[j]);
+      arr = g_value_get_boxed (list);
+      fail_unless_equals_int (arr->n_values, 5);
+      value = g_value_array_get_nth (arr, i);
+      dB = g_value_get_double (value);
+      GST_DEBUG ("%d: %s is %lf", i, fields[j], dB);
+      fail_if (dB < expected - 0.1);
+      fail_if (dB > expected + 0.1);
+    }
+  }
+
+  /* clean up */
+  /* flush current messages,and future state change messages */
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (level, NULL);
+  gst_object_unref (bus);
+  gst_element_set_state (level, GST_STATE_NULL);
+  cleanup_level (level);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_message_on_eos)
 {
   GstElement *level;
@@ -647,6 +726,7 @@ level_suite (void)
   tcase_add_test (tc_chain, test_int16);
   tcase_add_test (tc_chain, test_int16_panned);
   tcase_add_test (tc_chain, test_float);
+  tcase_add_test (tc_chain, test_float_multichannel);
   tcase_add_test (tc_chain, test_message_on_eos);
   tcase_add_test (tc_chain, test_message_count);
   tcase_add_test (tc_chain, test_message_timestamps);
@@ -0,0 +1,341 @@
+/* GStreamer
+ *
+ * unit test for loudness
+ *
+ * Copyright (C) 2026 GStreamer developers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+
+#include <gst/audio/audio.h>
+#include <gst/check/gstcheck.h>
+
+static GstPad *mysrcpad, *mysinkpad;
+
+#define LOUDNESS_CAPS_TEMPLATE_STRING \
+  "audio/x-raw, " \
+    "format = (string) { "GST_AUDIO_NE(S16)", "GST_AUDIO_NE(F32)" }, " \
+    "layout = (string) interleaved, " \
+    "rate = (int) [ 1, MAX ], " \
+    "channels = (int) [ 1, 8 ]"
+
+#define LOUDNESS_S16_CAPS_STRING \
+  "audio/x-raw, " \
+    "format = (string) "GST_AUDIO_NE(S16)", " \
+    "layout = (string) interleaved, " \
+    "rate = (int) 48000, " \
+    "channels = (int) 2, "  \
+    "channel-mask = (bitmask) 3"
+
+#define LOUDNESS_F32_CAPS_STRING \
+  "audio/x-raw, " \
+    "format = (string) "GST_AUDIO_NE(F32)", " \
+    "layout = (string) interleaved, " \
+    "rate = (int) 48000, " \
+    "channels = (int) 2, "  \
+    "channel-mask = (bitmask) 3"
+
+#define RATE 48000
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (LOUDNESS_CAPS_TEMPLATE_STRING)
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (LOUDNESS_CAPS_TEMPLATE_STRING)
+    );
+
+static GstElement *
+setup_loudness (const gchar * caps_str)
+{
+  GstElement *loudness;
+  GstCaps *caps;
+
+  GST_DEBUG ("setup_loudness");
+  loudness = gst_check_setup_element ("loudness");
+  mysrcpad = gst_check_setup_src_pad (loudness, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (loudness, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  caps = gst_caps_from_string (caps_str);
+  gst_check_setup_events (mysrcpad, loudness, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  return loudness;
+}
+
+static void
+cleanup_loudness (GstElement * loudness)
+{
+  GST_DEBUG ("cleanup_loudness");
+
+  gst_check_drop_buffers ();
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (loudness);
+  gst_check_teardown_sink_pad (loudness);
+  gst_check_teardown_element (loudness);
+}
+
+/* create a 0.1 sec stereo sine buffer, @offset is in frames */
+static GstBuffer *
+create_f32_sine_buffer (gdouble freq, gdouble amplitude, gdouble phase,
+    guint offset)
+{
+  GstBuffer *buf = gst_buffer_new_and_alloc (2 * RATE / 10 * sizeof (gfloat));
+  GstMapInfo map;
+  gfloat *data;
+  gint j;
+
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  data = (gfloat *) map.data;
+  for (j = 0; j < RATE / 10; ++j) {
+    gfloat v = amplitude * sin (2 * G_PI * freq * (offset + j) / RATE + phase);
+
+    *(data++) = v;
+    *(data++) = v;
+  }
+  gst_buffer_unmap (buf, &map);
+  GST_BUFFER_TIMESTAMP (buf) = gst_util_uint64_scale_int (offset, GST_SECOND,
+      RATE);
+  GST_BUFFER_DURATION (buf) = GST_SECOND / 10;
+  return buf;
+}
+
+/* pushes @seconds of sine and returns the message posted at the end */
+static GstMessage *
+push_sine (GstElement * loudness, GstBus * bus, gdouble freq,
+    gdouble amplitude, gdouble phase, guint seconds)
+{
+  guint i;
+
+  for (i = 0; i < seconds * 10; i++) {
+    GstBuffer *inbuffer =
+        create_f32_sine_buffer (freq, amplitude, phase, i * RATE / 10);
+
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+
+  return gst_bus_poll (bus, GST_MESSAGE_ELEMENT, -1);
+}
+
+static gdouble
+get_double (const GstStructure * s, const gchar * field)
+{
+  gdouble v;
+
+  fail_unless (gst_structure_get_double (s, field, &v));
+  GST_DEBUG ("%s: %f", field, v);
+  return v;
+}
+
+static gdouble
+get_true_peak (const GstStructure * s, guint channel)
+{
+  const GValue *array, *v;
+
+  array = gst_structure_get_value (s, "true-peak");
+  fail_unless (array != NULL);
+  fail_unless_equals_int (gst_value_array_get_size (array), 2);
+  v = gst_value_array_get_value (array, channel);
+  fail_unless (G_VALUE_HOLDS_DOUBLE (v));
+  GST_DEBUG ("true-peak[%u]: %f", channel, g_value_get_double (v));
+  return g_value_get_double (v);
+}
+
+/* tests */
+
+GST_START_TEST (test_message_is_valid)
+{
+  GstElement *loudness;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+  GstClockTime ts, duration;
+
+  loudness = setup_loudness (LOUDNESS_F32_CAPS_STRING);
+  g_object_set (loudness, "interval", (guint64) GST_SECOND / 10, NULL);
+  gst_element_set_state (loudness, GST_STATE_PLAYING);
+  bus = gst_bus_new ();
+  gst_element_set_bus (loudness, bus);
+
+  message = push_sine (loudness, bus, 997.0, 0.1, 0.0, 1);
+  fail_unless (message != NULL);
+  fail_unless (GST_MESSAGE_SRC (message) == GST_OBJECT (loudness));
+  structure = gst_message_get_structure (message);
+  fail_if (structure == NULL);
+  fail_unless_equals_string (gst_structure_get_name (structure), "loudness");
+  fail_unless (gst_structure_get_clock_time (structure, "timestamp", &ts));
+  fail_unless (gst_structure_get_clock_time (structure, "duration", &duration));
+  fail_unless_equals_uint64 (ts, 0);
+  fail_unless_equals_uint64 (duration, GST_SECOND / 10);
+  fail_unless (gst_structure_has_field_typed (structure, "momentary",
+          G_TYPE_DOUBLE));
+  fail_unless (gst_structure_has_field_typed (structure, "short-term",
+          G_TYPE_DOUBLE));
+  fail_unless (gst_structure_has_field_typed (structure, "integrated",
+          G_TYPE_DOUBLE));
+  fail_unless (gst_structure_has_field_typed (structure, "loudness-range",
+          G_TYPE_DOUBLE));
+  get_true_peak (structure, 0);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (loudness, NULL);
+  gst_object_unref (bus);
+  gst_element_set_state (loudness, GST_STATE_NULL);
+  cleanup_loudness (loudness);
+}
+
+GST_END_TEST;
+
+/* EBU Tech 3341 test case 1: a 1kHz sine at -23 dBFS on both channels of a
+ * stereo signal has a loudness of -23 LUFS */
+GST_START_TEST (test_sine_loudness)
+{
+  GstElement *loudness;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+
+  loudness = setup_loudness (LOUDNESS_F32_CAPS_STRING);
+  g_object_set (loudness, "interval", (guint64) 5 * GST_SECOND, NULL);
+  gst_element_set_state (loudness, GST_STATE_PLAYING);
+  bus = gst_bus_new ();
+  gst_element_set_bus (loudness, bus);
+
+  message = push_sine (loudness, bus, 1000.0, pow (10, -23.0 / 20), 0.0, 5);
+  fail_unless (message != NULL);
+  structure = gst_message_get_structure (message);
+
+  fail_unless (fabs (get_double (structure, "momentary") + 23.0) < 0.1);
+  fail_unless (fabs (get_double (structure, "short-term") + 23.0) < 0.1);
+  fail_unless (fabs (get_double (structure, "integrated") + 23.0) < 0.1);
+  fail_unless (get_double (structure, "loudness-range") < 0.5);
+  fail_unless (fabs (get_true_peak (structure, 0) + 23.0) < 0.2);
+  fail_unless (fabs (get_true_peak (structure, 1) + 23.0) < 0.2);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (loudness, NULL);
+  gst_object_unref (bus);
+  gst_element_set_state (loudness, GST_STATE_NULL);
+  cleanup_loudness (loudness);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_silence)
+{
+  GstElement *loudness;
+  GstBuffer *inbuffer;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+
+  loudness = setup_loudness (LOUDNESS_S16_CAPS_STRING);
+  g_object_set (loudness, "interval", (guint64) GST_SECOND / 10, NULL);
+  gst_element_set_state (loudness, GST_STATE_PLAYING);
+  bus = gst_bus_new ();
+  gst_element_set_bus (loudness, bus);
+
+  inbuffer = gst_buffer_new_and_alloc (2 * RATE / 10 * sizeof (gint16));
+  gst_buffer_memset (inbuffer, 0, 0, 2 * RATE / 10 * sizeof (gint16));
+  GST_BUFFER_TIMESTAMP (inbuffer) = 0;
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  message = gst_bus_poll (bus, GST_MESSAGE_ELEMENT, -1);
+  fail_unless (message != NULL);
+  structure = gst_message_get_structure (message);
+
+  fail_unless (isinf (get_double (structure, "momentary")));
+  fail_unless (isinf (get_double (structure, "integrated")));
+  fail_unless (get_double (structure, "loudness-range") == 0.0);
+  fail_unless (isinf (get_true_peak (structure, 0)));
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_message_unref (message);
+  gst_element_set_bus (loudness, NULL);
+  gst_object_unref (bus);
+  gst_element_set_state (loudness, GST_STATE_NULL);
+  cleanup_loudness (loudness);
+}
+
+GST_END_TEST;
+
+/* a sine at a quarter of the sample rate with a phase of 45 degrees never
+ * hits its peak on a sample, which are all at 1/sqrt(2) of the amplitude */
+GST_START_TEST (test_true_peak)
+{
+  GstElement *loudness;
+  GstBus *bus;
+  GstMessage *message;
+  const GstStructure *structure;
+  gboolean true_peak;
+
+  for (true_peak = FALSE; true_peak <= TRUE; true_peak++) {
+    gdouble peak;
+
+    loudness = setup_loudness (LOUDNESS_F32_CAPS_STRING);
+    g_object_set (loudness, "interval", (guint64) GST_SECOND,
+        "true-peak", true_peak, NULL);
+    gst_element_set_state (loudness, GST_STATE_PLAYING);
+    bus = gst_bus_new ();
+    gst_element_set_bus (loudness, bus);
+
+    message = push_sine (loudness, bus, RATE / 4, 0.5, G_PI / 4, 1);
+    fail_unless (message != NULL);
+    structure = gst_message_get_structure (message);
+
+    peak = get_true_peak (structure, 0);
+    if (true_peak)
+      fail_unless (fabs (peak - 20 * log10 (0.5)) < 0.2);
+    else
+      fail_unless (fabs (peak - 20 * log10 (0.5 * G_SQRT2 / 2)) < 0.01);
+
+    gst_bus_set_flushing (bus, TRUE);
+    gst_message_unref (message);
+    gst_element_set_bus (loudness, NULL);
+    gst_object_unref (bus);
+    gst_element_set_state (loudness, GST_STATE_NULL);
+    cleanup_loudness (loudness);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+loudness_suite (void)
+{
+  Suite *s = suite_create ("loudness");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_message_is_valid);
+  tcase_add_test (tc_chain, test_sine_loudness);
+  tcase_add_test (tc_chain, test_silence);
+  tcase_add_test (tc_chain, test_true_peak);
+
+  return s;
+}
+
+GST_CHECK_MAIN (loudness);
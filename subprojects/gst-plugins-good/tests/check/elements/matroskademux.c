@@ -17,6 +17,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
 
@@ -484,6 +485,89 @@ GST_START_TEST (test_segment_looping_middle_segment_with_rate)
 
 GST_END_TEST;
 
+static void
+seek_and_check_position (GstElement * pipeline, GstElement * sink,
+    GstClockTime position)
+{
+  GstSample *sample;
+  GstBuffer *buf;
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  g_object_get (sink, "last-sample", &sample, NULL);
+  fail_unless (sample != NULL);
+  buf = gst_sample_get_buffer (sample);
+  GST_DEBUG ("seek to %" GST_TIME_FORMAT " prerolled %" GST_PTR_FORMAT,
+      GST_TIME_ARGS (position), buf);
+  fail_unless (GST_BUFFER_PTS (buf) <= position);
+  fail_unless (GST_BUFFER_PTS (buf) + GST_BUFFER_DURATION (buf) > position);
+  gst_sample_unref (sample);
+}
+
+/* Files without Cues are seeked in by bisecting over the clusters, make sure
+ * repeated seeks, which can use the clusters found before, end up at the
+ * right place */
+GST_START_TEST (test_seek_without_cues)
+{
+  GstElement *pipeline, *src, *demux, *sink;
+  GstMessage *msg;
+  GError *err = NULL;
+  gchar *location, *launch;
+  gint fd;
+
+  fd = g_file_open_tmp ("matroskademux-XXXXXX.mkv", &location, &err);
+  fail_unless (fd >= 0, "%s", err ? err->message : "");
+  g_close (fd, NULL);
+
+  /* 20 seconds in 100ms buffers, one cluster per second and no Cues */
+  launch = g_strdup_printf ("audiotestsrc num-buffers=200 "
+      "samplesperbuffer=4410 ! audio/x-raw,format=S16LE,rate=44100,channels=1 "
+      "! matroskamux streamable=true min-cluster-duration=1000000000 "
+      "! filesink location=\"%s\"", location);
+  pipeline = gst_parse_launch (launch, &err);
+  g_free (launch);
+  fail_unless (pipeline != NULL, "%s", err ? err->message : "");
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  pipeline = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("matroskademux", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, demux, sink, NULL);
+  fail_unless (gst_element_link (src, demux));
+  g_signal_connect (demux, "pad-added", G_CALLBACK (demux_pad_added_cb), sink);
+  g_object_set (src, "location", location, NULL);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PAUSED) !=
+      GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  seek_and_check_position (pipeline, sink, 7350 * GST_MSECOND);
+  seek_and_check_position (pipeline, sink, 15050 * GST_MSECOND);
+  seek_and_check_position (pipeline, sink, 7350 * GST_MSECOND);
+  seek_and_check_position (pipeline, sink, 3 * GST_SECOND);
+  seek_and_check_position (pipeline, sink, 15550 * GST_MSECOND);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
 static Suite *
 matroskademux_suite (void)
 {
@@ -496,6 +580,7 @@ matroskademux_suite (void)
   tcase_add_test (tc_chain, test_segment_looping);
   tcase_add_test (tc_chain, test_segment_looping_middle_segment);
   tcase_add_test (tc_chain, test_segment_looping_middle_segment_with_rate);
+  tcase_add_test (tc_chain, test_seek_without_cues);
 
   return s;
 }
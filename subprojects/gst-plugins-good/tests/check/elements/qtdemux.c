@@ -29,6 +29,7 @@
 #include <gio/gio.h>
 
 #include <gst/check/check.h>
+#include <gst/base/base.h>
 #include <gst/app/app.h>
 #include <gst/audio/audio.h>
 
@@ -1618,6 +1619,931 @@ GST_START_TEST (test_qtdemux_gapless_nero_data_without_itunsmpb)
 
 GST_END_TEST;
 
+/* Seek straight to frames whose sample table entries have not been parsed
+ * yet, the demuxer only parses the sample table up to the seek position */
+GST_START_TEST (test_qtdemux_seek_unparsed_samples)
+{
+  GaplessTestInfo info;
+  GstElement *source, *demux, *pipeline;
+  GstStateChangeReturn state_ret;
+  GstClockTime position;
+  gchar *full_filename;
+
+  setup_gapless_itunes_test_info (&info);
+
+  pipeline = gst_pipeline_new (NULL);
+  source = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("qtdemux", NULL);
+  info.appsink = gst_element_factory_make ("appsink", NULL);
+
+  g_signal_connect (demux, "pad-added", (GCallback)
+      qtdemux_pad_added_cb_for_gapless, &info);
+
+  gst_bin_add_many (GST_BIN (pipeline), source, demux, info.appsink, NULL);
+  gst_element_link (source, demux);
+
+  full_filename = g_build_filename (GST_TEST_FILES_PATH, info.filename, NULL);
+  g_object_set (G_OBJECT (source), "location", full_filename, NULL);
+  g_free (full_filename);
+
+  g_object_set (G_OBJECT (info.appsink), "sync", FALSE, NULL);
+
+  /* only preroll, so that just the first samples are parsed */
+  state_ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  fail_unless (state_ret != GST_STATE_CHANGE_FAILURE);
+  state_ret = gst_element_get_state (pipeline, NULL, NULL, -1);
+  fail_unless_equals_int (state_ret, GST_STATE_CHANGE_SUCCESS);
+
+  /* the last frame with valid samples */
+  position =
+      gst_util_uint64_scale_int (info.num_samples_in_first_valid_frame +
+      info.num_samples_without_padding - info.num_samples_per_frame,
+      GST_SECOND, info.sample_rate);
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  switch_state_with_async_wait (pipeline, GST_STATE_PLAYING);
+
+  check_parsed_aac_frame (&info, info.last_frame_with_valid_samples);
+
+  /* and back into the part of the sample table that is parsed now */
+  switch_state_with_async_wait (pipeline, GST_STATE_PAUSED);
+  position =
+      gst_util_uint64_scale_int (info.num_samples_in_first_valid_frame +
+      info.num_samples_per_frame * 99, GST_SECOND, info.sample_rate);
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  switch_state_with_async_wait (pipeline, GST_STATE_PLAYING);
+
+  check_parsed_aac_frame (&info, info.first_frame_with_valid_samples + 100);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* Minimal MOV files with hand-written sample tables */
+typedef struct
+{
+  guint32 handler;
+  guint32 timescale;
+  guint32 n_samples;
+  guint32 sample_duration;
+  /* a fixed sample size, or 0 to take them from sizes */
+  guint32 sample_size;
+  const guint32 *sizes;
+  guint32 samples_per_chunk;
+  guint32 n_chunks;
+  const guint64 *chunk_offsets;
+  /* the sample entry without its size */
+  const guint8 *stsd_entry;
+  guint stsd_entry_size;
+  /* if non-zero, the stsc is corrupt from this chunk on */
+  guint32 corrupt_chunk;
+} TestMovTrack;
+
+static guint
+put_box_start (GstByteWriter * bw, guint32 fourcc)
+{
+  guint pos = gst_byte_writer_get_pos (bw);
+
+  gst_byte_writer_put_uint32_be (bw, 0);
+  gst_byte_writer_put_uint32_le (bw, fourcc);
+
+  return pos;
+}
+
+static void
+put_box_end (GstByteWriter * bw, guint pos)
+{
+  guint end = gst_byte_writer_get_pos (bw);
+
+  gst_byte_writer_set_pos (bw, pos);
+  gst_byte_writer_put_uint32_be (bw, end - pos);
+  gst_byte_writer_set_pos (bw, end);
+}
+
+static void
+put_matrix (GstByteWriter * bw)
+{
+  gst_byte_writer_put_uint32_be (bw, 0x00010000);
+  gst_byte_writer_fill (bw, 0, 12);
+  gst_byte_writer_put_uint32_be (bw, 0x00010000);
+  gst_byte_writer_fill (bw, 0, 12);
+  gst_byte_writer_put_uint32_be (bw, 0x40000000);
+}
+
+static void
+put_ftyp (GstByteWriter * bw)
+{
+  guint box = put_box_start (bw, GST_MAKE_FOURCC ('f', 't', 'y', 'p'));
+
+  gst_byte_writer_put_uint32_le (bw, GST_MAKE_FOURCC ('q', 't', ' ', ' '));
+  gst_byte_writer_put_uint32_be (bw, 0x200);
+  gst_byte_writer_put_uint32_le (bw, GST_MAKE_FOURCC ('q', 't', ' ', ' '));
+  put_box_end (bw, box);
+}
+
+/* durations are in milliseconds in the mvhd and tkhd */
+static void
+put_trak (GstByteWriter * bw, guint32 track_id, const TestMovTrack * track)
+{
+  guint64 duration = (guint64) track->n_samples * track->sample_duration;
+  guint trak, mdia, minf, dinf, stbl, box;
+  guint i;
+
+  trak = put_box_start (bw, GST_MAKE_FOURCC ('t', 'r', 'a', 'k'));
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('t', 'k', 'h', 'd'));
+  gst_byte_writer_put_uint32_be (bw, 0x7);
+  gst_byte_writer_fill (bw, 0, 4 + 4);
+  gst_byte_writer_put_uint32_be (bw, track_id);
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw,
+      gst_util_uint64_scale (duration, 1000, track->timescale));
+  gst_byte_writer_fill (bw, 0, 8 + 2 + 2);
+  gst_byte_writer_put_uint16_be (bw,
+      track->handler == GST_MAKE_FOURCC ('s', 'o', 'u', 'n') ? 0x0100 : 0);
+  gst_byte_writer_fill (bw, 0, 2);
+  put_matrix (bw);
+  gst_byte_writer_fill (bw, 0, 4 + 4);
+  put_box_end (bw, box);
+
+  mdia = put_box_start (bw, GST_MAKE_FOURCC ('m', 'd', 'i', 'a'));
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('m', 'd', 'h', 'd'));
+  gst_byte_writer_fill (bw, 0, 4 + 4 + 4);
+  gst_byte_writer_put_uint32_be (bw, track->timescale);
+  gst_byte_writer_put_uint32_be (bw, duration);
+  gst_byte_writer_fill (bw, 0, 2 + 2);
+  put_box_end (bw, box);
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('h', 'd', 'l', 'r'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_le (bw, GST_MAKE_FOURCC ('m', 'h', 'l', 'r'));
+  gst_byte_writer_put_uint32_le (bw, track->handler);
+  gst_byte_writer_fill (bw, 0, 4 + 4 + 4 + 1);
+  put_box_end (bw, box);
+
+  minf = put_box_start (bw, GST_MAKE_FOURCC ('m', 'i', 'n', 'f'));
+
+  if (track->handler == GST_MAKE_FOURCC ('s', 'o', 'u', 'n')) {
+    box = put_box_start (bw, GST_MAKE_FOURCC ('s', 'm', 'h', 'd'));
+    gst_byte_writer_fill (bw, 0, 4 + 2 + 2);
+  } else {
+    box = put_box_start (bw, GST_MAKE_FOURCC ('v', 'm', 'h', 'd'));
+    gst_byte_writer_put_uint32_be (bw, 1);
+    gst_byte_writer_fill (bw, 0, 2 + 3 * 2);
+  }
+  put_box_end (bw, box);
+
+  dinf = put_box_start (bw, GST_MAKE_FOURCC ('d', 'i', 'n', 'f'));
+  box = put_box_start (bw, GST_MAKE_FOURCC ('d', 'r', 'e', 'f'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, 1);
+  gst_byte_writer_put_uint32_be (bw, 12);
+  gst_byte_writer_put_uint32_le (bw, GST_MAKE_FOURCC ('a', 'l', 'i', 's'));
+  gst_byte_writer_put_uint32_be (bw, 1);
+  put_box_end (bw, box);
+  put_box_end (bw, dinf);
+
+  stbl = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 'b', 'l'));
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 's', 'd'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, 1);
+  gst_byte_writer_put_uint32_be (bw, 4 + track->stsd_entry_size);
+  gst_byte_writer_put_data (bw, track->stsd_entry, track->stsd_entry_size);
+  put_box_end (bw, box);
+
+  /* a single entry for all samples */
+  box = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 't', 's'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, 1);
+  gst_byte_writer_put_uint32_be (bw, track->n_samples);
+  gst_byte_writer_put_uint32_be (bw, track->sample_duration);
+  put_box_end (bw, box);
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 's', 'c'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, track->corrupt_chunk ? 3 : 1);
+  gst_byte_writer_put_uint32_be (bw, 1);
+  gst_byte_writer_put_uint32_be (bw, track->samples_per_chunk);
+  gst_byte_writer_put_uint32_be (bw, 1);
+  if (track->corrupt_chunk) {
+    /* chunk numbers start at 1, the entry after the corrupt chunk has 0 */
+    gst_byte_writer_put_uint32_be (bw, track->corrupt_chunk + 1);
+    gst_byte_writer_put_uint32_be (bw, track->samples_per_chunk);
+    gst_byte_writer_put_uint32_be (bw, 1);
+    gst_byte_writer_put_uint32_be (bw, 0);
+    gst_byte_writer_put_uint32_be (bw, track->samples_per_chunk);
+    gst_byte_writer_put_uint32_be (bw, 1);
+  }
+  put_box_end (bw, box);
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 's', 'z'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, track->sample_size);
+  gst_byte_writer_put_uint32_be (bw, track->n_samples);
+  if (track->sample_size == 0) {
+    for (i = 0; i < track->n_samples; i++)
+      gst_byte_writer_put_uint32_be (bw, track->sizes[i]);
+  }
+  put_box_end (bw, box);
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('s', 't', 'c', 'o'));
+  gst_byte_writer_fill (bw, 0, 4);
+  gst_byte_writer_put_uint32_be (bw, track->n_chunks);
+  for (i = 0; i < track->n_chunks; i++)
+    gst_byte_writer_put_uint32_be (bw, track->chunk_offsets[i]);
+  put_box_end (bw, box);
+
+  put_box_end (bw, stbl);
+  put_box_end (bw, minf);
+  put_box_end (bw, mdia);
+  put_box_end (bw, trak);
+}
+
+/* If @fragmented_duration is non-zero, the moov has a mvex with that total
+ * duration in milliseconds and defaults for the fragments of all tracks */
+static void
+put_moov (GstByteWriter * bw, const TestMovTrack * tracks, guint n_tracks,
+    guint32 fragmented_duration)
+{
+  guint64 duration = 0;
+  guint moov, box;
+  guint i;
+
+  for (i = 0; i < n_tracks; i++) {
+    duration = MAX (duration,
+        gst_util_uint64_scale ((guint64) tracks[i].n_samples *
+            tracks[i].sample_duration, 1000, tracks[i].timescale));
+  }
+
+  moov = put_box_start (bw, GST_MAKE_FOURCC ('m', 'o', 'o', 'v'));
+
+  box = put_box_start (bw, GST_MAKE_FOURCC ('m', 'v', 'h', 'd'));
+  gst_byte_writer_fill (bw, 0, 4 + 4 + 4);
+  gst_byte_writer_put_uint32_be (bw, 1000);
+  gst_byte_writer_put_uint32_be (bw, duration);
+  gst_byte_writer_put_uint32_be (bw, 0x00010000);
+  gst_byte_writer_put_uint16_be (bw, 0x0100);
+  gst_byte_writer_fill (bw, 0, 10);
+  put_matrix (bw);
+  gst_byte_writer_fill (bw, 0, 24);
+  gst_byte_writer_put_uint32_be (bw, n_tracks + 1);
+  put_box_end (bw, box);
+
+  for (i = 0; i < n_tracks; i++)
+    put_trak (bw, i + 1, &tracks[i]);
+
+  if (fragmented_duration) {
+    guint mvex = put_box_start (bw, GST_MAKE_FOURCC ('m', 'v', 'e', 'x'));
+
+    box = put_box_start (bw, GST_MAKE_FOURCC ('m', 'e', 'h', 'd'));
+    gst_byte_writer_fill (bw, 0, 4);
+    gst_byte_writer_put_uint32_be (bw, fragmented_duration);
+    put_box_end (bw, box);
+
+    /* sample description 1, no default size and keyframes */
+    for (i = 0; i < n_tracks; i++) {
+      box = put_box_start (bw, GST_MAKE_FOURCC ('t', 'r', 'e', 'x'));
+      gst_byte_writer_fill (bw, 0, 4);
+      gst_byte_writer_put_uint32_be (bw, i + 1);
+      gst_byte_writer_put_uint32_be (bw, 1);
+      gst_byte_writer_put_uint32_be (bw, tracks[i].sample_duration);
+      gst_byte_writer_fill (bw, 0, 4 + 4);
+      put_box_end (bw, box);
+    }
+    put_box_end (bw, mvex);
+  }
+
+  put_box_end (bw, moov);
+}
+
+/* A MOV with raw PCM audio that is sampled (compression ID -2) and has a fixed
+ * sample size, so that the demuxer merges every chunk into a single sample */
+#define MERGED_PCM_RATE 8000
+#define MERGED_PCM_SAMPLES_PER_CHUNK 1024
+#define MERGED_PCM_N_CHUNKS 50
+#define MERGED_PCM_MDAT_OFFSET (20 + 8)
+
+/* sound sample description v1, mono S16LE */
+static const guint8 merged_pcm_stsd_entry[] = {
+  's', 'o', 'w', 't', 0, 0, 0, 0, 0, 0, 0x00, 0x01,
+  0x00, 0x01, 0x00, 0x00, 0, 0, 0, 0,
+  0x00, 0x01, 0x00, 0x10, 0xff, 0xfe, 0x00, 0x00, 0x1f, 0x40, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+  0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02
+};
+
+/* Every 16 bit sample of a chunk holds the number of the chunk */
+static guint8 *
+create_merged_pcm_mov (gsize * size)
+{
+  guint64 chunk_offsets[MERGED_PCM_N_CHUNKS];
+  TestMovTrack track = {
+    GST_MAKE_FOURCC ('s', 'o', 'u', 'n'), MERGED_PCM_RATE,
+    MERGED_PCM_SAMPLES_PER_CHUNK * MERGED_PCM_N_CHUNKS, 1, 2, NULL,
+    MERGED_PCM_SAMPLES_PER_CHUNK, MERGED_PCM_N_CHUNKS, chunk_offsets,
+    merged_pcm_stsd_entry, sizeof (merged_pcm_stsd_entry), 0
+  };
+  GstByteWriter bw;
+  guint box;
+  guint i, j;
+
+  for (i = 0; i < MERGED_PCM_N_CHUNKS; i++) {
+    chunk_offsets[i] =
+        MERGED_PCM_MDAT_OFFSET + i * MERGED_PCM_SAMPLES_PER_CHUNK * 2;
+  }
+
+  gst_byte_writer_init (&bw);
+
+  put_ftyp (&bw);
+
+  box = put_box_start (&bw, GST_MAKE_FOURCC ('m', 'd', 'a', 't'));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&bw),
+      MERGED_PCM_MDAT_OFFSET);
+  for (i = 0; i < MERGED_PCM_N_CHUNKS; i++) {
+    for (j = 0; j < MERGED_PCM_SAMPLES_PER_CHUNK; j++)
+      gst_byte_writer_put_uint16_le (&bw, i);
+  }
+  put_box_end (&bw, box);
+
+  put_moov (&bw, &track, 1, 0);
+
+  *size = gst_byte_writer_get_size (&bw);
+  return gst_byte_writer_reset_and_get_data (&bw);
+}
+
+static gchar *
+write_temp_mov (const guint8 * data, gsize size)
+{
+  gchar *filename;
+  gint fd;
+
+  fd = g_file_open_tmp ("qtdemux-test-XXXXXX.mov", &filename, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (filename, (const gchar *) data, size,
+          NULL));
+
+  return filename;
+}
+
+static void
+qtdemux_pad_added_cb_link_sink (GstElement * demux, GstPad * pad,
+    GstElement * sink)
+{
+  GstPad *sinkpad = gst_element_get_static_pad (sink, "sink");
+
+  if (!gst_pad_is_linked (sinkpad))
+    fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (pad, sinkpad)));
+  gst_object_unref (sinkpad);
+}
+
+/* Pulls the first buffer after a seek to @position and checks that it is from
+ * the chunk that contains @position */
+static void
+check_merged_pcm_seek (GstElement * pipeline, GstElement * appsink,
+    GstClockTime position)
+{
+  guint chunk = gst_util_uint64_scale (position, MERGED_PCM_RATE,
+      GST_SECOND * MERGED_PCM_SAMPLES_PER_CHUNK);
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  switch_state_with_async_wait (pipeline, GST_STATE_PLAYING);
+
+  sample = gst_app_sink_pull_sample (GST_APP_SINK (appsink));
+  fail_unless (sample != NULL);
+  buffer = gst_sample_get_buffer (sample);
+
+  /* the buffer is clipped to the seek position */
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), position);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless (map.size >= 2);
+  fail_unless_equals_int (GST_READ_UINT16_LE (map.data), chunk);
+  gst_buffer_unmap (buffer, &map);
+
+  gst_sample_unref (sample);
+}
+
+/* The merged PCM stream has a sample table that is generated by the demuxer,
+ * seeking into its unparsed part has to land in the right chunk too */
+GST_START_TEST (test_qtdemux_seek_unparsed_merged_pcm)
+{
+  GstElement *source, *demux, *appsink, *pipeline;
+  GstStateChangeReturn state_ret;
+  gchar *filename;
+  guint8 *data;
+  gsize size;
+
+  data = create_merged_pcm_mov (&size);
+  filename = write_temp_mov (data, size);
+  g_free (data);
+
+  pipeline = gst_pipeline_new (NULL);
+  source = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("qtdemux", NULL);
+  appsink = gst_element_factory_make ("appsink", NULL);
+
+  g_signal_connect (demux, "pad-added", (GCallback)
+      qtdemux_pad_added_cb_link_sink, appsink);
+
+  gst_bin_add_many (GST_BIN (pipeline), source, demux, appsink, NULL);
+  gst_element_link (source, demux);
+
+  g_object_set (source, "location", filename, NULL);
+  g_object_set (appsink, "sync", FALSE, NULL);
+
+  /* only preroll, so that just the first samples are parsed */
+  state_ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  fail_unless (state_ret != GST_STATE_CHANGE_FAILURE);
+  state_ret = gst_element_get_state (pipeline, NULL, NULL, -1);
+  fail_unless_equals_int (state_ret, GST_STATE_CHANGE_SUCCESS);
+
+  /* start of chunk 30, then the middle of chunk 40 */
+  check_merged_pcm_seek (pipeline, appsink,
+      gst_util_uint64_scale (30 * MERGED_PCM_SAMPLES_PER_CHUNK, GST_SECOND,
+          MERGED_PCM_RATE));
+  check_merged_pcm_seek (pipeline, appsink,
+      gst_util_uint64_scale (40 * MERGED_PCM_SAMPLES_PER_CHUNK +
+          MERGED_PCM_SAMPLES_PER_CHUNK / 2, GST_SECOND, MERGED_PCM_RATE));
+
+  /* and back into the part of the sample table that is parsed now */
+  check_merged_pcm_seek (pipeline, appsink,
+      gst_util_uint64_scale (10 * MERGED_PCM_SAMPLES_PER_CHUNK, GST_SECOND,
+          MERGED_PCM_RATE));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+/* An interleaved MOV with one video and one audio sample of 40ms per chunk
+ * and different sample sizes, with the moov in front of the mdat */
+#define INTERLEAVED_N_SAMPLES 200
+#define INTERLEAVED_CORRUPT_CHUNK 100
+
+typedef struct
+{
+  guint8 *data;
+  gsize size;
+  /* video and audio */
+  guint64 offsets[2][INTERLEAVED_N_SAMPLES];
+  guint32 sizes[2][INTERLEAVED_N_SAMPLES];
+} InterleavedMov;
+
+static const guint8 interleaved_video_stsd_entry[] = {
+  'j', 'p', 'e', 'g', 0, 0, 0, 0, 0, 0, 0x00, 0x01,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0x00, 0x10, 0x00, 0x10, 0x00, 0x48, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00,
+  0, 0, 0, 0, 0x00, 0x01,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0x00, 0x18, 0xff, 0xff
+};
+
+static const guint8 interleaved_audio_stsd_entry[] = {
+  's', 'a', 'm', 'r', 0, 0, 0, 0, 0, 0, 0x00, 0x01,
+  0x00, 0x00, 0x00, 0x00, 0, 0, 0, 0,
+  0x00, 0x01, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x40, 0x00, 0x00
+};
+
+/* Every byte of the mdat depends on its offset in the file */
+static void
+create_interleaved_mov (InterleavedMov * mov, gboolean corrupt)
+{
+  TestMovTrack tracks[2] = {
+    {GST_MAKE_FOURCC ('v', 'i', 'd', 'e'), 1000, INTERLEAVED_N_SAMPLES, 40,
+          0, mov->sizes[0], 1, INTERLEAVED_N_SAMPLES, mov->offsets[0],
+          interleaved_video_stsd_entry, sizeof (interleaved_video_stsd_entry),
+        0},
+    {GST_MAKE_FOURCC ('s', 'o', 'u', 'n'), 8000, INTERLEAVED_N_SAMPLES, 320,
+          0, mov->sizes[1], 1, INTERLEAVED_N_SAMPLES, mov->offsets[1],
+          interleaved_audio_stsd_entry, sizeof (interleaved_audio_stsd_entry),
+        corrupt ? INTERLEAVED_CORRUPT_CHUNK : 0}
+  };
+  GstByteWriter bw;
+  guint64 offset;
+  guint mdat, i;
+
+  for (i = 0; i < INTERLEAVED_N_SAMPLES; i++) {
+    mov->sizes[0][i] = 1000 + (i * 337) % 3000;
+    mov->sizes[1][i] = 100 + (i * 53) % 200;
+  }
+
+  /* the size of the moov doesn't depend on the chunk offsets */
+  gst_byte_writer_init (&bw);
+  put_ftyp (&bw);
+  put_moov (&bw, tracks, 2, 0);
+  offset = gst_byte_writer_get_pos (&bw) + 8;
+  gst_byte_writer_reset (&bw);
+
+  for (i = 0; i < INTERLEAVED_N_SAMPLES; i++) {
+    mov->offsets[0][i] = offset;
+    offset += mov->sizes[0][i];
+    mov->offsets[1][i] = offset;
+    offset += mov->sizes[1][i];
+  }
+
+  gst_byte_writer_init (&bw);
+  put_ftyp (&bw);
+  put_moov (&bw, tracks, 2, 0);
+  mdat = put_box_start (&bw, GST_MAKE_FOURCC ('m', 'd', 'a', 't'));
+  fail_unless_equals_uint64 (gst_byte_writer_get_pos (&bw),
+      mov->offsets[0][0]);
+  while (gst_byte_writer_get_pos (&bw) < offset) {
+    guint pos = gst_byte_writer_get_pos (&bw);
+
+    gst_byte_writer_put_uint8 (&bw, (pos * 7) ^ (pos >> 8));
+  }
+  put_box_end (&bw, mdat);
+
+  mov->size = gst_byte_writer_get_size (&bw);
+  mov->data = gst_byte_writer_reset_and_get_data (&bw);
+}
+
+typedef struct
+{
+  GstElement *video_sink;
+  GstElement *audio_sink;
+} InterleavedSinks;
+
+static void
+qtdemux_pad_added_cb_interleaved (GstElement * demux, GstPad * pad,
+    InterleavedSinks * sinks)
+{
+  if (g_str_has_prefix (GST_PAD_NAME (pad), "video_"))
+    qtdemux_pad_added_cb_link_sink (demux, pad, sinks->video_sink);
+  else
+    qtdemux_pad_added_cb_link_sink (demux, pad, sinks->audio_sink);
+}
+
+static GstElement *
+create_interleaved_pipeline (const gchar * filename, InterleavedSinks * sinks)
+{
+  GstElement *source, *demux, *pipeline;
+
+  pipeline = gst_pipeline_new (NULL);
+  source = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("qtdemux", NULL);
+  sinks->video_sink = gst_element_factory_make ("appsink", NULL);
+  sinks->audio_sink = gst_element_factory_make ("appsink", NULL);
+
+  g_signal_connect (demux, "pad-added", (GCallback)
+      qtdemux_pad_added_cb_interleaved, sinks);
+
+  gst_bin_add_many (GST_BIN (pipeline), source, demux, sinks->video_sink,
+      sinks->audio_sink, NULL);
+  gst_element_link (source, demux);
+
+  g_object_set (source, "location", filename, NULL);
+  g_object_set (sinks->video_sink, "sync", FALSE, NULL);
+  g_object_set (sinks->audio_sink, "sync", FALSE, NULL);
+
+  return pipeline;
+}
+
+static GstMessageType
+wait_for_eos_or_error (GstElement * pipeline)
+{
+  GstMessage *msg;
+  GstMessageType type;
+
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  type = GST_MESSAGE_TYPE (msg);
+  gst_message_unref (msg);
+
+  return type;
+}
+
+/* Pulls all queued samples of @track and checks that they are the samples of
+ * the file starting with @first, as if each was pulled on its own.
+ *
+ * Returns the number of samples */
+static guint
+check_interleaved_samples (InterleavedMov * mov, GstElement * appsink,
+    guint track, guint first)
+{
+  GstSample *sample;
+  guint n = 0;
+
+  while ((sample = gst_app_sink_try_pull_sample (GST_APP_SINK (appsink), 0))) {
+    GstBuffer *buffer = gst_sample_get_buffer (sample);
+    guint index = first + n;
+
+    fail_unless (index < INTERLEAVED_N_SAMPLES);
+    fail_unless_equals_uint64 (GST_BUFFER_DTS (buffer),
+        index * 40 * GST_MSECOND);
+    fail_unless_equals_int (gst_buffer_get_size (buffer),
+        mov->sizes[track][index]);
+    fail_unless (gst_buffer_memcmp (buffer, 0,
+            mov->data + mov->offsets[track][index],
+            mov->sizes[track][index]) == 0, "track %u sample %u differs",
+        track, index);
+
+    gst_sample_unref (sample);
+    n++;
+  }
+
+  return n;
+}
+
+GST_START_TEST (test_qtdemux_pull_interleaved)
+{
+  InterleavedSinks sinks;
+  InterleavedMov mov;
+  GstElement *pipeline;
+  GstStateChangeReturn state_ret;
+  GstClockTime position;
+  gchar *filename;
+
+  create_interleaved_mov (&mov, FALSE);
+  filename = write_temp_mov (mov.data, mov.size);
+  pipeline = create_interleaved_pipeline (filename, &sinks);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_eos_or_error (pipeline), GST_MESSAGE_EOS);
+
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.video_sink,
+          0, 0), INTERLEAVED_N_SAMPLES);
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.audio_sink,
+          1, 0), INTERLEAVED_N_SAMPLES);
+
+  /* and again from the middle of the file */
+  state_ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  fail_unless (state_ret != GST_STATE_CHANGE_FAILURE);
+  state_ret = gst_element_get_state (pipeline, NULL, NULL, -1);
+  fail_unless_equals_int (state_ret, GST_STATE_CHANGE_SUCCESS);
+
+  position = 150 * 40 * GST_MSECOND;
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_eos_or_error (pipeline), GST_MESSAGE_EOS);
+
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.video_sink,
+          0, 150), INTERLEAVED_N_SAMPLES - 150);
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.audio_sink,
+          1, 150), INTERLEAVED_N_SAMPLES - 150);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_unlink (filename);
+  g_free (filename);
+
+  /* a truncated file ends in the middle of video sample 120, the readahead
+   * doesn't fit anymore but all complete samples before it still do */
+  filename = write_temp_mov (mov.data,
+      mov.offsets[0][120] + mov.sizes[0][120] / 2);
+  pipeline = create_interleaved_pipeline (filename, &sinks);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_eos_or_error (pipeline), GST_MESSAGE_EOS);
+
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.video_sink,
+          0, 0), 120);
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.audio_sink,
+          1, 0), 120);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_unlink (filename);
+  g_free (filename);
+
+  g_free (mov.data);
+}
+
+GST_END_TEST;
+
+/* Reading ahead parses the sample table of the other stream in advance, a
+ * corrupt entry in it must only fail once the stream gets there */
+GST_START_TEST (test_qtdemux_pull_interleaved_corrupt)
+{
+  InterleavedSinks sinks;
+  InterleavedMov mov;
+  GstElement *pipeline;
+  gchar *filename;
+
+  create_interleaved_mov (&mov, TRUE);
+  filename = write_temp_mov (mov.data, mov.size);
+  pipeline = create_interleaved_pipeline (filename, &sinks);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_eos_or_error (pipeline),
+      GST_MESSAGE_ERROR);
+
+  fail_unless (check_interleaved_samples (&mov, sinks.video_sink, 0,
+          0) >= INTERLEAVED_CORRUPT_CHUNK);
+  fail_unless_equals_int (check_interleaved_samples (&mov, sinks.audio_sink,
+          1, 0), INTERLEAVED_CORRUPT_CHUNK);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_unlink (filename);
+  g_free (filename);
+
+  g_free (mov.data);
+}
+
+GST_END_TEST;
+
+/* A fragmented MOV with a video track that has some samples in the moov,
+ * followed by several fragments with one moof and mdat each */
+#define FRAGMENTED_N_MOOV_SAMPLES 10
+#define FRAGMENTED_N_FRAGMENTS 5
+#define FRAGMENTED_SAMPLES_PER_FRAGMENT 10
+#define FRAGMENTED_N_SAMPLES (FRAGMENTED_N_MOOV_SAMPLES + \
+    FRAGMENTED_N_FRAGMENTS * FRAGMENTED_SAMPLES_PER_FRAGMENT)
+#define FRAGMENTED_SAMPLE_DURATION 40
+
+static guint32
+fragmented_sample_size (guint index)
+{
+  return 100 + (index * 37) % 200;
+}
+
+/* Every byte of a sample holds the lower 8 bits of its index */
+static void
+put_fragmented_samples (GstByteWriter * bw, guint first, guint n)
+{
+  guint box = put_box_start (bw, GST_MAKE_FOURCC ('m', 'd', 'a', 't'));
+  guint i;
+
+  for (i = first; i < first + n; i++)
+    gst_byte_writer_fill (bw, i & 0xff, fragmented_sample_size (i));
+  put_box_end (bw, box);
+}
+
+static guint8 *
+create_fragmented_mov (gsize * size)
+{
+  guint32 sizes[FRAGMENTED_N_MOOV_SAMPLES];
+  guint64 offsets[FRAGMENTED_N_MOOV_SAMPLES];
+  TestMovTrack track = {
+    GST_MAKE_FOURCC ('v', 'i', 'd', 'e'), 1000, FRAGMENTED_N_MOOV_SAMPLES,
+    FRAGMENTED_SAMPLE_DURATION, 0, sizes, 1, FRAGMENTED_N_MOOV_SAMPLES,
+    offsets, interleaved_video_stsd_entry,
+    sizeof (interleaved_video_stsd_entry), 0
+  };
+  GstByteWriter bw;
+  guint64 offset;
+  guint i, j;
+
+  for (i = 0; i < FRAGMENTED_N_MOOV_SAMPLES; i++)
+    sizes[i] = fragmented_sample_size (i);
+
+  /* the size of the moov doesn't depend on the chunk offsets */
+  gst_byte_writer_init (&bw);
+  put_ftyp (&bw);
+  put_moov (&bw, &track, 1, FRAGMENTED_N_SAMPLES * FRAGMENTED_SAMPLE_DURATION);
+  offset = gst_byte_writer_get_pos (&bw) + 8;
+  gst_byte_writer_reset (&bw);
+
+  for (i = 0; i < FRAGMENTED_N_MOOV_SAMPLES; i++) {
+    offsets[i] = offset;
+    offset += sizes[i];
+  }
+
+  gst_byte_writer_init (&bw);
+  put_ftyp (&bw);
+  put_moov (&bw, &track, 1, FRAGMENTED_N_SAMPLES * FRAGMENTED_SAMPLE_DURATION);
+  put_fragmented_samples (&bw, 0, FRAGMENTED_N_MOOV_SAMPLES);
+
+  for (i = 0; i < FRAGMENTED_N_FRAGMENTS; i++) {
+    guint first = FRAGMENTED_N_MOOV_SAMPLES +
+        i * FRAGMENTED_SAMPLES_PER_FRAGMENT;
+    guint moof, traf, box, data_offset_pos, end;
+
+    moof = put_box_start (&bw, GST_MAKE_FOURCC ('m', 'o', 'o', 'f'));
+
+    box = put_box_start (&bw, GST_MAKE_FOURCC ('m', 'f', 'h', 'd'));
+    gst_byte_writer_fill (&bw, 0, 4);
+    gst_byte_writer_put_uint32_be (&bw, i + 1);
+    put_box_end (&bw, box);
+
+    traf = put_box_start (&bw, GST_MAKE_FOURCC ('t', 'r', 'a', 'f'));
+    box = put_box_start (&bw, GST_MAKE_FOURCC ('t', 'f', 'h', 'd'));
+    gst_byte_writer_fill (&bw, 0, 4);
+    gst_byte_writer_put_uint32_be (&bw, 1);
+    put_box_end (&bw, box);
+
+    /* data offset and sample sizes, the data offset is relative to the moof
+     * and filled in once its size is known */
+    box = put_box_start (&bw, GST_MAKE_FOURCC ('t', 'r', 'u', 'n'));
+    gst_byte_writer_put_uint32_be (&bw, 0x000201);
+    gst_byte_writer_put_uint32_be (&bw, FRAGMENTED_SAMPLES_PER_FRAGMENT);
+    data_offset_pos = gst_byte_writer_get_pos (&bw);
+    gst_byte_writer_put_uint32_be (&bw, 0);
+    for (j = first; j < first + FRAGMENTED_SAMPLES_PER_FRAGMENT; j++)
+      gst_byte_writer_put_uint32_be (&bw, fragmented_sample_size (j));
+    put_box_end (&bw, box);
+    put_box_end (&bw, traf);
+    put_box_end (&bw, moof);
+
+    end = gst_byte_writer_get_pos (&bw);
+    gst_byte_writer_set_pos (&bw, data_offset_pos);
+    gst_byte_writer_put_uint32_be (&bw, end - moof + 8);
+    gst_byte_writer_set_pos (&bw, end);
+
+    put_fragmented_samples (&bw, first, FRAGMENTED_SAMPLES_PER_FRAGMENT);
+  }
+
+  *size = gst_byte_writer_get_size (&bw);
+  return gst_byte_writer_reset_and_get_data (&bw);
+}
+
+/* Pulls the first buffer after a seek to sample @index and checks that it is
+ * that sample */
+static void
+check_fragmented_seek (GstElement * pipeline, GstElement * appsink,
+    guint index)
+{
+  GstClockTime position = index * FRAGMENTED_SAMPLE_DURATION * GST_MSECOND;
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstMapInfo map;
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  switch_state_with_async_wait (pipeline, GST_STATE_PLAYING);
+
+  sample = gst_app_sink_pull_sample (GST_APP_SINK (appsink));
+  fail_unless (sample != NULL);
+  buffer = gst_sample_get_buffer (sample);
+
+  fail_unless_equals_uint64 (GST_BUFFER_DTS (buffer), position);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, fragmented_sample_size (index));
+  fail_unless_equals_int (map.data[0], index & 0xff);
+  gst_buffer_unmap (buffer, &map);
+
+  gst_sample_unref (sample);
+
+  switch_state_with_async_wait (pipeline, GST_STATE_PAUSED);
+}
+
+/* In pull mode the fragments are only parsed when the samples before them are
+ * needed, a seek several fragments past the moov samples has to parse all of
+ * them and not just the next one */
+GST_START_TEST (test_qtdemux_pull_fragmented_seek)
+{
+  GstElement *source, *demux, *appsink, *pipeline;
+  GstStateChangeReturn state_ret;
+  gchar *filename;
+  guint8 *data;
+  gsize size;
+
+  data = create_fragmented_mov (&size);
+  filename = write_temp_mov (data, size);
+  g_free (data);
+
+  pipeline = gst_pipeline_new (NULL);
+  source = gst_element_factory_make ("filesrc", NULL);
+  demux = gst_element_factory_make ("qtdemux", NULL);
+  appsink = gst_element_factory_make ("appsink", NULL);
+
+  g_signal_connect (demux, "pad-added", (GCallback)
+      qtdemux_pad_added_cb_link_sink, appsink);
+
+  gst_bin_add_many (GST_BIN (pipeline), source, demux, appsink, NULL);
+  gst_element_link (source, demux);
+
+  g_object_set (source, "location", filename, NULL);
+  g_object_set (appsink, "sync", FALSE, NULL);
+
+  /* only preroll, so that no fragment is parsed yet */
+  state_ret = gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  fail_unless (state_ret != GST_STATE_CHANGE_FAILURE);
+  state_ret = gst_element_get_state (pipeline, NULL, NULL, -1);
+  fail_unless_equals_int (state_ret, GST_STATE_CHANGE_SUCCESS);
+
+  /* into the fourth fragment, then back into the moov samples and into the
+   * last fragment */
+  check_fragmented_seek (pipeline, appsink, FRAGMENTED_N_MOOV_SAMPLES +
+      3 * FRAGMENTED_SAMPLES_PER_FRAGMENT + 5);
+  check_fragmented_seek (pipeline, appsink, 3);
+  check_fragmented_seek (pipeline, appsink, FRAGMENTED_N_SAMPLES - 2);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_qtdemux_editlist)
 {
   const gsize editlist_mp4_size = 5322593;
@@ -1757,6 +2683,11 @@ qtdemux_suite (void)
   tcase_add_test (tc_chain, test_qtdemux_gapless_itunes_data);
   tcase_add_test (tc_chain, test_qtdemux_gapless_nero_data_with_itunsmpb);
   tcase_add_test (tc_chain, test_qtdemux_gapless_nero_data_without_itunsmpb);
+  tcase_add_test (tc_chain, test_qtdemux_seek_unparsed_samples);
+  tcase_add_test (tc_chain, test_qtdemux_seek_unparsed_merged_pcm);
+  tcase_add_test (tc_chain, test_qtdemux_pull_interleaved);
+  tcase_add_test (tc_chain, test_qtdemux_pull_interleaved_corrupt);
+  tcase_add_test (tc_chain, test_qtdemux_pull_fragmented_seek);
   tcase_add_test (tc_chain, test_qtdemux_editlist);
 
   return s;
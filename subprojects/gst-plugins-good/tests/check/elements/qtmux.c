@@ -1427,26 +1427,67 @@ check_output (const gchar * location, struct TestInputData *input1,
   gst_object_unref (demux);
 }
 
+/* Returns the offset of the first top-level atom of type @fourcc in the
+ * file at @location, or -1 */
+static gint64
+find_top_level_atom (const gchar * location, guint32 fourcc)
+{
+  gchar *data;
+  gsize size, offset = 0;
+  gint64 res = -1;
+
+  fail_unless (g_file_get_contents (location, &data, &size, NULL));
+
+  while (offset + 8 <= size) {
+    guint64 atom_size = GST_READ_UINT32_BE (data + offset);
+
+    if (GST_READ_UINT32_LE (data + offset + 4) == fourcc) {
+      res = offset;
+      break;
+    }
+    if (atom_size == 1) {
+      fail_unless (offset + 16 <= size);
+      atom_size = GST_READ_UINT64_BE (data + offset + 8);
+    }
+    fail_unless (atom_size >= 8);
+    offset += atom_size;
+  }
+
+  g_free (data);
+  return res;
+}
+
 /* Muxes a file with qtmux using the inputs provided and
  * then verifies that the generated file corresponds to the
- * data in the inputs */
+ * data in the inputs. If @reserved_bytes_per_sec is not 0, the
+ * headers are written into reserved space in faststart mode */
 static void
-run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
+run_muxing_test_full (struct TestInputData *input1,
+    struct TestInputData *input2, guint reserved_bytes_per_sec)
 {
   gchar *location;
   GstElement *qtmux;
   GstElement *filesink;
+  GstMessage *msg;
   GstBus *bus;
+  gboolean reserved_space_warning = FALSE;
 
   location = g_strdup_printf ("%s/%s-%d", g_get_tmp_dir (), "qtmuxtest",
       g_random_int ());
   qtmux = gst_check_setup_element ("qtmux");
+  if (reserved_bytes_per_sec) {
+    g_object_set (qtmux, "faststart", TRUE, "faststart-file",
+        "/nonexistent/qtmux-faststart-file", "reserved-max-duration",
+        10 * GST_SECOND, "reserved-bytes-per-sec", reserved_bytes_per_sec,
+        NULL);
+  }
   filesink = gst_element_factory_make ("filesink", NULL);
   g_object_set (filesink, "location", location, NULL);
   gst_element_link (qtmux, filesink);
 
   bus = gst_bus_new ();
   gst_element_set_bus (filesink, bus);
+  gst_element_set_bus (qtmux, bus);
   gst_object_unref (bus);
 
   input1->srcpad = setup_src_pad (qtmux, &srcvideorawtemplate, "video_%u");
@@ -1474,16 +1515,50 @@ run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
   input1->thread = NULL;
   input2->thread = NULL;
 
-  gst_message_unref (gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
-          GST_MESSAGE_EOS));
+  while ((msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+              GST_MESSAGE_EOS | GST_MESSAGE_WARNING))) {
+    GstMessageType type = GST_MESSAGE_TYPE (msg);
+
+    if (type == GST_MESSAGE_WARNING) {
+      GError *err = NULL;
+
+      gst_message_parse_warning (msg, &err, NULL);
+      if (g_error_matches (err, GST_STREAM_ERROR, GST_STREAM_ERROR_MUX))
+        reserved_space_warning = TRUE;
+      g_error_free (err);
+    }
+    gst_message_unref (msg);
+
+    if (type == GST_MESSAGE_EOS)
+      break;
+  }
 
   gst_element_set_state (qtmux, GST_STATE_NULL);
   gst_element_set_state (filesink, GST_STATE_NULL);
 
   gst_element_set_bus (filesink, NULL);
+  gst_element_set_bus (qtmux, NULL);
 
   check_output (location, input1, input2);
 
+  if (reserved_bytes_per_sec) {
+    gint64 moov_pos = find_top_level_atom (location, GST_MAKE_FOURCC ('m',
+            'o', 'o', 'v'));
+    gint64 mdat_pos = find_top_level_atom (location, GST_MAKE_FOURCC ('m',
+            'd', 'a', 't'));
+
+    fail_unless (moov_pos > 0);
+    fail_unless (mdat_pos > 0);
+    /* with too little space reserved the moov ends up after the mdat */
+    if (reserved_bytes_per_sec > 1) {
+      fail_unless (moov_pos < mdat_pos);
+      fail_if (reserved_space_warning);
+    } else {
+      fail_unless (moov_pos > mdat_pos);
+      fail_unless (reserved_space_warning);
+    }
+  }
+
   gst_object_unref (filesink);
   test_input_data_clean (input1);
   test_input_data_clean (input2);
@@ -1494,7 +1569,14 @@ run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
   g_free (location);
 }
 
-GST_START_TEST (test_muxing)
+static void
+run_muxing_test (struct TestInputData *input1, struct TestInputData *input2)
+{
+  run_muxing_test_full (input1, input2, 0);
+}
+
+static void
+run_basic_muxing_test (guint reserved_bytes_per_sec)
 {
   struct TestInputData input1, input2;
   GstCaps *caps;
@@ -1545,7 +1627,26 @@ GST_START_TEST (test_muxing)
           2 * GST_SECOND, GST_SECOND, 4096));
   input2.input = g_list_append (input2.input, gst_event_new_eos ());
 
-  run_muxing_test (&input1, &input2);
+  run_muxing_test_full (&input1, &input2, reserved_bytes_per_sec);
+}
+
+GST_START_TEST (test_muxing)
+{
+  run_basic_muxing_test (0);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_muxing_faststart_reserved)
+{
+  run_basic_muxing_test (550);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_muxing_faststart_reserved_overflow)
+{
+  run_basic_muxing_test (1);
 }
 
 GST_END_TEST;
@@ -1894,6 +1995,8 @@ qtmux_suite (void)
   tcase_add_test (tc_chain, test_encodebin_mp4mux);
 
   tcase_add_test (tc_chain, test_muxing);
+  tcase_add_test (tc_chain, test_muxing_faststart_reserved);
+  tcase_add_test (tc_chain, test_muxing_faststart_reserved_overflow);
   tcase_add_test (tc_chain, test_muxing_non_zero_segment);
   tcase_add_test (tc_chain, test_muxing_non_zero_segment_different);
   tcase_add_test (tc_chain, test_muxing_dts_outside_segment);
@@ -246,6 +246,34 @@ GST_START_TEST (test_push_forward_seq)
 
 GST_END_TEST;
 
+GST_START_TEST (test_push_list_unordered)
+{
+  GstElement *jitterbuffer;
+  const guint num_buffers = 4;
+  GstBufferList *list;
+  GList *node;
+
+  jitterbuffer = setup_jitterbuffer (num_buffers);
+  fail_unless (start_jitterbuffer (jitterbuffer)
+      == GST_STATE_CHANGE_SUCCESS, "could not set to playing");
+
+  /* push buffers in one list: 0,3,2,1 */
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, (GstBuffer *) inbuffers->data);
+  for (node = g_list_last (inbuffers); node != inbuffers;
+      node = g_list_previous (node))
+    gst_buffer_list_add (list, (GstBuffer *) node->data);
+  fail_unless (gst_pad_push_list (mysrcpad, list) == GST_FLOW_OK);
+
+  /* check the buffer list */
+  check_jitterbuffer_results (num_buffers);
+
+  /* cleanup */
+  cleanup_jitterbuffer (jitterbuffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_push_backward_seq)
 {
   GstElement *jitterbuffer;
@@ -3639,6 +3667,7 @@ rtpjitterbuffer_suite (void)
   tcase_add_test (tc_chain, test_push_forward_seq);
   tcase_add_test (tc_chain, test_push_backward_seq);
   tcase_add_test (tc_chain, test_push_unordered);
+  tcase_add_test (tc_chain, test_push_list_unordered);
   tcase_add_test (tc_chain, test_push_eos);
   tcase_add_test (tc_chain, test_basetime);
   tcase_add_test (tc_chain, test_clear_pt_map);
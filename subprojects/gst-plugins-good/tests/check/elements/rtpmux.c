@@ -692,6 +692,105 @@ GST_START_TEST (test_rtpmux_ts_offset_downstream_overrules_upstream)
 
 GST_END_TEST;
 
+/* Only the RTP header gets rewritten, a payload shared with other buffers must
+ * neither be modified nor copied */
+GST_START_TEST (test_rtpmux_shared_payload)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpmux", NULL, "src");
+  GstHarness *h0 = gst_harness_new_with_element (h->element, "sink_0", NULL);
+  GstBufferList *list;
+  GstBuffer *in[3], *out;
+  guint i;
+
+  g_object_set (h->element, "ssrc", 111111, NULL);
+  gst_harness_set_src_caps_str (h0, "application/x-rtp, ssrc=(uint)222222");
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++) {
+    in[i] = generate_test_buffer (i, 222222);
+    fail_unless_equals_int (gst_buffer_n_memory (in[i]), 1);
+  }
+
+  /* a single buffer and a list */
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h0, gst_buffer_ref (in[0])));
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, gst_buffer_ref (in[1]));
+  gst_buffer_list_add (list, gst_buffer_ref (in[2]));
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h0->srcpad, list));
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++) {
+    out = gst_harness_pull (h);
+
+    fail_unless_equals_int (111111, _rtp_buffer_get_ssrc (out));
+    fail_unless_equals_int (222222, _rtp_buffer_get_ssrc (in[i]));
+
+    /* the header was copied, the payload is a sub-memory of the input */
+    fail_unless_equals_int (gst_buffer_n_memory (out), 2);
+    fail_unless (gst_buffer_peek_memory (out, 1)->parent ==
+        gst_buffer_peek_memory (in[i], 0));
+    fail_unless_equals_int (gst_buffer_get_size (out),
+        gst_buffer_get_size (in[i]));
+
+    gst_buffer_unref (out);
+    gst_buffer_unref (in[i]);
+  }
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static guint16
+_rtp_buffer_get_seq (GstBuffer * buf)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint16 ret;
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  ret = gst_rtp_buffer_get_seq (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+  return ret;
+}
+
+/* An invalid buffer in a list is dropped, the rest of the list is still
+ * pushed */
+GST_START_TEST (test_rtpmux_list_invalid_buffer)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpmux", "sink_0", "src");
+  GstBufferList *list;
+  GstBuffer *out;
+  guint16 seq;
+
+  g_object_set (h->element, "ssrc", 111111, NULL);
+  gst_harness_set_src_caps_str (h, "application/x-rtp, ssrc=(uint)222222");
+
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, generate_test_buffer (0, 222222));
+  gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, 4, NULL));
+  gst_buffer_list_add (list, generate_test_buffer (1, 222222));
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h->srcpad, list));
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), 2);
+  out = gst_harness_pull (h);
+  fail_unless_equals_int (111111, _rtp_buffer_get_ssrc (out));
+  seq = _rtp_buffer_get_seq (out);
+  gst_buffer_unref (out);
+  out = gst_harness_pull (h);
+  fail_unless_equals_int (111111, _rtp_buffer_get_ssrc (out));
+  fail_unless_equals_int ((guint16) (seq + 1), _rtp_buffer_get_seq (out));
+  gst_buffer_unref (out);
+
+  /* nothing is pushed for a list without any valid buffer */
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, gst_buffer_new_allocate (NULL, 4, NULL));
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h->srcpad, list));
+  fail_unless_equals_int (gst_harness_buffers_received (h), 2);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpmux_suite (void)
 {
@@ -714,6 +813,8 @@ rtpmux_suite (void)
       test_rtpmux_caps_query_with_downsteam_ts_offset_and_ssrc);
   tcase_add_test (tc_chain,
       test_rtpmux_ts_offset_downstream_overrules_upstream);
+  tcase_add_test (tc_chain, test_rtpmux_shared_payload);
+  tcase_add_test (tc_chain, test_rtpmux_list_invalid_buffer);
 
   tc_chain = tcase_create ("rtpdtmfmux_basic");
   tcase_add_test (tc_chain, test_rtpdtmfmux_basic);
@@ -128,6 +128,123 @@ GST_START_TEST (test_rtpptdemux_srccaps_from_signal_nossrc)
 
 GST_END_TEST;
 
+typedef struct
+{
+  GSList *src_h;
+  GArray *pt_changes;
+  guint n_lists;
+} ListTestData;
+
+static GstPadProbeReturn
+count_buffer_lists (G_GNUC_UNUSED GstPad * pad,
+    G_GNUC_UNUSED GstPadProbeInfo * info, ListTestData * data)
+{
+  data->n_lists++;
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+new_payload_type_list (GstElement * element, G_GNUC_UNUSED guint pt,
+    GstPad * pad, ListTestData * data)
+{
+  GstHarness *h = gst_harness_new_with_element (element, NULL, NULL);
+
+  gst_harness_add_element_src_pad (h, pad);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) count_buffer_lists, data, NULL);
+  data->src_h = g_slist_append (data->src_h, h);
+}
+
+static void
+payload_type_changed (G_GNUC_UNUSED GstElement * element, guint pt,
+    ListTestData * data)
+{
+  g_array_append_val (data->pt_changes, pt);
+}
+
+static GstBuffer *
+create_rtp_buffer (guint8 pt, guint16 seq)
+{
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (0, 0, 0);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, pt);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+GST_START_TEST (test_rtpptdemux_buffer_list)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpptdemux", "sink", NULL);
+  static const guint8 pts[] = { 0, 0, 8, 8, 0 };
+  static guint8 bad_pkt[] = { 0x01, 0x02, 0x03 };
+  ListTestData data = { NULL, NULL, 0 };
+  GstBufferList *list;
+  GSList *walk;
+  guint i, n_bufs = 0;
+
+  data.pt_changes = g_array_new (FALSE, FALSE, sizeof (guint));
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+  g_signal_connect (h->element,
+      "new-payload-type", (GCallback) new_payload_type_list, &data);
+  g_signal_connect (h->element,
+      "payload-type-changed", (GCallback) payload_type_changed, &data);
+  gst_harness_play (h);
+
+  /* runs of payload types, with an invalid packet in the middle of one */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (pts); i++) {
+    gst_buffer_list_add (list, create_rtp_buffer (pts[i], i));
+    if (i == 2)
+      gst_buffer_list_add (list, gst_buffer_new_wrapped_full (0, bad_pkt,
+              sizeof bad_pkt, 0, sizeof bad_pkt, NULL, NULL));
+  }
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h->srcpad, list));
+
+  /* one pad per payload type, payload-type-changed in packet order */
+  fail_unless_equals_int (g_slist_length (data.src_h), 2);
+  fail_unless_equals_int (data.pt_changes->len, 3);
+  fail_unless_equals_int (g_array_index (data.pt_changes, guint, 0), 0);
+  fail_unless_equals_int (g_array_index (data.pt_changes, guint, 1), 8);
+  fail_unless_equals_int (g_array_index (data.pt_changes, guint, 2), 0);
+
+  /* every run was pushed as a list, the invalid packet splits the second */
+  fail_unless_equals_int (data.n_lists, 4);
+
+  /* and every pad got the packets of its payload type in order */
+  for (walk = data.src_h; walk; walk = walk->next) {
+    GstHarness *src = walk->data;
+    GstBuffer *buf;
+    gint last_seq = -1;
+    gint pt = -1;
+
+    while ((buf = gst_harness_try_pull (src))) {
+      GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+      fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+      if (pt == -1)
+        pt = gst_rtp_buffer_get_payload_type (&rtp);
+      fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), pt);
+      fail_unless (gst_rtp_buffer_get_seq (&rtp) > last_seq);
+      fail_unless_equals_int (pts[gst_rtp_buffer_get_seq (&rtp)], pt);
+      last_seq = gst_rtp_buffer_get_seq (&rtp);
+      gst_rtp_buffer_unmap (&rtp);
+      gst_buffer_unref (buf);
+      n_bufs++;
+    }
+  }
+  fail_unless_equals_int (n_bufs, G_N_ELEMENTS (pts));
+
+  g_slist_free_full (data.src_h, (GDestroyNotify) gst_harness_teardown);
+  g_array_free (data.pt_changes, TRUE);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpptdemux_suite (void)
 {
@@ -139,6 +256,7 @@ rtpptdemux_suite (void)
   tcase_add_test (tc_chain, test_rtpptdemux_srccaps_from_sinkcaps_nossrc);
   tcase_add_test (tc_chain, test_rtpptdemux_srccaps_from_signal);
   tcase_add_test (tc_chain, test_rtpptdemux_srccaps_from_signal_nossrc);
+  tcase_add_test (tc_chain, test_rtpptdemux_buffer_list);
   suite_add_tcase (s, tc_chain);
 
   return s;
@@ -214,6 +214,63 @@ GST_START_TEST (test_rtxsend_basic)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtxsend_request_blp)
+{
+  const guint32 main_ssrc = 1234567;
+  const guint main_pt = 96;
+  const guint32 rtx_ssrc = 7654321;
+  const guint rtx_pt = 106;
+  GstHarness *h = gst_harness_new ("rtprtxsend");
+  GstStructure *ssrc_map =
+      create_rtx_map ("application/x-rtp-ssrc-map", main_ssrc, rtx_ssrc);
+  GstStructure *pt_map =
+      create_rtx_map ("application/x-rtp-pt-map", main_pt, rtx_pt);
+  guint rtx_requests, rtx_packets;
+  guint16 seqnum;
+
+  g_object_set (h->element, "ssrc-map", ssrc_map, NULL);
+  g_object_set (h->element, "payload-type-map", pt_map, NULL);
+
+  gst_harness_set_src_caps_str (h, "application/x-rtp, "
+      "clock-rate = (int)90000");
+
+  /* push packets across the seqnum wraparound, 65534 gets lost */
+  for (seqnum = 65530; seqnum != 6; seqnum++) {
+    if (seqnum == 65534)
+      continue;
+    fail_unless_equals_int (GST_FLOW_OK,
+        gst_harness_push (h, create_rtp_buffer (main_ssrc, main_pt, seqnum)));
+    pull_and_verify (h, FALSE, main_ssrc, main_pt, seqnum);
+  }
+
+  /* request 65532 and, like a generic NACK, 65533, 65534, 0 and 2 */
+  gst_harness_push_upstream_event (h,
+      gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+          gst_structure_new ("GstRTPRetransmissionRequest",
+              "seqnum", G_TYPE_UINT, 65532,
+              "ssrc", G_TYPE_UINT, main_ssrc,
+              "blp", G_TYPE_UINT, 0x2b, NULL)));
+
+  /* the packets that are in the history get retransmitted in order */
+  pull_and_verify (h, TRUE, rtx_ssrc, rtx_pt, 65532);
+  pull_and_verify (h, TRUE, rtx_ssrc, rtx_pt, 65533);
+  pull_and_verify (h, TRUE, rtx_ssrc, rtx_pt, 0);
+  pull_and_verify (h, TRUE, rtx_ssrc, rtx_pt, 2);
+  fail_unless_equals_int (0, gst_harness_buffers_in_queue (h));
+
+  /* every requested seqnum counts as a request */
+  g_object_get (h->element, "num-rtx-requests", &rtx_requests,
+      "num-rtx-packets", &rtx_packets, NULL);
+  fail_unless_equals_int (5, rtx_requests);
+  fail_unless_equals_int (4, rtx_packets);
+
+  gst_structure_free (ssrc_map);
+  gst_structure_free (pt_map);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtxsend_disabled_enabled_disabled)
 {
   const guint32 main_ssrc = 1234567;
@@ -1173,6 +1230,7 @@ rtprtx_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_rtxsend_basic);
+  tcase_add_test (tc_chain, test_rtxsend_request_blp);
   tcase_add_test (tc_chain, test_rtxsend_disabled_enabled_disabled);
   tcase_add_test (tc_chain, test_rtxsend_configured_not_playing_cleans_up);
 
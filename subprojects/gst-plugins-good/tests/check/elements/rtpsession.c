@@ -2543,6 +2543,228 @@ GST_START_TEST (test_disable_probation)
 
 GST_END_TEST;
 
+GST_START_TEST (test_receive_stats_of_sender)
+{
+  SessionHarness *h = session_harness_new ();
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket rtcp_packet;
+  guint64 packets_received;
+  guint32 ssrc, exthighestseq;
+  gint32 packetslost;
+  GstStructure *stats;
+  GObject *source;
+  GstBuffer *buf;
+  guint i;
+
+  g_signal_connect (h->internal_session, "on-new-ssrc",
+      G_CALLBACK (disable_probation_on_new_ssrc), NULL);
+
+  /* once the source is a validated sender, its packets are handled with only
+   * the lock of the source. Packet 10 gets lost */
+  for (i = 1; i <= 20; i++) {
+    if (i == 10)
+      continue;
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0x12345678)));
+  }
+  fail_unless_equals_int (19, gst_harness_buffers_in_queue (h->recv_rtp_h));
+
+  g_signal_emit_by_name (h->internal_session, "get-source-by-ssrc",
+      0x12345678, &source);
+  g_object_get (source, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "packets-received",
+          &packets_received));
+  fail_unless_equals_uint64 (19, packets_received);
+  gst_structure_free (stats);
+  g_object_unref (source);
+
+  /* the report block accounts for all of them */
+  session_harness_produce_rtcp (h, 1);
+  buf = session_harness_pull_rtcp (h);
+  fail_unless (gst_rtcp_buffer_validate (buf));
+  gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet));
+  fail_unless_equals_int (GST_RTCP_TYPE_RR,
+      gst_rtcp_packet_get_type (&rtcp_packet));
+  fail_unless_equals_int (1, gst_rtcp_packet_get_rb_count (&rtcp_packet));
+  gst_rtcp_packet_get_rb (&rtcp_packet, 0, &ssrc, NULL, &packetslost,
+      &exthighestseq, NULL, NULL, NULL);
+  fail_unless_equals_int (0x12345678, ssrc);
+  fail_unless_equals_int (1, packetslost);
+  fail_unless_equals_int (20, exthighestseq);
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
+static void
+session_harness_block_recv_rtp (SessionHarness * h, BlockingProbeData * probe)
+{
+  probe->pad = gst_element_get_static_pad (h->session, "recv_rtp_src");
+  fail_unless (probe->pad);
+
+  g_mutex_init (&probe->mutex);
+  g_cond_init (&probe->cond);
+  probe->blocked = FALSE;
+  probe->id = gst_pad_add_probe (probe->pad,
+      GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER,
+      on_rtcp_pad_blocked, probe, NULL);
+}
+
+static void
+session_harness_wait_recv_rtp_blocked (BlockingProbeData * probe)
+{
+  g_mutex_lock (&probe->mutex);
+  while (!probe->blocked)
+    g_cond_wait (&probe->cond, &probe->mutex);
+  g_mutex_unlock (&probe->mutex);
+}
+
+typedef struct
+{
+  SessionHarness *h;
+  GstBuffer *buf;
+} RecvRtpData;
+
+static gpointer
+recv_rtp_thread (RecvRtpData * data)
+{
+  return GINT_TO_POINTER (session_harness_recv_rtp (data->h, data->buf));
+}
+
+/* Receives a packet of a validated sender in a thread and waits until it is
+ * pushed downstream, which is done without the session lock */
+static GThread *
+session_harness_recv_rtp_blocked (SessionHarness * h, GstBuffer * buf,
+    BlockingProbeData * probe, RecvRtpData * data)
+{
+  GThread *thread;
+
+  session_harness_block_recv_rtp (h, probe);
+  data->h = h;
+  data->buf = buf;
+  thread = g_thread_new ("recv-rtp", (GThreadFunc) recv_rtp_thread, data);
+  session_harness_wait_recv_rtp_blocked (probe);
+
+  return thread;
+}
+
+static guint
+session_harness_get_num_active_sources (SessionHarness * h)
+{
+  guint num;
+
+  g_object_get (h->internal_session, "num-active-sources", &num, NULL);
+  return num;
+}
+
+GST_START_TEST (test_receive_bye_while_pushing)
+{
+  SessionHarness *h = session_harness_new ();
+  BlockingProbeData probe;
+  RecvRtpData data;
+  GThread *thread;
+  guint num_active;
+  guint i;
+
+  g_signal_connect (h->internal_session, "on-new-ssrc",
+      G_CALLBACK (disable_probation_on_new_ssrc), NULL);
+  num_active = session_harness_get_num_active_sources (h);
+
+  for (i = 0; i < 3; i++)
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0x12345678)));
+  fail_unless_equals_int (num_active + 1,
+      session_harness_get_num_active_sources (h));
+
+  thread = session_harness_recv_rtp_blocked (h,
+      generate_test_buffer (3, 0x12345678), &probe, &data);
+
+  /* a BYE handled meanwhile makes the source inactive */
+  fail_unless_equals_int (GST_FLOW_OK,
+      session_harness_recv_rtcp (h, create_bye_rtcp (0x12345678)));
+  fail_unless_equals_int (num_active,
+      session_harness_get_num_active_sources (h));
+
+  session_harness_unblock_rtcp (h, &probe);
+  fail_unless_equals_int (GST_FLOW_OK, GPOINTER_TO_INT (g_thread_join (thread)));
+
+  /* and is accounted for once, also when more packets arrive after it */
+  fail_unless_equals_int (num_active,
+      session_harness_get_num_active_sources (h));
+  fail_unless_equals_int (GST_FLOW_OK,
+      session_harness_recv_rtp (h, generate_test_buffer (4, 0x12345678)));
+  fail_unless_equals_int (num_active,
+      session_harness_get_num_active_sources (h));
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
+static void
+on_sender_timeout_cb (GObject * session, GObject * source, gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+GST_START_TEST (test_receive_sender_timeout_while_pushing)
+{
+  SessionHarness *h = session_harness_new ();
+  BlockingProbeData probe;
+  RecvRtpData data;
+  GThread *thread;
+  GObject *source;
+  gboolean is_sender;
+  gint timeouts = 0;
+  guint num_active;
+  guint i;
+
+  g_signal_connect (h->internal_session, "on-new-ssrc",
+      G_CALLBACK (disable_probation_on_new_ssrc), NULL);
+  g_signal_connect (h->internal_session, "on-sender-timeout",
+      G_CALLBACK (on_sender_timeout_cb), &timeouts);
+  num_active = session_harness_get_num_active_sources (h);
+
+  for (i = 0; i < 3; i++)
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0x12345678)));
+
+  thread = session_harness_recv_rtp_blocked (h,
+      generate_test_buffer (3, 0x12345678), &probe, &data);
+
+  /* long enough for the source to time out as sender, but not to be removed */
+  fail_unless (session_harness_advance_and_crank (h, 15 * GST_SECOND));
+  gst_buffer_unref (session_harness_pull_rtcp (h));
+  fail_unless_equals_int (1, g_atomic_int_get (&timeouts));
+
+  session_harness_unblock_rtcp (h, &probe);
+  fail_unless_equals_int (GST_FLOW_OK, GPOINTER_TO_INT (g_thread_join (thread)));
+
+  g_signal_emit_by_name (h->internal_session, "get-source-by-ssrc",
+      0x12345678, &source);
+  g_object_get (source, "is-sender", &is_sender, NULL);
+  fail_if (is_sender);
+  fail_unless_equals_int (num_active + 1,
+      session_harness_get_num_active_sources (h));
+
+  /* the next packet makes it a sender again */
+  fail_unless_equals_int (GST_FLOW_OK,
+      session_harness_recv_rtp (h, generate_test_buffer (4, 0x12345678)));
+  g_object_get (source, "is-sender", &is_sender, NULL);
+  fail_unless (is_sender);
+  fail_unless_equals_int (num_active + 1,
+      session_harness_get_num_active_sources (h));
+  g_object_unref (source);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_request_late_nack)
 {
   SessionHarness *h = session_harness_new ();
@@ -3562,6 +3784,50 @@ GST_START_TEST (test_twcc_duplicate_seqnums)
 
 GST_END_TEST;
 
+/* Duplicates are not reported twice, but they still count as received packets
+   when deciding to send a feedback before the marker bit */
+GST_START_TEST (test_twcc_duplicates_count_as_received)
+{
+  SessionHarness *h = session_harness_new ();
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  TWCCPacket packets[42];
+  GstBuffer *buf;
+  guint8 *fci_data;
+  guint i;
+
+  /* 20 packets received twice, then a gap of 69 packets. Without the
+     duplicates, 21 received and 69 lost packets after 41 packets without
+     marker would already trigger a feedback for the packets up to #89 */
+  for (i = 0; i < 40; i++) {
+    packets[i].seqnum = i / 2;
+    packets[i].timestamp = i * GST_MSECOND;
+    packets[i].marker = FALSE;
+  }
+  packets[40].seqnum = 89;
+  packets[40].timestamp = 40 * GST_MSECOND;
+  packets[40].marker = FALSE;
+  packets[41].seqnum = 90;
+  packets[41].timestamp = 41 * GST_MSECOND;
+  packets[41].marker = TRUE;
+
+  twcc_push_packets (h, packets);
+
+  /* a single feedback for all packets, sent for the marker bit */
+  buf = session_harness_produce_twcc (h);
+  fail_unless (gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp));
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &packet));
+  fci_data = gst_rtcp_packet_fb_get_fci (&packet);
+  fail_unless_equals_int (0, GST_READ_UINT16_BE (fci_data));
+  fail_unless_equals_int (91, GST_READ_UINT16_BE (fci_data + 2));
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 
 GST_START_TEST (test_twcc_multiple_markers)
 {
@@ -4413,6 +4679,9 @@ rtpsession_suite (void)
   tcase_add_test (tc_chain, test_disable_sr_timestamp);
   tcase_add_test (tc_chain, test_on_sending_nacks);
   tcase_add_test (tc_chain, test_disable_probation);
+  tcase_add_test (tc_chain, test_receive_stats_of_sender);
+  tcase_add_test (tc_chain, test_receive_bye_while_pushing);
+  tcase_add_test (tc_chain, test_receive_sender_timeout_while_pushing);
   tcase_add_test (tc_chain, test_request_late_nack);
   tcase_add_test (tc_chain, test_clear_pt_map_stress);
   tcase_add_test (tc_chain, test_packet_rate);
@@ -4437,6 +4706,7 @@ rtpsession_suite (void)
   tcase_add_test (tc_chain, test_twcc_huge_seqnum_gap);
   tcase_add_test (tc_chain, test_twcc_double_packets);
   tcase_add_test (tc_chain, test_twcc_duplicate_seqnums);
+  tcase_add_test (tc_chain, test_twcc_duplicates_count_as_received);
   tcase_add_test (tc_chain, test_twcc_multiple_markers);
   tcase_add_test (tc_chain, test_twcc_no_marker_and_gaps);
   tcase_add_test (tc_chain, test_twcc_bad_rtcp);
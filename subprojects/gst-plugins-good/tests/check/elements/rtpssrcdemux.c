@@ -286,6 +286,70 @@ GST_START_TEST (test_rtpssrcdemux_max_streams)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtpssrcdemux_buffer_list)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpssrcdemux", "sink", NULL);
+  GstBufferList *list;
+  GSList *src_h = NULL, *walk;
+  guint8 bad_pkt[] = {
+    0x01, 0x02, 0x03
+  };
+  gint i;
+
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+  g_signal_connect (h->element,
+      "new-ssrc-pad", (GCallback) new_ssrc_pad_found, &src_h);
+  gst_harness_play (h);
+
+  /* a list of a single SSRC */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 4; i++)
+    gst_buffer_list_add (list, create_buffer (i, 0));
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h->srcpad, list));
+  fail_unless_equals_int (g_slist_length (src_h), 1);
+
+  /* interleaved SSRCs and an invalid packet */
+  list = gst_buffer_list_new ();
+  for (i = 4; i < 12; i++) {
+    gst_buffer_list_add (list, create_buffer (i, i % 2));
+    if (i == 6)
+      gst_buffer_list_add (list, gst_buffer_new_wrapped_full (0, bad_pkt,
+              sizeof bad_pkt, 0, sizeof bad_pkt, NULL, NULL));
+  }
+  fail_unless_equals_int (GST_FLOW_OK, gst_pad_push_list (h->srcpad, list));
+  fail_unless_equals_int (g_slist_length (src_h), 2);
+
+  /* every SSRC got its packets in order */
+  for (walk = src_h; walk; walk = walk->next) {
+    GstHarness *src = walk->data;
+    guint16 last_seq = 0;
+    guint32 ssrc = 0;
+    GstBuffer *buf;
+    guint n = 0;
+
+    while ((buf = gst_harness_try_pull (src))) {
+      GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+      fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+      if (n == 0)
+        ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+      else
+        fail_unless (gst_rtp_buffer_get_seq (&rtp) > last_seq);
+      fail_unless_equals_int (ssrc, gst_rtp_buffer_get_ssrc (&rtp));
+      last_seq = gst_rtp_buffer_get_seq (&rtp);
+      gst_rtp_buffer_unmap (&rtp);
+      gst_buffer_unref (buf);
+      n++;
+    }
+    fail_unless_equals_int (n, ssrc == 0 ? 8 : 4);
+  }
+
+  g_slist_free_full (src_h, (GDestroyNotify) gst_harness_teardown);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static void
 new_rtcp_ssrc_pad_found (GstElement * element, guint ssrc,
     G_GNUC_UNUSED GstPad * rtp_pad, GSList ** src_h)
@@ -463,6 +527,7 @@ rtpssrcdemux_suite (void)
   tcase_add_test (tc_chain, test_event_forwarding);
   tcase_add_test (tc_chain, test_oob_event_locking);
   tcase_add_test (tc_chain, test_rtpssrcdemux_max_streams);
+  tcase_add_test (tc_chain, test_rtpssrcdemux_buffer_list);
   tcase_add_test (tc_chain, test_rtpssrcdemux_rtcp_app);
   tcase_add_test (tc_chain, test_rtpssrcdemux_invalid_rtp);
   tcase_add_test (tc_chain, test_rtpssrcdemux_invalid_rtcp);
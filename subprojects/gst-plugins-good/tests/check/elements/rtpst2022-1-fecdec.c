@@ -346,6 +346,53 @@ GST_START_TEST (test_2d)
 
 GST_END_TEST;
 
+/**
+ * +------------------+
+ * | 65534 | x | x | x
+ * | 1     | x | x | x
+ * | 4     | x | x |
+ * +------------------+
+ *   d0
+ *
+ * Missing values:
+ * 1: 0xc5
+ */
+GST_START_TEST (test_column_seqnum_wraparound)
+{
+  guint8 payload;
+  GstHarness *h =
+      gst_harness_new_with_padnames ("rtpst2022-1-fecdec", NULL, "src");
+  GstHarness *h0 = gst_harness_new_with_element (h->element, "sink", NULL);
+  GstHarness *h_fec_0 =
+      gst_harness_new_with_element (h->element, "fec_0", NULL);
+
+  gst_harness_set_src_caps_str (h0, "application/x-rtp");
+  gst_harness_set_src_caps_str (h_fec_0, "application/x-rtp");
+
+  payload = 0x37;
+  gst_harness_push (h0, make_media_sample (65534, 0, &payload, 1));
+  payload = 0x28;
+  gst_harness_push (h0, make_media_sample (4, 0, &payload, 1));
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+  while (gst_harness_buffers_in_queue (h))
+    gst_buffer_unref (gst_harness_pull (h));
+
+  payload = 0xda;
+  gst_harness_push (h_fec_0, make_fec_sample (0, 0, 65534, FALSE, 3, 3, 0,
+          &payload, 1, 1));
+
+  /* d0 protects 65534, 1 and 4 across the wraparound */
+  payload = 0xc5;
+  pull_and_check (h, 1, 0, &payload, 1, 1);
+
+  gst_harness_teardown (h);
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h_fec_0);
+}
+
+GST_END_TEST;
+
 static void
 _xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
 {
@@ -436,6 +483,7 @@ st2022_1_dec_suite (void)
   tcase_add_test (tc_chain, test_row);
   tcase_add_test (tc_chain, test_column);
   tcase_add_test (tc_chain, test_2d);
+  tcase_add_test (tc_chain, test_column_seqnum_wraparound);
   tcase_add_test (tc_chain, test_variable_length);
 
   return s;
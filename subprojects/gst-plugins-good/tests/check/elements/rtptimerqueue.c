@@ -305,6 +305,44 @@ GST_START_TEST (test_timer_queue_timer_offset)
 
 GST_END_TEST;
 
+GST_START_TEST (test_timer_queue_wheel_order)
+{
+  RtpTimerQueue *queue = rtp_timer_queue_new ();
+  RtpTimer *timer;
+  GstClockTime last = 0;
+  guint i, n = 0;
+
+  fail_unless (rtp_timer_queue_get_use_wheel (queue));
+
+  /* timeouts spread far beyond the span of the wheel, in random order and
+   * with some of them rescheduled */
+  for (i = 0; i < 1000; i++)
+    rtp_timer_queue_set_deadline (queue, i,
+        ((i * 7919) % 1000) * 100 * GST_MSECOND, 0);
+  for (i = 0; i < 1000; i += 10) {
+    timer = rtp_timer_queue_find (queue, i);
+    rtp_timer_queue_update_timer (queue, timer, i,
+        timer->timeout + 5 * GST_SECOND, 0, 0, FALSE);
+  }
+
+  rtp_timer_queue_set_use_wheel (queue, FALSE);
+  fail_if (rtp_timer_queue_get_use_wheel (queue));
+  rtp_timer_queue_set_deadline (queue, 1000, 42 * GST_SECOND, 0);
+  rtp_timer_queue_set_use_wheel (queue, TRUE);
+
+  while ((timer = rtp_timer_queue_pop_until (queue, GST_CLOCK_TIME_NONE))) {
+    fail_unless (timer->timeout >= last);
+    last = timer->timeout;
+    rtp_timer_free (timer);
+    n++;
+  }
+  fail_unless_equals_int (1001, n);
+
+  g_object_unref (queue);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtptimerqueue_suite (void)
 {
@@ -319,6 +357,7 @@ rtptimerqueue_suite (void)
   tcase_add_test (tc_chain, test_timer_queue_update_timer_seqnum);
   tcase_add_test (tc_chain, test_timer_queue_dup_timer);
   tcase_add_test (tc_chain, test_timer_queue_timer_offset);
+  tcase_add_test (tc_chain, test_timer_queue_wheel_order);
 
   return s;
 }
@@ -0,0 +1,180 @@
+/* GStreamer
+ *
+ * unit test for scaletempo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <math.h>
+
+#include <gst/audio/audio.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#define RATE 48000
+#define N_FRAMES RATE
+
+/* At 48kHz and with the default stride and overlap, the best overlap is
+ * searched with the FFT for the default search length of 14ms, and with
+ * the direct correlation for 4ms */
+#define SEARCH_FFT 14
+#define SEARCH_DIRECT 4
+
+static gint16 input[N_FRAMES];
+
+static void
+make_input (void)
+{
+  GRand *rand = g_rand_new_with_seed (1234);
+  gint i;
+
+  for (i = 0; i < N_FRAMES; i++) {
+    gdouble v = 0.4 * sin (2 * G_PI * 440 * i / RATE) +
+        0.3 * sin (2 * G_PI * 1234.5 * i / RATE + 1.0) +
+        g_rand_double_range (rand, -0.05, 0.05);
+
+    input[i] = lrint (v * 32767);
+  }
+  g_rand_free (rand);
+}
+
+/* Returns the output for the input in @format with every channel
+ * carrying the same signal */
+static GstBuffer *
+run_scaletempo (GstAudioFormat format, gint channels, guint search)
+{
+  GstHarness *h = gst_harness_new ("scaletempo");
+  GstSegment segment;
+  GstAudioInfo info;
+  GstBuffer *buf;
+  GstMapInfo map;
+  GstCaps *caps;
+  gint i, c;
+
+  g_object_set (h->element, "search", search, NULL);
+
+  gst_audio_info_set_format (&info, format, RATE, channels, NULL);
+  caps = gst_audio_info_to_caps (&info);
+  gst_harness_set_caps (h, gst_caps_ref (caps), caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.rate = 1.5;
+  fail_unless (gst_harness_push_event (h, gst_event_new_segment (&segment)));
+
+  buf = gst_buffer_new_allocate (NULL, N_FRAMES * GST_AUDIO_INFO_BPF (&info),
+      NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  for (i = 0; i < N_FRAMES; i++) {
+    for (c = 0; c < channels; c++) {
+      if (format == GST_AUDIO_FORMAT_S16)
+        ((gint16 *) map.data)[i * channels + c] = input[i];
+      else
+        ((gfloat *) map.data)[i * channels + c] = input[i] / 32768.0f;
+    }
+  }
+  gst_buffer_unmap (buf, &map);
+  GST_BUFFER_PTS (buf) = 0;
+  GST_BUFFER_DURATION (buf) = GST_SECOND;
+
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  buf = gst_harness_take_all_data_as_buffer (h);
+  gst_harness_teardown (h);
+
+  return buf;
+}
+
+/* The downmix for the correlation only scales the signal by powers of two
+ * here, which doesn't change the best overlap offset. The output of every
+ * channel has to be the one of the mono F32 conversion. */
+static void
+check_formats (guint search)
+{
+  static const gint n_channels[] = { 2, 4 };
+  GstBuffer *ref, *buf;
+  GstMapInfo ref_map, map;
+  const gfloat *r;
+  gsize n_out;
+  guint i, j, c;
+
+  ref = run_scaletempo (GST_AUDIO_FORMAT_F32, 1, search);
+  gst_buffer_map (ref, &ref_map, GST_MAP_READ);
+  r = (const gfloat *) ref_map.data;
+  n_out = ref_map.size / sizeof (gfloat);
+  /* 1s at rate 1.5, minus the latency */
+  fail_unless (n_out > N_FRAMES / 2);
+
+  for (j = 0; j < G_N_ELEMENTS (n_channels); j++) {
+    const gfloat *f;
+
+    buf = run_scaletempo (GST_AUDIO_FORMAT_F32, n_channels[j], search);
+    gst_buffer_map (buf, &map, GST_MAP_READ);
+    fail_unless_equals_uint64 (map.size, ref_map.size * n_channels[j]);
+    f = (const gfloat *) map.data;
+    for (i = 0; i < n_out; i++) {
+      for (c = 0; c < n_channels[j]; c++)
+        fail_unless_equals_float (f[i * n_channels[j] + c], r[i]);
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+
+  /* S16 blends the overlap in fixed point */
+  buf = run_scaletempo (GST_AUDIO_FORMAT_S16, 1, search);
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_uint64 (map.size, n_out * sizeof (gint16));
+  for (i = 0; i < n_out; i++) {
+    gint16 s = ((const gint16 *) map.data)[i];
+
+    fail_unless (fabs (s - r[i] * 32768.0) <= 2.0,
+        "sample %u: %d != %f", i, s, r[i] * 32768.0);
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  gst_buffer_unmap (ref, &ref_map);
+  gst_buffer_unref (ref);
+}
+
+GST_START_TEST (test_formats_fft)
+{
+  make_input ();
+  check_formats (SEARCH_FFT);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_formats_direct)
+{
+  make_input ();
+  check_formats (SEARCH_DIRECT);
+}
+
+GST_END_TEST;
+
+static Suite *
+scaletempo_suite (void)
+{
+  Suite *s = suite_create ("scaletempo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_formats_fft);
+  tcase_add_test (tc_chain, test_formats_direct);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scaletempo);
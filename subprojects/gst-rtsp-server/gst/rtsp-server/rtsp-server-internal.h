@@ -40,12 +40,22 @@ gboolean                 gst_rtsp_stream_transport_backlog_pop   (GstRTSPStreamT
                                                                   GstBufferList **buffer_list,
                                                                   gboolean *is_rtp);
 
+gboolean                 gst_rtsp_stream_transport_backlog_pop_batch (GstRTSPStreamTransport *trans,
+                                                                  GstBuffer **buffer,
+                                                                  GstBufferList **buffer_list,
+                                                                  gboolean *is_rtp);
+
 gboolean                 gst_rtsp_stream_transport_backlog_peek_is_rtp (GstRTSPStreamTransport * trans);
 
 gboolean                 gst_rtsp_stream_transport_backlog_is_empty (GstRTSPStreamTransport *trans);
 
 void                     gst_rtsp_stream_transport_clear_backlog (GstRTSPStreamTransport * trans);
 
+void                     gst_rtsp_stream_transport_set_backlog_limits (GstRTSPStreamTransport * trans,
+                                                                  guint64 max_bytes,
+                                                                  GstClockTime max_duration,
+                                                                  GstRTSPBacklogPolicy policy);
+
 void                     gst_rtsp_stream_transport_lock_backlog  (GstRTSPStreamTransport * trans);
 
 void                     gst_rtsp_stream_transport_unlock_backlog (GstRTSPStreamTransport * trans);
@@ -150,6 +150,12 @@ void                  gst_rtsp_server_set_thread_pool      (GstRTSPServer *serve
 GST_RTSP_SERVER_API
 GstRTSPThreadPool *   gst_rtsp_server_get_thread_pool      (GstRTSPServer *server);
 
+GST_RTSP_SERVER_API
+void                  gst_rtsp_server_set_accept_threads   (GstRTSPServer *server, guint accept_threads);
+
+GST_RTSP_SERVER_API
+guint                 gst_rtsp_server_get_accept_threads   (GstRTSPServer *server);
+
 GST_RTSP_SERVER_API
 gboolean              gst_rtsp_server_transfer_connection  (GstRTSPServer * server, GSocket *socket,
                                                             const gchar * ip, gint port,
@@ -50,6 +50,12 @@
  * The server uses the configured #GstRTSPThreadPool object to handle the
  * remainder of the communication with this client.
  *
+ * With gst_rtsp_server_set_accept_threads(), the server opens additional
+ * listening sockets on the same port with SO_REUSEPORT, each one handled by
+ * its own thread. The kernel spreads the incoming connections over the
+ * sockets, and the clients accepted in one of these threads are handled by
+ * that thread for their whole lifetime instead of by the #GstRTSPThreadPool.
+ *
  * Last reviewed on 2013-07-11 (1.0.0)
  */
 #ifdef HAVE_CONFIG_H
@@ -59,6 +65,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <gio/gnetworking.h>
+
 #include "rtsp-context.h"
 #include "rtsp-server-object.h"
 #include "rtsp-client.h"
@@ -93,6 +101,10 @@ struct _GstRTSPServerPrivate
   /* resource manager */
   GstRTSPThreadPool *thread_pool;
 
+  /* extra SO_REUSEPORT listeners and the sources accepting on them */
+  guint accept_threads;
+  GPtrArray *accept_sources;
+
   /* the clients that are connected */
   GList *clients;
   guint clients_cookie;
@@ -103,6 +115,7 @@ struct _GstRTSPServerPrivate
 /* #define DEFAULT_ADDRESS         "::0" */
 #define DEFAULT_SERVICE         "8554"
 #define DEFAULT_BACKLOG         5
+#define DEFAULT_ACCEPT_THREADS  0
 
 /* Define to use the SO_LINGER option so that the server sockets can be resused
  * sooner. Disabled for now because it is not very well implemented by various
@@ -120,6 +133,7 @@ enum
   PROP_SESSION_POOL,
   PROP_MOUNT_POINTS,
   PROP_CONTENT_LENGTH_LIMIT,
+  PROP_ACCEPT_THREADS,
   PROP_LAST
 };
 
@@ -135,6 +149,7 @@ GST_DEBUG_CATEGORY_STATIC (rtsp_server_debug);
 #define GST_CAT_DEFAULT rtsp_server_debug
 
 typedef struct _ClientContext ClientContext;
+typedef struct _AcceptSource AcceptSource;
 
 static guint gst_rtsp_server_signals[SIGNAL_LAST] = { 0 };
 
@@ -240,6 +255,26 @@ gst_rtsp_server_class_init (GstRTSPServerClass * klass)
           "Limitation of Content-Length",
           0, G_MAXUINT, G_MAXUINT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRTSPServer::accept-threads:
+   *
+   * The number of additional threads accepting connections on their own
+   * SO_REUSEPORT socket. Clients stay in the thread that accepted them.
+   *
+   * These threads are not taken from the #GstRTSPThreadPool. A custom thread
+   * pool set with gst_rtsp_server_set_thread_pool() is not used for the
+   * clients they accept, and the #GstRTSPThreadPool:max-threads limit does
+   * not apply to them. Only the clients accepted on the main socket go
+   * through the thread pool.
+   *
+   * Since: 1.26
+   */
+  g_object_class_install_property (gobject_class, PROP_ACCEPT_THREADS,
+      g_param_spec_uint ("accept-threads", "Accept Threads",
+          "Number of extra threads that accept and handle clients on their "
+          "own listening socket (0 = disabled)", 0, G_MAXINT,
+          DEFAULT_ACCEPT_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_rtsp_server_signals[SIGNAL_CLIENT_CONNECTED] =
       g_signal_new ("client-connected", G_TYPE_FROM_CLASS (gobject_class),
       G_SIGNAL_RUN_LAST, G_STRUCT_OFFSET (GstRTSPServerClass, client_connected),
@@ -266,6 +301,7 @@ gst_rtsp_server_init (GstRTSPServer * server)
   priv->mount_points = gst_rtsp_mount_points_new ();
   priv->content_length_limit = G_MAXUINT;
   priv->thread_pool = gst_rtsp_thread_pool_new ();
+  priv->accept_threads = DEFAULT_ACCEPT_THREADS;
 }
 
 static void
@@ -782,6 +818,64 @@ gst_rtsp_server_get_thread_pool (GstRTSPServer * server)
   return result;
 }
 
+/**
+ * gst_rtsp_server_set_accept_threads:
+ * @server: a #GstRTSPServer
+ * @accept_threads: the number of extra accepting threads
+ *
+ * Configure @server to listen with @accept_threads additional sockets bound
+ * to the same port with SO_REUSEPORT, each one dispatched from its own
+ * thread. Clients accepted on such a socket are handled by the thread that
+ * accepted them instead of by the #GstRTSPThreadPool of @server, so neither
+ * a custom thread pool nor its #GstRTSPThreadPool:max-threads apply to them.
+ *
+ * This function must be called before the server is attached. It has no
+ * effect on platforms without SO_REUSEPORT.
+ *
+ * Since: 1.26
+ */
+void
+gst_rtsp_server_set_accept_threads (GstRTSPServer * server,
+    guint accept_threads)
+{
+  GstRTSPServerPrivate *priv;
+
+  g_return_if_fail (GST_IS_RTSP_SERVER (server));
+
+  priv = server->priv;
+
+  GST_RTSP_SERVER_LOCK (server);
+  priv->accept_threads = accept_threads;
+  GST_RTSP_SERVER_UNLOCK (server);
+}
+
+/**
+ * gst_rtsp_server_get_accept_threads:
+ * @server: a #GstRTSPServer
+ *
+ * Get the number of extra accepting threads of @server.
+ *
+ * Returns: the number of extra accepting threads.
+ *
+ * Since: 1.26
+ */
+guint
+gst_rtsp_server_get_accept_threads (GstRTSPServer * server)
+{
+  GstRTSPServerPrivate *priv;
+  guint result;
+
+  g_return_val_if_fail (GST_IS_RTSP_SERVER (server), 0);
+
+  priv = server->priv;
+
+  GST_RTSP_SERVER_LOCK (server);
+  result = priv->accept_threads;
+  GST_RTSP_SERVER_UNLOCK (server);
+
+  return result;
+}
+
 static void
 gst_rtsp_server_get_property (GObject * object, guint propid,
     GValue * value, GParamSpec * pspec)
@@ -811,6 +905,9 @@ gst_rtsp_server_get_property (GObject * object, guint propid,
       g_value_set_uint (value,
           gst_rtsp_server_get_content_length_limit (server));
       break;
+    case PROP_ACCEPT_THREADS:
+      g_value_set_uint (value, gst_rtsp_server_get_accept_threads (server));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, propid, pspec);
   }
@@ -842,6 +939,9 @@ gst_rtsp_server_set_property (GObject * object, guint propid,
       gst_rtsp_server_set_content_length_limit (server,
           g_value_get_uint (value));
       break;
+    case PROP_ACCEPT_THREADS:
+      gst_rtsp_server_set_accept_threads (server, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, propid, pspec);
   }
@@ -920,6 +1020,12 @@ gst_rtsp_server_create_socket (GstRTSPServer * server,
       g_object_unref (sockaddr);
       continue;
     }
+#ifdef SO_REUSEPORT
+    /* the accept threads listen on the same port */
+    if (priv->accept_threads > 0 &&
+        !g_socket_set_option (socket, SOL_SOCKET, SO_REUSEPORT, TRUE, NULL))
+      GST_WARNING_OBJECT (server, "failed to set SO_REUSEPORT");
+#endif
 
     if (g_socket_bind (socket, sockaddr, TRUE, bind_error ? NULL : &bind_error)) {
       /* ask what port the socket has been bound to */
@@ -1049,6 +1155,13 @@ struct _ClientContext
   GstRTSPClient *client;
 };
 
+/* the callback data of a listening source of an accept thread */
+struct _AcceptSource
+{
+  GstRTSPServer *server;
+  GstRTSPThread *thread;
+};
+
 static gboolean
 free_client_context (ClientContext * ctx)
 {
@@ -1092,9 +1205,11 @@ unmanage_client (GstRTSPClient * client, ClientContext * ctx)
 }
 
 /* add the client context to the active list of clients, takes ownership
- * of client */
+ * of client. Clients accepted in one of the accept threads stay in
+ * @accept_thread */
 static void
-manage_client (GstRTSPServer * server, GstRTSPClient * client)
+manage_client (GstRTSPServer * server, GstRTSPClient * client,
+    GstRTSPThread * accept_thread)
 {
   ClientContext *cctx;
   GstRTSPServerPrivate *priv = server->priv;
@@ -1115,8 +1230,11 @@ manage_client (GstRTSPServer * server, GstRTSPClient * client)
   ctx.server = server;
   ctx.client = client;
 
-  cctx->thread = gst_rtsp_thread_pool_get_thread (priv->thread_pool,
-      GST_RTSP_THREAD_TYPE_CLIENT, &ctx);
+  if (accept_thread && gst_rtsp_thread_reuse (accept_thread))
+    cctx->thread = accept_thread;
+  else
+    cctx->thread = gst_rtsp_thread_pool_get_thread (priv->thread_pool,
+        GST_RTSP_THREAD_TYPE_CLIENT, &ctx);
   if (cctx->thread)
     mainctx = cctx->thread->context;
   else {
@@ -1200,7 +1318,7 @@ gst_rtsp_server_transfer_connection (GstRTSPServer * server, GSocket * socket,
   gst_rtsp_client_set_connection (client, conn);
 
   /* manage the client connection */
-  manage_client (server, client);
+  manage_client (server, client, NULL);
 
   return TRUE;
 
@@ -1222,20 +1340,11 @@ no_connection:
   }
 }
 
-/**
- * gst_rtsp_server_io_func:
- * @socket: a #GSocket
- * @condition: the condition on @source
- * @server: (transfer none): a #GstRTSPServer
- *
- * A default #GSocketSourceFunc that creates a new #GstRTSPClient to accept and handle a
- * new connection on @socket or @server.
- *
- * Returns: TRUE if the source could be connected, FALSE if an error occurred.
- */
-gboolean
-gst_rtsp_server_io_func (GSocket * socket, GIOCondition condition,
-    GstRTSPServer * server)
+/* accepts a new connection on @socket, clients accepted in one of the accept
+ * threads are passed that thread as @accept_thread */
+static gboolean
+accept_client (GstRTSPServer * server, GSocket * socket,
+    GIOCondition condition, GstRTSPThread * accept_thread)
 {
   GstRTSPServerPrivate *priv = server->priv;
   GstRTSPClient *client = NULL;
@@ -1268,7 +1377,7 @@ gst_rtsp_server_io_func (GSocket * socket, GIOCondition condition,
     gst_rtsp_client_set_connection (client, conn);
 
     /* manage the client connection */
-    manage_client (server, client);
+    manage_client (server, client, accept_thread);
   } else {
     GST_WARNING_OBJECT (server, "received unknown event %08x", condition);
     goto exit_no_ctx;
@@ -1303,13 +1412,183 @@ client_failed:
   }
 }
 
+/**
+ * gst_rtsp_server_io_func:
+ * @socket: a #GSocket
+ * @condition: the condition on @source
+ * @server: (transfer none): a #GstRTSPServer
+ *
+ * A default #GSocketSourceFunc that creates a new #GstRTSPClient to accept and handle a
+ * new connection on @socket or @server.
+ *
+ * Returns: TRUE if the source could be connected, FALSE if an error occurred.
+ */
+gboolean
+gst_rtsp_server_io_func (GSocket * socket, GIOCondition condition,
+    GstRTSPServer * server)
+{
+  return accept_client (server, socket, condition, NULL);
+}
+
+static gboolean
+accept_source_io_func (GSocket * socket, GIOCondition condition,
+    AcceptSource * asrc)
+{
+  return accept_client (asrc->server, socket, condition, asrc->thread);
+}
+
+static void
+free_accept_source (AcceptSource * asrc)
+{
+  /* the mainloop keeps running until the clients of the thread are gone */
+  gst_rtsp_thread_stop (asrc->thread);
+  g_object_unref (asrc->server);
+  g_free (asrc);
+}
+
+static void
+destroy_accept_source (GSource * source)
+{
+  g_source_destroy (source);
+  g_source_unref (source);
+}
+
+static gpointer
+accept_thread_loop (GstRTSPThread * thread)
+{
+  g_main_context_push_thread_default (thread->context);
+
+  GST_INFO ("enter mainloop of accept thread %p", thread);
+  g_main_loop_run (thread->loop);
+  GST_INFO ("exit mainloop of accept thread %p", thread);
+
+  g_main_context_pop_thread_default (thread->context);
+  gst_rtsp_thread_unref (thread);
+
+  return NULL;
+}
+
+static GstRTSPThread *
+start_accept_thread (guint index, GError ** error)
+{
+  GstRTSPThread *thread;
+  GThread *t;
+  gchar *name;
+
+  thread = gst_rtsp_thread_new (GST_RTSP_THREAD_TYPE_CLIENT);
+
+  name = g_strdup_printf ("rtsp-accept-%u", index);
+  t = g_thread_try_new (name, (GThreadFunc) accept_thread_loop,
+      gst_rtsp_thread_ref (thread), error);
+  g_free (name);
+
+  if (t == NULL) {
+    /* also drop the ref of the mainloop */
+    gst_rtsp_thread_unref (thread);
+    gst_rtsp_thread_unref (thread);
+    return NULL;
+  }
+  g_thread_unref (t);
+
+  return thread;
+}
+
+/* open the extra SO_REUSEPORT sockets and start a thread accepting on each
+ * of them */
+static gboolean
+start_accept_threads (GstRTSPServer * server, GCancellable * cancellable,
+    GError ** error)
+{
+  GstRTSPServerPrivate *priv = server->priv;
+  GPtrArray *sources, *old;
+  guint i, n_threads;
+
+  GST_RTSP_SERVER_LOCK (server);
+  n_threads = priv->accept_threads;
+  GST_RTSP_SERVER_UNLOCK (server);
+
+#ifndef SO_REUSEPORT
+  if (n_threads > 0) {
+    GST_WARNING_OBJECT (server, "SO_REUSEPORT is not supported, not starting "
+        "%u accept threads", n_threads);
+    n_threads = 0;
+  }
+#endif
+
+  if (n_threads == 0)
+    return TRUE;
+
+  sources = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      destroy_accept_source);
+
+  for (i = 0; i < n_threads; i++) {
+    AcceptSource *asrc;
+    GstRTSPThread *thread;
+    GSocket *socket;
+    GSource *source;
+
+    socket = gst_rtsp_server_create_socket (server, cancellable, error);
+    if (socket == NULL)
+      goto failed;
+
+    thread = start_accept_thread (i, error);
+    if (thread == NULL) {
+      g_object_unref (socket);
+      goto failed;
+    }
+
+    asrc = g_new0 (AcceptSource, 1);
+    asrc->server = g_object_ref (server);
+    asrc->thread = thread;
+
+    source = g_socket_create_source (socket, G_IO_IN |
+        G_IO_ERR | G_IO_HUP | G_IO_NVAL, cancellable);
+    g_object_unref (socket);
+
+    g_source_set_callback (source, (GSourceFunc) accept_source_io_func, asrc,
+        (GDestroyNotify) free_accept_source);
+    g_source_attach (source, thread->context);
+    g_ptr_array_add (sources, source);
+  }
+
+  GST_DEBUG_OBJECT (server, "started %u accept threads", n_threads);
+
+  GST_RTSP_SERVER_LOCK (server);
+  old = priv->accept_sources;
+  priv->accept_sources = sources;
+  GST_RTSP_SERVER_UNLOCK (server);
+
+  if (old)
+    g_ptr_array_unref (old);
+
+  return TRUE;
+
+  /* ERRORS */
+failed:
+  {
+    GST_ERROR_OBJECT (server, "failed to start accept thread %u", i);
+    g_ptr_array_unref (sources);
+    return FALSE;
+  }
+}
+
 static void
 watch_destroyed (GstRTSPServer * server)
 {
   GstRTSPServerPrivate *priv = server->priv;
+  GPtrArray *accept_sources;
 
   GST_DEBUG_OBJECT (server, "source destroyed");
 
+  /* stop accepting in the accept threads too */
+  GST_RTSP_SERVER_LOCK (server);
+  accept_sources = priv->accept_sources;
+  priv->accept_sources = NULL;
+  GST_RTSP_SERVER_UNLOCK (server);
+
+  if (accept_sources)
+    g_ptr_array_unref (accept_sources);
+
   g_object_unref (priv->socket);
   priv->socket = NULL;
   g_object_unref (server);
@@ -1331,6 +1610,10 @@ watch_destroyed (GstRTSPServer * server)
  *
  * This takes a reference on @server until @source is destroyed.
  *
+ * When #GstRTSPServer:accept-threads is set, this also opens the extra
+ * listening sockets and starts their threads. They stop accepting new
+ * connections when @source is destroyed.
+ *
  * Returns: (transfer full): the #GSource for @server or %NULL when an error
  * occurred. Free with g_source_unref ()
  */
@@ -1350,6 +1633,9 @@ gst_rtsp_server_create_source (GstRTSPServer * server,
   if (socket == NULL)
     goto no_socket;
 
+  if (!start_accept_threads (server, cancellable, error))
+    goto no_accept_threads;
+
   GST_RTSP_SERVER_LOCK (server);
   old = priv->socket;
   priv->socket = g_object_ref (socket);
@@ -1375,6 +1661,12 @@ no_socket:
     GST_ERROR_OBJECT (server, "failed to create socket");
     return NULL;
   }
+no_accept_threads:
+  {
+    GST_ERROR_OBJECT (server, "failed to start accept threads");
+    g_object_unref (socket);
+    return NULL;
+  }
 }
 
 /**
@@ -89,17 +89,26 @@ struct _GstRTSPStreamTransportPrivate
   /* TCP backlog */
   GstClockTime first_rtp_timestamp;
   GstVecDeque *items;
+  gsize backlog_bytes;
+  guint64 max_backlog_bytes;
+  GstClockTime max_backlog_duration;
+  GstRTSPBacklogPolicy backlog_policy;
   GRecMutex backlog_lock;
 };
 
 #define MAX_BACKLOG_DURATION (10 * GST_SECOND)
+/* the duration limit only applies to backlogs with more items than this, so
+ * that a few large frames are not mistaken for a slow client */
 #define MAX_BACKLOG_SIZE 100
+/* maximum number of buffers merged into one data message list */
+#define MAX_BACKLOG_BATCH 32
 
 typedef struct
 {
   GstBuffer *buffer;
   GstBufferList *buffer_list;
   gboolean is_rtp;
+  gsize size;
 } BackLogItem;
 
 
@@ -143,6 +152,8 @@ gst_rtsp_stream_transport_init (GstRTSPStreamTransport * trans)
   trans->priv = gst_rtsp_stream_transport_get_instance_private (trans);
   trans->priv->items = gst_vec_deque_new_for_struct (sizeof (BackLogItem), 0);
   trans->priv->first_rtp_timestamp = GST_CLOCK_TIME_NONE;
+  trans->priv->max_backlog_duration = MAX_BACKLOG_DURATION;
+  trans->priv->backlog_policy = GST_RTSP_BACKLOG_POLICY_DROP_CLIENT;
   gst_vec_deque_set_clear_func (trans->priv->items,
       (GDestroyNotify) clear_backlog_item);
   g_rec_mutex_init (&trans->priv->backlog_lock);
@@ -870,48 +881,118 @@ get_first_backlog_timestamp (GstRTSPStreamTransport * trans)
   return ret;
 }
 
+static GstClockTime
+get_last_backlog_timestamp (GstRTSPStreamTransport * trans)
+{
+  GstRTSPStreamTransportPrivate *priv = trans->priv;
+  GstClockTime ret = GST_CLOCK_TIME_NONE;
+  guint i;
+
+  for (i = gst_vec_deque_get_length (priv->items); i > 0; i--) {
+    BackLogItem *item = (BackLogItem *)
+        gst_vec_deque_peek_nth_struct (priv->items, i - 1);
+
+    if (item->is_rtp) {
+      ret = get_backlog_item_timestamp (item);
+      break;
+    }
+  }
+
+  return ret;
+}
+
+static gboolean
+backlog_is_full (GstRTSPStreamTransport * trans)
+{
+  GstRTSPStreamTransportPrivate *priv = trans->priv;
+  GstClockTime last_rtp_timestamp;
+
+  if (priv->max_backlog_bytes != 0 &&
+      priv->backlog_bytes > priv->max_backlog_bytes)
+    return TRUE;
+
+  if (!GST_CLOCK_TIME_IS_VALID (priv->max_backlog_duration) ||
+      !GST_CLOCK_TIME_IS_VALID (priv->first_rtp_timestamp) ||
+      gst_vec_deque_get_length (priv->items) <= MAX_BACKLOG_SIZE)
+    return FALSE;
+
+  last_rtp_timestamp = get_last_backlog_timestamp (trans);
+
+  return GST_CLOCK_DIFF (priv->first_rtp_timestamp, last_rtp_timestamp) >
+      (GstClockTimeDiff) priv->max_backlog_duration;
+}
+
+static void
+drop_backlog_item (GstRTSPStreamTransport * trans, BackLogItem * item)
+{
+  trans->priv->backlog_bytes -= item->size;
+  clear_backlog_item (item);
+}
+
 /* Not MT-safe, caller should ensure consistent locking (see
  * gst_rtsp_stream_transport_lock_backlog()). Ownership
- * of @buffer and @buffer_list is transfered to the transport */
+ * of @buffer and @buffer_list is transfered to the transport.
+ *
+ * Returns FALSE when the backlog is over its limits and the
+ * policy is to drop the client */
 gboolean
 gst_rtsp_stream_transport_backlog_push (GstRTSPStreamTransport * trans,
     GstBuffer * buffer, GstBufferList * buffer_list, gboolean is_rtp)
 {
-  gboolean ret = TRUE;
   BackLogItem item = { 0, };
-  GstClockTime item_timestamp;
   GstRTSPStreamTransportPrivate *priv;
+  guint dropped = 0;
 
   priv = trans->priv;
 
-  if (buffer)
+  if (buffer) {
     item.buffer = buffer;
-  if (buffer_list)
+    item.size = gst_buffer_get_size (buffer);
+  }
+  if (buffer_list) {
     item.buffer_list = buffer_list;
+    item.size += gst_buffer_list_calculate_size (buffer_list);
+  }
   item.is_rtp = is_rtp;
 
   gst_vec_deque_push_tail_struct (priv->items, &item);
+  priv->backlog_bytes += item.size;
+
+  if (is_rtp && priv->first_rtp_timestamp == GST_CLOCK_TIME_NONE)
+    priv->first_rtp_timestamp = get_backlog_item_timestamp (&item);
+
+  if (!backlog_is_full (trans))
+    return TRUE;
+
+  switch (priv->backlog_policy) {
+    case GST_RTSP_BACKLOG_POLICY_DROP_CLIENT:
+      return FALSE;
+    case GST_RTSP_BACKLOG_POLICY_DROP_NEWEST:
+      /* a single item larger than the limit is still sent */
+      if (gst_vec_deque_get_length (priv->items) > 1) {
+        drop_backlog_item (trans, gst_vec_deque_pop_tail_struct (priv->items));
+        dropped++;
+      }
+      break;
+    case GST_RTSP_BACKLOG_POLICY_DROP_OLDEST:
+      /* always keep the item we just queued */
+      while (gst_vec_deque_get_length (priv->items) > 1) {
+        drop_backlog_item (trans, gst_vec_deque_pop_head_struct (priv->items));
+        dropped++;
+        priv->first_rtp_timestamp = get_first_backlog_timestamp (trans);
+        if (!backlog_is_full (trans))
+          break;
+      }
+      break;
+  }
 
-  item_timestamp = get_backlog_item_timestamp (&item);
-
-  if (is_rtp && priv->first_rtp_timestamp != GST_CLOCK_TIME_NONE) {
-    GstClockTimeDiff queue_duration;
-
-    g_assert (GST_CLOCK_TIME_IS_VALID (item_timestamp));
-
-    queue_duration = GST_CLOCK_DIFF (priv->first_rtp_timestamp, item_timestamp);
-
-    g_assert (queue_duration >= 0);
+  priv->first_rtp_timestamp = get_first_backlog_timestamp (trans);
 
-    if (queue_duration > MAX_BACKLOG_DURATION &&
-        gst_vec_deque_get_length (priv->items) > MAX_BACKLOG_SIZE) {
-      ret = FALSE;
-    }
-  } else if (is_rtp) {
-    priv->first_rtp_timestamp = item_timestamp;
-  }
+  GST_LOG_OBJECT (trans, "dropped %u backlog items, now %u items of %"
+      G_GSIZE_FORMAT " bytes", dropped, gst_vec_deque_get_length (priv->items),
+      priv->backlog_bytes);
 
-  return ret;
+  return TRUE;
 }
 
 /* Not MT-safe, caller should ensure consistent locking (see
@@ -931,6 +1012,7 @@ gst_rtsp_stream_transport_backlog_pop (GstRTSPStreamTransport * trans,
   priv = trans->priv;
 
   item = (BackLogItem *) gst_vec_deque_pop_head_struct (priv->items);
+  priv->backlog_bytes -= item->size;
 
   priv->first_rtp_timestamp = get_first_backlog_timestamp (trans);
 
@@ -950,6 +1032,83 @@ gst_rtsp_stream_transport_backlog_pop (GstRTSPStreamTransport * trans,
   return TRUE;
 }
 
+/* Not MT-safe, caller should ensure consistent locking (see
+ * gst_rtsp_stream_transport_lock_backlog()).
+ *
+ * Like gst_rtsp_stream_transport_backlog_pop(), but when the transport can
+ * send buffer lists, the consecutive RTP or RTCP items at the head of the
+ * backlog are merged into one @buffer_list so that the client writes them
+ * out with a single data message batch. The buffers are only reffed. */
+gboolean
+gst_rtsp_stream_transport_backlog_pop_batch (GstRTSPStreamTransport * trans,
+    GstBuffer ** buffer, GstBufferList ** buffer_list, gboolean * is_rtp)
+{
+  GstRTSPStreamTransportPrivate *priv;
+  BackLogItem *item;
+  GstBufferList *list;
+  gboolean rtp;
+  guint n_items, n_buffers = 0;
+
+  g_return_val_if_fail (!gst_rtsp_stream_transport_backlog_is_empty (trans),
+      FALSE);
+  g_return_val_if_fail (buffer != NULL && buffer_list != NULL
+      && is_rtp != NULL, FALSE);
+
+  priv = trans->priv;
+
+  n_items = gst_vec_deque_get_length (priv->items);
+  item = (BackLogItem *) gst_vec_deque_peek_head_struct (priv->items);
+  rtp = item->is_rtp;
+
+  if (n_items == 1 || (rtp ? priv->send_rtp_list : priv->send_rtcp_list) == NULL
+      || ((BackLogItem *) gst_vec_deque_peek_nth_struct (priv->items,
+              1))->is_rtp != rtp)
+    return gst_rtsp_stream_transport_backlog_pop (trans, buffer, buffer_list,
+        is_rtp);
+
+  list = gst_buffer_list_new_sized (MAX_BACKLOG_BATCH);
+
+  while (!gst_vec_deque_is_empty (priv->items)) {
+    guint len;
+
+    item = (BackLogItem *) gst_vec_deque_peek_head_struct (priv->items);
+    if (item->is_rtp != rtp)
+      break;
+
+    len = item->buffer ? 1 : 0;
+    if (item->buffer_list)
+      len += gst_buffer_list_length (item->buffer_list);
+    if (n_buffers > 0 && n_buffers + len > MAX_BACKLOG_BATCH)
+      break;
+
+    item = (BackLogItem *) gst_vec_deque_pop_head_struct (priv->items);
+    priv->backlog_bytes -= item->size;
+
+    if (item->buffer)
+      gst_buffer_list_add (list, item->buffer);
+    if (item->buffer_list) {
+      guint i;
+
+      for (i = 0; i < gst_buffer_list_length (item->buffer_list); i++)
+        gst_buffer_list_add (list,
+            gst_buffer_ref (gst_buffer_list_get (item->buffer_list, i)));
+      gst_buffer_list_unref (item->buffer_list);
+    }
+    n_buffers += len;
+  }
+
+  priv->first_rtp_timestamp = get_first_backlog_timestamp (trans);
+
+  GST_LOG_OBJECT (trans, "popped %u %s buffers", n_buffers,
+      rtp ? "RTP" : "RTCP");
+
+  *buffer = NULL;
+  *buffer_list = list;
+  *is_rtp = rtp;
+
+  return TRUE;
+}
+
 /* Not MT-safe, caller should ensure consistent locking.
  * See gst_rtsp_stream_transport_lock_backlog() */
 gboolean
@@ -987,6 +1146,22 @@ gst_rtsp_stream_transport_clear_backlog (GstRTSPStreamTransport * trans)
   }
 }
 
+/* Not MT-safe, caller should ensure consistent locking.
+ * See gst_rtsp_stream_transport_lock_backlog()
+ *
+ * A @max_bytes of 0 and a @max_duration of GST_CLOCK_TIME_NONE disable the
+ * respective limit. @policy is applied when a push exceeds a limit. */
+void
+gst_rtsp_stream_transport_set_backlog_limits (GstRTSPStreamTransport * trans,
+    guint64 max_bytes, GstClockTime max_duration, GstRTSPBacklogPolicy policy)
+{
+  GstRTSPStreamTransportPrivate *priv = trans->priv;
+
+  priv->max_backlog_bytes = max_bytes;
+  priv->max_backlog_duration = max_duration;
+  priv->backlog_policy = policy;
+}
+
 /* Internal API, protects access to the TCP backlog. Safe to
  * call recursively */
 void
@@ -62,7 +62,14 @@
  * are then popped from that backlog when the transport reports it has sent the message.
  *
  * Once the backlog reaches an overly large duration, the transport is dropped as
- * the client was deemed too slow.
+ * the client was deemed too slow. The limits can be changed with
+ * gst_rtsp_stream_set_backlog_limits(), and with gst_rtsp_stream_set_backlog_policy()
+ * the oldest or newest packets can be dropped instead of the client.
+ *
+ * The samples are shared by all transports, only references to the buffers are
+ * queued. When the client can send buffer lists, consecutive RTP or RTCP packets
+ * in the backlog are handed over together so that they are written to the
+ * connection with one vectored write.
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -202,6 +209,11 @@ struct _GstRTSPStreamPrivate
   /* Used to control shutdown of @send_thread */
   gboolean continue_sending;
 
+  /* limits of the TCP transports' backlogs */
+  guint64 backlog_max_bytes;
+  GstClockTime backlog_max_duration;
+  GstRTSPBacklogPolicy backlog_policy;
+
   /* stream blocking */
   gulong blocked_id[2];
   gboolean blocking;
@@ -248,6 +260,9 @@ struct _GstRTSPStreamPrivate
 #define DEFAULT_BIND_MCAST_ADDRESS FALSE
 #define DEFAULT_DO_RATE_CONTROL TRUE
 #define DEFAULT_ENABLE_RTCP TRUE
+#define DEFAULT_BACKLOG_MAX_BYTES 0
+#define DEFAULT_BACKLOG_MAX_DURATION (10 * GST_SECOND)
+#define DEFAULT_BACKLOG_POLICY GST_RTSP_BACKLOG_POLICY_DROP_CLIENT
 
 enum
 {
@@ -286,6 +301,29 @@ static guint gst_rtsp_stream_signals[SIGNAL_LAST] = { 0 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GstRTSPStream, gst_rtsp_stream, G_TYPE_OBJECT);
 
+#define C_ENUM(v) ((gint) v)
+
+GType
+gst_rtsp_backlog_policy_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {C_ENUM (GST_RTSP_BACKLOG_POLICY_DROP_CLIENT),
+        "GST_RTSP_BACKLOG_POLICY_DROP_CLIENT", "drop-client"},
+    {C_ENUM (GST_RTSP_BACKLOG_POLICY_DROP_OLDEST),
+        "GST_RTSP_BACKLOG_POLICY_DROP_OLDEST", "drop-oldest"},
+    {C_ENUM (GST_RTSP_BACKLOG_POLICY_DROP_NEWEST),
+        "GST_RTSP_BACKLOG_POLICY_DROP_NEWEST", "drop-newest"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_enum_register_static ("GstRTSPBacklogPolicy", values);
+    g_once_init_leave (&id, tmp);
+  }
+  return (GType) id;
+}
+
 static void
 gst_rtsp_stream_class_init (GstRTSPStreamClass * klass)
 {
@@ -348,6 +386,9 @@ gst_rtsp_stream_init (GstRTSPStream * stream)
   priv->bind_mcast_address = DEFAULT_BIND_MCAST_ADDRESS;
   priv->do_rate_control = DEFAULT_DO_RATE_CONTROL;
   priv->enable_rtcp = DEFAULT_ENABLE_RTCP;
+  priv->backlog_max_bytes = DEFAULT_BACKLOG_MAX_BYTES;
+  priv->backlog_max_duration = DEFAULT_BACKLOG_MAX_DURATION;
+  priv->backlog_policy = DEFAULT_BACKLOG_POLICY;
 
   g_mutex_init (&priv->lock);
 
@@ -2658,8 +2699,8 @@ check_transport_backlog (GstRTSPStream * stream, GstRTSPStreamTransport * trans)
 
     if (!gst_rtsp_stream_transport_check_back_pressure (trans, is_rtp)) {
       popped =
-          gst_rtsp_stream_transport_backlog_pop (trans, &buffer, &buffer_list,
-          &is_rtp);
+          gst_rtsp_stream_transport_backlog_pop_batch (trans, &buffer,
+          &buffer_list, &is_rtp);
 
       g_assert (popped == TRUE);
 
@@ -2740,6 +2781,10 @@ send_tcp_message (GstRTSPStream * stream, gint idx)
       if (buffer_list)
         buflist_ref = gst_buffer_list_ref (buffer_list);
 
+      gst_rtsp_stream_transport_set_backlog_limits (tr,
+          priv->backlog_max_bytes, priv->backlog_max_duration,
+          priv->backlog_policy);
+
       if (!gst_rtsp_stream_transport_backlog_push (tr,
               buf_ref, buflist_ref, is_rtp)) {
         GST_ERROR_OBJECT (stream,
@@ -6555,3 +6600,117 @@ gst_rtsp_stream_set_drop_delta_units (GstRTSPStream * stream, gboolean drop)
   priv->drop_delta_units = drop;
   g_mutex_unlock (&priv->lock);
 }
+
+/**
+ * gst_rtsp_stream_set_backlog_limits:
+ * @stream: a #GstRTSPStream
+ * @max_bytes: the maximum number of bytes in a backlog, or 0 for no limit
+ * @max_duration: the maximum duration of a backlog, or %GST_CLOCK_TIME_NONE
+ *   for no limit
+ *
+ * Set the limits of the backlogs in which packets for TCP transports of @stream
+ * are queued while the client is not ready to receive them. The duration limit
+ * only applies once a backlog holds more than 100 packets.
+ *
+ * When a limit is exceeded, the policy set with
+ * gst_rtsp_stream_set_backlog_policy() is applied.
+ *
+ * Since: 1.26
+ */
+void
+gst_rtsp_stream_set_backlog_limits (GstRTSPStream * stream, guint64 max_bytes,
+    GstClockTime max_duration)
+{
+  GstRTSPStreamPrivate *priv;
+
+  g_return_if_fail (GST_IS_RTSP_STREAM (stream));
+
+  priv = stream->priv;
+
+  g_mutex_lock (&priv->lock);
+  priv->backlog_max_bytes = max_bytes;
+  priv->backlog_max_duration = max_duration;
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * gst_rtsp_stream_get_backlog_limits:
+ * @stream: a #GstRTSPStream
+ * @max_bytes: (out) (optional): the maximum number of bytes in a backlog
+ * @max_duration: (out) (optional): the maximum duration of a backlog
+ *
+ * Get the limits of the backlogs of the TCP transports of @stream.
+ *
+ * Since: 1.26
+ */
+void
+gst_rtsp_stream_get_backlog_limits (GstRTSPStream * stream,
+    guint64 * max_bytes, GstClockTime * max_duration)
+{
+  GstRTSPStreamPrivate *priv;
+
+  g_return_if_fail (GST_IS_RTSP_STREAM (stream));
+
+  priv = stream->priv;
+
+  g_mutex_lock (&priv->lock);
+  if (max_bytes)
+    *max_bytes = priv->backlog_max_bytes;
+  if (max_duration)
+    *max_duration = priv->backlog_max_duration;
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * gst_rtsp_stream_set_backlog_policy:
+ * @stream: a #GstRTSPStream
+ * @policy: a #GstRTSPBacklogPolicy
+ *
+ * Set what happens when the backlog of a TCP transport of @stream exceeds the
+ * limits set with gst_rtsp_stream_set_backlog_limits(). The default is to
+ * remove the transport of the slow client.
+ *
+ * Since: 1.26
+ */
+void
+gst_rtsp_stream_set_backlog_policy (GstRTSPStream * stream,
+    GstRTSPBacklogPolicy policy)
+{
+  GstRTSPStreamPrivate *priv;
+
+  g_return_if_fail (GST_IS_RTSP_STREAM (stream));
+
+  priv = stream->priv;
+
+  g_mutex_lock (&priv->lock);
+  priv->backlog_policy = policy;
+  g_mutex_unlock (&priv->lock);
+}
+
+/**
+ * gst_rtsp_stream_get_backlog_policy:
+ * @stream: a #GstRTSPStream
+ *
+ * Get the policy applied when the backlog of a TCP transport of @stream
+ * exceeds its limits.
+ *
+ * Returns: the #GstRTSPBacklogPolicy of @stream
+ *
+ * Since: 1.26
+ */
+GstRTSPBacklogPolicy
+gst_rtsp_stream_get_backlog_policy (GstRTSPStream * stream)
+{
+  GstRTSPStreamPrivate *priv;
+  GstRTSPBacklogPolicy policy;
+
+  g_return_val_if_fail (GST_IS_RTSP_STREAM (stream), DEFAULT_BACKLOG_POLICY);
+
+  priv = stream->priv;
+
+  g_mutex_lock (&priv->lock);
+  policy = priv->backlog_policy;
+  g_mutex_unlock (&priv->lock);
+
+  return policy;
+}
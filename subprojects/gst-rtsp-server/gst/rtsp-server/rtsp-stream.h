@@ -67,6 +67,26 @@ struct _GstRTSPStreamClass {
   gpointer _gst_reserved[GST_PADDING];
 };
 
+/**
+ * GstRTSPBacklogPolicy:
+ * @GST_RTSP_BACKLOG_POLICY_DROP_CLIENT: Remove the transport of the client
+ * @GST_RTSP_BACKLOG_POLICY_DROP_OLDEST: Drop the oldest queued packets
+ * @GST_RTSP_BACKLOG_POLICY_DROP_NEWEST: Drop the packet that was just queued
+ *
+ * What to do when the backlog of a TCP transport exceeds its limits.
+ *
+ * Since: 1.26
+ */
+typedef enum {
+  GST_RTSP_BACKLOG_POLICY_DROP_CLIENT,
+  GST_RTSP_BACKLOG_POLICY_DROP_OLDEST,
+  GST_RTSP_BACKLOG_POLICY_DROP_NEWEST
+} GstRTSPBacklogPolicy;
+
+#define GST_TYPE_RTSP_BACKLOG_POLICY (gst_rtsp_backlog_policy_get_type())
+GST_RTSP_SERVER_API
+GType gst_rtsp_backlog_policy_get_type (void);
+
 GST_RTSP_SERVER_API
 GType             gst_rtsp_stream_get_type         (void);
 
@@ -368,6 +388,23 @@ gboolean           gst_rtsp_stream_get_rate_control (GstRTSPStream * stream);
 GST_RTSP_SERVER_API
 void               gst_rtsp_stream_unblock_rtcp (GstRTSPStream * stream);
 
+GST_RTSP_SERVER_API
+void               gst_rtsp_stream_set_backlog_limits (GstRTSPStream * stream,
+                                                       guint64 max_bytes,
+                                                       GstClockTime max_duration);
+
+GST_RTSP_SERVER_API
+void               gst_rtsp_stream_get_backlog_limits (GstRTSPStream * stream,
+                                                       guint64 * max_bytes,
+                                                       GstClockTime * max_duration);
+
+GST_RTSP_SERVER_API
+void               gst_rtsp_stream_set_backlog_policy (GstRTSPStream * stream,
+                                                       GstRTSPBacklogPolicy policy);
+
+GST_RTSP_SERVER_API
+GstRTSPBacklogPolicy gst_rtsp_stream_get_backlog_policy (GstRTSPStream * stream);
+
 /**
  * GstRTSPStreamTransportFilterFunc:
  * @stream: a #GstRTSPStream object
@@ -0,0 +1,326 @@
+/* GStreamer
+ *
+ * rtspsessions.c: opens many RTSP sessions and keeps them alive, to measure
+ *     the connection and keepalive handling of the server
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Without an url, the sessions are opened on a server running in the same
+ * process, with the given number of accept threads. Each session uses one
+ * socket on both ends, so the file descriptor limit (ulimit -n) usually has
+ * to be raised for more than a few hundred sessions. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/rtsp/gstrtspconnection.h>
+
+#include <gst/rtsp-server/rtsp-server.h>
+
+#define TIMEOUT (10 * G_USEC_PER_SEC)
+#define MOUNT_POINT "/test"
+#define LAUNCH_LINE "( videotestsrc is-live=true ! " \
+  "video/x-raw,width=320,height=240,framerate=10/1 ! rtpvrawpay name=pay0 pt=96 )"
+
+static gint n_sessions = 1000;
+static gint n_keepalives = 10;
+static gint n_client_threads = 4;
+static gint n_accept_threads = 0;
+static gchar *url = NULL;
+
+static GOptionEntry entries[] = {
+  {"sessions", 'n', 0, G_OPTION_ARG_INT, &n_sessions,
+      "Number of sessions to open (default: 1000)", "N"},
+  {"keepalives", 'k', 0, G_OPTION_ARG_INT, &n_keepalives,
+      "Number of keepalive requests per session (default: 10)", "N"},
+  {"client-threads", 'j', 0, G_OPTION_ARG_INT, &n_client_threads,
+      "Number of threads sending the requests (default: 4)", "N"},
+  {"accept-threads", 't', 0, G_OPTION_ARG_INT, &n_accept_threads,
+      "Accept threads of the in-process server (default: 0)", "N"},
+  {"url", 'u', 0, G_OPTION_ARG_STRING, &url,
+      "Open the sessions on this server instead of an in-process one", "URL"},
+  {NULL}
+};
+
+typedef enum
+{
+  PHASE_SETUP,
+  PHASE_KEEPALIVE,
+  PHASE_TEARDOWN
+} Phase;
+
+static const gchar *phase_names[] = { "setup", "keepalive", "teardown" };
+
+typedef struct
+{
+  GstRTSPConnection *conn;
+  gchar *session;
+} Session;
+
+typedef struct
+{
+  Session *sessions;
+  guint n_sessions;
+  Phase phase;
+  guint n_failed;
+} Worker;
+
+static gboolean
+do_request (GstRTSPConnection * conn, GstRTSPMethod method,
+    const gchar * uri, const gchar * session, const gchar * transport,
+    gchar ** session_out)
+{
+  GstRTSPMessage request = { 0, };
+  GstRTSPMessage response = { 0, };
+  gboolean res = FALSE;
+  gchar *value;
+
+  gst_rtsp_message_init_request (&request, method, uri);
+  if (session)
+    gst_rtsp_message_add_header (&request, GST_RTSP_HDR_SESSION, session);
+  if (transport)
+    gst_rtsp_message_add_header (&request, GST_RTSP_HDR_TRANSPORT, transport);
+
+  if (gst_rtsp_connection_send_usec (conn, &request, TIMEOUT) != GST_RTSP_OK)
+    goto done;
+  if (gst_rtsp_connection_receive_usec (conn, &response, TIMEOUT) !=
+      GST_RTSP_OK)
+    goto done;
+  if (response.type != GST_RTSP_MESSAGE_RESPONSE ||
+      response.type_data.response.code != GST_RTSP_STS_OK)
+    goto done;
+
+  if (session_out) {
+    if (gst_rtsp_message_get_header (&response, GST_RTSP_HDR_SESSION, &value,
+            0) != GST_RTSP_OK)
+      goto done;
+    /* strip the timeout */
+    *session_out = g_strndup (value, strcspn (value, ";"));
+  }
+  res = TRUE;
+
+done:
+  gst_rtsp_message_unset (&request);
+  gst_rtsp_message_unset (&response);
+
+  return res;
+}
+
+static gboolean
+open_session (Session * s)
+{
+  GstRTSPUrl *rtsp_url;
+  gchar *control;
+  gboolean res;
+
+  if (gst_rtsp_url_parse (url, &rtsp_url) != GST_RTSP_OK)
+    return FALSE;
+  res = gst_rtsp_connection_create (rtsp_url, &s->conn) == GST_RTSP_OK;
+  gst_rtsp_url_free (rtsp_url);
+  if (!res)
+    return FALSE;
+
+  if (gst_rtsp_connection_connect_usec (s->conn, TIMEOUT) != GST_RTSP_OK)
+    return FALSE;
+
+  /* the server names the streams stream=%d */
+  control = g_strdup_printf ("%s/stream=0", url);
+  res = do_request (s->conn, GST_RTSP_OPTIONS, url, NULL, NULL, NULL) &&
+      do_request (s->conn, GST_RTSP_DESCRIBE, url, NULL, NULL, NULL) &&
+      do_request (s->conn, GST_RTSP_SETUP, control, NULL,
+      "RTP/AVP/TCP;unicast;interleaved=0-1", &s->session);
+  g_free (control);
+
+  return res;
+}
+
+static void
+close_session (Session * s)
+{
+  if (s->session)
+    do_request (s->conn, GST_RTSP_TEARDOWN, url, s->session, NULL, NULL);
+  if (s->conn)
+    gst_rtsp_connection_free (s->conn);
+  g_free (s->session);
+  s->conn = NULL;
+  s->session = NULL;
+}
+
+static gpointer
+run_worker (Worker * w)
+{
+  guint i, j;
+
+  for (i = 0; i < w->n_sessions; i++) {
+    Session *s = &w->sessions[i];
+
+    switch (w->phase) {
+      case PHASE_SETUP:
+        if (!open_session (s))
+          w->n_failed++;
+        break;
+      case PHASE_KEEPALIVE:
+        if (!s->session)
+          break;
+        for (j = 0; j < n_keepalives; j++) {
+          if (!do_request (s->conn, GST_RTSP_GET_PARAMETER, url, s->session,
+                  NULL, NULL))
+            w->n_failed++;
+        }
+        break;
+      case PHASE_TEARDOWN:
+        close_session (s);
+        break;
+    }
+  }
+
+  return NULL;
+}
+
+static void
+run_phase (Worker * workers, Phase phase, guint n_requests)
+{
+  GThread **threads = g_new (GThread *, n_client_threads);
+  GstClockTime start, end;
+  guint i, n_failed = 0;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_client_threads; i++) {
+    workers[i].phase = phase;
+    workers[i].n_failed = 0;
+    threads[i] = g_thread_new (phase_names[phase], (GThreadFunc) run_worker,
+        &workers[i]);
+  }
+  for (i = 0; i < n_client_threads; i++) {
+    g_thread_join (threads[i]);
+    n_failed += workers[i].n_failed;
+  }
+  end = gst_util_get_timestamp ();
+
+  g_print ("%-9s %6d sessions, %2d accept threads: %10.1f us/request, "
+      "%u failed\n", phase_names[phase], n_sessions, n_accept_threads,
+      (gdouble) GST_CLOCK_DIFF (start, end) / (n_requests * GST_USECOND),
+      n_failed);
+
+  g_free (threads);
+}
+
+static gpointer
+run_server (GMainLoop * loop)
+{
+  g_main_context_push_thread_default (g_main_loop_get_context (loop));
+  g_main_loop_run (loop);
+  g_main_context_pop_thread_default (g_main_loop_get_context (loop));
+
+  return NULL;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GOptionContext *optctx;
+  GError *error = NULL;
+  GstRTSPServer *server = NULL;
+  GMainContext *context = NULL;
+  GMainLoop *loop = NULL;
+  GThread *server_thread = NULL;
+  GSource *source = NULL;
+  Session *sessions;
+  Worker *workers;
+  guint i;
+
+  optctx = g_option_context_new ("- RTSP session benchmark");
+  g_option_context_add_main_entries (optctx, entries, NULL);
+  g_option_context_add_group (optctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (optctx, &argc, &argv, &error)) {
+    g_printerr ("Error parsing options: %s\n", error->message);
+    g_option_context_free (optctx);
+    g_clear_error (&error);
+    return -1;
+  }
+  g_option_context_free (optctx);
+
+  if (n_sessions <= 0 || n_client_threads <= 0 || n_accept_threads < 0) {
+    g_printerr ("invalid number of sessions or threads\n");
+    return -1;
+  }
+
+  if (url == NULL) {
+    GstRTSPMountPoints *mounts;
+    GstRTSPMediaFactory *factory;
+
+    server = gst_rtsp_server_new ();
+    gst_rtsp_server_set_service (server, "0");
+    gst_rtsp_server_set_backlog (server, 1024);
+    gst_rtsp_server_set_accept_threads (server, n_accept_threads);
+
+    /* all sessions share one pipeline, only the RTSP handling is measured */
+    factory = gst_rtsp_media_factory_new ();
+    gst_rtsp_media_factory_set_launch (factory, LAUNCH_LINE);
+    gst_rtsp_media_factory_set_shared (factory, TRUE);
+    mounts = gst_rtsp_server_get_mount_points (server);
+    gst_rtsp_mount_points_add_factory (mounts, MOUNT_POINT, factory);
+    g_object_unref (mounts);
+
+    context = g_main_context_new ();
+    source = gst_rtsp_server_create_source (server, NULL, &error);
+    if (source == NULL) {
+      g_printerr ("failed to start server: %s\n", error->message);
+      g_clear_error (&error);
+      return -1;
+    }
+    g_source_attach (source, context);
+
+    loop = g_main_loop_new (context, FALSE);
+    server_thread = g_thread_new ("server", (GThreadFunc) run_server, loop);
+
+    url = g_strdup_printf ("rtsp://127.0.0.1:%d" MOUNT_POINT,
+        gst_rtsp_server_get_bound_port (server));
+  }
+
+  sessions = g_new0 (Session, n_sessions);
+  workers = g_new0 (Worker, n_client_threads);
+  for (i = 0; i < n_client_threads; i++) {
+    guint first = (guint64) n_sessions * i / n_client_threads;
+    guint last = (guint64) n_sessions * (i + 1) / n_client_threads;
+
+    workers[i].sessions = sessions + first;
+    workers[i].n_sessions = last - first;
+  }
+
+  /* OPTIONS, DESCRIBE and SETUP */
+  run_phase (workers, PHASE_SETUP, n_sessions * 3);
+  run_phase (workers, PHASE_KEEPALIVE, n_sessions * MAX (n_keepalives, 1));
+  run_phase (workers, PHASE_TEARDOWN, n_sessions);
+
+  g_free (workers);
+  g_free (sessions);
+
+  if (server) {
+    g_source_destroy (source);
+    g_source_unref (source);
+    g_main_loop_quit (loop);
+    g_thread_join (server_thread);
+    g_main_loop_unref (loop);
+    g_main_context_unref (context);
+    g_object_unref (server);
+  }
+  g_free (url);
+
+  return 0;
+}
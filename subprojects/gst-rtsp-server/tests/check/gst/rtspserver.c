@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <netinet/in.h>
+#include <gio/gnetworking.h>
 
 #include "rtsp-server.h"
 
@@ -1383,6 +1384,63 @@ GST_START_TEST (test_play_multithreaded)
 
 GST_END_TEST;
 
+typedef struct
+{
+  GThread *main_thread;
+  gint n_connected;
+  gint n_accept_thread;
+} AcceptThreadsData;
+
+static void
+client_connected_count (GstRTSPServer * server, GstRTSPClient * client,
+    AcceptThreadsData * data)
+{
+  g_atomic_int_inc (&data->n_connected);
+  /* clients on the main socket are accepted from the default main context,
+   * which is iterated in the test thread */
+  if (g_thread_self () != data->main_thread)
+    g_atomic_int_inc (&data->n_accept_thread);
+}
+
+GST_START_TEST (test_play_accept_threads)
+{
+  GstRTSPConnection *conns[16];
+  AcceptThreadsData data = { g_thread_self (), 0, 0 };
+  guint i;
+
+  g_object_set (server, "accept-threads", 3, NULL);
+  fail_unless_equals_int (gst_rtsp_server_get_accept_threads (server), 3);
+  g_signal_connect (server, "client-connected",
+      G_CALLBACK (client_connected_count), &data);
+
+  start_server (FALSE);
+
+  /* the connections are spread over all listening sockets, each of them
+   * must be accepted and served */
+  for (i = 0; i < G_N_ELEMENTS (conns); i++) {
+    conns[i] = connect_to_server (test_port, TEST_MOUNT_POINT);
+    fail_unless (do_simple_request (conns[i], GST_RTSP_OPTIONS,
+            NULL) == GST_RTSP_STS_OK);
+  }
+  fail_unless_equals_int (g_atomic_int_get (&data.n_connected),
+      G_N_ELEMENTS (conns));
+#ifdef SO_REUSEPORT
+  /* with 4 sockets, all 16 connections landing on the main socket is very
+   * unlikely */
+  fail_unless (g_atomic_int_get (&data.n_accept_thread) > 0);
+#endif
+
+  do_test_play (NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (conns); i++)
+    gst_rtsp_connection_free (conns[i]);
+
+  stop_server ();
+  iterate ();
+}
+
+GST_END_TEST;
+
 enum
 {
   BLOCK_ME,
@@ -2730,6 +2788,7 @@ rtspserver_suite (void)
   tcase_add_test (tc, test_play_without_session);
   tcase_add_test (tc, test_bind_already_in_use);
   tcase_add_test (tc, test_play_multithreaded);
+  tcase_add_test (tc, test_play_accept_threads);
   tcase_add_test (tc, test_play_multithreaded_block_in_describe);
   tcase_add_test (tc, test_play_multithreaded_timeout_client);
   tcase_add_test (tc, test_play_multithreaded_timeout_session);
@@ -21,6 +21,7 @@
 
 #include <rtsp-stream.h>
 #include <rtsp-address-pool.h>
+#include <rtsp-server-internal.h>
 
 static void
 get_sockets (GstRTSPLowerTrans lower_transport, GSocketFamily socket_family)
@@ -498,6 +499,331 @@ GST_START_TEST (test_tcp_transport)
 
 GST_END_TEST;
 
+GST_START_TEST (test_tcp_backlog_limits)
+{
+  GstPad *srcpad;
+  GstElement *pay;
+  GstRTSPStream *stream;
+  guint64 max_bytes;
+  GstClockTime max_duration;
+  GEnumClass *enum_class;
+  GEnumValue *value;
+
+  srcpad = gst_pad_new ("testsrcpad", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  pay = gst_element_factory_make ("rtpgstpay", "testpayloader");
+  fail_unless (pay != NULL);
+  stream = gst_rtsp_stream_new (0, pay, srcpad);
+  fail_unless (stream != NULL);
+  gst_object_unref (pay);
+  gst_object_unref (srcpad);
+
+  /* by default slow clients are dropped after 10 seconds of backlog */
+  gst_rtsp_stream_get_backlog_limits (stream, &max_bytes, &max_duration);
+  fail_unless_equals_uint64 (max_bytes, 0);
+  fail_unless_equals_uint64 (max_duration, 10 * GST_SECOND);
+  fail_unless_equals_int (gst_rtsp_stream_get_backlog_policy (stream),
+      GST_RTSP_BACKLOG_POLICY_DROP_CLIENT);
+
+  gst_rtsp_stream_set_backlog_limits (stream, 1024 * 1024,
+      GST_CLOCK_TIME_NONE);
+  gst_rtsp_stream_set_backlog_policy (stream,
+      GST_RTSP_BACKLOG_POLICY_DROP_OLDEST);
+
+  gst_rtsp_stream_get_backlog_limits (stream, &max_bytes, NULL);
+  fail_unless_equals_uint64 (max_bytes, 1024 * 1024);
+  gst_rtsp_stream_get_backlog_limits (stream, NULL, &max_duration);
+  fail_unless_equals_uint64 (max_duration, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (gst_rtsp_stream_get_backlog_policy (stream),
+      GST_RTSP_BACKLOG_POLICY_DROP_OLDEST);
+
+  enum_class = g_type_class_ref (GST_TYPE_RTSP_BACKLOG_POLICY);
+  value = g_enum_get_value_by_nick (enum_class, "drop-newest");
+  fail_unless (value != NULL);
+  fail_unless_equals_int (value->value, GST_RTSP_BACKLOG_POLICY_DROP_NEWEST);
+  g_type_class_unref (enum_class);
+
+  gst_object_unref (stream);
+}
+
+GST_END_TEST;
+
+#define BACKLOG_PACKET_SIZE 100
+
+static gboolean
+backlog_send_list (GstBufferList * buffer_list, guint8 channel,
+    gpointer user_data)
+{
+  fail ("nothing is sent from the backlog in these tests");
+  return FALSE;
+}
+
+/* a TCP transport nobody sends on, so packets stay in its backlog */
+static GstRTSPStreamTransport *
+new_backlog_transport (GstRTSPStream ** stream, gboolean send_lists)
+{
+  GstRTSPStreamTransport *trans;
+  GstRTSPTransport *transport;
+  GstPad *srcpad;
+  GstElement *pay;
+
+  srcpad = gst_pad_new ("testsrcpad", GST_PAD_SRC);
+  fail_unless (srcpad != NULL);
+  pay = gst_element_factory_make ("rtpgstpay", "testpayloader");
+  fail_unless (pay != NULL);
+  *stream = gst_rtsp_stream_new (0, pay, srcpad);
+  fail_unless (*stream != NULL);
+  gst_object_unref (pay);
+  gst_object_unref (srcpad);
+
+  fail_unless (gst_rtsp_transport_new (&transport) == GST_RTSP_OK);
+  transport->lower_transport = GST_RTSP_LOWER_TRANS_TCP;
+  transport->interleaved.min = 0;
+  transport->interleaved.max = 1;
+
+  trans = gst_rtsp_stream_transport_new (*stream, transport);
+  fail_unless (trans != NULL);
+
+  /* only checked for merging packets into lists */
+  if (send_lists)
+    gst_rtsp_stream_transport_set_list_callbacks (trans, backlog_send_list,
+        backlog_send_list, NULL, NULL);
+
+  return trans;
+}
+
+static gboolean
+backlog_push (GstRTSPStreamTransport * trans, guint index, gboolean is_rtp)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_allocate (NULL, BACKLOG_PACKET_SIZE, NULL);
+  GST_BUFFER_PTS (buffer) = index * GST_MSECOND;
+
+  return gst_rtsp_stream_transport_backlog_push (trans, buffer, NULL, is_rtp);
+}
+
+static void
+backlog_push_list (GstRTSPStreamTransport * trans, guint index, guint length)
+{
+  GstBufferList *list;
+  guint i;
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < length; i++) {
+    GstBuffer *buffer;
+
+    buffer = gst_buffer_new_allocate (NULL, BACKLOG_PACKET_SIZE, NULL);
+    GST_BUFFER_PTS (buffer) = (index + i) * GST_MSECOND;
+    gst_buffer_list_add (list, buffer);
+  }
+
+  fail_unless (gst_rtsp_stream_transport_backlog_push (trans, NULL, list,
+          TRUE));
+}
+
+/* pops a single RTP packet and returns its index */
+static guint
+backlog_pop (GstRTSPStreamTransport * trans)
+{
+  GstBuffer *buffer = NULL;
+  GstBufferList *list = NULL;
+  gboolean is_rtp = FALSE;
+  guint index;
+
+  fail_unless (gst_rtsp_stream_transport_backlog_pop (trans, &buffer, &list,
+          &is_rtp));
+  fail_unless (buffer != NULL);
+  fail_unless (list == NULL);
+  fail_unless (is_rtp);
+
+  index = GST_BUFFER_PTS (buffer) / GST_MSECOND;
+  gst_buffer_unref (buffer);
+
+  return index;
+}
+
+/* pops a batch and checks that it holds @length packets starting at
+ * @index */
+static void
+backlog_pop_batch (GstRTSPStreamTransport * trans, guint index, guint length,
+    gboolean rtp)
+{
+  GstBuffer *buffer = NULL;
+  GstBufferList *list = NULL;
+  gboolean is_rtp = !rtp;
+  guint i;
+
+  fail_unless (gst_rtsp_stream_transport_backlog_pop_batch (trans, &buffer,
+          &list, &is_rtp));
+  fail_unless_equals_int (is_rtp, rtp);
+
+  if (length == 1 && buffer) {
+    fail_unless (list == NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), index * GST_MSECOND);
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  fail_unless (buffer == NULL);
+  fail_unless (list != NULL);
+  fail_unless_equals_int (gst_buffer_list_length (list), length);
+  for (i = 0; i < length; i++)
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (gst_buffer_list_get (list, i)),
+        (index + i) * GST_MSECOND);
+  gst_buffer_list_unref (list);
+}
+
+GST_START_TEST (test_tcp_backlog_drop_oldest)
+{
+  GstRTSPStreamTransport *trans;
+  GstRTSPStream *stream;
+  guint i;
+
+  trans = new_backlog_transport (&stream, FALSE);
+  gst_rtsp_stream_transport_set_backlog_limits (trans,
+      10 * BACKLOG_PACKET_SIZE, GST_CLOCK_TIME_NONE,
+      GST_RTSP_BACKLOG_POLICY_DROP_OLDEST);
+
+  /* only the 10 newest packets fit */
+  for (i = 0; i < 15; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  for (i = 5; i < 15; i++)
+    fail_unless_equals_int (backlog_pop (trans), i);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  /* the popped packets don't count anymore */
+  for (i = 100; i < 110; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  fail_unless_equals_int (backlog_pop (trans), 100);
+
+  /* a single packet over the limit is kept */
+  gst_rtsp_stream_transport_clear_backlog (trans);
+  gst_rtsp_stream_transport_set_backlog_limits (trans,
+      BACKLOG_PACKET_SIZE / 2, GST_CLOCK_TIME_NONE,
+      GST_RTSP_BACKLOG_POLICY_DROP_OLDEST);
+  fail_unless (backlog_push (trans, 200, TRUE));
+  fail_unless (backlog_push (trans, 201, TRUE));
+  fail_unless_equals_int (backlog_pop (trans), 201);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  g_object_unref (trans);
+  gst_object_unref (stream);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_tcp_backlog_drop_newest)
+{
+  GstRTSPStreamTransport *trans;
+  GstRTSPStream *stream;
+  guint i;
+
+  trans = new_backlog_transport (&stream, FALSE);
+  gst_rtsp_stream_transport_set_backlog_limits (trans,
+      10 * BACKLOG_PACKET_SIZE, GST_CLOCK_TIME_NONE,
+      GST_RTSP_BACKLOG_POLICY_DROP_NEWEST);
+
+  /* the packets that don't fit anymore are dropped */
+  for (i = 0; i < 15; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (backlog_pop (trans), i);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  /* a cleared backlog is empty again */
+  for (i = 100; i < 110; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  gst_rtsp_stream_transport_clear_backlog (trans);
+  for (i = 200; i < 210; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  for (i = 200; i < 210; i++)
+    fail_unless_equals_int (backlog_pop (trans), i);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  g_object_unref (trans);
+  gst_object_unref (stream);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_tcp_backlog_drop_client)
+{
+  GstRTSPStreamTransport *trans;
+  GstRTSPStream *stream;
+  guint i;
+
+  trans = new_backlog_transport (&stream, FALSE);
+  gst_rtsp_stream_transport_set_backlog_limits (trans,
+      10 * BACKLOG_PACKET_SIZE, GST_CLOCK_TIME_NONE,
+      GST_RTSP_BACKLOG_POLICY_DROP_CLIENT);
+
+  for (i = 0; i < 10; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  fail_if (backlog_push (trans, i, TRUE));
+
+  g_object_unref (trans);
+  gst_object_unref (stream);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_tcp_backlog_pop_batch)
+{
+  GstRTSPStreamTransport *trans;
+  GstRTSPStream *stream;
+  guint i;
+
+  /* without list callbacks, every packet is popped on its own */
+  trans = new_backlog_transport (&stream, FALSE);
+  for (i = 0; i < 3; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  for (i = 0; i < 3; i++)
+    backlog_pop_batch (trans, i, 1, TRUE);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+  g_object_unref (trans);
+  gst_object_unref (stream);
+
+  trans = new_backlog_transport (&stream, TRUE);
+  gst_rtsp_stream_transport_set_backlog_limits (trans,
+      50 * BACKLOG_PACKET_SIZE, GST_CLOCK_TIME_NONE,
+      GST_RTSP_BACKLOG_POLICY_DROP_OLDEST);
+
+  /* at most 32 packets per batch, and RTP and RTCP are never merged */
+  for (i = 0; i < 40; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  fail_unless (backlog_push (trans, 40, FALSE));
+  fail_unless (backlog_push (trans, 41, FALSE));
+  fail_unless (backlog_push (trans, 42, TRUE));
+  backlog_pop_batch (trans, 0, 32, TRUE);
+  backlog_pop_batch (trans, 32, 8, TRUE);
+  backlog_pop_batch (trans, 40, 2, FALSE);
+  backlog_pop_batch (trans, 42, 1, TRUE);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  /* the batches released their bytes, 50 packets fit again */
+  for (i = 100; i < 150; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  backlog_pop_batch (trans, 100, 32, TRUE);
+  backlog_pop_batch (trans, 132, 18, TRUE);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  /* buffer lists are merged as a whole, a list that doesn't fit anymore
+   * starts the next batch */
+  for (i = 200; i < 230; i++)
+    fail_unless (backlog_push (trans, i, TRUE));
+  backlog_push_list (trans, 230, 5);
+  fail_unless (backlog_push (trans, 235, TRUE));
+  backlog_pop_batch (trans, 200, 30, TRUE);
+  backlog_pop_batch (trans, 230, 6, TRUE);
+  fail_unless (gst_rtsp_stream_transport_backlog_is_empty (trans));
+
+  g_object_unref (trans);
+  gst_object_unref (stream);
+}
+
+GST_END_TEST;
+
 static void
 check_multicast_client_address (const gchar * destination, guint port,
     const gchar * expected_addr_str, gboolean expected_res)
@@ -695,6 +1021,11 @@ rtspstream_suite (void)
   tcase_add_test (tc, test_allocate_udp_ports_multicast);
   tcase_add_test (tc, test_allocate_udp_ports_client_settings);
   tcase_add_test (tc, test_tcp_transport);
+  tcase_add_test (tc, test_tcp_backlog_limits);
+  tcase_add_test (tc, test_tcp_backlog_drop_oldest);
+  tcase_add_test (tc, test_tcp_backlog_drop_newest);
+  tcase_add_test (tc, test_tcp_backlog_drop_client);
+  tcase_add_test (tc, test_tcp_backlog_pop_batch);
   tcase_add_test (tc, test_multicast_client_address);
   tcase_add_test (tc, test_multicast_client_address_invalid);
   tcase_add_test (tc, test_add_transport_twice);